@@ -143,10 +143,17 @@ void array_copy_value(void* csound, void* dest, void* src) {
 
 /* MEM SIZE UPDATING FUNCTIONS */
 
+/* with --simd-align, a-rate buffers are padded to CS_SIMD_ALIGN bytes */
+static int asigMemBlockSize(CSOUND* csound, int ksmps) {
+    if (csound->oparms->simd_align)
+      return CS_SIMD_PAD(ksmps) * sizeof (MYFLT);
+    return CS_FLOAT_ALIGN(ksmps * sizeof (MYFLT));
+}
+
 void updateAsigMemBlock(void* csound, CS_VARIABLE* var) {
     CSOUND* cs = (CSOUND*)csound;
     int ksmps = cs->ksmps;
-    var->memBlockSize = CS_FLOAT_ALIGN(ksmps * sizeof (MYFLT));
+    var->memBlockSize = asigMemBlockSize(cs, ksmps);
 }
 
 void varInitMemory(void *csound, CS_VARIABLE* var, MYFLT* memblock) {
@@ -192,7 +199,7 @@ CS_VARIABLE* createAsig(void* cs, void* p) {
 //    }
 
     CS_VARIABLE* var = csound->Calloc(csound, sizeof (CS_VARIABLE));
-    var->memBlockSize = CS_FLOAT_ALIGN(ksmps * sizeof (MYFLT));
+    var->memBlockSize = asigMemBlockSize(csound, ksmps);
     var->updateMemBlockSize = &updateAsigMemBlock;
     var->initializeVariableMemory = &varInitMemory;
     return var;
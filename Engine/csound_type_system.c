@@ -211,6 +211,26 @@ CS_VARIABLE* csoundGetVariable(CS_VAR_POOL* pool, int index) {
 //    return -1;
 //}
 
+/* Sets the position of var in the pool memory, after the varCount - 1
+   variables already in it, and adds its size to the pool.  Each variable
+   is preceded by its type pointer.  var pools are accessed as MYFLT*, so
+   all memory is aligned to sizeof(MYFLT); with the simd_align option
+   a-rate variables are moved up to CS_SIMD_ALIGN boundaries from the
+   start of the pool, which instance() aligns to match, and the gap is
+   counted in poolSize. */
+static void placeVariable(CSOUND* csound, CS_VAR_POOL* pool,
+                          CS_VARIABLE* var, int varCount)
+{
+    size_t offset = (size_t) pool->poolSize +
+                    (size_t) varCount * CS_FLOAT_ALIGN(CS_VAR_TYPE_OFFSET);
+    if (csound->oparms->simd_align && var->varType == &CS_VAR_TYPE_A) {
+      pool->poolSize += (int) (CS_SIMD_ALIGN_UP(offset) - offset);
+      offset = CS_SIMD_ALIGN_UP(offset);
+    }
+    var->memBlockIndex = (int) (offset / sizeof(MYFLT));
+    pool->poolSize += var->memBlockSize;
+}
+
 int csoundAddVariable(CSOUND* csound, CS_VAR_POOL* pool, CS_VARIABLE* var) {
   if(var != NULL) {
     if(pool->head == NULL) {
@@ -221,11 +241,7 @@ int csoundAddVariable(CSOUND* csound, CS_VAR_POOL* pool, CS_VARIABLE* var) {
       pool->tail = var;
     }
     cs_hash_table_put(csound, pool->table, var->varName, var);
-    // may need to revise this; var pools are accessed as MYFLT*,
-    // so need to ensure all memory is aligned to sizeof(MYFLT)
-    var->memBlockIndex = (pool->poolSize / sizeof(MYFLT)) +
-      ((pool->varCount + 1) * (CS_FLOAT_ALIGN(CS_VAR_TYPE_OFFSET) / sizeof(MYFLT)));
-    pool->poolSize += var->memBlockSize;
+    placeVariable(csound, pool, var, pool->varCount + 1);
     pool->varCount += 1;
     return 0;
   } else return -1;
@@ -244,9 +260,7 @@ void recalculateVarPoolMemory(void* csound, CS_VAR_POOL* pool)
         current->updateMemBlockSize(csound, current);
       }
 
-      current->memBlockIndex = (pool->poolSize / sizeof(MYFLT)) +
-        (varCount * CS_FLOAT_ALIGN(CS_VAR_TYPE_OFFSET) / sizeof(MYFLT));
-      pool->poolSize += current->memBlockSize;
+      placeVariable((CSOUND*) csound, pool, current, varCount);
 
       current = current->next;
       varCount++;
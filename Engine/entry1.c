@@ -864,7 +864,7 @@ OENTRY opcodlst_1[] = {
     (SUBR)fassign_set, (SUBR)fassign },
   { "init.f",   S(FASSIGN),0, 1,    "f",   "f",
     (SUBR)fassign_set, NULL, NULL    },
-  { "pvsanal",  S(PVSANAL), 0, 5,   "f",   "aiiiioo",
+  { "pvsanal",  S(PVSANAL), 0, 5,   "f",   "aiiiioooo",
     pvsanalset, NULL, pvsanal   },
   { "pvsynth",  S(PVSYNTH),0, 5,    "a",   "fo",     pvsynthset, NULL, pvsynth },
   { "pvsadsyn", S(PVADS),0,   7,    "a",   "fikopo", pvadsynset, pvadsyn, pvadsyn},
@@ -54,6 +54,17 @@ static const char *envVar_list[] = {
     NULL
 };
 
+/* a seek queued for an async file's worker; mark is the number of items
+   the opcode had moved through the ring when it asked for it */
+
+#define ASYNC_IO_SEEKS      8   /* seeks that may be queued, power of 2  */
+
+typedef struct ASYNC_SEEK_ {
+    int             pos;
+    int             whence;
+    unsigned int    mark;
+} ASYNC_SEEK;
+
 typedef struct CSFILE_ {
     struct CSFILE_  *nxt;
     struct CSFILE_  *prv;
@@ -67,9 +78,59 @@ typedef struct CSFILE_ {
     int             pos;
     MYFLT           *buf;
     int             bufsize;
+    /* asynchronous i/o state, see the async i/o service below */
+    struct CSFILE_  *anxt;          /* next file served by the same worker */
+    void            *worker;
+    ASYNC_SEEK      seekq[ASYNC_IO_SEEKS];  /* seeks for the worker */
+    volatile unsigned int seek_wr;  /* seeks queued by the opcode side */
+    volatile unsigned int seek_rd;  /* seeks carried out by the worker */
+    unsigned int    drained;        /* items the worker took off the ring */
+    int             ringsize;       /* ring capacity in items */
+    int             nchnls;         /* items per frame */
+    unsigned int    transferred;    /* items moved by the opcode side */
+    unsigned int    transferred_seen;
+    unsigned int    wake_mark;
+    double          rate;           /* smoothed items moved per service */
+    unsigned int    overruns;       /* items dropped with the ring full */
+    int             wpad;           /* items owed to a frame cut short */
     char            fullName[1];
 } CSFILE;
 
+/* async i/o service: a small pool of worker threads, each owning a list
+   of files. A worker sleeps until an opcode has moved half a ring of data
+   (or a seek is requested) and then services only its own files, so no
+   lock is shared between files on different workers and the opcode side
+   never takes a lock at all. */
+
+#define ASYNC_IO_MAXWORKERS 4
+#define ASYNC_IO_RINGBUFS   8   /* ring size, in units of the i/o buffer  */
+#define ASYNC_IO_WRITEBUFS  32  /* ring size for files being written      */
+#define ASYNC_IO_MAXCHUNK   4   /* largest readahead, same units          */
+
+typedef struct ASYNC_WORKER_ {
+    CSOUND          *csound;
+    void            *thread;
+    void            *wake;          /* thread lock the worker sleeps on */
+    void            *mutex;         /* protects the file list */
+    CSFILE          *files;
+    volatile int    pending;
+    volatile int    running;
+} ASYNC_WORKER;
+
+typedef struct ASYNC_IO_ {
+    ASYNC_WORKER    worker[ASYNC_IO_MAXWORKERS];
+    int             next;           /* round robin file assignment */
+} ASYNC_IO;
+
+#ifdef HAVE_ATOMIC_BUILTIN
+#define ASYNC_BARRIER() __sync_synchronize()
+#else
+#define ASYNC_BARRIER()
+#endif
+
+static void async_io_drain(CSOUND *csound, CSFILE *p, unsigned int limit);
+static void async_io_seek(CSOUND *csound, CSFILE *p);
+
 #if defined(MSVC)
 #define RD_OPTS  _O_RDONLY | _O_BINARY
 #define WR_OPTS  _O_TRUNC | _O_CREAT | _O_WRONLY | _O_BINARY,_S_IWRITE
@@ -1240,6 +1301,9 @@ void *csoundCreateFileHandle(CSOUND *csound,
     csound->open_files = (void*) p;
     /* return with opaque file handle */
     p->cb = NULL;
+    p->async_flag = 0;
+    p->buf = NULL;
+    p->bufsize = 0;
     return (void*) p;
 }
 
@@ -1261,7 +1325,26 @@ int csoundFileClose(CSOUND *csound, void *fd)
     CSFILE  *p = (CSFILE*) fd;
     int     retval = -1;
     if (p->async_flag == ASYNC_GLOBAL) {
-     csound->WaitThreadLockNoTimeout(csound->file_io_threadlock);
+     ASYNC_WORKER *w = (ASYNC_WORKER *) p->worker;
+     CSFILE **pp;
+     /* detach from the worker; it never holds its list lock for longer
+        than one pass over its own files */
+     csound->LockMutex(w->mutex);
+     for (pp = &(w->files); *pp != NULL; pp = &((*pp)->anxt))
+       if (*pp == p) {
+         *pp = p->anxt;
+         break;
+       }
+     csound->UnlockMutex(w->mutex);
+     /* flush anything still queued for writing */
+     if (p->type == CSFILE_SND_W && p->sf != NULL) {
+       async_io_seek(csound, p);
+       async_io_drain(csound, p, p->transferred - p->drained);
+     }
+     if (p->overruns)
+       csound->Warning(csound, Str("%s: write buffer overrun, "
+                                   "%u samples dropped"),
+                       p->fullName, p->overruns);
      /* close file */
     switch (p->type) {
       case CSFILE_FD_R:
@@ -1290,7 +1373,6 @@ int csoundFileClose(CSOUND *csound, void *fd)
     if(p->buf != NULL) csound->Free(csound, p->buf);
     p->bufsize = 0;
     csound->DestroyCircularBuffer(csound, p->cb);
-    csound->NotifyThreadLock(csound->file_io_threadlock);
    } else {
    /* close file */
     switch (p->type) {
@@ -1330,11 +1412,22 @@ void close_all_files(CSOUND *csound)
     while (csound->open_files != NULL)
       csoundFileClose(csound, csound->open_files);
     if (csound->file_io_start) {
-#ifndef __EMSCRIPTEN__
-        csound->JoinThread(csound->file_io_thread);
-#endif
-        if (csound->file_io_threadlock != NULL)
-         csound->DestroyThreadLock(csound->file_io_threadlock);
+      ASYNC_IO *io = (ASYNC_IO *) csound->file_io_service;
+      int i;
+      for (i = 0; i < ASYNC_IO_MAXWORKERS; i++) {
+        ASYNC_WORKER *w = &(io->worker[i]);
+        if (w->thread == NULL)
+          continue;
+        w->running = 0;
+        csound->NotifyThreadLock(w->wake);
+        csound->JoinThread(w->thread);
+        csound->NotifyThreadLock(w->wake);   /* release before destroy */
+        csound->DestroyThreadLock(w->wake);
+        csound->DestroyMutex(w->mutex);
+      }
+      csound->Free(csound, io);
+      csound->file_io_service = NULL;
+      csound->file_io_start = 0;
     }
 }
 
@@ -1370,7 +1463,52 @@ void *fopen_path(CSOUND *csound, FILE **fp, char *name, char *basename,
   return fd;
 }
 
-void *file_iothread(void *p);
+static uintptr_t async_io_worker(void *p);
+
+static void async_io_wake(CSOUND *csound, ASYNC_WORKER *w)
+{
+    if (!w->pending) {
+      w->pending = 1;
+      csound->NotifyThreadLock(w->wake);
+    }
+}
+
+/* returns the worker that gets the next file, starting it if needed */
+
+static ASYNC_WORKER *async_io_worker_get(CSOUND *csound)
+{
+    ASYNC_IO *io;
+    ASYNC_WORKER *w;
+    if (csound->file_io_start == 0) {
+      io = (ASYNC_IO *) csound->Calloc(csound, sizeof(ASYNC_IO));
+      if (io == NULL)
+        return NULL;
+      csound->file_io_service = (void *) io;
+      csound->file_io_start = 1;
+    }
+    io = (ASYNC_IO *) csound->file_io_service;
+    w = &(io->worker[io->next]);
+    if (w->thread == NULL) {
+      w->csound = csound;
+      w->files = NULL;
+      w->pending = 0;
+      w->running = 1;
+      if ((w->wake = csound->CreateThreadLock()) == NULL)
+        return NULL;
+      if ((w->mutex = csound->Create_Mutex(0)) == NULL) {
+        csound->DestroyThreadLock(w->wake);
+        return NULL;
+      }
+      w->thread = csound->CreateThread(async_io_worker, (void *) w);
+      if (w->thread == NULL) {
+        csound->DestroyMutex(w->mutex);
+        csound->DestroyThreadLock(w->wake);
+        return NULL;
+      }
+    }
+    io->next = (io->next + 1) % ASYNC_IO_MAXWORKERS;
+    return w;
+}
 
 void *csoundFileOpenWithType_Async(CSOUND *csound, void *fd, int type,
                      const char *name, void *param, const char *env,
@@ -1378,32 +1516,53 @@ void *csoundFileOpenWithType_Async(CSOUND *csound, void *fd, int type,
 {
 #ifndef __EMSCRIPTEN__
     CSFILE *p;
+    ASYNC_WORKER *w;
+    if ((w = async_io_worker_get(csound)) == NULL)
+      return NULL;
     if ((p = (CSFILE *) csoundFileOpenWithType(csound,fd,type,name,param,env,
                                                csFileType,isTemporary)) == NULL)
       return NULL;
 
-    if (csound->file_io_start == 0) {
-      csound->file_io_start = 1;
-      csound->file_io_threadlock = csound->CreateThreadLock();
-      csound->NotifyThreadLock(csound->file_io_threadlock);
-      csound->file_io_thread =
-        csound->CreateThread((uintptr_t (*)(void *))file_iothread, (void *) csound);
-    }
-    csound->WaitThreadLockNoTimeout(csound->file_io_threadlock);
     p->async_flag = ASYNC_GLOBAL;
-
-    p->cb = csound->CreateCircularBuffer(csound, buffsize*4, sizeof(MYFLT));
+    p->worker = (void *) w;
+    p->anxt = NULL;
+    p->seek_wr = p->seek_rd = 0;
+    p->drained = 0;
+    p->nchnls = (type == CSFILE_SND_W || type == CSFILE_SND_R) ?
+      ((SF_INFO*) param)->channels : 1;
+    if (p->nchnls < 1)
+      p->nchnls = 1;
+    if (buffsize < p->nchnls)
+      buffsize = p->nchnls;
+    /* files being written get a deeper ring, so that a slow disk is   */
+    /* absorbed by the worker rather than stalling the performance     */
+    p->ringsize = buffsize*(type == CSFILE_SND_W ?
+                            ASYNC_IO_WRITEBUFS : ASYNC_IO_RINGBUFS);
+    p->transferred = p->transferred_seen = p->wake_mark = 0;
+    p->rate = 0.0;
+    p->overruns = 0;
+    p->wpad = 0;
+    p->cb = csound->CreateCircularBuffer(csound, p->ringsize, sizeof(MYFLT));
     p->items = 0;
     p->pos = 0;
     p->bufsize = buffsize;
-    p->buf = (MYFLT *) csound->Calloc(csound, sizeof(MYFLT)*buffsize);
-    csound->NotifyThreadLock(csound->file_io_threadlock);
+    p->buf = (MYFLT *) csound->Calloc(csound,
+                                      sizeof(MYFLT)*buffsize*ASYNC_IO_MAXCHUNK);
 
     if (p->cb == NULL || p->buf == NULL) {
       /* close file immediately */
+      p->async_flag = 0;
+      if (p->buf != NULL) csound->Free(csound, p->buf);
+      csound->DestroyCircularBuffer(csound, p->cb);
       csoundFileClose(csound, (void *) p);
       return NULL;
     }
+    /* hand the file to its worker */
+    csound->LockMutex(w->mutex);
+    p->anxt = w->files;
+    w->files = p;
+    csound->UnlockMutex(w->mutex);
+    async_io_wake(csound, w);
     return (void *) p;
 #else
     return NULL;
@@ -1414,97 +1573,190 @@ unsigned int csoundReadAsync(CSOUND *csound, void *handle,
                              MYFLT *buf, int items)
 {
     CSFILE *p = handle;
-    if(p != NULL &&  p->cb != NULL)
-    return csound->ReadCircularBuffer(csound, p->cb, buf, items);
-    else return 0;
+    int n;
+    if (p == NULL || p->cb == NULL || p->seek_rd != p->seek_wr)
+      return 0;
+    ASYNC_BARRIER();
+    n = csound->ReadCircularBuffer(csound, p->cb, buf, items);
+    p->transferred += n;
+    if (p->transferred - p->wake_mark >= (unsigned int) (p->ringsize >> 1)) {
+      p->wake_mark = p->transferred;
+      async_io_wake(csound, (ASYNC_WORKER *) p->worker);
+    }
+    return n;
 }
 
+/* Writes never wait: data that does not fit in the ring, which only
+   happens when the disk has fallen behind by a whole ring, is dropped
+   and counted, and reported when the file is closed.  A frame cut short
+   is completed with zeros ahead of the next write, so that the channels
+   stay in step. */
+
 unsigned int csoundWriteAsync(CSOUND *csound, void *handle,
                               MYFLT *buf, int items)
 {
     CSFILE *p = handle;
-    if(p != NULL &&  p->cb != NULL)
-    return csound->WriteCircularBuffer(csound, p->cb, buf, items);
-    else return 0;
+    int n;
+    if (p == NULL || p->cb == NULL)
+      return 0;
+    while (p->wpad > 0) {
+      MYFLT zero = FL(0.0);
+      if (csound->WriteCircularBuffer(csound, p->cb, &zero, 1) != 1)
+        break;
+      p->wpad--;
+      p->transferred++;
+    }
+    n = (p->wpad > 0 ? 0 :
+         csound->WriteCircularBuffer(csound, p->cb, buf, items));
+    if (UNLIKELY(n < items)) {
+      p->overruns += items - n;
+      if (n % p->nchnls)
+        p->wpad = p->nchnls - n % p->nchnls;
+    }
+    p->transferred += n;
+    if (n < items ||
+        p->transferred - p->wake_mark >= (unsigned int) (p->ringsize >> 1)) {
+      p->wake_mark = p->transferred;
+      async_io_wake(csound, (ASYNC_WORKER *) p->worker);
+    }
+    return n;
 }
 
+/* Seeks are queued for the file's worker, which carries them out in the
+   order they were asked for: a seek on a file being written takes effect
+   after the data written before it, and reads return nothing until every
+   queued seek has been done.  Returns the requested position for SEEK_SET
+   and 0 for the other origins, the new position not being known until
+   the worker has moved there; -1 if the file is not an async sound file
+   or ASYNC_IO_SEEKS seeks are still waiting. */
+
 int csoundFSeekAsync(CSOUND *csound, void *handle, int pos, int whence){
-     CSFILE *p = handle;
-     int ret = 0;
-     csound->WaitThreadLockNoTimeout(csound->file_io_threadlock);
-     switch (p->type) {
-      case CSFILE_FD_R:
-        break;
-      case CSFILE_FD_W:
-        break;
-      case CSFILE_STD:
-        break;
-     case CSFILE_SND_R:
-     case CSFILE_SND_W:
-       ret = sf_seek(p->sf,pos,whence);
-       //csoundMessage(csound, "seek set %d \n", pos);
-       csound->FlushCircularBuffer(csound, p->cb);
-       p->items = 0;
-      break;
-    }
-    csound->NotifyThreadLock(csound->file_io_threadlock);
-    return ret;
+    CSFILE *p = handle;
+    ASYNC_SEEK *q;
+    unsigned int wr;
+    if (p == NULL || p->async_flag != ASYNC_GLOBAL ||
+        (p->type != CSFILE_SND_R && p->type != CSFILE_SND_W))
+      return -1;
+    wr = p->seek_wr;
+    if (wr - p->seek_rd >= ASYNC_IO_SEEKS)
+      return -1;
+    q = &(p->seekq[wr & (ASYNC_IO_SEEKS - 1)]);
+    q->pos = pos;
+    q->whence = whence;
+    q->mark = p->transferred;
+    ASYNC_BARRIER();
+    p->seek_wr = wr + 1;
+    async_io_wake(csound, (ASYNC_WORKER *) p->worker);
+    return (whence == SEEK_SET ? pos : 0);
 }
 
+/* Write out up to 'limit' items queued for a file, in chunks of up to
+   the whole i/o buffer.  Only whole frames are passed to libsndfile; the
+   rest of a frame stays at the start of the buffer (p->pos items) until
+   the next pass. */
 
-static int read_files(CSOUND *csound){
-  CSFILE *current = (CSFILE *) csound->open_files;
-  if (current == NULL) return 0;
-  while (current) {
-    if(current->async_flag == ASYNC_GLOBAL) {
-    int m = current->pos, l, n = current->items;
-    int items = current->bufsize;
-    MYFLT *buf = current->buf;
-    switch (current->type) {
-      case CSFILE_FD_R:
-        break;
-      case CSFILE_FD_W:
-        break;
-      case CSFILE_STD:
-        break;
-      case CSFILE_SND_R:
-       if(n == 0) {
-           n = sf_read_MYFLT(current->sf, buf, items);
-           m = 0;
-        }
-        l = csound->WriteCircularBuffer(csound,current->cb,&buf[m],n);
-        m += l;
-        n -= l;
-        current->items = n;
-        current->pos = m;
-        break;
-      case CSFILE_SND_W:
-        items = csound->ReadCircularBuffer(csound, current->cb, buf, items);
-        if(items == 0) { csoundSleep(10); break;}
-        sf_write_MYFLT(current->sf, buf, items);
+static void async_io_drain(CSOUND *csound, CSFILE *p, unsigned int limit)
+{
+    int n, items = p->bufsize*ASYNC_IO_MAXCHUNK;
+    while (limit > 0) {
+      if ((unsigned int) (items - p->pos) < limit)
+        n = items - p->pos;
+      else
+        n = (int) limit;
+      if ((n = csound->ReadCircularBuffer(csound, p->cb,
+                                          p->buf + p->pos, n)) <= 0)
         break;
+      p->drained += n;
+      limit -= n;
+      n += p->pos;
+      p->pos = n % p->nchnls;
+      sf_write_MYFLT(p->sf, p->buf, n - p->pos);
+      if (p->pos)
+        memmove(p->buf, p->buf + (n - p->pos), p->pos*sizeof(MYFLT));
     }
-    }
-    current = current->nxt;
-  }
-  return 1;
 }
 
+/* Carry out the seeks queued for a file, in order. */
 
+static void async_io_seek(CSOUND *csound, CSFILE *p)
+{
+    while (p->seek_rd != p->seek_wr) {
+      const ASYNC_SEEK *q = &(p->seekq[p->seek_rd & (ASYNC_IO_SEEKS - 1)]);
+      ASYNC_BARRIER();
+      if (p->type == CSFILE_SND_W) {
+        /* what was written before the seek goes where it was meant to */
+        async_io_drain(csound, p, q->mark - p->drained);
+        p->pos = 0;
+      }
+      sf_seek(p->sf, q->pos, q->whence);
+      if (p->type == CSFILE_SND_R) {
+        /* the reader backs off while seeks are queued */
+        csound->FlushCircularBuffer(csound, p->cb);
+        p->items = 0;
+        p->pos = 0;
+      }
+      ASYNC_BARRIER();
+      p->seek_rd++;
+    }
+}
 
+static void async_io_service(CSOUND *csound, CSFILE *p)
+{
+    int l, chunk;
+    unsigned int moved;
+    async_io_seek(csound, p);
+    /* readahead follows the rate at which the opcode consumes data */
+    moved = p->transferred;
+    p->rate += 0.25 * ((double) (moved - p->transferred_seen) - p->rate);
+    p->transferred_seen = moved;
+    switch (p->type) {
+    case CSFILE_SND_R:
+      chunk = (int) (2.0 * p->rate / p->bufsize) + 1;
+      if (chunk > ASYNC_IO_MAXCHUNK)
+        chunk = ASYNC_IO_MAXCHUNK;
+      chunk *= p->bufsize;
+      while (1) {
+        if (p->items == 0) {
+          p->items = (int) sf_read_MYFLT(p->sf, p->buf, chunk);
+          p->pos = 0;
+          if (p->items <= 0) {     /* end of file or error */
+            p->items = 0;
+            break;
+          }
+        }
+        l = csound->WriteCircularBuffer(csound, p->cb,
+                                        &(p->buf[p->pos]), p->items);
+        p->pos += l;
+        p->items -= l;
+        if (p->items)              /* ring is full */
+          break;
+      }
+      break;
+    case CSFILE_SND_W:
+      /* only what was written before any seek not yet seen */
+      moved = p->transferred;
+      ASYNC_BARRIER();
+      if (p->seek_rd == p->seek_wr)
+        async_io_drain(csound, p, moved - p->drained);
+      break;
+    }
+}
 
-void *file_iothread(void *p){
-  int res = 1;
-  CSOUND *csound = p;
-  int wakeup = (int) (1000*csound->ksmps/csound->esr);
-  _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
-  if(wakeup == 0) wakeup = 1;
-  while(res){
-    csoundSleep(wakeup);
-    csound->WaitThreadLockNoTimeout(csound->file_io_threadlock);
-    res = read_files(csound);
-    csound->NotifyThreadLock(csound->file_io_threadlock);
-  }
-  csound->file_io_start = 0;
-  return NULL;
+static uintptr_t async_io_worker(void *p)
+{
+    ASYNC_WORKER *w = (ASYNC_WORKER *) p;
+    CSOUND *csound = w->csound;
+    CSFILE *current;
+    int timeout = (int) (4000*csound->ksmps/csound->esr);
+    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+    if (timeout < 1) timeout = 1;
+    while (w->running) {
+      csound->WaitThreadLock(w->wake, (size_t) timeout);
+      w->pending = 0;
+      csound->LockMutex(w->mutex);
+      for (current = w->files; current != NULL; current = current->anxt)
+        async_io_service(csound, current);
+      csound->UnlockMutex(w->mutex);
+    }
+    return 0;
 }
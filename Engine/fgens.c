@@ -33,6 +33,14 @@
 #include "pstream.h"
 #include "pvfileio.h"
 #include <stdlib.h>
+#if defined(LINUX) || defined(__MACH__)
+#  define GEN01_MMAP 1
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <errno.h>
+#endif
 /* #undef ISSTRCOD */
 
 
@@ -113,6 +121,7 @@ typedef struct namedgen {
 CS_NOINLINE int  fterror(const FGDATA *, const char *, ...);
 static CS_NOINLINE void ftresdisp(const FGDATA *, FUNC *);
 static CS_NOINLINE FUNC *ftalloc(const FGDATA *);
+static int ftable_unmap(CSOUND *, MYFLT *);
 
 static int GENUL(FGDATA *ff, FUNC *ftp)
 {
@@ -162,6 +171,7 @@ int hfgens(CSOUND *csound, FUNC **ftpp, const EVTBLK *evtblkp, int mode)
         return fterror(&ff, Str("ftable does not exist"));
       }
       csound->flist[ff.fno] = NULL;
+      ftable_unmap(csound, ftp->ftable);
       csound->Free(csound, (void*) ftp);
       if (UNLIKELY(msg_enabled))
         csoundMessage(csound, Str("ftable %d now deleted\n"), ff.fno);
@@ -379,11 +389,34 @@ int csoundFTDelete(CSOUND *csound, int tableNum)
     if (UNLIKELY(ftp == NULL))
       return -1;
     csound->flist[tableNum] = NULL;
+    ftable_unmap(csound, ftp->ftable);
     csound->Free(csound, ftp);
 
     return 0;
 }
 
+/**
+ * Replaces the data of table ftp by a new block of nbytes bytes, keeping
+ * as much of the old data (flen + 1 values) as fits. Unlike ReAlloc(),
+ * this also works for the mapped data of GEN01 tables.
+ * Returns the new data, which is also stored in ftp->ftable.
+ */
+
+MYFLT *csoundFTReAlloc(CSOUND *csound, FUNC *ftp, size_t nbytes)
+{
+    MYFLT   *tab = (MYFLT*) csound->Calloc(csound, nbytes);
+    size_t  oldbytes = sizeof(MYFLT) * ((size_t) ftp->flen + 1);
+
+    if (ftp->ftable != NULL) {
+      memcpy(tab, ftp->ftable, oldbytes < nbytes ? oldbytes : nbytes);
+      /* a mapping is not an allocator block */
+      if (!ftable_unmap(csound, ftp->ftable))
+        csound->Free(csound, ftp->ftable);
+    }
+    ftp->ftable = tab;
+    return tab;
+}
+
 /* read ftable values directly from p-args */
 
 static int gen02(FGDATA *ff, FUNC *ftp)
@@ -2343,7 +2376,8 @@ static CS_NOINLINE FUNC *ftalloc(const FGDATA *ff)
     if (UNLIKELY(ftp != NULL)) {
       csound->Warning(csound, Str("replacing previous ftable %d"), ff->fno);
       if (ff->flen != (int32)ftp->flen) {       /* if redraw & diff len, */
-        csound->Free(csound, ftp->ftable);
+        if (!ftable_unmap(csound, ftp->ftable))
+          csound->Free(csound, ftp->ftable);
         csound->Free(csound, (void*) ftp);             /*   release old space   */
         csound->flist[ff->fno] = ftp = NULL;
         if (csound->actanchor.nxtact != NULL) { /*   & chk for danger    */
@@ -2585,6 +2619,273 @@ static const int gen01_format_table[11] = {
     AE_LONG,    AE_FLOAT,   AE_UNCH,    AE_24INT,   AE_DOUBLE
 };
 
+/* GEN01 tables whose samples are stored on disk exactly as MYFLT (float
+   or double WAV/raw files, matching the build, unscaled) are mapped
+   directly rather than read through libsndfile.  Other files that fill
+   the whole table go through the process-wide sample cache, so that
+   tables loading the same file in any Csound instance share one copy
+   of the converted samples.  Both kinds of mapping are private: writes
+   to the table stay local to it, while the clean pages are shared.     */
+
+static int ftable_unmap(CSOUND *csound, MYFLT *ftable)
+{
+    return samplecache_unmap(csound, (void*) ftable);
+}
+
+#ifdef GEN01_MMAP
+
+static uint32_t gen01_le32(const unsigned char *b)
+{
+    return ((uint32_t) b[0] | ((uint32_t) b[1] << 8) |
+            ((uint32_t) b[2] << 16) | ((uint32_t) b[3] << 24));
+}
+
+/* find the sample data of a RIFF/WAVE file: returns the byte offset, */
+/* and the size in *nbytes, or -1 if not found                         */
+
+static off_t gen01_wav_data(int fd, off_t *nbytes)
+{
+    unsigned char hdr[12];
+    off_t   pos = 12;
+    int     n;
+
+    if (pread(fd, hdr, 12, 0) != 12 ||
+        memcmp(hdr, "RIFF", 4) != 0 || memcmp(hdr + 8, "WAVE", 4) != 0)
+      return (off_t) -1;
+    for (n = 0; n < 64; n++) {                  /* give up on odd files */
+      uint32_t  size;
+      if (pread(fd, hdr, 8, pos) != 8)
+        return (off_t) -1;
+      size = gen01_le32(hdr + 4);
+      pos += 8;
+      if (memcmp(hdr, "data", 4) == 0) {
+        *nbytes = (off_t) size;
+        return pos;
+      }
+      pos += (off_t) size + (off_t) (size & 1);
+    }
+    return (off_t) -1;
+}
+
+#endif  /* GEN01_MMAP */
+
+/* the scaling getsndin() would apply to the samples of p */
+
+static MYFLT gen01_scalefac(CSOUND *csound, SOUNDIN *p)
+{
+    if ((p->format == AE_FLOAT || p->format == AE_DOUBLE) &&
+        p->filetyp != TYP_WAV && p->filetyp != TYP_AIFF &&
+        p->filetyp != TYP_W64)
+      return FL(1.0);
+    return csound->e0dbfs;
+}
+
+static int64_t gen01_skipframes(SOUNDIN *p)
+{
+    if (p->skiptime < FL(0.0))
+      return -1;
+    return (int64_t) ((double) p->skiptime * (double) p->sr + 0.5);
+}
+
+/* try to map nread sample values of the open soundfile p into a table   */
+/* of nalloc values; returns NULL if the file has to be converted. The   */
+/* samples can only be mapped where they start at a multiple of          */
+/* sizeof(MYFLT) in the file (not so for a 44 byte WAV header in the     */
+/* double build): they are then read as they are into ftable instead.    */
+
+static MYFLT *gen01_map(CSOUND *csound, SOUNDIN *p, MYFLT *ftable,
+                        int32 nread, int32 nalloc, int32 *inlocs)
+{
+#ifdef GEN01_MMAP
+    struct stat st;
+    const char *path;
+    off_t   dataoff, nbytes;
+    int64_t skipframes, avail;
+    int     fd;
+    MYFLT   *tab;
+
+#  ifdef WORDS_BIGENDIAN
+    return NULL;
+#  endif
+#  ifdef USE_DOUBLE
+    if (p->format != AE_DOUBLE)
+#  else
+    if (p->format != AE_FLOAT)
+#  endif
+      return NULL;
+    if (p->nchanls != 1 && p->channel != ALLCHNLS)
+      return NULL;
+    if ((p->filetyp != TYP_RAW && p->filetyp != TYP_WAV) ||
+        gen01_scalefac(csound, p) != FL(1.0))
+      return NULL;
+    if ((skipframes = gen01_skipframes(p)) < 0 || p->framesrem <= 0)
+      return NULL;
+    if ((path = csound->GetFileName(p->fd)) == NULL ||
+        (fd = open(path, O_RDONLY)) < 0)
+      return NULL;
+    if (fstat(fd, &st) != 0)
+      goto fail;
+    if (p->filetyp == TYP_RAW) {
+      dataoff = 0;
+      nbytes = st.st_size;
+    }
+    else if ((dataoff = gen01_wav_data(fd, &nbytes)) < 0)
+      goto fail;
+    if (nbytes > st.st_size - dataoff)
+      nbytes = st.st_size - dataoff;
+    dataoff += (off_t) (skipframes * p->nchanls) * (off_t) sizeof(MYFLT);
+    nbytes -= (off_t) (skipframes * p->nchanls) * (off_t) sizeof(MYFLT);
+    avail = (int64_t) (nbytes / (off_t) sizeof(MYFLT));
+    if (avail > p->framesrem * p->nchanls)
+      avail = p->framesrem * p->nchanls;
+    if (avail > (int64_t) nread)
+      avail = (int64_t) nread;
+    if (avail <= 0)
+      goto fail;
+    if ((dataoff % (off_t) sizeof(MYFLT)) != 0) {
+      char    *dst = (char*) ftable;
+      size_t  n = (size_t) avail * sizeof(MYFLT);
+      while (n > 0) {
+        ssize_t r = pread(fd, dst, n, dataoff);
+        if (r < 0 && errno == EINTR)
+          continue;
+        if (r <= 0)
+          goto fail;
+        n -= (size_t) r; dst += r; dataoff += (off_t) r;
+      }
+      close(fd);
+      if (csound->oparms->msglevel & 7)
+        csoundMessage(csound, Str("  read %d samples of %s\n"),
+                      (int) avail, path);
+      p->audrem -= (int64_t) avail;
+      *inlocs = (int32) avail;
+      return ftable;
+    }
+    tab = (MYFLT*) samplecache_map(csound, NULL, fd, (int64_t) dataoff,
+                                   (size_t) avail * sizeof(MYFLT),
+                                   (size_t) nalloc * sizeof(MYFLT));
+    close(fd);
+    if (tab == NULL)
+      return NULL;
+    if (csound->oparms->msglevel & 7)
+      csoundMessage(csound, Str("  mapped %d samples of %s\n"),
+                    (int) avail, path);
+    p->audrem -= (int64_t) avail;
+    *inlocs = (int32) avail;
+    return tab;
+ fail:
+    close(fd);
+#else
+    (void) csound; (void) p; (void) ftable; (void) nread; (void) nalloc;
+    (void) inlocs;
+#endif
+    return NULL;
+}
+
+/* read the selected channel(s) of the whole soundfile into the sample   */
+/* cache; returns a cache handle or NULL                                 */
+
+static void *gen01_cache_load(CSOUND *csound, SNDFILE *fd, SOUNDIN *p,
+                              const char *path, int64_t nframes)
+{
+    MYFLT   *buf, *tmp;
+    int64_t i, n, nvals;
+    int     j, nsel = (p->channel == ALLCHNLS ? p->nchanls : 1);
+    void    *entry = NULL;
+
+    nvals = nframes * nsel;
+    buf = (MYFLT*) csound->Malloc(csound, (size_t) nvals * sizeof(MYFLT));
+    tmp = (MYFLT*) csound->Malloc(csound, (size_t) p->bufsmps * sizeof(MYFLT));
+    if (sf_seek(fd, (sf_count_t) 0, SEEK_SET) != 0)
+      goto done;
+    for (i = 0; i < nvals; ) {
+      n = (int64_t) sf_read_MYFLT(fd, tmp, (sf_count_t) p->bufsmps);
+      if (n <= 0)
+        goto done;
+      if (nsel == p->nchanls) {
+        if (n > nvals - i)
+          n = nvals - i;
+        memcpy(&(buf[i]), tmp, (size_t) n * sizeof(MYFLT));
+        i += n;
+      }
+      else {
+        for (j = p->channel - 1; j < n && i < nvals; j += p->nchanls)
+          buf[i++] = tmp[j];
+      }
+    }
+    entry = samplecache_add(path, SAMPLECACHE_GEN01, p->format, p->channel,
+                            NULL, buf, (size_t) nvals * sizeof(MYFLT));
+ done:
+    csound->Free(csound, tmp);
+    csound->Free(csound, buf);
+    return entry;
+}
+
+/* fill the table from the process-wide sample cache, loading the file   */
+/* into the cache if the table takes all of it unscaled (a scaled table  */
+/* only copies from an entry that already exists); returns the (possibly */
+/* mapped) table, or NULL if the file has to be read with getsndin()     */
+
+static MYFLT *gen01_cached(CSOUND *csound, SNDFILE *fd, SOUNDIN *p,
+                           MYFLT *ftable, int32 nread, int32 nalloc,
+                           int32 *inlocs)
+{
+    const char *path;
+    const MYFLT *data;
+    void    *entry;
+    size_t  nbytes;
+    int64_t skipframes, nvals, avail, offs, i;
+    int     nsel = (p->channel == ALLCHNLS ? p->nchanls : 1);
+    MYFLT   scalefac, *tab;
+
+    if ((skipframes = gen01_skipframes(p)) < 0 || p->framesrem <= 0 ||
+        (path = csound->GetFileName(p->fd)) == NULL)
+      return NULL;
+    offs = skipframes * nsel;
+    nvals = (skipframes + p->framesrem) * nsel;
+    scalefac = gen01_scalefac(csound, p);
+    entry = samplecache_find(path, SAMPLECACHE_GEN01, p->format, p->channel,
+                             NULL, &nbytes);
+    if (entry == NULL) {
+      /* only whole files, and only if the table will map the entry */
+      if (p->framesrem * nsel > (int64_t) nread || scalefac != FL(1.0))
+        return NULL;
+      if ((entry = gen01_cache_load(csound, fd, p, path,
+                                    skipframes + p->framesrem)) == NULL)
+        return NULL;
+      nbytes = (size_t) nvals * sizeof(MYFLT);
+    }
+    nvals = (int64_t) (nbytes / sizeof(MYFLT));
+    avail = nvals - offs;
+    if (avail > (int64_t) nread)
+      avail = (int64_t) nread;
+    if (avail <= 0) {
+      samplecache_release(entry);
+      return NULL;
+    }
+    if (scalefac == FL(1.0) &&
+        (tab = (MYFLT*) samplecache_map(csound, entry, -1,
+                                        offs * (int64_t) sizeof(MYFLT),
+                                        (size_t) avail * sizeof(MYFLT),
+                                        (size_t) nalloc * sizeof(MYFLT)))
+        != NULL) {
+      if (csound->oparms->msglevel & 7)
+        csoundMessage(csound, Str("  shared %d cached samples of %s\n"),
+                      (int) avail, path);
+    }
+    else {                      /* scaled: copy, keep the table's memory */
+      data = (const MYFLT*) samplecache_data(entry) + offs;
+      for (i = 0; i < avail; i++)
+        ftable[i] = data[i] * scalefac;
+      memset(&(ftable[avail]), 0, (size_t) (nread - avail) * sizeof(MYFLT));
+      samplecache_release(entry);
+      tab = ftable;
+    }
+    p->audrem -= avail;
+    *inlocs = (int32) avail;
+    return tab;
+}
+
 /* read ftable values from a sound file */
 /* stops reading when table is full     */
 
@@ -2595,6 +2896,7 @@ static int gen01raw(FGDATA *ff, FUNC *ftp)
     SOUNDIN tmpspace;
     SNDFILE *fd;
     int     truncmsg = 0;
+    MYFLT   *tab;
     int32   inlocs = 0;
     int     def = 0, table_length = ff->flen + 1;
 
@@ -2753,7 +3055,18 @@ static int gen01raw(FGDATA *ff, FUNC *ftp)
     }
     /* read sound with opt gain */
 
-    if (UNLIKELY((inlocs=getsndin(csound, fd, ftp->ftable, table_length, p)) < 0)) {
+    if ((tab = gen01_map(csound, p, ftp->ftable, table_length,
+                         ftp->flen + 1, &inlocs)) != NULL ||
+        (tab = gen01_cached(csound, fd, p, ftp->ftable, table_length,
+                            ftp->flen + 1, &inlocs)) != NULL) {
+      if (tab != ftp->ftable) {
+        if (!ftable_unmap(csound, ftp->ftable))
+          csound->Free(csound, ftp->ftable);
+        ftp->ftable = tab;
+      }
+    }
+    else if (UNLIKELY((inlocs=getsndin(csound, fd, ftp->ftable,
+                                       table_length, p)) < 0)) {
       return fterror(ff, Str("GEN1 read error"));
     }
 
@@ -2767,7 +3080,7 @@ static int gen01raw(FGDATA *ff, FUNC *ftp)
     ftp->soundend = inlocs / ftp->nchanls;   /* record end of sound samps */
     csound->FileClose(csound, p->fd);
     if (def) {
-      MYFLT *tab = ftp->ftable;
+      tab = ftp->ftable;
       ftresdisp(ff, ftp);       /* VL: 11.01.05  for deferred alloc tables */
       tab[ff->flen] = tab[0];  /* guard point */
       ftp->flen -= 1;  /* exclude guard point */
@@ -3381,8 +3694,7 @@ int resize_table(CSOUND *csound, RESIZE *p)
     if ((ftp = csound->FTFind(csound, p->fn)) == NULL)
       return NOTOK;
     if (ftp->flen<fsize)
-      ftp->ftable = (MYFLT *) csound->ReAlloc(csound, ftp->ftable,
-                                              sizeof(MYFLT)*(fsize+1));
+      csoundFTReAlloc(csound, ftp, sizeof(MYFLT)*(fsize+1));
     ftp->flen = fsize+1;
     csound->flist[fno] = ftp;
     return OK;
@@ -490,6 +490,10 @@ int MIDIinsert(CSOUND *csound, int insno, MCHNBLK *chn, MEVENT *mep)
     ip->relesing     = 0;
     ip->offbet       = -1.0;
     ip->offtim       = -1.0;              /* set indef duration */
+    /* start at the sample of a timestamped event */
+    ip->ksmps_offset = csound->midiGlobals->evtOffset;
+    ip->ksmps_no_end = 0;
+    ip->no_end       = 0;
     ip->opcod_iobufs = NULL;              /* IV - Sep 8 2002:            */
     ip->p1.value     = (MYFLT) insno;     /* set these required p-fields */
     ip->p2.value     = (MYFLT) (csound->icurTime/csound->esr - csound->timeOffs);
@@ -2129,7 +2133,7 @@ static void instance(CSOUND *csound, int insno)
                      (size_t) pextent + tp->varPool->poolSize +
                      (tp->varPool->varCount * CS_FLOAT_ALIGN(CS_VAR_TYPE_OFFSET)) +
                      (tp->varPool->varCount * sizeof(CS_VARIABLE*)) +
-                     tp->opdstot);
+                     tp->opdstot + (O->simd_align ? CS_SIMD_ALIGN : 0));
     ip->csound = csound;
     ip->m_chnbp = (MCHNBLK*) NULL;
     ip->instr = tp;
@@ -2161,6 +2165,8 @@ static void instance(CSOUND *csound, int insno)
     /* gbloffbas = csound->globalVarPool; */
     lcloffbas = (CS_VAR_MEM*)&ip->p0;
     lclbas = (MYFLT*) ((char*) ip + pextent);   /* split local space */
+    if (O->simd_align)        /* the pool layout is relative to lclbas */
+      lclbas = (MYFLT*) CS_SIMD_ALIGN_UP((uintptr_t) lclbas);
     initializeVarPool((void *)csound, lclbas, tp->varPool);
 
     opMemStart = nxtopds = (char*) lclbas + tp->varPool->poolSize +
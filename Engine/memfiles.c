@@ -235,11 +235,12 @@ static int Load_LP_File_(CSOUND *csound, const char *filnam,
 }
 
 static int Load_File_(CSOUND *csound, const char *filnam,
-                       char **allocp, int32 *len, int csFileType)
+                       char **allocp, int32 *len, int csFileType, int *mapped)
 {
     FILE *f;
     void *dummy = 0;
     *allocp = NULL;
+    *mapped = 0;
     f = fopen(filnam, "rb");
     if (UNLIKELY(f == NULL))                    /* if cannot open the file */
       return 1;                                 /*    return 1             */
@@ -274,6 +275,15 @@ static int Load_File_(CSOUND *csound, const char *filnam,
     fseek(f, 0L, SEEK_SET);
     if (UNLIKELY(*len < 1L))
       goto err_return;
+    /* map the file if possible: its pages are then read in on demand, */
+    /* and shared with every other user of the same file               */
+    *allocp = (char*) samplecache_map(csound, NULL, fileno(f), 0,
+                                      (size_t) (*len), (size_t) (*len));
+    if (*allocp != NULL) {
+      fclose(f);
+      *mapped = 1;
+      return 0;
+    }
     *allocp = csound->Malloc(csound, (size_t) (*len)); /*   alloc as reqd     */
     if (UNLIKELY(fread(*allocp, (size_t) 1,     /*   read file in      */
                        (size_t) (*len), f) != (size_t) (*len)))
@@ -316,26 +326,25 @@ MEMFIL *ldmemfile2(CSOUND *csound, const char *filnam, int csFileType)
 MEMFIL *ldmemfile2withCB(CSOUND *csound, const char *filnam, int csFileType,
                          int (*callback)(CSOUND*, MEMFIL*))
 {                               /* read an entire file into memory and log it */
-    MEMFIL  *mfp, *last = NULL; /* share the file with all subsequent requests*/
+    MEMFIL  *mfp;               /* share the file with all subsequent requests*/
     char    *allocp;            /* if not fullpath, look in current directory,*/
     int32    len;                /*   then SADIR (if defined).                 */
     char    *pathnam;           /* Used by adsyn, pvoc, and lpread            */
+    void    *cache;
+    size_t  nbytes;
+    int     mapped;
 
-    mfp = csound->memfiles;
-    while (mfp != NULL) {                               /* Checking chain */
-      if (strcmp(mfp->filename, filnam) == 0)           /*   if match     */
-        return mfp;                                     /*   we have it   */
-      last = mfp;
-      mfp = mfp->next;
-    }
+    if (csound->memfile_index == NULL)
+      csound->memfile_index = cs_hash_table_create(csound);
+    else if ((mfp = (MEMFIL*) cs_hash_table_get(csound, csound->memfile_index,
+                                                 (char*) filnam)) != NULL)
+      return mfp;                                       /* we have it     */
     /* Add new file description */
     mfp = (MEMFIL*) csound->Calloc(csound, sizeof(MEMFIL));
-    if (last != NULL)
-      last->next = mfp;
-    else
-      csound->memfiles = mfp;
-    mfp->next = NULL;
+    mfp->next = csound->memfiles;
+    csound->memfiles = mfp;
     strncpy(mfp->filename, filnam, 255);
+    cs_hash_table_put(csound, csound->memfile_index, (char*) filnam, mfp);
 
     pathnam = csoundFindInputFile(csound, filnam, "SADIR");
     if (UNLIKELY(pathnam == NULL)) {
@@ -343,7 +352,23 @@ MEMFIL *ldmemfile2withCB(CSOUND *csound, const char *filnam, int csFileType,
       delete_memfile(csound, filnam);
       return NULL;
     }
-    if (UNLIKELY(Load_File_(csound, pathnam, &allocp, &len, csFileType) != 0)) {
+    /* another instance may have loaded (and processed) it already */
+    cache = samplecache_find(pathnam, SAMPLECACHE_MEMFILE, csFileType, 0,
+                             (const void*) callback, &nbytes);
+    if (cache != NULL) {
+      allocp = (char*) samplecache_map(csound, cache, -1, 0, nbytes, nbytes);
+      if (allocp != NULL) {
+        csoundNotifyFileOpened(csound, pathnam, csFileType, 0, 0);
+        mfp->beginp = allocp;
+        mfp->endp = allocp + nbytes;
+        mfp->length = (int32) nbytes;
+        csound->Free(csound, pathnam);
+        return mfp;
+      }
+      samplecache_release(cache);
+    }
+    if (UNLIKELY(Load_File_(csound, pathnam, &allocp, &len,
+                            csFileType, &mapped) != 0)) {
       /* loadfile */
       csoundMessage(csound, Str("cannot load %s, or SADIR undefined\n"),
                             pathnam);
@@ -363,6 +388,27 @@ MEMFIL *ldmemfile2withCB(CSOUND *csound, const char *filnam, int csFileType,
         return NULL;
       }
     }
+    /* share the processed data with other instances; files mapped as they */
+    /* are on disk are shared through the page cache already              */
+    if (mapped && callback == NULL)
+      cache = NULL;
+    else
+      cache = samplecache_add(pathnam, SAMPLECACHE_MEMFILE, csFileType, 0,
+                            (const void*) callback, mfp->beginp,
+                            (size_t) mfp->length);
+    if (cache != NULL) {
+      allocp = (char*) samplecache_map(csound, cache, -1, 0,
+                                       (size_t) mfp->length,
+                                       (size_t) mfp->length);
+      if (allocp != NULL) {
+        if (!samplecache_unmap(csound, mfp->beginp))
+          csound->Free(csound, mfp->beginp);
+        mfp->beginp = allocp;
+        mfp->endp = allocp + mfp->length;
+      }
+      else
+        samplecache_release(cache);
+    }
     csoundMessage(csound, Str("file %s (%ld bytes) loaded into memory\n"),
                   pathnam, (long) len);
     csound->Free(csound, pathnam);
@@ -377,32 +423,36 @@ void rlsmemfiles(CSOUND *csound)
 
     while (mfp != NULL) {
       nxt = mfp->next;
-      csound->Free(csound, mfp->beginp);       /*   free the space */
+      if (!samplecache_unmap(csound, mfp->beginp))
+        csound->Free(csound, mfp->beginp);     /*   free the space */
       csound->Free(csound, mfp);
       mfp = nxt;
     }
     csound->memfiles = NULL;
+    if (csound->memfile_index != NULL) {
+      cs_hash_table_free(csound, csound->memfile_index);
+      csound->memfile_index = NULL;
+    }
 }
 
 int delete_memfile(CSOUND *csound, const char *filnam)
 {
     MEMFIL  *mfp, *prv;
 
-    prv = NULL;
-    mfp = csound->memfiles;
-    while (mfp != NULL) {
-      if (strcmp(mfp->filename, filnam) == 0)
-        break;
-      prv = mfp;
-      mfp = mfp->next;
-    }
-    if (mfp == NULL)
+    if (csound->memfile_index == NULL ||
+        (mfp = (MEMFIL*) cs_hash_table_get(csound, csound->memfile_index,
+                                           (char*) filnam)) == NULL)
       return -1;
-    if (prv == NULL)
+    cs_hash_table_remove(csound, csound->memfile_index, (char*) filnam);
+    if (csound->memfiles == mfp)
       csound->memfiles = mfp->next;
-    else
+    else {
+      for (prv = csound->memfiles; prv->next != mfp; prv = prv->next)
+        ;
       prv->next = mfp->next;
-    csound->Free(csound, mfp->beginp);
+    }
+    if (!samplecache_unmap(csound, mfp->beginp))
+      csound->Free(csound, mfp->beginp);
     csound->Free(csound, mfp);
     return 0;
 }
@@ -552,6 +602,517 @@ int PVOCEX_LoadFile(CSOUND *csound, const char *fname, PVOCEX_MEMFILE *p)
     return 0;
 }
 
+/* Streaming access to PVOC-EX files.
+
+   All the instances that stream a file share one PVX_FILE, a pool of
+   blocks of frames that grows by PVX_NBLOCKS for each instance that
+   opens the file, and is kept until the engine is reset so that later
+   notes find their blocks already read.  Block b holds one frame more
+   than its length, so that a frame and its successor are always
+   contiguous for interpolation.  Each instance (a PVX_STREAM) asks for
+   the PVX_NBLOCKS blocks from the one its last frame was in, in the
+   direction it is reading, and one reader thread per engine reads them.
+   The first blocks are read at init; after that the performance thread
+   never reads, and a frame whose block is not there yet is taken from
+   the nearest block that is.  The reader's mutex is held to look at and
+   swap blocks, never while reading.  Frames are scaled to Csound's
+   amplitude range as by PVOCEX_LoadFile().                              */
+
+#define PVX_NBLOCKS     8
+#define PVX_BLOCKBYTES  262144
+#define PVX_LOADING     (-2)        /* slot being read at init         */
+
+typedef struct pvx_stream_ {
+    struct pvx_stream_ *nxt;
+    struct pvx_file_ *f;
+    struct pvx_reader_ *r;
+    int32   cur;                    /* block last asked for            */
+    int32   dir;                    /* 1 if reading forwards, else -1  */
+    int32   held;                   /* block last returned, or -1      */
+} PVX_STREAM;
+
+typedef struct pvx_file_ {
+    struct pvx_file_ *nxt;
+    char    *name;                  /* as passed to OpenStream         */
+    char    *filename;
+    void    *fd, *rfd;              /* for init and for the reader     */
+    FILE    *fp, *rfp;
+    PVOCEX_MEMFILE info;
+    int32   dataoff;
+    int32   framelen;               /* floats per frame                */
+    int32   nframes, blkframes, nblocks;
+    float   scale;
+    int     nslots;
+    int32   *blk;                   /* block held by each slot, or -1  */
+    float   **slot;
+    float   *rspare;                /* load buffer of the reader       */
+    float   *zeros;                 /* two silent frames               */
+    PVX_STREAM *streams;
+} PVX_FILE;
+
+typedef struct pvx_reader_ {
+    CSOUND  *csound;
+    PVX_FILE *files;
+    void    *mutex, *wake, *thread;
+    volatile int running, pending;
+} PVX_READER;
+
+/* seek to a byte offset that may not fit a (32 bit) long */
+
+static int pvx_seek(FILE *fp, int64_t offset)
+{
+#if defined(_WIN32)
+    return _fseeki64(fp, (__int64) offset, SEEK_SET);
+#else
+    if ((int64_t) (off_t) offset != offset)
+      return -1;                        /* past what this build can seek */
+    return fseeko(fp, (off_t) offset, SEEK_SET);
+#endif
+}
+
+static void pvx_stream_read(PVX_FILE *f, FILE *fp, int32 b, float *buf)
+{
+    int32   first = b * f->blkframes, n = f->blkframes + 1, got = 0, i;
+    int32   nfloats;
+
+    if (first + n > f->nframes)
+      n = f->nframes - first;
+    nfloats = n * f->framelen;
+    if (pvx_seek(fp, (int64_t) f->dataoff + (int64_t) first
+                     * (int64_t) f->framelen * (int64_t) sizeof(float)) == 0)
+      got = (int32) fread(buf, sizeof(float), (size_t) nfloats, fp);
+    memset(&(buf[got]), 0, (size_t) ((f->blkframes + 1) * f->framelen - got)
+                           * sizeof(float));
+#ifdef WORDS_BIGENDIAN
+    for (i = 0; i < got; i++) {
+      uint32_t  tmp;
+      memcpy(&tmp, &(buf[i]), sizeof(uint32_t));
+      tmp =   ((tmp & (uint32_t) 0x000000FFU) << 24)
+            | ((tmp & (uint32_t) 0x0000FF00U) << 8)
+            | ((tmp & (uint32_t) 0x00FF0000U) >> 8)
+            | ((tmp & (uint32_t) 0xFF000000U) >> 24);
+      memcpy(&(buf[i]), &tmp, sizeof(uint32_t));
+    }
+#endif
+    for (i = 0; i < got; i += 2)        /* scale amps to Csound range */
+      buf[i] *= f->scale;
+}
+
+/* the slot holding block b, or -1 */
+
+static int pvx_slot_find(PVX_FILE *f, int32 b)
+{
+    int i;
+
+    for (i = 0; i < f->nslots; i++)
+      if (f->blk[i] == b)
+        return i;
+    return -1;
+}
+
+/* whether an instance is reading block b or will soon */
+
+static int pvx_wanted(PVX_FILE *f, int32 b)
+{
+    PVX_STREAM  *s;
+
+    for (s = f->streams; s != NULL; s = s->nxt)
+      if (b == s->held || (s->dir > 0 ? b >= s->cur && b < s->cur + PVX_NBLOCKS
+                                      : b <= s->cur && b > s->cur - PVX_NBLOCKS))
+        return 1;
+    return 0;
+}
+
+/* a slot that is free or holds a block no instance wants, or -1 */
+
+static int pvx_victim(PVX_FILE *f)
+{
+    int i;
+
+    for (i = 0; i < f->nslots; i++)
+      if (f->blk[i] == -1)
+        return i;
+    for (i = 0; i < f->nslots; i++)
+      if (f->blk[i] >= 0 && !pvx_wanted(f, f->blk[i]))
+        return i;
+    return -1;
+}
+
+/* a block that an instance wants and that there is a slot for, or -1 */
+
+static int32 pvx_next_block(PVX_FILE *f)
+{
+    PVX_STREAM  *s;
+    int32       t;
+    int         i;
+
+    for (s = f->streams; s != NULL; s = s->nxt)
+      for (i = 0, t = s->cur; i < PVX_NBLOCKS && t >= 0 && t < f->nblocks;
+           i++, t += s->dir)
+        if (pvx_slot_find(f, t) < 0 && pvx_victim(f) >= 0)
+          return t;
+    return -1;
+}
+
+static uintptr_t pvx_stream_reader(void *arg)
+{
+    PVX_READER  *r = (PVX_READER*) arg;
+    CSOUND      *csound = r->csound;
+    PVX_FILE    *f;
+    int32       t = -1;
+    int         k;
+    float       *tmp;
+
+    while (r->running) {
+      csound->WaitThreadLock(r->wake, 50);
+      r->pending = 0;
+      while (r->running) {
+        csound->LockMutex(r->mutex);
+        for (f = r->files; f != NULL; f = f->nxt)
+          if ((t = pvx_next_block(f)) >= 0)
+            break;
+        csound->UnlockMutex(r->mutex);
+        if (f == NULL)
+          break;
+        pvx_stream_read(f, f->rfp, t, f->rspare);
+        csound->LockMutex(r->mutex);
+        /* the instances may have moved on while reading */
+        if (pvx_slot_find(f, t) < 0 && pvx_wanted(f, t) &&
+            (k = pvx_victim(f)) >= 0) {
+          tmp = f->slot[k];
+          f->slot[k] = f->rspare;
+          f->rspare = tmp;
+          f->blk[k] = t;
+        }
+        csound->UnlockMutex(r->mutex);
+      }
+    }
+    return 0;
+}
+
+static void pvx_file_free(CSOUND *csound, PVX_FILE *f)
+{
+    int i;
+
+    if (f->fd != NULL)
+      csound->FileClose(csound, f->fd);
+    if (f->rfd != NULL)
+      csound->FileClose(csound, f->rfd);
+    for (i = 0; i < f->nslots; i++)
+      csound->Free(csound, f->slot[i]);
+    csound->Free(csound, f->slot);
+    csound->Free(csound, f->blk);
+    csound->Free(csound, f->rspare);
+    csound->Free(csound, f->zeros);
+    csound->Free(csound, f->filename);
+    csound->Free(csound, f->name);
+    csound->Free(csound, f);
+}
+
+/* stops the reader when the engine is reset, by which time every
+   instance has closed its stream, and frees the files */
+
+static int pvx_reader_stop(CSOUND *csound, void *p)
+{
+    PVX_READER  *r = (PVX_READER*) p;
+    PVX_FILE    *f;
+
+    r->running = 0;
+    csound->NotifyThreadLock(r->wake);
+    csound->JoinThread(r->thread);
+    csound->NotifyThreadLock(r->wake);
+    csound->DestroyThreadLock(r->wake);
+    csound->DestroyMutex(r->mutex);
+    while ((f = r->files) != NULL) {
+      r->files = f->nxt;
+      pvx_file_free(csound, f);
+    }
+    return OK;
+}
+
+/* the reader of the engine, started on first use */
+
+static PVX_READER *pvx_reader_get(CSOUND *csound)
+{
+    PVX_READER  *r;
+
+    if ((r = (PVX_READER*) csound->QueryGlobalVariable(csound,
+                                                       "PVX_READER")) != NULL)
+      return r;
+    if (csound->CreateGlobalVariable(csound, "PVX_READER",
+                                     sizeof(PVX_READER)) != 0)
+      return NULL;
+    r = (PVX_READER*) csound->QueryGlobalVariable(csound, "PVX_READER");
+    r->csound = csound;
+    r->mutex = csound->Create_Mutex(0);
+    r->wake = csound->CreateThreadLock();
+    r->running = 1;
+    r->thread = (r->mutex != NULL && r->wake != NULL ?
+                 csound->CreateThread(pvx_stream_reader, (void*) r) : NULL);
+    if (UNLIKELY(r->thread == NULL)) {
+      if (r->mutex != NULL) csound->DestroyMutex(r->mutex);
+      if (r->wake != NULL) csound->DestroyThreadLock(r->wake);
+      csound->DestroyGlobalVariable(csound, "PVX_READER");
+      return NULL;
+    }
+    csound->RegisterResetCallback(csound, (void*) r, pvx_reader_stop);
+    return r;
+}
+
+static PVX_FILE *pvx_file_open(CSOUND *csound, const char *fname)
+{
+    PVOCDATA      pvdata;
+    WAVEFORMATEX  fmt;
+    PVX_FILE      *f;
+    const char    *path;
+    int           pvx_id;
+
+    memset(&pvdata, 0, sizeof(PVOCDATA));
+    memset(&fmt, 0, sizeof(WAVEFORMATEX));
+    pvx_id = csound->PVOC_OpenFile(csound, fname, &pvdata, &fmt);
+    if (UNLIKELY(pvx_id < 0)) {
+      pvx_err_msg(csound, Str("unable to open pvocex file %s: %s"),
+                          fname, csound->PVOC_ErrorString(csound));
+      return NULL;
+    }
+    if (UNLIKELY(pvdata.wWordFormat != PVOC_IEEE_FLOAT)) {
+      csound->PVOC_CloseFile(csound, pvx_id);
+      pvx_err_msg(csound, Str("pvoc-ex file %s is not 32bit floats"), fname);
+      return NULL;
+    }
+    if (UNLIKELY(pvdata.wAnalFormat != PVOC_AMP_FREQ)) {
+      csound->PVOC_CloseFile(csound, pvx_id);
+      pvx_err_msg(csound, Str("pvoc-ex file %s not in AMP_FREQ format"), fname);
+      return NULL;
+    }
+    f = (PVX_FILE*) csound->Calloc(csound, sizeof(PVX_FILE));
+    f->name = (char*) csound->Malloc(csound, strlen(fname) + 1);
+    strcpy(f->name, fname);
+    f->nframes = csound->PVOC_FrameCount(csound, pvx_id);
+    path = pvoc_datalocation(csound, pvx_id, &(f->dataoff));
+    if (path != NULL) {
+      f->filename = (char*) csound->Malloc(csound, strlen(path) + 1);
+      strcpy(f->filename, path);
+    }
+    csound->PVOC_CloseFile(csound, pvx_id);
+    if (UNLIKELY(f->nframes <= 0 || f->filename == NULL)) {
+      pvx_err_msg(csound, Str("pvoc-ex file %s is empty!"), fname);
+      pvx_file_free(csound, f);
+      return NULL;
+    }
+    f->fd = csound->FileOpen2(csound, &(f->fp), CSFILE_STD, f->filename,
+                              "rb", NULL, CSFTYPE_PVCEX, 0);
+    f->rfd = csound->FileOpen2(csound, &(f->rfp), CSFILE_STD, f->filename,
+                               "rb", NULL, CSFTYPE_PVCEX, 0);
+    if (UNLIKELY(f->fd == NULL || f->rfd == NULL)) {
+      pvx_err_msg(csound, Str("unable to open pvocex file %s"), fname);
+      pvx_file_free(csound, f);
+      return NULL;
+    }
+    f->framelen = 2 * pvdata.nAnalysisBins;
+    f->blkframes = PVX_BLOCKBYTES / (f->framelen * (int32) sizeof(float));
+    if (f->blkframes < 2)
+      f->blkframes = 2;
+    f->nblocks = (f->nframes + f->blkframes - 1) / f->blkframes;
+    f->scale = (float) csound->e0dbfs;
+    f->rspare = (float*) csound->Malloc(csound, (size_t) ((f->blkframes + 1)
+                                                 * f->framelen) * sizeof(float));
+    f->zeros = (float*) csound->Calloc(csound, (size_t) (2 * f->framelen)
+                                               * sizeof(float));
+
+    f->info.filename = f->filename;
+    f->info.data = NULL;
+    f->info.nframes = (uint32) f->nframes;
+    f->info.format = PVS_AMP_FREQ;
+    f->info.fftsize = 2 * (pvdata.nAnalysisBins - 1);
+    f->info.overlap = pvdata.dwOverlap;
+    f->info.winsize = pvdata.dwWinlen;
+    f->info.chans = fmt.nChannels;
+    f->info.srate = (MYFLT) fmt.nSamplesPerSec;
+    switch ((pv_wtype) pvdata.wWindowType) {
+      case PVOC_HANN:
+        f->info.wintype = PVS_WIN_HANN;
+        break;
+      case PVOC_KAISER:
+        f->info.wintype = PVS_WIN_KAISER;
+        break;
+      default:
+        f->info.wintype = PVS_WIN_HAMMING;
+        break;
+    }
+    if (f->info.srate != csound->esr) {
+      csound->Warning(csound, Str("%s's srate = %8.0f, orch's srate = %8.0f"),
+                              fname, f->info.srate, csound->esr);
+    }
+    return f;
+}
+
+/**
+ * Opens a PVOC-EX file for streaming, sharing the blocks read with the
+ * other streams of the same file, and reads its first blocks. The file
+ * parameters are stored in *p (with p->data set to NULL). Returns NULL
+ * on error.
+ */
+
+void *PVOCEX_OpenStream(CSOUND *csound, const char *fname, PVOCEX_MEMFILE *p)
+{
+    PVX_READER    *r;
+    PVX_FILE      *f;
+    PVX_STREAM    *s;
+    float         **slot, *buf;
+    size_t        blksize;
+    int32         b;
+    int           i, k;
+
+    memset(p, 0, sizeof(PVOCEX_MEMFILE));
+    if (UNLIKELY(fname == NULL || fname[0] == '\0')) {
+      pvx_err_msg(csound, Str("Empty or NULL file name"));
+      return NULL;
+    }
+    if (UNLIKELY((r = pvx_reader_get(csound)) == NULL)) {
+      pvx_err_msg(csound, Str("unable to start the pvoc-ex reader for %s"),
+                          fname);
+      return NULL;
+    }
+    for (f = r->files; f != NULL; f = f->nxt)
+      if (strcmp(f->name, fname) == 0)
+        break;
+    if (f == NULL) {
+      if (UNLIKELY((f = pvx_file_open(csound, fname)) == NULL))
+        return NULL;
+      csound->LockMutex(r->mutex);
+      f->nxt = r->files;
+      r->files = f;
+      csound->UnlockMutex(r->mutex);
+    }
+    /* PVX_NBLOCKS more slots for the new stream */
+    blksize = (size_t) ((f->blkframes + 1) * f->framelen) * sizeof(float);
+    slot = (float**) csound->Malloc(csound, (size_t) (f->nslots + PVX_NBLOCKS)
+                                            * sizeof(float*));
+    for (i = 0; i < PVX_NBLOCKS; i++)
+      slot[f->nslots + i] = (float*) csound->Malloc(csound, blksize);
+    s = (PVX_STREAM*) csound->Calloc(csound, sizeof(PVX_STREAM));
+    s->f = f;
+    s->r = r;
+    s->cur = 0;
+    s->dir = 1;
+    s->held = -1;
+    csound->LockMutex(r->mutex);
+    if (f->nslots > 0)
+      memcpy(slot, f->slot, (size_t) f->nslots * sizeof(float*));
+    csound->Free(csound, f->slot);
+    f->slot = slot;
+    f->blk = (int32*) csound->ReAlloc(csound, f->blk,
+                                      (size_t) (f->nslots + PVX_NBLOCKS)
+                                      * sizeof(int32));
+    for (i = 0; i < PVX_NBLOCKS; i++)
+      f->blk[f->nslots + i] = -1;
+    f->nslots += PVX_NBLOCKS;
+    s->nxt = f->streams;
+    f->streams = s;
+    csound->UnlockMutex(r->mutex);
+    /* read the first blocks that no other stream has read yet */
+    for (b = 0; b < PVX_NBLOCKS && b < f->nblocks; b++) {
+      csound->LockMutex(r->mutex);
+      if (pvx_slot_find(f, b) >= 0 || (k = pvx_victim(f)) < 0) {
+        csound->UnlockMutex(r->mutex);
+        continue;
+      }
+      f->blk[k] = PVX_LOADING;
+      buf = f->slot[k];
+      csound->UnlockMutex(r->mutex);
+      pvx_stream_read(f, f->fp, b, buf);
+      csound->LockMutex(r->mutex);
+      f->blk[k] = b;
+      csound->UnlockMutex(r->mutex);
+    }
+    memcpy(p, &(f->info), sizeof(PVOCEX_MEMFILE));
+    return (void*) s;
+}
+
+/**
+ * Returns a pointer to frame 'frame' of a PVOC-EX stream, followed by the
+ * next frame. The pointer is valid until the next call for the stream.
+ * If the frame has not been read yet, the nearest frame that has is
+ * returned instead, and the reader is asked for the frames from 'frame'.
+ */
+
+float *PVOCEX_StreamFrame(CSOUND *csound, void *stream, int32 frame)
+{
+    PVX_STREAM  *s = (PVX_STREAM*) stream;
+    PVX_FILE    *f = s->f;
+    PVX_READER  *r = s->r;
+    int32       b, d, dk = 0;
+    int         i, k;
+    float       *ptr;
+
+    if (frame < 0)
+      frame = 0;
+    else if (frame >= f->nframes)
+      frame = f->nframes - 1;
+    b = frame / f->blkframes;
+    csound->LockMutex(r->mutex);
+    if (b != s->cur) {
+      s->dir = (b > s->cur ? 1 : -1);
+      s->cur = b;
+      if (!r->pending) {
+        r->pending = 1;                 /* window moved: read ahead */
+        csound->NotifyThreadLock(r->wake);
+      }
+    }
+    if ((k = pvx_slot_find(f, b)) >= 0) {
+      s->held = b;
+      ptr = f->slot[k] + (size_t) (frame - b * f->blkframes)
+                         * (size_t) f->framelen;
+    }
+    else {
+      /* not read yet: the nearest frame that is */
+      for (i = 0, k = -1; i < f->nslots; i++) {
+        if (f->blk[i] < 0)
+          continue;
+        d = (f->blk[i] < b ? b - f->blk[i] : f->blk[i] - b);
+        if (k < 0 || d < dk) {
+          k = i;
+          dk = d;
+        }
+      }
+      if (k < 0) {
+        s->held = -1;
+        ptr = f->zeros;
+      }
+      else {
+        s->held = f->blk[k];
+        ptr = f->slot[k] + (f->blk[k] < b ?
+                            (size_t) (f->blkframes - 1) * (size_t) f->framelen
+                            : (size_t) 0);
+      }
+    }
+    csound->UnlockMutex(r->mutex);
+    return ptr;
+}
+
+/**
+ * Closes a PVOC-EX stream. The blocks it read stay with the file for
+ * other streams until the engine is reset; nothing waits for the reader.
+ */
+
+void PVOCEX_CloseStream(CSOUND *csound, void *stream)
+{
+    PVX_STREAM  *s = (PVX_STREAM*) stream;
+    PVX_STREAM  **pp;
+
+    if (s == NULL)
+      return;
+    csound->LockMutex(s->r->mutex);
+    for (pp = &(s->f->streams); *pp != NULL; pp = &((*pp)->nxt))
+      if (*pp == s) {
+        *pp = s->nxt;
+        break;
+      }
+    csound->UnlockMutex(s->r->mutex);
+    csound->Free(csound, s);
+}
+
  /* ------------------------------------------------------------------------ */
 
 /**
@@ -838,6 +838,7 @@ static void process_midi_event(CSOUND *csound, MEVENT *mep, MCHNBLK *chn)
       }
       else xturnoff(csound, ip);                    /*  else some kind of off */
     }
+    csound->midiGlobals->evtOffset = 0;             /* timestamp used up      */
 }
 
 static int process_rt_event(CSOUND *csound, int sensType)
@@ -0,0 +1,529 @@
+/*
+    samplecache.c:
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+
+#include "csoundCore.h"     /*                              SAMPLECACHE.C   */
+#include "soundio.h"
+#include <sndfile.h>
+#include <string.h>
+
+/* Process-wide cache of loaded file data.
+
+   Entries are keyed by canonical path, modification time, size, kind,
+   sample format, channel and an optional tag, and hold their data in an
+   anonymous file (memfd where available).  Every Csound instance in the
+   process that loads the same data attaches to the entry instead of
+   reading the file again: it gets a private mapping of the cached data,
+   so the clean pages are shared while writes stay local to the table or
+   memfile that made them.  Entries are reference counted, and are
+   released when the last mapping goes away unless they were pinned by
+   csoundPreloadSample().  The mappings are tracked here as well, so that
+   callers can tell mapped memory from memory of the Csound allocator.
+   Each entry keeps its backing file open, so the number of entries is
+   limited to a quarter of the descriptor limit (at most 256); past that,
+   files are simply not cached.  */
+
+#if defined(LINUX) || defined(__MACH__)
+#  define SAMPLECACHE_MMAP 1
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <sys/resource.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <limits.h>
+#  include <stdlib.h>
+#endif
+
+/* from threads.c */
+void csoundLock(void);
+void csoundUnLock(void);
+
+#ifdef SAMPLECACHE_MMAP
+
+typedef struct samplecache_s {
+    char    *path;              /* canonical path name       */
+    int64_t mtime, size;        /* of the file when loaded   */
+    int     kind, format, channel;
+    const void *tag;
+    int     refcnt;             /* users, +1 while pinned    */
+    int     pinned;
+    int     fd;                 /* backing store             */
+    void    *data;              /* shared read-only view     */
+    size_t  nbytes;
+    struct samplecache_s *nxt;
+} SAMPLECACHE;
+
+typedef struct cachemap_s {
+    CSOUND  *csound;
+    void    *ptr;               /* what the caller sees      */
+    void    *base;              /* start of the mapped pages */
+    size_t  len;
+    SAMPLECACHE *entry;         /* NULL for direct maps      */
+    struct cachemap_s *nxt;
+} CACHEMAP;
+
+static SAMPLECACHE  *cache_list = NULL;
+static CACHEMAP     *map_list = NULL;
+static int          cache_nfds = 0;     /* open backing files */
+
+#define CACHE_MAXFDS    256
+
+/* number of backing files the cache may keep open */
+
+static int cache_maxfds(void)
+{
+    struct rlimit rl;
+
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY &&
+        rl.rlim_cur / 4 < (rlim_t) CACHE_MAXFDS)
+      return (int) (rl.rlim_cur / 4);
+    return CACHE_MAXFDS;
+}
+
+static int cache_key(const char *path, char *fullpath, struct stat *st)
+{
+    if (path == NULL || realpath(path, fullpath) == NULL)
+      return -1;
+    return stat(fullpath, st);
+}
+
+static SAMPLECACHE *cache_lookup(const char *fullpath, const struct stat *st,
+                                 int kind, int format, int channel,
+                                 const void *tag)
+{
+    SAMPLECACHE *e;
+
+    for (e = cache_list; e != NULL; e = e->nxt) {
+      if (e->kind == kind && e->format == format && e->channel == channel &&
+          e->tag == tag && e->mtime == (int64_t) st->st_mtime &&
+          e->size == (int64_t) st->st_size && strcmp(e->path, fullpath) == 0)
+        return e;
+    }
+    return NULL;
+}
+
+static void cache_free(SAMPLECACHE *e)
+{
+    SAMPLECACHE **pp;
+
+    for (pp = &cache_list; *pp != NULL; pp = &((*pp)->nxt)) {
+      if (*pp == e) {
+        *pp = e->nxt;
+        break;
+      }
+    }
+    munmap(e->data, e->nbytes);
+    close(e->fd);
+    cache_nfds--;
+    free(e->path);
+    free(e);
+}
+
+/* create an anonymous file holding a copy of data */
+
+static int cache_backing(const void *data, size_t nbytes)
+{
+    const char  *p = (const char*) data;
+    size_t  n = 0;
+    int     fd;
+
+#  if defined(LINUX) && defined(MFD_CLOEXEC)
+    fd = memfd_create("csound-samplecache", MFD_CLOEXEC);
+#  else
+    {
+      FILE *f = tmpfile();
+      if (f == NULL)
+        return -1;
+      fd = dup(fileno(f));
+      fclose(f);
+    }
+#  endif
+    if (fd < 0)
+      return -1;
+    while (n < nbytes) {
+      ssize_t k = write(fd, p + n, nbytes - n);
+      if (k <= 0) {
+        close(fd);
+        return -1;
+      }
+      n += (size_t) k;
+    }
+    return fd;
+}
+
+#endif  /* SAMPLECACHE_MMAP */
+
+/* look up cached data for a file; returns a handle holding a reference, */
+/* or NULL if the file is not in the cache                               */
+
+void *samplecache_find(const char *path, int kind, int format, int channel,
+                       const void *tag, size_t *nbytes)
+{
+#ifdef SAMPLECACHE_MMAP
+    char        fullpath[PATH_MAX];
+    struct stat st;
+    SAMPLECACHE *e;
+
+    if (cache_key(path, fullpath, &st) != 0)
+      return NULL;
+    csoundLock();
+    if ((e = cache_lookup(fullpath, &st, kind, format, channel, tag)) != NULL) {
+      e->refcnt++;
+      *nbytes = e->nbytes;
+    }
+    csoundUnLock();
+    return (void*) e;
+#else
+    (void) path; (void) kind; (void) format; (void) channel; (void) tag;
+    (void) nbytes;
+    return NULL;
+#endif
+}
+
+/* store a copy of nbytes of data for a file in the cache; returns a     */
+/* handle holding a reference (to an existing entry if another instance  */
+/* got there first), or NULL on failure                                  */
+
+void *samplecache_add(const char *path, int kind, int format, int channel,
+                      const void *tag, const void *data, size_t nbytes)
+{
+#ifdef SAMPLECACHE_MMAP
+    char        fullpath[PATH_MAX];
+    struct stat st;
+    SAMPLECACHE *e, *old;
+
+    if (nbytes == 0 || cache_key(path, fullpath, &st) != 0)
+      return NULL;
+    csoundLock();                       /* reserve a backing file */
+    if (cache_nfds >= cache_maxfds()) {
+      csoundUnLock();
+      return NULL;
+    }
+    cache_nfds++;
+    csoundUnLock();
+    if ((e = (SAMPLECACHE*) calloc(1, sizeof(SAMPLECACHE))) == NULL)
+      goto err_return;
+    if ((e->path = strdup(fullpath)) == NULL ||
+        (e->fd = cache_backing(data, nbytes)) < 0) {
+      free(e->path);
+      free(e);
+      goto err_return;
+    }
+    e->data = mmap(NULL, nbytes, PROT_READ, MAP_SHARED, e->fd, 0);
+    if (e->data == MAP_FAILED) {
+      close(e->fd);
+      free(e->path);
+      free(e);
+      goto err_return;
+    }
+    e->mtime = (int64_t) st.st_mtime;
+    e->size = (int64_t) st.st_size;
+    e->kind = kind;
+    e->format = format;
+    e->channel = channel;
+    e->tag = tag;
+    e->nbytes = nbytes;
+    e->refcnt = 1;
+    csoundLock();
+    if ((old = cache_lookup(fullpath, &st, kind, format, channel, tag))
+        != NULL) {
+      old->refcnt++;
+      cache_nfds--;
+      csoundUnLock();
+      munmap(e->data, nbytes);
+      close(e->fd);
+      free(e->path);
+      free(e);
+      return (void*) old;
+    }
+    e->nxt = cache_list;
+    cache_list = e;
+    csoundUnLock();
+    return (void*) e;
+ err_return:
+    csoundLock();
+    cache_nfds--;
+    csoundUnLock();
+    return NULL;
+#else
+    (void) path; (void) kind; (void) format; (void) channel; (void) tag;
+    (void) data; (void) nbytes;
+    return NULL;
+#endif
+}
+
+/* read-only view of the cached data */
+
+const void *samplecache_data(void *entry)
+{
+#ifdef SAMPLECACHE_MMAP
+    return ((SAMPLECACHE*) entry)->data;
+#else
+    (void) entry;
+    return NULL;
+#endif
+}
+
+/* drop a reference obtained from samplecache_find() or samplecache_add() */
+
+void samplecache_release(void *entry)
+{
+#ifdef SAMPLECACHE_MMAP
+    SAMPLECACHE *e = (SAMPLECACHE*) entry;
+
+    if (e == NULL)
+      return;
+    csoundLock();
+    if (--(e->refcnt) <= 0)
+      cache_free(e);
+    csoundUnLock();
+#else
+    (void) entry;
+#endif
+}
+
+#ifdef SAMPLECACHE_MMAP
+
+static CACHEMAP *map_unlink(CSOUND *csound, void *ptr)
+{
+    CACHEMAP  **pp, *m;
+
+    for (pp = &map_list; (m = *pp) != NULL; pp = &(m->nxt)) {
+      if ((ptr == NULL || m->ptr == ptr) && m->csound == csound) {
+        *pp = m->nxt;
+        return m;
+      }
+    }
+    return NULL;
+}
+
+static void map_free(CACHEMAP *m)
+{
+    munmap(m->base, m->len);
+    samplecache_release(m->entry);
+    free(m);
+}
+
+#endif
+
+/* Map nbytes at byte offset 'offset' of a file privately into a zeroed  */
+/* region of 'alloc' bytes.  The data comes from the cache entry if it   */
+/* is not NULL (the reference is then owned by the mapping), else from   */
+/* the open file descriptor fd.  The offset must be aligned to MYFLT.    */
+/* Returns NULL if the data cannot be mapped.                            */
+
+void *samplecache_map(CSOUND *csound, void *entry, int fd,
+                      int64_t offset, size_t nbytes, size_t alloc)
+{
+#ifdef SAMPLECACHE_MMAP
+    CACHEMAP  *m;
+    size_t    pgsize, delta, len, flen;
+    int64_t   pgoff;
+    void      *base;
+    char      *ptr;
+
+    if (entry != NULL)
+      fd = ((SAMPLECACHE*) entry)->fd;
+    if (fd < 0 || offset < 0 || nbytes == 0 || alloc < nbytes ||
+        (offset % (int64_t) sizeof(MYFLT)) != 0)
+      return NULL;
+    /* reserve the whole region as zeroed anonymous memory, then map */
+    /* the file over its beginning                                   */
+    pgsize = (size_t) sysconf(_SC_PAGESIZE);
+    pgoff = offset & ~((int64_t) pgsize - 1);
+    delta = (size_t) (offset - pgoff);
+    len = (delta + alloc + pgsize - 1) & ~(pgsize - 1);
+    flen = (delta + nbytes + pgsize - 1) & ~(pgsize - 1);
+    base = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+      return NULL;
+    if (mmap(base, flen, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED,
+             fd, (off_t) pgoff) == MAP_FAILED) {
+      munmap(base, len);
+      return NULL;
+    }
+    ptr = (char*) base + delta;
+    {                                   /* clear file data past the end */
+      size_t  n = flen - delta;
+      if (n > alloc)
+        n = alloc;
+      if (n > nbytes)
+        memset(ptr + nbytes, 0, n - nbytes);
+    }
+    if ((m = (CACHEMAP*) malloc(sizeof(CACHEMAP))) == NULL) {
+      munmap(base, len);
+      return NULL;
+    }
+    m->csound = csound;
+    m->ptr = ptr;
+    m->base = base;
+    m->len = len;
+    m->entry = (SAMPLECACHE*) entry;
+    csoundLock();
+    m->nxt = map_list;
+    map_list = m;
+    csoundUnLock();
+    return ptr;
+#else
+    (void) csound; (void) entry; (void) fd; (void) offset; (void) nbytes;
+    (void) alloc;
+    return NULL;
+#endif
+}
+
+/* release a mapping made by samplecache_map(); returns non-zero if ptr */
+/* was such a mapping, and zero if it was not (and nothing was done)    */
+
+int samplecache_unmap(CSOUND *csound, void *ptr)
+{
+#ifdef SAMPLECACHE_MMAP
+    CACHEMAP  *m;
+
+    if (ptr == NULL)
+      return 0;
+    csoundLock();
+    m = map_unlink(csound, ptr);
+    csoundUnLock();
+    if (m == NULL)
+      return 0;
+    map_free(m);
+    return 1;
+#else
+    (void) csound; (void) ptr;
+    return 0;
+#endif
+}
+
+/* release all mappings of a Csound instance, called on reset */
+
+void samplecache_unmap_all(CSOUND *csound)
+{
+#ifdef SAMPLECACHE_MMAP
+    CACHEMAP  *m;
+
+    do {
+      csoundLock();
+      m = map_unlink(csound, NULL);
+      csoundUnLock();
+      if (m != NULL)
+        map_free(m);
+    } while (m != NULL);
+#else
+    (void) csound;
+#endif
+}
+
+/**
+ * Loads a sound file into the process-wide sample cache.
+ */
+
+PUBLIC int csoundPreloadSample(const char *path, int channel)
+{
+#ifdef SAMPLECACHE_MMAP
+    SF_INFO     sfinfo;
+    SNDFILE     *sf;
+    SAMPLECACHE *e;
+    MYFLT       *buf = NULL, *tmp = NULL;
+    sf_count_t  i, n, nvals;
+    int         j, nsel, format;
+    size_t      nbytes;
+
+    if (channel == 0)
+      channel = ALLCHNLS;
+    memset(&sfinfo, 0, sizeof(SF_INFO));
+    if ((sf = sf_open(path, SFM_READ, &sfinfo)) == NULL)
+      return CSOUND_ERROR;
+    format = SF2FORMAT(sfinfo.format);
+    if ((channel != ALLCHNLS && channel > sfinfo.channels) ||
+        sfinfo.frames <= 0)
+      goto err_return;
+    if ((e = samplecache_find(path, SAMPLECACHE_GEN01, format, channel,
+                              NULL, &nbytes)) == NULL) {
+      nsel = (channel == ALLCHNLS ? sfinfo.channels : 1);
+      nvals = sfinfo.frames * nsel;
+      buf = (MYFLT*) malloc((size_t) nvals * sizeof(MYFLT));
+      tmp = (MYFLT*) malloc((size_t) (1024 * sfinfo.channels) * sizeof(MYFLT));
+      if (buf == NULL || tmp == NULL)
+        goto err_return;
+      for (i = 0; i < nvals; ) {
+        n = sf_read_MYFLT(sf, tmp, (sf_count_t) (1024 * sfinfo.channels));
+        if (n <= 0)
+          goto err_return;
+        if (nsel == sfinfo.channels) {
+          if (n > nvals - i)
+            n = nvals - i;
+          memcpy(&(buf[i]), tmp, (size_t) n * sizeof(MYFLT));
+          i += n;
+        }
+        else {
+          for (j = channel - 1; j < n && i < nvals; j += sfinfo.channels)
+            buf[i++] = tmp[j];
+        }
+      }
+      e = samplecache_add(path, SAMPLECACHE_GEN01, format, channel, NULL,
+                          buf, (size_t) nvals * sizeof(MYFLT));
+      free(buf);
+      free(tmp);
+      if (e == NULL) {
+        sf_close(sf);
+        return CSOUND_MEMORY;
+      }
+    }
+    sf_close(sf);
+    csoundLock();
+    if (!e->pinned)
+      e->pinned = 1;
+    else
+      e->refcnt--;                      /* already holds a pin */
+    csoundUnLock();
+    return CSOUND_SUCCESS;
+ err_return:
+    free(buf);
+    free(tmp);
+    sf_close(sf);
+    return CSOUND_ERROR;
+#else
+    (void) path; (void) channel;
+    return CSOUND_ERROR;
+#endif
+}
+
+/**
+ * Releases the data loaded by csoundPreloadSample().
+ */
+
+PUBLIC void csoundFlushSampleCache(void)
+{
+#ifdef SAMPLECACHE_MMAP
+    SAMPLECACHE *e, *nxt;
+
+    csoundLock();
+    for (e = cache_list; e != NULL; e = nxt) {
+      nxt = e->nxt;
+      if (e->pinned) {
+        e->pinned = 0;
+        if (--(e->refcnt) <= 0)
+          cache_free(e);
+      }
+    }
+    csoundUnLock();
+#endif
+}
@@ -40,4 +40,8 @@ typedef struct RtJackGlobals_ {
     int     xrunFlag;                   /* non-zero if an xrun has occured  */
     jack_client_t   *listclient;
     int outDevNum, inDevNum;            /* select devs by number */
+    int     directMode;                 /* run performance in JACK callback */
+    int     directFrames;               /* frames in current JACK period    */
+    int     directInPos;                /* input position in JACK period    */
+    int     directOutPos;               /* output position in JACK period   */
 } RtJackGlobals;
@@ -31,6 +31,15 @@
 #define POS_FRAC_SCALE  0x10000000
 #define POS_FRAC_MASK   0x0FFFFFFF
 
+/* an asynchronous instance, as the io thread keeps it: the list and the
+   busy flag are changed under the io thread's mutex, which is never held
+   while a file is read */
+typedef struct DISKIN_IO_ {
+    struct DISKIN_IO_ *nxt;
+    void    *owner;             /* the DISKIN2 or DISKIN2_ARRAY */
+    volatile int busy;          /* being filled by the io thread */
+} DISKIN_IO;
+
 typedef struct {
     OPDS    h;
     MYFLT   *aOut[DISKIN2_MAXCHN];
@@ -72,6 +81,12 @@ typedef struct {
   MYFLT aOut_bufsize;
   void *cb;
   int  async;
+  int  aOut_pending;            /* rendered frames not yet in the ring */
+  int  aOut_pos;
+  int  lowWater;                /* frames consumed before waking io thread */
+  int  consumed;
+  void *wake;
+  DISKIN_IO io;                 /* entry in the io thread's list */
 } DISKIN2;
 
 typedef struct {
@@ -114,6 +129,12 @@ typedef struct {
   MYFLT aOut_bufsize;
   void *cb;
   int  async;
+  int  aOut_pending;            /* rendered frames not yet in the ring */
+  int  aOut_pos;
+  int  lowWater;                /* frames consumed before waking io thread */
+  int  consumed;
+  void *wake;
+  DISKIN_IO io;                 /* entry in the io thread's list */
 } DISKIN2_ARRAY;
 
 int diskin2_init(CSOUND *csound, DISKIN2 *p);
@@ -146,6 +167,7 @@ typedef struct {
 typedef struct {
     SNDFILE *sf;
     void    *fd;
+    int     async;          /* written by the async i/o service */
     MYFLT   *outbufp, *bufend;
     MYFLT   outbuf[SNDOUTSMPS];
 } SNDCOM;
@@ -233,12 +233,29 @@ extern "C" {
                                      int csFileType, int buffsize,
                                      int isTemporary);
 
+  /**
+   * Read up to 'items' samples that the file's worker has read ahead.
+   * Returns the number read, which is 0 while seeks are queued.
+   */
   unsigned int csoundReadAsync(CSOUND *csound, void *handle,
                                MYFLT *buf, int items);
 
+  /**
+   * Queue 'items' samples for the file's worker to write.  Never waits:
+   * returns the number queued, the rest being dropped if the worker has
+   * fallen behind by a whole ring.
+   */
   unsigned int csoundWriteAsync(CSOUND *csound, void *handle,
                                 MYFLT *buf, int items);
 
+  /**
+   * Queue a seek, in frames as for sf_seek(), for the file's worker, which
+   * carries out seeks in the order they were queued, after the data
+   * written before them.  Returns 'pos' for SEEK_SET and 0 for SEEK_CUR
+   * and SEEK_END, as the new position is not known until the worker has
+   * moved there, or -1 if 'handle' is not an async sound file or too
+   * many seeks are waiting.
+   */
   int csoundFSeekAsync(CSOUND *csound, void *handle, int pos, int whence);
 
 
@@ -141,6 +141,15 @@ extern "C" {
    */
   void csoundRealFFT2(CSOUND *csound, void *setup, MYFLT *sig);
 
+   /**
+   * New Real FFT interface
+   * Releases a setup created with csoundRealFFT2Setup(). Setups share the
+   * state of the FFT backend for each size; it is freed when the last
+   * setup that uses it is released, or when the engine is reset. Passing
+   * NULL does nothing.
+   */
+  void csoundRealFFT2Release(CSOUND *csound, void *setup);
+
 
 
 #ifdef __cplusplus
@@ -48,5 +48,13 @@ int csoundFTAlloc(CSOUND *csound, int tableNum, int len);
  */
 int csoundFTDelete(CSOUND *csound, int tableNum);
 
+/**
+ * Replaces the data of table ftp by a new block of nbytes bytes, keeping
+ * as much of the old data (flen + 1 values) as fits. Unlike ReAlloc(),
+ * this also works for the mapped data of GEN01 tables.
+ * Returns the new data, which is also stored in ftp->ftable.
+ */
+MYFLT *csoundFTReAlloc(CSOUND *csound, FUNC *ftp, size_t nbytes);
+
 #endif  /* CSOUND_FGENS_H */
 
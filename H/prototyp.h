@@ -90,6 +90,18 @@ MEMFIL  *ldmemfile2withCB(CSOUND *csound, const char *filnam, int csFileType,
                           int (*callback)(CSOUND*, MEMFIL*));
 void    rlsmemfiles(CSOUND *);
 int     delete_memfile(CSOUND *, const char *);
+#define SAMPLECACHE_GEN01   1
+#define SAMPLECACHE_MEMFILE 2
+void    *samplecache_find(const char *path, int kind, int format, int channel,
+                          const void *tag, size_t *nbytes);
+void    *samplecache_add(const char *path, int kind, int format, int channel,
+                         const void *tag, const void *data, size_t nbytes);
+const void *samplecache_data(void *entry);
+void    samplecache_release(void *entry);
+void    *samplecache_map(CSOUND *, void *entry, int fd, int64_t offset,
+                         size_t nbytes, size_t alloc);
+int     samplecache_unmap(CSOUND *, void *ptr);
+void    samplecache_unmap_all(CSOUND *);
 char    *csoundTmpFileName(CSOUND *, const char *);
 void    *SAsndgetset(CSOUND *, char *, void *, MYFLT *, MYFLT *, MYFLT *, int);
 int     getsndin(CSOUND *, void *, MYFLT *, int, void *);
@@ -98,6 +110,22 @@ void    dbfs_init(CSOUND *, MYFLT dbfs);
 int     csoundLoadExternals(CSOUND *);
 SNDMEMFILE  *csoundLoadSoundFile(CSOUND *, const char *name, void *sfinfo);
 int     PVOCEX_LoadFile(CSOUND *, const char *fname, PVOCEX_MEMFILE *p);
+void    *PVOCEX_OpenStream(CSOUND *, const char *fname, PVOCEX_MEMFILE *p);
+float   *PVOCEX_StreamFrame(CSOUND *, void *stream, int32 frame);
+void    PVOCEX_CloseStream(CSOUND *, void *stream);
+void    csoundSampleFromMYFLT(CSOUND *, void *out, int format, const MYFLT *in,
+                              int n, int dither, uint32_t *state);
+void    csoundSampleToMYFLT(CSOUND *, MYFLT *out, const void *in,
+                            int format, int n);
+void    csoundInterleaveFloat(CSOUND *, MYFLT *out, float *const *in,
+                              int offs, int nchnls, int nframes);
+void    csoundDeinterleaveFloat(CSOUND *, float *const *out, int offs,
+                                const MYFLT *in, int nchnls, int nframes);
+void    csoundAddDither(CSOUND *, MYFLT *buf, int n, MYFLT lsb,
+                        int dither, uint32_t *state);
+void    csoundSetDriverPaced(CSOUND *, int on);
+int     csoundDriverPerform(CSOUND *, int nkcycles);
+void    csoundMidiInTimestamp(CSOUND *, int pos, int n, int32 age);
 void    print_opcodedir_warning(CSOUND *);
 int     check_rtaudio_name(char *fName, char **devName, int isOutput);
 int     csoundLoadOpcodeDB(CSOUND *, const char *);
@@ -23,146 +23,203 @@
 
 #include <csoundCore.h>
 
+/* Single producer / single consumer ring. The size is a power of two and
+   rp/wp are free running counters, so the fill level is simply wp - rp
+   and the whole buffer is usable. Each index lives on its own cache line
+   so that reader and writer do not bounce the same line between cores. */
+
+#define CB_CACHELINE 64
+
 typedef struct _circular_buffer {
   char *buffer;
-  int  wp;
-  int rp;
-  int numelem;
-  int elemsize; /* in number of bytes */
+  unsigned int numelem;   /* power of two */
+  unsigned int mask;
+  int elemsize;           /* in number of bytes */
+  char pad0[CB_CACHELINE - sizeof(char *) - 3 * sizeof(int)];
+  volatile unsigned int wp;
+  char pad1[CB_CACHELINE - sizeof(unsigned int)];
+  volatile unsigned int rp;
+  char pad2[CB_CACHELINE - sizeof(unsigned int)];
 } circular_buffer;
 
+/* the producer publishes wp with release semantics after copying data in,
+   the consumer publishes rp with release semantics after copying data out;
+   each side reads the other's index with acquire semantics */
+#if defined(HAVE_ATOMIC_BUILTIN) && defined(__ATOMIC_ACQUIRE)
+#define CB_LOAD_ACQ(x)      __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define CB_STORE_REL(x, v)  __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+#elif defined(HAVE_ATOMIC_BUILTIN)
+static inline unsigned int cb_load_acq(volatile unsigned int *x)
+{
+    unsigned int v = *x;
+    __sync_synchronize();
+    return v;
+}
+#define CB_LOAD_ACQ(x)      cb_load_acq(&(x))
+#define CB_STORE_REL(x, v)  do { __sync_synchronize(); (x) = (v); } while (0)
+#else
+#define CB_LOAD_ACQ(x)      (x)
+#define CB_STORE_REL(x, v)  do { (x) = (v); } while (0)
+#endif
+
 void *csoundCreateCircularBuffer(CSOUND *csound, int numelem, int elemsize){
     circular_buffer *p;
+    unsigned int size = 1;
+    if (numelem < 1 || elemsize < 1)
+      return NULL;
+    while (size < (unsigned int) numelem)
+      size <<= 1;
     if ((p = (circular_buffer *)
-         csound->Malloc(csound, sizeof(circular_buffer))) == NULL) {
+         csound->Calloc(csound, sizeof(circular_buffer))) == NULL) {
       return NULL;
     }
-    p->numelem = numelem;
+    p->numelem = size;
+    p->mask = size - 1;
     p->wp = p->rp = 0;
     p->elemsize = elemsize;
 
-    if ((p->buffer = (char *) csound->Malloc(csound, numelem*elemsize)) == NULL) {
+    if ((p->buffer = (char *) csound->Calloc(csound,
+                                             (size_t) size*elemsize)) == NULL) {
+      csound->Free(csound, p);
       return NULL;
     }
-    memset(p->buffer, 0, numelem*elemsize);
     return (void *)p;
 }
 
-static int checkspace(circular_buffer *p, int writeCheck){
-    int wp = p->wp, rp = p->rp, numelem = p->numelem;
-    if(writeCheck){
-      if (wp > rp) return rp - wp + numelem - 1;
-      else if (wp < rp) return rp - wp - 1;
-      else return numelem - 1;
-    }
-    else {
-      if (wp > rp) return wp - rp;
-      else if (wp < rp) return wp - rp + numelem;
-      else return 0;
-    }
+/* copies n items starting at ring position pos into out, in at most two
+   contiguous segments */
+static void ring_copy_out(circular_buffer *p, unsigned int pos,
+                          char *out, unsigned int n)
+{
+    unsigned int start = pos & p->mask;
+    unsigned int first = p->numelem - start;
+    if (first > n) first = n;
+    memcpy(out, p->buffer + (size_t) start * p->elemsize,
+           (size_t) first * p->elemsize);
+    if (n > first)
+      memcpy(out + (size_t) first * p->elemsize, p->buffer,
+             (size_t) (n - first) * p->elemsize);
+}
+
+static void ring_copy_in(circular_buffer *p, unsigned int pos,
+                         const char *in, unsigned int n)
+{
+    unsigned int start = pos & p->mask;
+    unsigned int first = p->numelem - start;
+    if (first > n) first = n;
+    memcpy(p->buffer + (size_t) start * p->elemsize, in,
+           (size_t) first * p->elemsize);
+    if (n > first)
+      memcpy(p->buffer, in + (size_t) first * p->elemsize,
+             (size_t) (n - first) * p->elemsize);
 }
 
 int csoundReadCircularBuffer(CSOUND *csound, void *p, void *out, int items)
 {
+    circular_buffer *cb = (circular_buffer *) p;
+    unsigned int rp, remaining, n;
     IGN(csound);
-    if (p == NULL) return 0;
-    {
-      int remaining;
-      int itemsread, numelem = ((circular_buffer *)p)->numelem;
-      int elemsize = ((circular_buffer *)p)->elemsize;
-      int i=0, rp = ((circular_buffer *)p)->rp;
-      char *buffer = ((circular_buffer *)p)->buffer;
-      if ((remaining = checkspace(p, 0)) == 0) {
-        return 0;
-      }
-      itemsread = items > remaining ? remaining : items;
-      for (i=0; i < itemsread; i++){
-        memcpy((char *) out + (i * elemsize),
-               &(buffer[elemsize * rp++]),  elemsize);
-        if (rp == numelem) {
-          rp = 0;
-        }
-      }
-#ifdef HAVE_ATOMIC_BUILTIN
-      __sync_lock_test_and_set(&((circular_buffer *)p)->rp,rp);
-#else
-      ((circular_buffer *)p)->rp = rp;
-#endif
-      return itemsread;
-    }
+    if (cb == NULL || items <= 0) return 0;
+    rp = cb->rp;
+    remaining = CB_LOAD_ACQ(cb->wp) - rp;
+    if (remaining == 0)
+      return 0;
+    n = (unsigned int) items > remaining ? remaining : (unsigned int) items;
+    ring_copy_out(cb, rp, (char *) out, n);
+    CB_STORE_REL(cb->rp, rp + n);
+    return (int) n;
 }
 
 int csoundPeekCircularBuffer(CSOUND *csound, void *p, void *out, int items)
 {
+    circular_buffer *cb = (circular_buffer *) p;
+    unsigned int rp, remaining, n;
     IGN(csound);
-    if (p == NULL) return 0;
-    int remaining;
-    int itemsread, numelem = ((circular_buffer *)p)->numelem;
-    int elemsize = ((circular_buffer *)p)->elemsize;
-    int i=0, rp = ((circular_buffer *)p)->rp;
-    char *buffer = ((circular_buffer *)p)->buffer;
-    if ((remaining = checkspace(p, 0)) == 0) {
-        return 0;
-    }
-    itemsread = items > remaining ? remaining : items;
-    for(i=0; i < itemsread; i++){
-        memcpy((char *) out + (i * elemsize),
-               &(buffer[elemsize * rp++]),  elemsize);
-        if (rp == numelem) {
-            rp = 0;
-        }
-    }
-    return itemsread;
+    if (cb == NULL || items <= 0) return 0;
+    rp = cb->rp;
+    remaining = CB_LOAD_ACQ(cb->wp) - rp;
+    if (remaining == 0)
+      return 0;
+    n = (unsigned int) items > remaining ? remaining : (unsigned int) items;
+    ring_copy_out(cb, rp, (char *) out, n);
+    return (int) n;
 }
 
 void csoundFlushCircularBuffer(CSOUND *csound, void *p)
 {
+    circular_buffer *cb = (circular_buffer *) p;
     IGN(csound);
-    if (p == NULL) return;
-    int remaining;
-    int itemsread, numelem = ((circular_buffer *)p)->numelem;
-    int i=0, rp = ((circular_buffer *)p)->rp;
-    //MYFLT *buffer = ((circular_buffer *)p)->buffer;
-    if ((remaining = checkspace(p, 0)) == 0) {
-        return;
-    }
-    itemsread = numelem > remaining ? remaining: numelem;
-    for (i=0; i < itemsread; i++){
-        rp++;
-        if(rp == numelem) rp = 0;
-    }
-#ifdef HAVE_ATOMIC_BUILTIN
-      __sync_lock_test_and_set(&((circular_buffer *)p)->rp,rp);
-#else
-      ((circular_buffer *)p)->rp = rp;
-#endif
+    if (cb == NULL) return;
+    CB_STORE_REL(cb->rp, CB_LOAD_ACQ(cb->wp));
 }
 
 
 int csoundWriteCircularBuffer(CSOUND *csound, void *p, const void *in, int items)
 {
+    circular_buffer *cb = (circular_buffer *) p;
+    unsigned int wp, remaining, n;
     IGN(csound);
-    if (p == NULL) return 0;
-    int remaining;
-    int itemswrite, numelem = ((circular_buffer *)p)->numelem;
-    int elemsize = ((circular_buffer *)p)->elemsize;
-    int i=0, wp = ((circular_buffer *)p)->wp;
-    char *buffer = ((circular_buffer *)p)->buffer;
-    if ((remaining = checkspace(p, 1)) == 0) {
-        return 0;
-    }
-    itemswrite = items > remaining ? remaining : items;
-    for(i=0; i < itemswrite; i++){
-        memcpy(&(buffer[elemsize * wp++]),
-                ((char *) in) + (i * elemsize),  elemsize);
-        if(wp == numelem) wp = 0;
-    }
-#ifdef HAVE_ATOMIC_BUILTIN
-      __sync_lock_test_and_set(&((circular_buffer *)p)->wp,wp);
-#else
-      ((circular_buffer *)p)->wp = wp;
-#endif
-    return itemswrite;
+    if (cb == NULL || items <= 0) return 0;
+    wp = cb->wp;
+    remaining = cb->numelem - (wp - CB_LOAD_ACQ(cb->rp));
+    if (remaining == 0)
+      return 0;
+    n = (unsigned int) items > remaining ? remaining : (unsigned int) items;
+    ring_copy_in(cb, wp, (const char *) in, n);
+    CB_STORE_REL(cb->wp, wp + n);
+    return (int) n;
+}
+
+int csoundAcquireWriteCircularBuffer(CSOUND *csound, void *p,
+                                     void **ptr, int items)
+{
+    circular_buffer *cb = (circular_buffer *) p;
+    unsigned int wp, remaining, contig, n;
+    IGN(csound);
+    *ptr = NULL;
+    if (cb == NULL || items <= 0) return 0;
+    wp = cb->wp;
+    remaining = cb->numelem - (wp - CB_LOAD_ACQ(cb->rp));
+    contig = cb->numelem - (wp & cb->mask);
+    n = remaining < contig ? remaining : contig;
+    if ((unsigned int) items < n) n = (unsigned int) items;
+    if (n)
+      *ptr = cb->buffer + (size_t) (wp & cb->mask) * cb->elemsize;
+    return (int) n;
+}
+
+void csoundCommitWriteCircularBuffer(CSOUND *csound, void *p, int items)
+{
+    circular_buffer *cb = (circular_buffer *) p;
+    IGN(csound);
+    if (cb == NULL || items <= 0) return;
+    CB_STORE_REL(cb->wp, cb->wp + (unsigned int) items);
+}
+
+int csoundAcquireReadCircularBuffer(CSOUND *csound, void *p,
+                                    void **ptr, int items)
+{
+    circular_buffer *cb = (circular_buffer *) p;
+    unsigned int rp, remaining, contig, n;
+    IGN(csound);
+    *ptr = NULL;
+    if (cb == NULL || items <= 0) return 0;
+    rp = cb->rp;
+    remaining = CB_LOAD_ACQ(cb->wp) - rp;
+    contig = cb->numelem - (rp & cb->mask);
+    n = remaining < contig ? remaining : contig;
+    if ((unsigned int) items < n) n = (unsigned int) items;
+    if (n)
+      *ptr = cb->buffer + (size_t) (rp & cb->mask) * cb->elemsize;
+    return (int) n;
+}
+
+void csoundCommitReadCircularBuffer(CSOUND *csound, void *p, int items)
+{
+    circular_buffer *cb = (circular_buffer *) p;
+    IGN(csound);
+    if (cb == NULL || items <= 0) return;
+    CB_STORE_REL(cb->rp, cb->rp + (unsigned int) items);
 }
 
 void csoundDestroyCircularBuffer(CSOUND *csound, void *p){
@@ -160,6 +160,17 @@ static void spoutsf_noscale(CSOUND *csound)
 /* diskfile write option for audtran's */
 /*      assigned during sfopenout()    */
 
+/* write to the output file, through the async i/o service if it is */
+/* written by a worker thread (see sfopenout())                     */
+
+static inline sf_count_t outfile_write(CSOUND *csound, MYFLT *buf,
+                                       sf_count_t n)
+{
+    if (STA(outfd) != NULL)
+      return (sf_count_t) csound->WriteAsync(csound, STA(outfd), buf, (int) n);
+    return sf_write_MYFLT(STA(outfile), buf, n);
+}
+
 static void writesf(CSOUND *csound, const MYFLT *outbuf, int nbytes)
 {
     OPARMS  *O = csound->oparms;
@@ -167,11 +178,11 @@ static void writesf(CSOUND *csound, const MYFLT *outbuf, int nbytes)
 
     if (UNLIKELY(STA(outfile) == NULL))
       return;
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
+    n = (int) outfile_write(csound, (MYFLT*) outbuf,
+                            nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
     if (UNLIKELY(n < nbytes))
       sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
+    if (UNLIKELY(O->rewrt_hdr) && STA(outfd) == NULL)
       rewriteheader((void *)STA(outfile));
     switch (O->heartbeat) {
       case 1:
@@ -209,21 +220,12 @@ static void writesf_dither_16(CSOUND *csound, const MYFLT *outbuf, int nbytes)
     if (UNLIKELY(STA(outfile) == NULL))
       return;
 
-    for (n=0; n<m; n++) {
-      int   tmp = ((STA(dither) * 15625) + 1) & 0xFFFF;
-      int   rnd = ((tmp * 15625) + 1) & 0xFFFF;
-      MYFLT result;
-      STA(dither) = rnd;
-      rnd = (rnd+tmp)>>1;           /* triangular distribution */
-      result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7fff);
-      buf[n] += result;
-    }
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
+    csoundAddDither(csound, buf, m, FL(1.0) / (MYFLT) 0x7fff, 1, STA(dither));
+    n = (int) outfile_write(csound, (MYFLT*) outbuf,
+                            nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
     if (UNLIKELY(n < nbytes))
       sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
+    if (UNLIKELY(O->rewrt_hdr) && STA(outfd) == NULL)
       rewriteheader(STA(outfile));
     switch (O->heartbeat) {
       case 1:
@@ -261,21 +263,12 @@ static void writesf_dither_8(CSOUND *csound, const MYFLT *outbuf, int nbytes)
     if (UNLIKELY(STA(outfile) == NULL))
       return;
 
-    for (n=0; n<m; n++) {
-      int   tmp = ((STA(dither) * 15625) + 1) & 0xFFFF;
-      int   rnd = ((tmp * 15625) + 1) & 0xFFFF;
-      MYFLT result;
-      STA(dither) = rnd;
-      rnd = (rnd+tmp)>>1;           /* triangular distribution */
-      result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7f);
-      buf[n] += result;
-    }
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
+    csoundAddDither(csound, buf, m, FL(1.0) / (MYFLT) 0x7f, 1, STA(dither));
+    n = (int) outfile_write(csound, (MYFLT*) outbuf,
+                            nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
     if (UNLIKELY(n < nbytes))
       sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
+    if (UNLIKELY(O->rewrt_hdr) && STA(outfd) == NULL)
       rewriteheader(STA(outfile));
     switch (O->heartbeat) {
       case 1:
@@ -313,19 +306,12 @@ static void writesf_dither_u16(CSOUND *csound, const MYFLT *outbuf, int nbytes)
     if (UNLIKELY(STA(outfile) == NULL))
       return;
 
-    for (n=0; n<m; n++) {
-        int   rnd = ((STA(dither) * 15625) + 1) & 0xFFFF;
-        MYFLT result;
-        STA(dither) = rnd;
-        result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-        result /= ((MYFLT) 0x7fff);
-        buf[n] += result;
-    }
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
+    csoundAddDither(csound, buf, m, FL(1.0) / (MYFLT) 0x7fff, 2, STA(dither));
+    n = (int) outfile_write(csound, (MYFLT*) outbuf,
+                            nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
     if (UNLIKELY(n < nbytes))
       sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
+    if (UNLIKELY(O->rewrt_hdr) && STA(outfd) == NULL)
       rewriteheader(STA(outfile));
     switch (O->heartbeat) {
       case 1:
@@ -363,19 +349,12 @@ static void writesf_dither_u8(CSOUND *csound, const MYFLT *outbuf, int nbytes)
     if (UNLIKELY(STA(outfile) == NULL))
       return;
 
-    for (n=0; n<m; n++) {
-      int   rnd = ((STA(dither) * 15625) + 1) & 0xFFFF;
-      MYFLT result;
-      STA(dither) = rnd;
-      result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7f);
-      buf[n] += result;
-    }
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
+    csoundAddDither(csound, buf, m, FL(1.0) / (MYFLT) 0x7f, 2, STA(dither));
+    n = (int) outfile_write(csound, (MYFLT*) outbuf,
+                            nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
     if (UNLIKELY(n < nbytes))
       sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
+    if (UNLIKELY(O->rewrt_hdr) && STA(outfd) == NULL)
       rewriteheader(STA(outfile));
     switch (O->heartbeat) {
       case 1:
@@ -785,14 +764,31 @@ void sfopenout(CSOUND *csound)                  /* init for sound out       */
       if (UNLIKELY(fullName == NULL))
         csoundDie(csound, Str("sfinit: cannot open %s"), fName);
       STA(sfoutname) = fullName;
-      STA(outfile)   = sf_open(fullName, SFM_WRITE, &sfinfo);
-      sf_command(STA(outfile), SFC_SET_VBR_ENCODING_QUALITY,
-                 &O->quality, sizeof(double));
-      if (UNLIKELY(STA(outfile) == NULL))
-        csoundDie(csound, Str("sfinit: cannot open %s"), fullName);
-      /* only notify the host if we opened a real file, not stdout or a pipe */
-      csoundNotifyFileOpened(csound, fullName,
-                              type2csfiletype(O->filetyp, O->outformat), 1, 0);
+      if (O->realtime) {
+        /* leave the disk writes to a worker thread of the async i/o */
+        /* service, so that they cannot hold up a live performance  */
+        STA(outfd) = csound->FileOpenAsync(csound, &STA(outfile), CSFILE_SND_W,
+                                           fullName, &sfinfo, NULL,
+                                           type2csfiletype(O->filetyp,
+                                                           O->outformat),
+                                           O->outbufsamps, 0);
+        if (UNLIKELY(STA(outfd) == NULL))
+          csoundDie(csound, Str("sfinit: cannot open %s"), fullName);
+        /* nothing is queued yet, so the worker has not written anything */
+        sf_command(STA(outfile), SFC_SET_VBR_ENCODING_QUALITY,
+                   &O->quality, sizeof(double));
+      }
+      else {
+        STA(outfile)   = sf_open(fullName, SFM_WRITE, &sfinfo);
+        sf_command(STA(outfile), SFC_SET_VBR_ENCODING_QUALITY,
+                   &O->quality, sizeof(double));
+        if (UNLIKELY(STA(outfile) == NULL))
+          csoundDie(csound, Str("sfinit: cannot open %s"), fullName);
+        /* only notify the host if we opened a real file, */
+        /* not stdout or a pipe                           */
+        csoundNotifyFileOpened(csound, fullName,
+                               type2csfiletype(O->filetyp, O->outformat), 1, 0);
+      }
     }
     /* IV - Feb 22 2005: clip integer formats */
     if (O->outformat != AE_FLOAT && O->outformat != AE_DOUBLE)
@@ -918,7 +914,13 @@ void sfcloseout(CSOUND *csound)
     }
     if (STA(pipdevout) == 2)
       goto report;
-    if (STA(outfile) != NULL) {
+    if (STA(outfd) != NULL) {
+      /* writes out what is still queued, then closes the file */
+      csound->FileClose(csound, STA(outfd));
+      STA(outfd) = NULL;
+      STA(outfile) = NULL;
+    }
+    else if (STA(outfile) != NULL) {
       if (!STA(pipdevout) && O->outformat != AE_VORBIS)
         sf_command(STA(outfile), SFC_UPDATE_HEADER_NOW, NULL, 0);
       sf_close(STA(outfile));
@@ -471,6 +471,45 @@ static void midNotesOff(CSOUND *csound)
     } while (++chan < MAXCHAN);
 }
 
+/* Called by a MIDI input module from its read callback: bytes pos to */
+/* pos + n - 1 of the data it returns were received 'age' sample frames */
+/* before the read.  The k-cycles of an output buffer (-b) are computed */
+/* in one go, so the read is taken to happen at the start of the buffer */
+/* being computed, and the bytes are due 'age' frames before the end of */
+/* that buffer: events keep their timing at the cost of one buffer of   */
+/* latency.  sensMidi() holds them back until the k-cycle holding that  */
+/* frame; events older than the buffer are due at once.                 */
+
+void csoundMidiInTimestamp(CSOUND *csound, int pos, int n, int32 age)
+{
+    MGLOBAL *p = csound->midiGlobals;
+    OPARMS  *O = csound->oparms;
+    int64_t bufframes = (int64_t) (O->outbufsamps / csound->nchnls);
+    int64_t bufpos = 0, start, due;
+
+    if (pos < 0 || n <= 0 || pos + n > MBUFSIZ)
+      return;
+    if (bufframes >= (int64_t) csound->ksmps) {
+      /* frame position of the current k-cycle in the output buffer */
+      bufpos = ((int64_t) O->outbufsamps
+                - (int64_t) csound->libsndStatics.outbufrem)
+               / (int64_t) csound->nchnls;
+      if (bufpos < 0 || bufpos >= bufframes)
+        bufpos = 0;
+    }
+    else
+      bufframes = (int64_t) csound->ksmps;
+    start = csound->icurTime - bufpos;
+    due = start + bufframes - (int64_t) age;
+    if (due < csound->icurTime)
+      due = csound->icurTime;
+    else if (due >= start + bufframes)
+      due = start + bufframes - 1;
+    /* 0 means untimed, which is the same as due at frame 0 */
+    while (n--)
+      p->mtime[pos++] = due;
+}
+
 /* sense a MIDI event, collect the data & dispatch */
 /* called from sensevents(), returns 2 if MIDI on/off */
 
@@ -484,6 +523,8 @@ int sensMidi(CSOUND *csound)
 
  nxtchr:
     if (p->bufp >= p->endatp) {
+      /* clear the timestamps of the data used up */
+      memset(p->mtime, 0, sizeof(int64_t) * (size_t) (p->endatp - p->mbuf));
       p->bufp = &(p->mbuf[0]);
       p->endatp = p->bufp;
       if (O->Midiin && !csound->advanceCnt) {   /* read MIDI device */
@@ -503,6 +544,9 @@ int sensMidi(CSOUND *csound)
       if (p->endatp <= p->bufp)
         return 0;               /* no events were received */
     }
+    /* leave data due in a later k-cycle in the buffer until then */
+    if (p->mtime[p->bufp - p->mbuf] >= csound->icurTime + csound->ksmps)
+      return 0;
 
     if ((c = *(p->bufp++)) & 0x80) {    /* STATUS byte:         */
       type = c & 0xF0;
@@ -581,6 +625,10 @@ int sensMidi(CSOUND *csound)
       m_chanmsg(csound, mep);           /*   handle from here   */
       goto nxtchr;                      /*   & go look for more */
     }
+    {                                   /* sample of the k-cycle */
+      int64_t ofs = p->mtime[p->bufp - p->mbuf - 1] - csound->icurTime;
+      p->evtOffset = (ofs > 0 ? (int) ofs : 0);
+    }
     return 2;                           /* else it's note_on/off */
 }
 
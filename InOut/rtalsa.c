@@ -68,11 +68,8 @@ typedef struct devparams_ {
     int             nchns;          /* number of channels               */
     int             buffer_smps;    /* buffer length in samples         */
     int             period_smps;    /* period time in samples           */
-    /* playback sample conversion function */
-    void            (*playconv)(int, MYFLT *, void *, int *);
-    /* record sample conversion function */
-    void            (*rec_conv)(int, void *, MYFLT *);
-    int             seed;           /* random seed for dithering        */
+    int             dither;         /* dither mode for 16 bit playback  */
+    uint32_t        dither_state[CS_DITHER_LANES];  /* dither generator */
 } DEVPARAMS;
 
 #ifdef BUF_SIZE
@@ -102,6 +99,7 @@ typedef struct alsaseqMidi_ {
     snd_seq_event_t       sev;
     snd_seq_client_info_t *cinfo;
     snd_seq_port_info_t   *pinfo;
+    int                   queue;    /* queue for input timestamps, or -1 */
 } alsaseqMidi;
 
 static const unsigned char dataBytes[16] = {
@@ -146,158 +144,12 @@ int set_scheduler_priority(CSOUND *csound, int priority)
 }
 
 
-/* sample conversion routines for playback */
-
-static void MYFLT_to_short(int nSmps, MYFLT *inBuf, int16_t *outBuf, int *seed)
-{
-    MYFLT tmp_f;
-    int   tmp_i;
-    int n;
-    for (n=0; n<nSmps; n++) {
-      int rnd = (((*seed) * 15625) + 1) & 0xFFFF;
-      *seed = (((rnd) * 15625) + 1) & 0xFFFF;
-      rnd += *seed;           /* triangular distribution */
-      tmp_f = (MYFLT) ((rnd>>1) - 0x8000) * (FL(1.0) / (MYFLT) 0x10000);
-      tmp_f += inBuf[n] * (MYFLT) 0x8000;
-#ifndef USE_DOUBLE
-      tmp_i = (int) lrintf(tmp_f);
-#else
-      tmp_i = (int) lrint(tmp_f);
-#endif
-      if (tmp_i < -0x8000) tmp_i = -0x8000;
-      if (tmp_i > 0x7FFF) tmp_i = 0x7FFF;
-      outBuf[n] = (int16_t) tmp_i;
-    }
-}
-
-static void MYFLT_to_short_u(int nSmps, MYFLT *inBuf, int16_t *outBuf, int *seed)
-{
-    MYFLT tmp_f;
-    int   tmp_i;
-    int n;
-    for (n=0; n<nSmps; n++) {
-      int rnd = (((*seed) * 15625) + 1) & 0xFFFF;
-      *seed = rnd;
-      tmp_f = (MYFLT) (rnd - 0x8000) * (FL(1.0) / (MYFLT) 0x10000);
-      tmp_f += inBuf[n] * (MYFLT) 0x8000;
-#ifndef USE_DOUBLE
-      tmp_i = (int) lrintf(tmp_f);
-#else
-      tmp_i = (int) lrint(tmp_f);
-#endif
-      if (tmp_i < -0x8000) tmp_i = -0x8000;
-      if (tmp_i > 0x7FFF) tmp_i = 0x7FFF;
-      outBuf[n] = (int16_t) tmp_i;
-    }
-}
-
-static void MYFLT_to_short_no_dither(int nSmps, MYFLT *inBuf,
-                                     int16_t *outBuf, int *seed)
-{
-    MYFLT tmp_f;
-    int   tmp_i;
-    int n;
-    for (n=0; n<nSmps; n++) {
-      tmp_f = inBuf[n] * (MYFLT) 0x8000;
-#ifndef USE_DOUBLE
-      tmp_i = (int) lrintf(tmp_f);
-#else
-      tmp_i = (int) lrint(tmp_f);
-#endif
-      if (tmp_i < -0x8000) tmp_i = -0x8000;
-      if (tmp_i > 0x7FFF) tmp_i = 0x7FFF;
-      outBuf[n] = (int16_t) tmp_i;
-    }
-}
-
-static void MYFLT_to_long(int nSmps, MYFLT *inBuf, int32_t *outBuf, int *seed)
-{
-    MYFLT   tmp_f;
-    int64_t tmp_i;
-    (void) seed;
-    int n;
-    for (n=0; n<nSmps; n++) {
-      tmp_f = inBuf[n] * (MYFLT) 0x80000000UL;
-#ifndef USE_DOUBLE
-      tmp_i = (int64_t) llrintf(tmp_f);
-#else
-      tmp_i = (int64_t) llrint(tmp_f);
-#endif
-      if (tmp_i < -((int64_t) 0x80000000UL))
-        tmp_i = -((int64_t) 0x80000000UL);
-      if (tmp_i > (int64_t) 0x7FFFFFFF) tmp_i = (int64_t) 0x7FFFFFFF;
-      outBuf[n] = (int32_t) tmp_i;
-    }
-}
-
-static void MYFLT_to_float(int nSmps, MYFLT *inBuf, float *outBuf, int *seed)
-{
-    (void) seed;
-    int n;
-    for (n=0; n<nSmps; n++)
-      outBuf[n] = (float) inBuf[n];
-}
-
-/* sample conversion routines for recording */
-
-static void short_to_MYFLT(int nSmps, int16_t *inBuf, MYFLT *outBuf)
-{
-    int n;
-    MYFLT adjust = FL(1.0) / (MYFLT) 0x8000;
-    for (n=0; n<nSmps; n++)
-      outBuf[n] = (MYFLT) inBuf[n] * adjust;
-}
-
-static void long_to_MYFLT(int nSmps, int32_t *inBuf, MYFLT *outBuf)
-{
-    int n;
-    MYFLT adjust = FL(1.0) / (MYFLT) 0x80000000UL;
-    for (n=0; n<nSmps; n++)
-      outBuf[n] = (MYFLT) inBuf[n] * adjust;
-}
-
-static void float_to_MYFLT(int nSmps, float *inBuf, MYFLT *outBuf)
-{
-    int n;
-    for (n=0; n<nSmps; n++)
-      outBuf[n] = (MYFLT) inBuf[n];
-}
-
 /* select sample format */
 
-static snd_pcm_format_t set_format(void (**convFunc)(void), int csound_format,
-                                   int play, int csound_dither)
+static snd_pcm_format_t set_format(int csound_format)
 {
     int16   endian_test = 0x1234;
 
-    (*convFunc) = NULL;
-    /* select conversion routine */
-    switch (csound_format) {
-    case AE_SHORT:
-      if (play) {
-        if (csound_dither==1)
-          *convFunc = (void (*)(void)) MYFLT_to_short;
-        else if (csound_dither==2)
-          *convFunc = (void (*)(void)) MYFLT_to_short_u;
-        else
-          *convFunc = (void (*)(void)) MYFLT_to_short_no_dither;
-      }
-      else
-        *convFunc = (void (*)(void)) short_to_MYFLT;
-      break;
-    case AE_LONG:
-      if (play)
-        *convFunc = (void (*)(void)) MYFLT_to_long;
-      else
-        *convFunc = (void (*)(void)) long_to_MYFLT;
-      break;
-    case AE_FLOAT:
-      if (play)
-        *convFunc = (void (*)(void)) MYFLT_to_float;
-      else
-        *convFunc = (void (*)(void)) float_to_MYFLT;
-      break;
-    }
     if (*((unsigned char*) (&endian_test)) == (unsigned char) 0x34) {
       /* little-endian */
       switch (csound_format) {
@@ -397,12 +249,9 @@ static int set_device_params(CSOUND *csound, DEVPARAMS *dev, int play)
     /* sample format, */
     alsaFmt = SND_PCM_FORMAT_UNKNOWN;
     dev->sampleSize = (int) sizeof(MYFLT) * dev->nchns;
-    {
-      void  (*fp)(void) = NULL;
-      alsaFmt = set_format(&fp, dev->format, play, csound->GetDitherMode(csound));
-      if (play) dev->playconv = (void (*)(int, MYFLT*, void*, int*)) fp;
-      else      dev->rec_conv = (void (*)(int, void*, MYFLT*)) fp;
-    }
+    alsaFmt = set_format(dev->format);
+    if (play)
+      dev->dither = csound->GetDitherMode(csound);
     if (alsaFmt == SND_PCM_FORMAT_UNKNOWN) {
       strncpy(msg, Str("Unknown sample format.\n *** Only 16-bit and 32-bit "
                        "integers, and 32-bit floats are supported."), MSGLEN);
@@ -637,9 +486,7 @@ static int open_device(CSOUND *csound, const csRtAudioParams *parm, int play)
     dev->nchns = parm->nChannels;
     dev->buffer_smps = parm->bufSamp_HW;
     dev->period_smps = parm->bufSamp_SW;
-    dev->playconv = (void (*)(int, MYFLT*, void*, int*)) NULL;
-    dev->rec_conv = (void (*)(int, void*, MYFLT*)) NULL;
-    dev->seed = 1;
+    dev->dither = 0;
     /* open device */
     retval = set_device_params(csound, dev, play);
     if (retval != 0) {
@@ -713,7 +560,8 @@ static int rtrecord_(CSOUND *csound, MYFLT *inbuf, int nbytes)
       break;
     }
     /* convert samples to MYFLT */
-    dev->rec_conv(m * dev->nchns, dev->buf, inbuf);
+    csound->SampleToMYFLT(csound, inbuf, dev->buf, dev->format,
+                          m * dev->nchns);
     return (m * dev->sampleSize);
 }
 
@@ -731,7 +579,8 @@ static void rtplay_(CSOUND *csound, const MYFLT *outbuf, int nbytes)
     n = nbytes / dev->sampleSize;
 
     /* convert samples from MYFLT */
-    dev->playconv(n * dev->nchns, (MYFLT*) outbuf, dev->buf, &(dev->seed));
+    csound->SampleFromMYFLT(csound, dev->buf, dev->format, outbuf,
+                            n * dev->nchns, dev->dither, dev->dither_state);
 
     while (n) {
       err = (int) snd_pcm_writei(dev->handle, dev->buf, (snd_pcm_uframes_t) n);
@@ -1415,6 +1264,25 @@ static int alsaseq_in_open(CSOUND *csound, void **userData, const char *devName)
     port_id = err;
     csound->Message(csound, Str("ALSASEQ: created input port '%s' %d:%d\n"),
                     client_name, client_id, port_id);
+    /* have incoming events stamped with the real time of a queue, */
+    /* so that notes can be started at the right sample */
+    amidi->queue = snd_seq_alloc_queue(amidi->seq);
+    if (amidi->queue >= 0) {
+      snd_seq_port_info_t *pinfo;
+      snd_seq_port_info_alloca(&pinfo);
+      if (snd_seq_get_port_info(amidi->seq, port_id, pinfo) < 0) {
+        snd_seq_free_queue(amidi->seq, amidi->queue);
+        amidi->queue = -1;
+      }
+      else {
+        snd_seq_port_info_set_timestamping(pinfo, 1);
+        snd_seq_port_info_set_timestamp_real(pinfo, 1);
+        snd_seq_port_info_set_timestamp_queue(pinfo, amidi->queue);
+        snd_seq_set_port_info(amidi->seq, port_id, pinfo);
+        snd_seq_start_queue(amidi->seq, amidi->queue, NULL);
+        snd_seq_drain_output(amidi->seq);
+      }
+    }
     err = snd_midi_event_new(ALSASEQ_SYSEX_BUFFER_SIZE, &amidi->mev);
     if (UNLIKELY(err < 0)) {
       csound->ErrorMsg(csound, Str("ALSASEQ: cannot create midi event (%s)"),
@@ -1435,13 +1303,27 @@ static int alsaseq_in_read(CSOUND *csound,
     int               err;
     alsaseqMidi       *amidi = (alsaseqMidi*) userData;
     snd_seq_event_t   *ev;
-    IGN(csound);
 
     err = snd_seq_event_input(amidi->seq, &ev);
     if (err <= 0)
       return 0;
     else
       err = snd_midi_event_decode(amidi->mev, buf, nbytes, ev);
+    if (err > 0 && amidi->queue >= 0 &&
+        (ev->flags & SND_SEQ_TIME_STAMP_MASK) == SND_SEQ_TIME_STAMP_REAL) {
+      snd_seq_queue_status_t    *qs;
+      const snd_seq_real_time_t *now;
+      snd_seq_queue_status_alloca(&qs);
+      if (snd_seq_get_queue_status(amidi->seq, amidi->queue, qs) >= 0) {
+        double age;
+        now = snd_seq_queue_status_get_real_time(qs);
+        age = (double) ((int32_t) now->tv_sec - (int32_t) ev->time.time.tv_sec)
+              + ((double) now->tv_nsec - (double) ev->time.time.tv_nsec)
+              * 1.0e-9;
+        csound->MidiInTimestamp(csound, 0, err,
+                                (int32) (age * csound->GetSr(csound) + 0.5));
+      }
+    }
     return err;
 }
 
@@ -74,6 +74,8 @@ typedef struct csdata_ {
   int devout;
   void *incb;
   void *outcb;
+  float **inbufs;               /* the channel buffers, for the */
+  float **outbufs;              /* (de)interleaving kernels */
 } csdata;
 
 
@@ -310,6 +312,8 @@ int AuHAL_open(CSOUND *csound, const csRtAudioParams * parm,
     if(!isInput){
       nchnls =cdata->onchnls = parm->nChannels;
       bufframes = csound->GetOutputBufferSize(csound)/nchnls;
+      cdata->outbufs =
+        (float **) csound->Calloc(csound, nchnls * sizeof(float *));
     }
     else {
       nchnls = cdata->inchnls = parm->nChannels;
@@ -426,6 +430,10 @@ int AuHAL_open(CSOUND *csound, const csRtAudioParams * parm,
           csound->Calloc(csound,bufframes* sizeof(Float32));
       }
       cdata->inputdata = CAInputData;
+      cdata->inbufs =
+        (float **) csound->Calloc(csound, cdata->inchnls * sizeof(float *));
+      for (i = 0; i < cdata->inchnls; i++)
+        cdata->inbufs[i] = (float *) CAInputData->mBuffers[i].mData;
 
       input.inputProc = Csound_Input;
       input.inputProcRefCon = cdata;
@@ -632,20 +640,15 @@ OSStatus  Csound_Input(void *inRefCon,
     CSOUND *csound = cdata->csound;
     int inchnls = cdata->inchnls;
     MYFLT *inputBuffer = cdata->inputBuffer;
-    int j,k;
-    Float32 *buffer;
     int n = inNumberFrames*inchnls;
     int l;
     IGN(ioData);
 
     AudioUnitRender(cdata->inunit, ioActionFlags, inTimeStamp, inBusNumber,
                     inNumberFrames, cdata->inputdata);
-    for (k = 0; k < inchnls; k++){
-      buffer = (Float32 *) cdata->inputdata->mBuffers[k].mData;
-      for(j=0; (unsigned int) j < inNumberFrames; j++){
-        inputBuffer[j*inchnls+k] = buffer[j];
-      }
-    }
+    csound->InterleaveFloat(csound, inputBuffer,
+                            (float *const *) cdata->inbufs, 0, inchnls,
+                            (int) inNumberFrames);
     l = csound->WriteCircularBuffer(csound, cdata->incb,inputBuffer,n);
     return 0;
 }
@@ -678,21 +681,18 @@ OSStatus  Csound_Render(void *inRefCon,
     CSOUND *csound = cdata->csound;
     int onchnls = cdata->onchnls;
     MYFLT *outputBuffer = cdata->outputBuffer;
-    int j,k;
-    Float32 *buffer;
+    int k;
     int n = inNumberFrames*onchnls;
     IGN(ioActionFlags);
     IGN(inTimeStamp);
     IGN(inBusNumber);
 
     n = csound->ReadCircularBuffer(csound,cdata->outcb,outputBuffer,n);
-    for (k = 0; k < onchnls; k++) {
-      buffer = (Float32 *) ioData->mBuffers[k].mData;
-      for(j=0; (unsigned int) j < inNumberFrames; j++){
-        buffer[j] = (Float32) outputBuffer[j*onchnls+k] ;
-        outputBuffer[j*onchnls+k] = FL(0.0);
-      }
-    }
+    for (k = 0; k < onchnls; k++)
+      cdata->outbufs[k] = (float *) ioData->mBuffers[k].mData;
+    csound->DeinterleaveFloat(csound, (float *const *) cdata->outbufs, 0,
+                              outputBuffer, onchnls, (int) inNumberFrames);
+    memset(outputBuffer, 0, inNumberFrames*onchnls*sizeof(MYFLT));
     return 0;
 }
 
@@ -745,6 +745,14 @@ static void rtclose_(CSOUND *csound)
         csound->Free(csound,cdata->inputBuffer);
         cdata->inputBuffer = NULL;
       }
+      if (cdata->inbufs != NULL) {
+        csound->Free(csound,cdata->inbufs);
+        cdata->inbufs = NULL;
+      }
+      if (cdata->outbufs != NULL) {
+        csound->Free(csound,cdata->outbufs);
+        cdata->outbufs = NULL;
+      }
 
       *(csound->GetRtRecordUserData(csound)) = NULL;
       *(csound->GetRtPlayUserData(csound)) = NULL;
@@ -198,6 +198,8 @@ static void shutDownCallback(void *arg)
   RtJackGlobals *p = (RtJackGlobals*) arg;
 
   p->jackState = 2;
+  if (p->directMode)
+    p->csound->SetDriverPaced(p->csound, 0);
   if (p->bufs != NULL) {
     int   i;
     for (i = 0; i < p->nBuffers; i++) {
@@ -360,19 +362,39 @@ static void openJackStreams(RtJackGlobals *p)
   }
   if (UNLIKELY(p->bufSize < 8 || p->bufSize > 32768))
     rtJack_Error(csound, -1, Str("invalid period size (-b)"));
-  if (p->nBuffers < 2)
-    p->nBuffers = 2;
-  if (UNLIKELY((unsigned int) (p->nBuffers * p->bufSize) > (unsigned int) 65536))
-    rtJack_Error(csound, -1, Str("invalid buffer size (-B)"));
-  if (UNLIKELY(((p->nBuffers - 1) * p->bufSize)
-               < (int) jack_get_buffer_size(p->client)))
-    rtJack_Error(csound, -1, Str("buffer size (-B) is too small"));
+  if (p->directMode && !p->outputEnabled) {
+    csound->Warning(csound, Str("rtjack: jack_direct requires audio output, "
+                                "ignored"));
+    p->directMode = 0;
+  }
+  if (p->directMode) {
+    /* the callback runs whole periods of k-cycles, which must fill */
+    /* whole -b buffers; no ring buffers are used */
+    int period = (int) jack_get_buffer_size(p->client);
+    if (UNLIKELY(period % csound->GetKsmps(csound) != 0 ||
+                 period % p->bufSize != 0)) {
+      snprintf(&(buf[0]), 256, Str("jack_direct: JACK period size %d is not "
+                                   "a multiple of ksmps and -b"), period);
+      rtJack_Error(p->csound, -1, &(buf[0]));
+    }
+    p->nBuffers = 0;
+  }
+  else {
+    if (p->nBuffers < 2)
+      p->nBuffers = 2;
+    if (UNLIKELY((unsigned int) (p->nBuffers * p->bufSize)
+                 > (unsigned int) 65536))
+      rtJack_Error(csound, -1, Str("invalid buffer size (-B)"));
+    if (UNLIKELY(((p->nBuffers - 1) * p->bufSize)
+                 < (int) jack_get_buffer_size(p->client)))
+      rtJack_Error(csound, -1, Str("buffer size (-B) is too small"));
+  }
 
   /* register ports */
   rtJack_RegisterPorts(p);
 
   /* allocate ring buffers if not done yet */
-  if (p->bufs == NULL)
+  if (p->bufs == NULL && !p->directMode)
     rtJack_AllocateBuffers(p);
 
   /* initialise ring buffers */
@@ -420,6 +442,11 @@ static void openJackStreams(RtJackGlobals *p)
   if (UNLIKELY(jack_set_process_callback(p->client,
                                          processCallback, (void*) p) != 0))
     rtJack_Error(csound, -1, Str("error setting process callback"));
+  if (p->directMode) {
+    csound->Message(csound, Str("rtjack: performing in the JACK "
+                                "process callback\n"));
+    csound->SetDriverPaced(csound, 1);
+  }
 
   /* activate client */
   if (UNLIKELY(jack_activate(p->client) != 0))
@@ -648,6 +675,38 @@ static int playopen_(CSOUND *csound, const csRtAudioParams *parm)
   return 0;
 }
 
+/* in direct mode, the process callback runs the k-cycles for the */
+/* period itself, and rtrecord_() and rtplay_() access the port buffers */
+
+static int processCallbackDirect(RtJackGlobals *p, jack_nframes_t nframes)
+{
+  CSOUND  *csound = p->csound;
+  int     i, ksmps = csound->GetKsmps(csound);
+
+  for (i = 0; i < p->nChannels; i++) {
+    if (p->inputEnabled)
+      p->inPortBufs[i] = (jack_default_audio_sample_t*)
+        jack_port_get_buffer(p->inPorts[i], nframes);
+    p->outPortBufs[i] = (jack_default_audio_sample_t*)
+      jack_port_get_buffer(p->outPorts[i], nframes);
+  }
+  p->directFrames = (int) nframes;
+  p->directInPos = 0;
+  p->directOutPos = 0;
+  if (LIKELY((int) nframes % ksmps == 0 && (int) nframes % p->bufSize == 0))
+    csound->DriverPerform(csound, (int) nframes / ksmps);
+  else
+    p->xrunFlag = 1;
+  /* silence whatever the performance did not fill */
+  if (p->directOutPos < (int) nframes) {
+    for (i = 0; i < p->nChannels; i++)
+      memset(&(p->outPortBufs[i][p->directOutPos]), 0,
+             sizeof(jack_default_audio_sample_t)
+             * (size_t) ((int) nframes - p->directOutPos));
+  }
+  return 0;
+}
+
 /* the process callback is called by the JACK client thread, */
 /* and copies data to the input and from the output ring buffers */
 
@@ -657,6 +716,8 @@ static int processCallback(jack_nframes_t nframes, void *arg)
   int           i, j, k, l;
 
   p = (RtJackGlobals*) arg;
+  if (p->directMode)
+    return processCallbackDirect(p, nframes);
   /* get pointers to port buffers */
   if (p->inputEnabled) {
     for (i = 0; i < p->nChannels; i++)
@@ -745,10 +806,22 @@ static CS_NOINLINE void rtJack_Restart(RtJackGlobals *p)
 static int rtrecord_(CSOUND *csound, MYFLT *inbuf_, int bytes_)
 {
   RtJackGlobals *p;
-  int           i, j, k, nframes, bufpos, bufcnt;
+  int           i, n, nframes, bufpos, bufcnt;
 
   p = (RtJackGlobals*) *(csound->GetRtPlayUserData(csound));
   if (UNLIKELY(p==NULL)) rtJack_Abort(csound, 0);
+  if (p->directMode && p->jackState == 0) {
+    /* called from processCallbackDirect() */
+    nframes = bytes_ / (p->nChannels * (int) sizeof(MYFLT));
+    if (UNLIKELY(p->directInPos + nframes > p->directFrames)) {
+      memset(inbuf_, 0, bytes_);
+      return bytes_;
+    }
+    csound->InterleaveFloat(csound, inbuf_, (float *const *) p->inPortBufs,
+                            p->directInPos, p->nChannels, nframes);
+    p->directInPos += nframes;
+    return bytes_;
+  }
   if (p->jackState != 0) {
     if (p->jackState < 0)
       openJackStreams(p);     /* open audio input */
@@ -760,7 +833,7 @@ static int rtrecord_(CSOUND *csound, MYFLT *inbuf_, int bytes_)
   nframes = bytes_ / (p->nChannels * (int) sizeof(MYFLT));
   bufpos = p->csndBufPos;
   bufcnt = p->csndBufCnt;
-  for (i = j = 0; i < nframes; i++) {
+  for (i = 0; i < nframes; i += n) {
     if (bufpos == 0) {
       /* wait until there is enough data in ring buffer */
       /* VL 28.03.15 -- timeout after wait for 10 buffer
@@ -776,10 +849,14 @@ static int rtrecord_(CSOUND *csound, MYFLT *inbuf_, int bytes_)
         return bytes_;
       }
     }
-    /* copy audio data */
-    for (k = 0; k < p->nChannels; k++)
-      inbuf_[j++] = (MYFLT) p->bufs[bufcnt]->inBufs[k][i];
-    if (++bufpos >= p->bufSize) {
+    /* copy audio data, up to the end of the current buffer */
+    n = p->bufSize - bufpos;
+    if (n > nframes - i)
+      n = nframes - i;
+    csound->InterleaveFloat(csound, &(inbuf_[i * p->nChannels]),
+                            (float *const *) p->bufs[bufcnt]->inBufs,
+                            bufpos, p->nChannels, n);
+    if ((bufpos += n) >= p->bufSize) {
       bufpos = 0;
       /* notify JACK callback that this buffer has been consumed */
       if (!p->outputEnabled)
@@ -809,11 +886,21 @@ static int rtrecord_(CSOUND *csound, MYFLT *inbuf_, int bytes_)
 static void rtplay_(CSOUND *csound, const MYFLT *outbuf_, int bytes_)
 {
   RtJackGlobals *p;
-  int           i, j, k, nframes;
+  int           i, n, nframes;
 
   p = (RtJackGlobals*) *(csound->GetRtPlayUserData(csound));
   if (p == NULL)
     return;
+  if (p->directMode) {
+    /* called from processCallbackDirect() */
+    nframes = bytes_ / (p->nChannels * (int) sizeof(MYFLT));
+    if (UNLIKELY(p->directOutPos + nframes > p->directFrames))
+      return;
+    csound->DeinterleaveFloat(csound, (float *const *) p->outPortBufs,
+                              p->directOutPos, outbuf_, p->nChannels, nframes);
+    p->directOutPos += nframes;
+    return;
+  }
   if (p->jackState != 0) {
     if (p->jackState == 2)
       rtJack_Restart(p);
@@ -822,18 +909,22 @@ static void rtplay_(CSOUND *csound, const MYFLT *outbuf_, int bytes_)
     return;
   }
   nframes = bytes_ / (p->nChannels * (int) sizeof(MYFLT));
-  for (i = j = 0; i < nframes; i++) {
+  for (i = 0; i < nframes; i += n) {
     if (p->csndBufPos == 0) {
       /* wait until there is enough free space in ring buffer */
       if (!p->inputEnabled)
         /* **** COVERITY: claims this is a double lock **** */
         rtJack_Lock(csound, &(p->bufs[p->csndBufCnt]->csndLock));
     }
-    /* copy audio data */
-    for (k = 0; k < p->nChannels; k++)
-      p->bufs[p->csndBufCnt]->outBufs[k][i] =
-        (jack_default_audio_sample_t) outbuf_[j++];
-    if (++(p->csndBufPos) >= p->bufSize) {
+    /* copy audio data, up to the end of the current buffer */
+    n = p->bufSize - p->csndBufPos;
+    if (n > nframes - i)
+      n = nframes - i;
+    csound->DeinterleaveFloat(csound,
+                              (float *const *) p->bufs[p->csndBufCnt]->outBufs,
+                              p->csndBufPos, &(outbuf_[i * p->nChannels]),
+                              p->nChannels, n);
+    if ((p->csndBufPos += n) >= p->bufSize) {
       p->csndBufPos = 0;
       /* notify JACK callback that this buffer is now filled */
       rtJack_Unlock(csound, &(p->bufs[p->csndBufCnt]->jackLock));
@@ -885,6 +976,8 @@ static CS_NOINLINE void rtclose_(CSOUND *csound)
   *(csound->GetRtRecordUserData(csound))  = NULL;
   memcpy(&p, pp, sizeof(RtJackGlobals));
   /* free globals */
+  if (p.directMode)
+    csound->SetDriverPaced(csound, 0);
 
   if (p.client != (jack_client_t*) NULL) {
     /* deactivate client */
@@ -1064,6 +1157,14 @@ PUBLIC int csoundModuleCreate(CSOUND *csound)
                                       (void*) &(p->sleepTime),
                                       CSOUNDCFG_INTEGER, 0, &i, &j,
                                       Str("Deprecated"), NULL);
+  /* run the performance in the JACK process callback */
+  csound->CreateConfigurationVariable(csound, "jack_direct",
+                                      (void*) &(p->directMode),
+                                      CSOUNDCFG_BOOLEAN, 0, NULL, NULL,
+                                      Str("Run the performance in the JACK "
+                                          "process callback, for one period "
+                                          "of latency (hosts must use "
+                                          "csoundPerform())"), NULL);
   /* done */
   p->listclient = NULL;
 
@@ -1116,11 +1217,19 @@ PUBLIC int csoundModuleCreate(CSOUND *csound)
 }
 
 #define JACK_MIDI_BUFFSIZE 1024
+
+/* MIDI input bytes are queued with the JACK frame time of their event */
+typedef struct jackMidiByte_ {
+  jack_nframes_t time;
+  unsigned char  data;
+} jackMidiByte;
+
 typedef struct jackMidiDevice_ {
   jack_client_t *client;
   jack_port_t *port;
   CSOUND *csound;
   void *cb;
+  jackMidiByte rbuf[JACK_MIDI_BUFFSIZE];
 } jackMidiDevice;
 
 int MidiInProcessCallback(jack_nframes_t nframes, void *userData){
@@ -1128,12 +1237,21 @@ int MidiInProcessCallback(jack_nframes_t nframes, void *userData){
   jack_midi_event_t event;
   jackMidiDevice *dev = (jackMidiDevice *) userData;
   CSOUND *csound = dev->csound;
+  jackMidiByte mb[JACK_MIDI_BUFFSIZE];
+  jack_nframes_t t0 = jack_last_frame_time(dev->client);
   int n = 0;
+  size_t i;
   while(jack_midi_event_get(&event,
                             jack_port_get_buffer(dev->port,nframes),
                             n++) == 0) {
+    if (event.size > JACK_MIDI_BUFFSIZE)
+      continue;
+    for (i = 0; i < event.size; i++) {
+      mb[i].time = t0 + event.time;
+      mb[i].data = event.buffer[i];
+    }
     if(csound->WriteCircularBuffer(csound,dev->cb,
-                                   event.buffer,event.size)
+                                   mb,(int) event.size)
        != (int) event.size){
       csound->Warning(csound, Str("Jack MIDI module: buffer overflow"));
       return 1;
@@ -1183,7 +1301,7 @@ static int midi_in_open(CSOUND *csound,
   dev->csound = csound;
   dev->cb = csound->CreateCircularBuffer(csound,
                                          JACK_MIDI_BUFFSIZE,
-                                         sizeof(char));
+                                         sizeof(jackMidiByte));
 
   if(jack_set_process_callback(jack_client,
                                MidiInProcessCallback,
@@ -1217,11 +1335,33 @@ static int midi_in_open(CSOUND *csound,
   return OK;
 }
 
+/* returns the queued bytes, and passes their age in sample frames */
+/* to Csound so that notes start at the right sample */
+
 static int midi_in_read(CSOUND *csound,
                         void *userData, unsigned char *buf, int nbytes)
 {
   jackMidiDevice *dev = (jackMidiDevice *) userData;
-  return csound->ReadCircularBuffer(csound,dev->cb,buf,nbytes);
+  jack_nframes_t now;
+  double         scl;
+  int            i, j, n;
+
+  if (nbytes > JACK_MIDI_BUFFSIZE)
+    nbytes = JACK_MIDI_BUFFSIZE;
+  n = csound->ReadCircularBuffer(csound,dev->cb,dev->rbuf,nbytes);
+  if (n <= 0)
+    return n;
+  now = jack_frame_time(dev->client);
+  scl = (double) csound->GetSr(csound)
+        / (double) jack_get_sample_rate(dev->client);
+  for (i = 0; i < n; i = j) {
+    jack_nframes_t t = dev->rbuf[i].time;
+    for (j = i; j < n && dev->rbuf[j].time == t; j++)
+      buf[j] = dev->rbuf[j].data;
+    csound->MidiInTimestamp(csound, i, j - i,
+                            (int32) ((double) (int32) (now - t) * scl));
+  }
+  return n;
 }
 
 static int midi_in_close(CSOUND *csound, void *userData){
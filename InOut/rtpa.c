@@ -484,9 +484,21 @@ static int rtrecord_(CSOUND *csound, MYFLT *buffer, int nbytes)
     }
 
     do {
-      buffer[i] = (MYFLT) pabs->inputBuffer[pabs->currentInputIndex++];
-      if (pabs->inParm.nChannels == 1)
-        pabs->currentInputIndex++;
+      if (pabs->inParm.nChannels == 1) {
+        buffer[i++] = (MYFLT) pabs->inputBuffer[pabs->currentInputIndex];
+        pabs->currentInputIndex += 2;
+      }
+      else {
+        /* copy up to the end of the stream buffer */
+        int n = pabs->inBufSamples - pabs->currentInputIndex;
+        if (n > samples - i)
+          n = samples - i;
+        csound->SampleToMYFLT(csound, &(buffer[i]),
+                              &(pabs->inputBuffer[pabs->currentInputIndex]),
+                              AE_FLOAT, n);
+        i += n;
+        pabs->currentInputIndex += n;
+      }
       if (pabs->currentInputIndex >= pabs->inBufSamples) {
         if (pabs->mode == 1) {
 #if NO_FULLDUPLEX_PA_LOCK
@@ -497,7 +509,7 @@ static int rtrecord_(CSOUND *csound, MYFLT *buffer, int nbytes)
         }
         pabs->currentInputIndex = 0;
       }
-    } while (++i < samples);
+    } while (i < samples);
 
     return nbytes;
 }
@@ -517,9 +529,21 @@ static void rtplay_(CSOUND *csound, const MYFLT *buffer, int nbytes)
 #endif
 
     do {
-      pabs->outputBuffer[pabs->currentOutputIndex++] = (float) buffer[i];
-      if (pabs->outParm.nChannels == 1)
+      if (pabs->outParm.nChannels == 1) {
         pabs->outputBuffer[pabs->currentOutputIndex++] = (float) buffer[i];
+        pabs->outputBuffer[pabs->currentOutputIndex++] = (float) buffer[i++];
+      }
+      else {
+        /* copy up to the end of the stream buffer */
+        int n = pabs->outBufSamples - pabs->currentOutputIndex;
+        if (n > samples - i)
+          n = samples - i;
+        csound->SampleFromMYFLT(csound,
+                                &(pabs->outputBuffer[pabs->currentOutputIndex]),
+                                AE_FLOAT, &(buffer[i]), n, 0, NULL);
+        i += n;
+        pabs->currentOutputIndex += n;
+      }
       if (pabs->currentOutputIndex >= pabs->outBufSamples) {
 #if NO_FULLDUPLEX_PA_LOCK
         if (!pabs->noPaLock)
@@ -528,7 +552,7 @@ static void rtplay_(CSOUND *csound, const MYFLT *buffer, int nbytes)
         csound->WaitThreadLock(pabs->clientLock, (size_t) 500);
         pabs->currentOutputIndex = 0;
       }
-    } while (++i < samples);
+    } while (i < samples);
 }
 
 /* open for audio input */
@@ -761,7 +785,7 @@ static int playopen_blocking(CSOUND *csound, const csRtAudioParams *parm)
 static int rtrecord_blocking(CSOUND *csound, MYFLT *inbuf, int nbytes)
 {
     DEVPARAMS *dev;
-    int       i, n, err;
+    int       n, err;
 
     dev = (DEVPARAMS*) (*(csound->GetRtRecordUserData(csound)));
     /* calculate the number of samples to record */
@@ -770,8 +794,7 @@ static int rtrecord_blocking(CSOUND *csound, MYFLT *inbuf, int nbytes)
     if (err != (int) paNoError && (csound->GetMessageLevel(csound) & 4))
       csound->Warning(csound, Str("Buffer overrun in real-time audio input"));
     /* convert samples to MYFLT */
-    for (i = 0; i < (n * dev->nchns); i++)
-      inbuf[i] = (MYFLT) dev->buf[i];
+    csound->SampleToMYFLT(csound, inbuf, dev->buf, AE_FLOAT, n * dev->nchns);
 
     return nbytes;
 }
@@ -781,14 +804,14 @@ static int rtrecord_blocking(CSOUND *csound, MYFLT *inbuf, int nbytes)
 static void rtplay_blocking(CSOUND *csound, const MYFLT *outbuf, int nbytes)
 {
     DEVPARAMS *dev;
-    int       i, n, err;
+    int       n, err;
 
     dev = (DEVPARAMS*) (*(csound->GetRtPlayUserData(csound)));
     /* calculate the number of samples to play */
     n = nbytes / (dev->nchns * (int) sizeof(MYFLT));
     /* convert samples from MYFLT */
-    for (i = 0; i < (n * dev->nchns); i++)
-      dev->buf[i] = (float) outbuf[i];
+    csound->SampleFromMYFLT(csound, dev->buf, AE_FLOAT, outbuf,
+                            n * dev->nchns, 0, NULL);
     err = (int) Pa_WriteStream(dev->handle, dev->buf, (unsigned long) n);
     if (err != (int) paNoError && (csound->GetMessageLevel(csound) & 4))
       csound->Warning(csound, Str("Buffer underrun in real-time audio output"));
@@ -22,6 +22,7 @@
 */
 
 #include <csdl.h>
+#include "soundio.h"
 #include <pulse/simple.h>
 #include <pulse/error.h>
 #include <string.h>
@@ -151,13 +152,13 @@ static int pulse_playopen(CSOUND *csound, const csRtAudioParams *parm)
 
 static void pulse_play(CSOUND *csound, const MYFLT *outbuf, int nbytes){
 
-  int i, bufsiz, pulserror;
+  int bufsiz, pulserror;
   float *buf;
   pulse_params *pulse = (pulse_params*) *(csound->GetRtPlayUserData(csound));
   //MYFLT norm = csound->e0dbfs;
   bufsiz = nbytes/sizeof(MYFLT);
   buf = pulse->buf;
-  for (i=0;i<bufsiz;i++) buf[i] = outbuf[i];
+  csound->SampleFromMYFLT(csound, buf, AE_FLOAT, outbuf, bufsiz, 0, NULL);
   if (UNLIKELY(pa_simple_write(pulse->ps, buf,
                                bufsiz*sizeof(float), &pulserror) < 0))
     csound->ErrorMsg(csound,Str("Pulse audio module error: %s\n"),
@@ -244,7 +245,7 @@ static int pulse_recopen(CSOUND *csound, const csRtAudioParams *parm)
 
 static int pulse_record(CSOUND *csound, MYFLT *inbuf, int nbytes)
 {
-    int i, bufsiz,pulserror;
+    int bufsiz,pulserror;
     float *buf;
     pulse_params *pulse = (pulse_params*) *(csound->GetRtRecordUserData(csound)) ;
     //MYFLT norm = csound->e0dbfs;
@@ -258,7 +259,7 @@ static int pulse_record(CSOUND *csound, MYFLT *inbuf, int nbytes)
       return -1;
     }
     else {
-      for (i=0;i<bufsiz;i++) inbuf[i] = buf[i];
+      csound->SampleToMYFLT(csound, inbuf, buf, AE_FLOAT, bufsiz);
       return nbytes;
     }
 
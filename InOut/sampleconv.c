@@ -0,0 +1,194 @@
+/*
+    sampleconv.c:
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+
+#include "csoundCore.h"     /*                              SAMPLECONV.C    */
+#include "soundio.h"
+
+/* Sample format conversion for the audio drivers and the sound file
+   writer: MYFLT to and from 16 and 32 bit integer and float samples,
+   with optional dither, and interleaving to and from the per-channel
+   float buffers of callback based drivers.
+
+   The kernels in sampleconv_kernels.h are compiled once for the
+   baseline instruction set of the build (SSE2 on x86-64, NEON on
+   aarch64) and, where the compiler supports it, once more for AVX2;
+   the AVX2 set is selected at run time on CPUs that have it.
+
+   Dither is TPDF (dither mode 1) or rectangular (dither mode 2) noise
+   of +/- half an LSB peak, as in the per-sample generators these
+   replace, but generated by CS_DITHER_LANES independent xorshift
+   generators so that it vectorises.  The caller owns the generator
+   state; an all zero state is seeded on first use.  */
+
+typedef struct {
+    void (*to_short)(int16_t *, const MYFLT *, int, int, uint32_t *);
+    void (*to_long)(int32_t *, const MYFLT *, int);
+    void (*to_float)(float *, const MYFLT *, int);
+    void (*from_short)(MYFLT *, const int16_t *, int);
+    void (*from_long)(MYFLT *, const int32_t *, int);
+    void (*from_float)(MYFLT *, const float *, int);
+    void (*deinterleave)(float *const *, int, const MYFLT *, int, int);
+    void (*interleave)(MYFLT *, float *const *, int, int, int);
+    void (*add_dither)(MYFLT *, int, MYFLT, int, uint32_t *);
+} SAMPLECONV_KERNELS;
+
+#define KERNEL      static
+#define KNAME(x)    conv_##x##_generic
+#include "sampleconv_kernels.h"
+#undef KNAME
+#undef KERNEL
+
+static const SAMPLECONV_KERNELS kernels_generic = {
+    conv_to_short_generic, conv_to_long_generic, conv_to_float_generic,
+    conv_from_short_generic, conv_from_long_generic, conv_from_float_generic,
+    conv_deinterleave_generic, conv_interleave_generic,
+    conv_add_dither_generic
+};
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#define HAVE_AVX2_KERNELS 1
+#define KERNEL      static __attribute__ ((target ("avx2")))
+#define KNAME(x)    conv_##x##_avx2
+#include "sampleconv_kernels.h"
+#undef KNAME
+#undef KERNEL
+
+static const SAMPLECONV_KERNELS kernels_avx2 = {
+    conv_to_short_avx2, conv_to_long_avx2, conv_to_float_avx2,
+    conv_from_short_avx2, conv_from_long_avx2, conv_from_float_avx2,
+    conv_deinterleave_avx2, conv_interleave_avx2,
+    conv_add_dither_avx2
+};
+#endif
+
+static const SAMPLECONV_KERNELS *volatile kernels = NULL;
+
+static const SAMPLECONV_KERNELS *get_kernels(void)
+{
+    const SAMPLECONV_KERNELS *k = kernels;
+    if (UNLIKELY(k == NULL)) {
+      k = &kernels_generic;
+#ifdef HAVE_AVX2_KERNELS
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2"))
+        k = &kernels_avx2;
+#endif
+      kernels = k;          /* every thread arrives at the same answer */
+    }
+    return k;
+}
+
+static void dither_seed(uint32_t *state)
+{
+    int j;
+    for (j = 0; j < CS_DITHER_LANES; j++)
+      if (state[j] != 0U)
+        return;
+    for (j = 0; j < CS_DITHER_LANES; j++)
+      state[j] = 0x9E3779B9U * (uint32_t) (j + 1);
+}
+
+/**
+ * Converts n MYFLT samples to the sample format 'format' (AE_SHORT,
+ * AE_LONG or AE_FLOAT), with full scale at 1.0.  If 'dither' is 1 or 2,
+ * triangular or rectangular dither is added to 16 bit output, using the
+ * generator state in 'state' (CS_DITHER_LANES words).
+ */
+void csoundSampleFromMYFLT(CSOUND *csound, void *out, int format,
+                           const MYFLT *in, int n, int dither, uint32_t *state)
+{
+    const SAMPLECONV_KERNELS *k = get_kernels();
+    (void) csound;
+    switch (format) {
+    case AE_SHORT:
+      if (dither && state != NULL)
+        dither_seed(state);
+      else
+        dither = 0;
+      k->to_short((int16_t *) out, in, n, dither, state);
+      break;
+    case AE_LONG:
+      k->to_long((int32_t *) out, in, n);
+      break;
+    case AE_FLOAT:
+      k->to_float((float *) out, in, n);
+      break;
+    }
+}
+
+/**
+ * Converts n samples of format 'format' (AE_SHORT, AE_LONG or AE_FLOAT)
+ * to MYFLT, with full scale at 1.0.
+ */
+void csoundSampleToMYFLT(CSOUND *csound, MYFLT *out, const void *in,
+                         int format, int n)
+{
+    const SAMPLECONV_KERNELS *k = get_kernels();
+    (void) csound;
+    switch (format) {
+    case AE_SHORT:
+      k->from_short(out, (const int16_t *) in, n);
+      break;
+    case AE_LONG:
+      k->from_long(out, (const int32_t *) in, n);
+      break;
+    case AE_FLOAT:
+      k->from_float(out, (const float *) in, n);
+      break;
+    }
+}
+
+/**
+ * Interleaves nframes frames of nchnls float channel buffers, starting
+ * at frame 'offs' of each, into the MYFLT buffer 'out'.
+ */
+void csoundInterleaveFloat(CSOUND *csound, MYFLT *out, float *const *in,
+                           int offs, int nchnls, int nframes)
+{
+    (void) csound;
+    get_kernels()->interleave(out, in, offs, nchnls, nframes);
+}
+
+/**
+ * Splits nframes interleaved frames of the MYFLT buffer 'in' into nchnls
+ * float channel buffers, starting at frame 'offs' of each.
+ */
+void csoundDeinterleaveFloat(CSOUND *csound, float *const *out, int offs,
+                             const MYFLT *in, int nchnls, int nframes)
+{
+    (void) csound;
+    get_kernels()->deinterleave(out, offs, in, nchnls, nframes);
+}
+
+/**
+ * Adds triangular (dither == 1) or rectangular (dither == 2) dither of
+ * +/- lsb/2 peak to n samples of 'buf', in place.
+ */
+void csoundAddDither(CSOUND *csound, MYFLT *buf, int n, MYFLT lsb,
+                     int dither, uint32_t *state)
+{
+    (void) csound;
+    if (!dither)
+      return;
+    dither_seed(state);
+    get_kernels()->add_dither(buf, n, lsb, dither, state);
+}
@@ -0,0 +1,168 @@
+/*
+    sampleconv_kernels.h:
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+
+/* Sample conversion kernels, included by sampleconv.c once for every
+   instruction set it dispatches to.  The includer defines KNAME(x) to
+   give the functions a per-target name and KERNEL to the storage class
+   and target attributes.  The loops are written so that the compiler
+   can vectorise them: no calls, no early exits, clipping and rounding
+   by selects, and dither generated in blocks of CS_DITHER_LANES
+   independent generators. */
+
+/* one block of dither noise, in units of one LSB: uniform in [-0.5, 0.5)
+   for dither == 2, else the average of two such values (triangular) */
+
+KERNEL void KNAME(dither_block)(MYFLT *noise, int dither, uint32_t *st)
+{
+    int j;
+    if (dither == 1) {
+      for (j = 0; j < CS_DITHER_LANES; j++) {
+        uint32_t x = st[j], u;
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        u = x >> 16;
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        u = (u + (x >> 16)) >> 1;
+        st[j] = x;
+        noise[j] = (MYFLT) ((int32_t) u - 0x8000) * (FL(1.0) / FL(65536.0));
+      }
+    }
+    else {
+      for (j = 0; j < CS_DITHER_LANES; j++) {
+        uint32_t x = st[j];
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        st[j] = x;
+        noise[j] = (MYFLT) ((int32_t) (x >> 16) - 0x8000)
+                   * (FL(1.0) / FL(65536.0));
+      }
+    }
+}
+
+KERNEL void KNAME(to_short)(int16_t *out, const MYFLT *in, int n,
+                            int dither, uint32_t *st)
+{
+    MYFLT noise[CS_DITHER_LANES];
+    int   i, j, m;
+    for (j = 0; j < CS_DITHER_LANES; j++)
+      noise[j] = FL(0.0);
+    for (i = 0; i < n; i += CS_DITHER_LANES) {
+      m = (n - i < CS_DITHER_LANES ? n - i : CS_DITHER_LANES);
+      if (dither)
+        KNAME(dither_block)(noise, dither, st);
+      for (j = 0; j < m; j++) {
+        MYFLT t = in[i + j] * FL(32768.0) + noise[j];
+        t = (t < FL(-32768.0) ? FL(-32768.0) : t);
+        t = (t > FL(32767.0) ? FL(32767.0) : t);
+        out[i + j] = (int16_t) (int32_t) (t + (t < FL(0.0) ? FL(-0.5) : FL(0.5)));
+      }
+    }
+}
+
+KERNEL void KNAME(to_long)(int32_t *out, const MYFLT *in, int n)
+{
+    int i;
+    for (i = 0; i < n; i++) {
+      double t = (double) in[i] * 2147483648.0;
+      t = (t < -2147483648.0 ? -2147483648.0 : t);
+      t = (t > 2147483647.0 ? 2147483647.0 : t);
+      out[i] = (int32_t) (t + (t < 0.0 ? -0.5 : 0.5));
+    }
+}
+
+KERNEL void KNAME(to_float)(float *out, const MYFLT *in, int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+      out[i] = (float) in[i];
+}
+
+KERNEL void KNAME(from_short)(MYFLT *out, const int16_t *in, int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+      out[i] = (MYFLT) in[i] * (FL(1.0) / FL(32768.0));
+}
+
+KERNEL void KNAME(from_long)(MYFLT *out, const int32_t *in, int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+      out[i] = (MYFLT) ((double) in[i] * (1.0 / 2147483648.0));
+}
+
+KERNEL void KNAME(from_float)(MYFLT *out, const float *in, int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+      out[i] = (MYFLT) in[i];
+}
+
+KERNEL void KNAME(deinterleave)(float *const *out, int offs, const MYFLT *in,
+                                int nchnls, int nframes)
+{
+    int i, c;
+    if (nchnls == 2) {
+      float *l = out[0] + offs, *r = out[1] + offs;
+      for (i = 0; i < nframes; i++) {
+        l[i] = (float) in[2 * i];
+        r[i] = (float) in[2 * i + 1];
+      }
+      return;
+    }
+    for (c = 0; c < nchnls; c++) {
+      float *o = out[c] + offs;
+      const MYFLT *p = in + c;
+      for (i = 0; i < nframes; i++)
+        o[i] = (float) p[i * nchnls];
+    }
+}
+
+KERNEL void KNAME(interleave)(MYFLT *out, float *const *in, int offs,
+                              int nchnls, int nframes)
+{
+    int i, c;
+    if (nchnls == 2) {
+      const float *l = in[0] + offs, *r = in[1] + offs;
+      for (i = 0; i < nframes; i++) {
+        out[2 * i] = (MYFLT) l[i];
+        out[2 * i + 1] = (MYFLT) r[i];
+      }
+      return;
+    }
+    for (c = 0; c < nchnls; c++) {
+      const float *p = in[c] + offs;
+      MYFLT *o = out + c;
+      for (i = 0; i < nframes; i++)
+        o[i * nchnls] = (MYFLT) p[i];
+    }
+}
+
+KERNEL void KNAME(add_dither)(MYFLT *buf, int n, MYFLT lsb,
+                              int dither, uint32_t *st)
+{
+    MYFLT noise[CS_DITHER_LANES];
+    int   i, j, m;
+    for (i = 0; i < n; i += CS_DITHER_LANES) {
+      m = (n - i < CS_DITHER_LANES ? n - i : CS_DITHER_LANES);
+      KNAME(dither_block)(noise, dither, st);
+      for (j = 0; j < m; j++)
+        buf[i + j] += noise[j] * lsb;
+    }
+}
@@ -264,9 +264,112 @@ int modkk(CSOUND *csound, AOP *p)
     return OK;
 }
 
-#define KA(OPNAME,OP)                           \
+/* The a-rate loops below call kernels from aops_kernels.h, compiled
+   once for the baseline instruction set of the build (SSE2 on x86-64,
+   NEON on aarch64) and, where the compiler supports them, for AVX2 and
+   AVX-512; the widest set the CPU has is selected on first use. */
+
+typedef struct {
+    void (*add_aa)(MYFLT *, const MYFLT *, const MYFLT *, int);
+    void (*sub_aa)(MYFLT *, const MYFLT *, const MYFLT *, int);
+    void (*mul_aa)(MYFLT *, const MYFLT *, const MYFLT *, int);
+    void (*div_aa)(MYFLT *, const MYFLT *, const MYFLT *, int);
+    void (*add_ak)(MYFLT *, const MYFLT *, MYFLT, int);
+    void (*sub_ak)(MYFLT *, const MYFLT *, MYFLT, int);
+    void (*mul_ak)(MYFLT *, const MYFLT *, MYFLT, int);
+    void (*div_ak)(MYFLT *, const MYFLT *, MYFLT, int);
+    void (*add_ka)(MYFLT *, MYFLT, const MYFLT *, int);
+    void (*sub_ka)(MYFLT *, MYFLT, const MYFLT *, int);
+    void (*mul_ka)(MYFLT *, MYFLT, const MYFLT *, int);
+    void (*div_ka)(MYFLT *, MYFLT, const MYFLT *, int);
+    void (*mod_aa)(MYFLT *, const MYFLT *, const MYFLT *, int);
+    void (*mod_ak)(MYFLT *, const MYFLT *, MYFLT, int);
+    void (*mod_ka)(MYFLT *, MYFLT, const MYFLT *, int);
+    void (*divz_aa)(MYFLT *, const MYFLT *, const MYFLT *, MYFLT, int);
+    void (*divz_ka)(MYFLT *, MYFLT, const MYFLT *, MYFLT, int);
+    void (*ampdb)(MYFLT *, const MYFLT *, MYFLT, int);
+    void (*cpsoct)(MYFLT *, const MYFLT *, const MYFLT *, int);
+    void (*int_trunc)(MYFLT *, const MYFLT *, int);
+    void (*frac)(MYFLT *, const MYFLT *, int);
+    void (*int_round)(MYFLT *, const MYFLT *, int);
+    void (*int_floor)(MYFLT *, const MYFLT *, int);
+    void (*int_ceil)(MYFLT *, const MYFLT *, int);
+} AOPS_KERNELS;
+
+#define AOPS_KERNEL_TABLE(S) {                                          \
+    aops_add_aa_##S, aops_sub_aa_##S, aops_mul_aa_##S, aops_div_aa_##S, \
+    aops_add_ak_##S, aops_sub_ak_##S, aops_mul_ak_##S, aops_div_ak_##S, \
+    aops_add_ka_##S, aops_sub_ka_##S, aops_mul_ka_##S, aops_div_ka_##S, \
+    aops_mod_aa_##S, aops_mod_ak_##S, aops_mod_ka_##S,                  \
+    aops_divz_aa_##S, aops_divz_ka_##S,                                 \
+    aops_ampdb_##S, aops_cpsoct_##S,                                    \
+    aops_int_trunc_##S, aops_frac_##S, aops_int_round_##S,              \
+    aops_int_floor_##S, aops_int_ceil_##S                               \
+}
+
+#define KERNEL      static
+#define KNAME(x)    aops_##x##_generic
+#include "aops_kernels.h"
+#undef KNAME
+#undef KERNEL
+
+static const AOPS_KERNELS kernels_generic = AOPS_KERNEL_TABLE(generic);
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#define HAVE_AVX2_KERNELS 1
+#define KERNEL      static __attribute__ ((target ("avx2")))
+#define KNAME(x)    aops_##x##_avx2
+#define AOPS_VECTOR_EXP 1
+#include "aops_kernels.h"
+#undef KNAME
+#undef AOPS_VECTOR_EXP
+#undef KERNEL
+
+static const AOPS_KERNELS kernels_avx2 = AOPS_KERNEL_TABLE(avx2);
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    !defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 8
+#define HAVE_AVX512_KERNELS 1
+#define KERNEL      static \
+                    __attribute__ ((target ("avx512f,prefer-vector-width=512")))
+#define KNAME(x)    aops_##x##_avx512
+#define AOPS_VECTOR_EXP 1
+#include "aops_kernels.h"
+#undef KNAME
+#undef AOPS_VECTOR_EXP
+#undef KERNEL
+
+static const AOPS_KERNELS kernels_avx512 = AOPS_KERNEL_TABLE(avx512);
+#endif
+
+static const AOPS_KERNELS *volatile kernels = NULL;
+
+static const AOPS_KERNELS *get_kernels(void)
+{
+    const AOPS_KERNELS *k = kernels;
+    if (UNLIKELY(k == NULL)) {
+      k = &kernels_generic;
+#if defined(HAVE_AVX2_KERNELS) || defined(HAVE_AVX512_KERNELS)
+      __builtin_cpu_init();
+#endif
+#ifdef HAVE_AVX2_KERNELS
+      if (__builtin_cpu_supports("avx2"))
+        k = &kernels_avx2;
+#endif
+#ifdef HAVE_AVX512_KERNELS
+      if (__builtin_cpu_supports("avx512f"))
+        k = &kernels_avx512;
+#endif
+      kernels = k;          /* every thread arrives at the same answer */
+    }
+    return k;
+}
+
+#define KA(OPNAME,OP,KERN)                      \
   int OPNAME(CSOUND *csound, AOP *p) {          \
-    uint32_t n, nsmps = CS_KSMPS;                    \
+    uint32_t nsmps = CS_KSMPS;                       \
     if (LIKELY(nsmps!=1)) {                     \
       MYFLT   *r, a, *b;                          \
       uint32_t offset = p->h.insdshead->ksmps_offset;  \
@@ -279,8 +382,7 @@ int modkk(CSOUND *csound, AOP *p)
         nsmps -= early;                                \
         memset(&r[nsmps], '\0', early*sizeof(MYFLT));  \
       }                                                \
-      for (n=offset; n<nsmps; n++)                     \
-        r[n] = a OP b[n];                              \
+      get_kernels()->KERN(&r[offset], a, &b[offset], nsmps-offset); \
       return OK;                                       \
     }                                                  \
     else {                                             \
@@ -290,18 +392,17 @@ int modkk(CSOUND *csound, AOP *p)
   }
 
 
-KA(addka,+)
-KA(subka,-)
-KA(mulka,*)
-KA(divka,/)
+KA(addka,+,add_ka)
+KA(subka,-,sub_ka)
+KA(mulka,*,mul_ka)
+KA(divka,/,div_ka)
 
-/* ********COULD BE IMPROVED******** */
 int modka(CSOUND *csound, AOP *p)
 {
     MYFLT   *r, a, *b;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
+    uint32_t nsmps = CS_KSMPS;
 
     r = p->r;
     a = *p->a;
@@ -311,14 +412,13 @@ int modka(CSOUND *csound, AOP *p)
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n=offset; n<nsmps; n++)
-      r[n] = MOD(a, b[n]);
+    get_kernels()->mod_ka(&r[offset], a, &b[offset], nsmps-offset);
     return OK;
 }
 
-#define AK(OPNAME,OP)                           \
+#define AK(OPNAME,OP,KERN)                      \
   int OPNAME(CSOUND *csound, AOP *p) {          \
-    uint32_t n, nsmps = CS_KSMPS;               \
+    uint32_t nsmps = CS_KSMPS;                  \
     if (LIKELY(nsmps != 1)) {                   \
       MYFLT   *r, *a, b;                        \
       uint32_t offset = p->h.insdshead->ksmps_offset;  \
@@ -332,8 +432,7 @@ int modka(CSOUND *csound, AOP *p)
         nsmps -= early;                         \
         memset(&r[nsmps], '\0', early*sizeof(MYFLT)); \
       }                                         \
-      for (n=offset; n<nsmps; n++)              \
-        r[n] = a[n] OP b;                       \
+      get_kernels()->KERN(&r[offset], &a[offset], b, nsmps-offset); \
       return OK;                                \
     }                                           \
     else {                                      \
@@ -342,12 +441,12 @@ int modka(CSOUND *csound, AOP *p)
     }                                           \
 }
 
-AK(addak,+)
-AK(subak,-)
-AK(mulak,*)
+AK(addak,+,add_ak)
+AK(subak,-,sub_ak)
+AK(mulak,*,mul_ak)
 //AK(divak,/)
 int divak(CSOUND *csound, AOP *p) {
-    uint32_t n, nsmps = CS_KSMPS;
+    uint32_t nsmps = CS_KSMPS;
     MYFLT b = *p->b;
     if (LIKELY(nsmps != 1)) {
       MYFLT   *r, *a;
@@ -364,8 +463,7 @@ int divak(CSOUND *csound, AOP *p) {
         nsmps -= early;
         memset(&r[nsmps], '\0', early*sizeof(MYFLT)); \
       }
-      for (n=offset; n<nsmps; n++)
-        r[n] = a[n] / b;
+      get_kernels()->div_ak(&r[offset], &a[offset], b, nsmps-offset);
       return OK;
     }
     else {
@@ -377,13 +475,12 @@ int divak(CSOUND *csound, AOP *p) {
 }
 
 
-/* ********COULD BE IMPROVED******** */
 int modak(CSOUND *csound, AOP *p)
 {
     MYFLT   *r, *a, b;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
+    uint32_t nsmps = CS_KSMPS;
 
     r = p->r;
     a = p->a;
@@ -393,15 +490,14 @@ int modak(CSOUND *csound, AOP *p)
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n=offset; n<nsmps; n++)
-      r[n] = MOD(a[n], b);
+    get_kernels()->mod_ak(&r[offset], &a[offset], b, nsmps-offset);
     return OK;
 }
 
-#define AA(OPNAME,OP)                           \
+#define AA(OPNAME,OP,KERN)                      \
   int OPNAME(CSOUND *csound, AOP *p) {          \
   MYFLT   *r, *a, *b;                           \
-  uint32_t n, nsmps = CS_KSMPS;                 \
+  uint32_t nsmps = CS_KSMPS;                    \
   if (LIKELY(nsmps!=1)) {                       \
     uint32_t offset = p->h.insdshead->ksmps_offset;       \
     uint32_t early  = p->h.insdshead->ksmps_no_end;  \
@@ -413,8 +509,7 @@ int modak(CSOUND *csound, AOP *p)
       nsmps -= early;                           \
       memset(&r[nsmps], '\0', early*sizeof(MYFLT)); \
     }                                           \
-    for (n=offset; n<nsmps; n++)                \
-      r[n] = a[n] OP b[n];                      \
+    get_kernels()->KERN(&r[offset], &a[offset], &b[offset], nsmps-offset); \
     return OK;                                  \
   }                                             \
     else {                                      \
@@ -424,56 +519,17 @@ int modak(CSOUND *csound, AOP *p)
   }
 
 
-/* VL
-   experimental code using SIMD for operations
-*/
-#define GCCVSIZEB 64
-#define GCCVSIZE  (GCCVSIZEB/sizeof(MYFLT))
-#define MAXKSMPS 256
-typedef double v2d __attribute__((vector_size(GCCVSIZEB)));
-#define AA_VECTOR(OPNAME,OP)                   \
-  int OPNAME(CSOUND *csound, AOP *p) {          \
-  MYFLT   *r, *a, *b;                           \
-  v2d     rv[MAXKSMPS/GCCVSIZE], av[MAXKSMPS/GCCVSIZE], bv[MAXKSMPS/GCCVSIZE];  \
-  uint32_t n, nsmps = CS_KSMPS, end;            \
-  if (LIKELY(nsmps!=1)) {                       \
-    uint32_t offset = p->h.insdshead->ksmps_offset; \
-    uint32_t early  = p->h.insdshead->ksmps_no_end; \
-    r = p->r;                                   \
-    a = p->a;                                   \
-    b = p->b;                                   \
-    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT)); \
-    if (UNLIKELY(early)) {                      \
-      nsmps -= early;                           \
-      memset(&r[nsmps], '\0', early*sizeof(MYFLT)); \
-    }                                           \
-    memcpy(av,a,nsmps*sizeof(MYFLT));       \
-    memcpy(bv,b,nsmps*sizeof(MYFLT));       \
-    offset /= GCCVSIZE; end = nsmps/GCCVSIZE; \
-    for (n=offset/GCCVSIZE; n<end; n+=1){         \
-       rv[n] = av[n] OP bv[n];                  \
-    }                                           \
-    memcpy(r,rv,nsmps*sizeof(MYFLT));           \
-    return OK;                                  \
-  }                                             \
-    else {                                      \
-      *p->r = *p->a OP *p->b;                    \
-      return OK;                                \
-    }                                           \
-  }
-
-AA(addaa,+)
-AA(subaa,-)
-AA(mulaa,*)
-AA(divaa,/)
+AA(addaa,+,add_aa)
+AA(subaa,-,sub_aa)
+AA(mulaa,*,mul_aa)
+AA(divaa,/,div_aa)
 
-/* ********COULD BE IMPROVED******** */
 int modaa(CSOUND *csound, AOP *p)
 {
     MYFLT   *r, *a, *b;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
+    uint32_t nsmps = CS_KSMPS;
 
     r = p->r;
     a = p->a;
@@ -483,8 +539,7 @@ int modaa(CSOUND *csound, AOP *p)
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n=offset; n<nsmps; n++)
-      r[n] = MOD(a[n], b[n]);
+    get_kernels()->mod_aa(&r[offset], &a[offset], &b[offset], nsmps-offset);
     return OK;
 }
 
@@ -494,11 +549,9 @@ int divzkk(CSOUND *csound, DIVZ *p)
     *p->r = (*p->b != FL(0.0) ? *p->a / *p->b : *p->def);
     return OK;
 }
-/* ********COULD BE IMPROVED******** */
 
 int divzka(CSOUND *csound, DIVZ *p)
 {
-    uint32_t n;
     MYFLT    *r, a, *b, def;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
@@ -513,12 +566,10 @@ int divzka(CSOUND *csound, DIVZ *p)
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n=offset; n<nsmps; n++)
-      r[n] = (b[n]==FL(0.0) ? def : a / b[n]);
+    get_kernels()->divz_ka(&r[offset], a, &b[offset], def, nsmps-offset);
     return OK;
 }
 
-/* ********COULD BE IMPROVED******** */
 int divzak(CSOUND *csound, DIVZ *p)
 {
     uint32_t n;
@@ -539,16 +590,13 @@ int divzak(CSOUND *csound, DIVZ *p)
     if (UNLIKELY(b==FL(0.0))) {
       for (n=offset; n<nsmps; n++) r[n] = def;
     }
-    else {
-      for (n=offset; n<nsmps; n++) r[n] = a[n] / b;
-    }
+    else
+      get_kernels()->div_ak(&r[offset], &a[offset], b, nsmps-offset);
     return OK;
 }
 
-/* ********COULD BE IMPROVED******** */
 int divzaa(CSOUND *csound, DIVZ *p)
 {
-    uint32_t n;
     MYFLT    *r, *a, *b, def;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
@@ -563,8 +611,8 @@ int divzaa(CSOUND *csound, DIVZ *p)
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n=offset; n<nsmps; n++)
-      r[n] = (b[n]==FL(0.0) ? def : a[n] / b[n]);
+    get_kernels()->divz_aa(&r[offset], &a[offset], &b[offset], def,
+                           nsmps-offset);
     return OK;
 }
 
@@ -606,23 +654,19 @@ int int1(CSOUND *csound, EVAL *p)               /* returns signed whole no. */
     return OK;
 }
 
-/* ********COULD BE IMPROVED******** */
 int int1a(CSOUND *csound, EVAL *p)              /* returns signed whole no. */
 {
-    MYFLT        intpart, *a=p->a, *r=p->r;
+    MYFLT        *a=p->a, *r=p->r;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps =CS_KSMPS;
+    uint32_t nsmps =CS_KSMPS;
 
     if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n = offset; n < nsmps; n++) {
-      MODF(a[n], &intpart);
-      r[n] = intpart;
-    }
+    get_kernels()->int_trunc(&r[offset], &a[offset], nsmps-offset);
     return OK;
 }
 
@@ -635,23 +679,19 @@ int frac1(CSOUND *csound, EVAL *p)              /* returns positive frac part */
     return OK;
 }
 
-/* ********COULD BE IMPROVED******** */
 int frac1a(CSOUND *csound, EVAL *p)             /* returns positive frac part */
 {
-    MYFLT intpart, fracpart, *r = p->r, *a = p->a;
+    MYFLT *r = p->r, *a = p->a;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps =CS_KSMPS;
+    uint32_t nsmps =CS_KSMPS;
 
     if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n = offset; n < nsmps; n++) {
-      fracpart = MODF(a[n], &intpart);
-      r[n] = fracpart;
-    }
+    get_kernels()->frac(&r[offset], &a[offset], nsmps-offset);
     return OK;
 }
 
@@ -672,12 +712,11 @@ int int1_round(CSOUND *csound, EVAL *p)         /* round to nearest integer */
     return OK;
 }
 
-/* ********COULD BE IMPROVED******** */
 int int1a_round(CSOUND *csound, EVAL *p)        /* round to nearest integer */
 {
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps =CS_KSMPS;
+    uint32_t nsmps =CS_KSMPS;
     MYFLT *r=p->r, *a=p->a;
 
     if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
@@ -685,8 +724,7 @@ int int1a_round(CSOUND *csound, EVAL *p)        /* round to nearest integer */
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n = offset; n < nsmps; n++)
-      r[n] = (MYFLT)MYFLT2LRND(a[n]);
+    get_kernels()->int_round(&r[offset], &a[offset], nsmps-offset);
     return OK;
 }
 
@@ -697,21 +735,19 @@ int int1_floor(CSOUND *csound, EVAL *p)         /* round down */
     return OK;
 }
 
-/* ********COULD BE IMPROVED******** */
 int int1a_floor(CSOUND *csound, EVAL *p)        /* round down */
 {
     MYFLT    *a=p->a, *r=p->r;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps =CS_KSMPS;
+    uint32_t nsmps =CS_KSMPS;
 
     if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n = offset; n < nsmps; n++)
-      r[n] = (MYFLT)(MYFLOOR(a[n]));
+    get_kernels()->int_floor(&r[offset], &a[offset], nsmps-offset);
     return OK;
 }
 
@@ -722,21 +758,19 @@ int int1_ceil(CSOUND *csound, EVAL *p)          /* round up */
     return OK;
 }
 
-/* ********COULD BE IMPROVED******** */
 int int1a_ceil(CSOUND *csound, EVAL *p)         /* round up */
 {
     MYFLT    *a=p->a, *r=p->r;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps =CS_KSMPS;
+    uint32_t nsmps =CS_KSMPS;
 
     if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n = offset; n < nsmps; n++)
-      r[n] = (MYFLT)(MYCEIL(a[n]));
+    get_kernels()->int_ceil(&r[offset], &a[offset], nsmps-offset);
     return OK;
 }
 
@@ -855,7 +889,7 @@ int aampdb(CSOUND *csound, EVAL *p)
 {
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps =CS_KSMPS;
+    uint32_t nsmps =CS_KSMPS;
     MYFLT   *r = p->r, *a = p->a;
 
     if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
@@ -863,8 +897,7 @@ int aampdb(CSOUND *csound, EVAL *p)
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n = offset; n < nsmps; n++)
-      r[n] = EXP(a[n] * LOG10D20);
+    get_kernels()->ampdb(&r[offset], &a[offset], FL(1.0), nsmps-offset);
     return OK;
 }
 
@@ -880,12 +913,11 @@ int ampdbfs(CSOUND *csound, EVAL *p)
     return OK;
 }
 
-/* ********COULD BE IMPROVED******** */
 int aampdbfs(CSOUND *csound, EVAL *p)
 {
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps =CS_KSMPS;
+    uint32_t nsmps =CS_KSMPS;
     MYFLT   *r, *a;
 
     r = p->r;
@@ -895,8 +927,8 @@ int aampdbfs(CSOUND *csound, EVAL *p)
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n = offset; n < nsmps; n++)
-      r[n] = csound->e0dbfs * EXP(a[n] * LOG10D20);
+    get_kernels()->ampdb(&r[offset], &a[offset], csound->e0dbfs,
+                         nsmps-offset);
     return OK;
 }
 
@@ -1022,10 +1054,9 @@ int cpsoct(CSOUND *csound, EVAL *p)
 int acpsoct(CSOUND *csound, EVAL *p)
 {
     MYFLT   *r, *a;
-    int    loct;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps =CS_KSMPS;
+    uint32_t nsmps =CS_KSMPS;
 
     a = p->a;
     r = p->r;
@@ -1034,10 +1065,8 @@ int acpsoct(CSOUND *csound, EVAL *p)
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n = offset; n < nsmps; n++) {
-      loct = (int)(a[n] * OCTRES);
-      r[n] = CPSOCTL(loct);
-    }
+    get_kernels()->cpsoct(&r[offset], &a[offset], csound->cpsocfrc,
+                          nsmps-offset);
     return OK;
 }
 
@@ -0,0 +1,278 @@
+/*
+    aops_kernels.h:
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+
+/* Kernels for the a-rate arithmetic and conversion opcodes, included by
+   aops.c once for every instruction set it dispatches to (and by the
+   benchmark in tests/c).  The includer defines KNAME(x) to give the
+   functions a per-target name and KERNEL to the storage class and
+   target attributes.  Every kernel works on n samples from the start of
+   the pointers it is given; the caller deals with ksmps_offset and
+   ksmps_no_end.  The loops are written so that the compiler can
+   vectorise them: no calls other than those it expands inline, and
+   exceptional cases handled by selects, which the compiler will only
+   turn into vector code if it may assume that floating point operations
+   do not trap (aops.c is built with -fno-trapping-math). */
+
+#ifndef AOPS_KERNELS_DEFS
+#define AOPS_KERNELS_DEFS
+#ifdef USE_DOUBLE
+#  define KTRUNC(x)       trunc(x)
+#  define KCOPYSIGN(x,y)  copysign(x, y)
+#  define KINTBIG         FL(4503599627370496.0)        /* 2^52 */
+#else
+#  define KTRUNC(x)       truncf(x)
+#  define KCOPYSIGN(x,y)  copysignf(x, y)
+#  define KINTBIG         FL(8388608.0)                 /* 2^23 */
+#endif
+#define AOPS_MOD_BLOCK  64
+
+/* MOD() in aops.c, whose loops never run on a result of fmod() */
+static inline MYFLT aops_fmod(MYFLT a, MYFLT b)
+{
+    return (b == FL(0.0) ? FL(0.0) : FMOD(a, FABS(b)));
+}
+#endif  /* AOPS_KERNELS_DEFS */
+
+#define AOPS_AA(NAME, OP)                                               \
+KERNEL void KNAME(NAME)(MYFLT *r, const MYFLT *a, const MYFLT *b, int n) \
+{                                                                       \
+    int i;                                                              \
+    for (i = 0; i < n; i++)                                             \
+      r[i] = a[i] OP b[i];                                              \
+}
+
+#define AOPS_AK(NAME, OP)                                               \
+KERNEL void KNAME(NAME)(MYFLT *r, const MYFLT *a, MYFLT b, int n)       \
+{                                                                       \
+    int i;                                                              \
+    for (i = 0; i < n; i++)                                             \
+      r[i] = a[i] OP b;                                                 \
+}
+
+#define AOPS_KA(NAME, OP)                                               \
+KERNEL void KNAME(NAME)(MYFLT *r, MYFLT a, const MYFLT *b, int n)       \
+{                                                                       \
+    int i;                                                              \
+    for (i = 0; i < n; i++)                                             \
+      r[i] = a OP b[i];                                                 \
+}
+
+AOPS_AA(add_aa, +)
+AOPS_AA(sub_aa, -)
+AOPS_AA(mul_aa, *)
+AOPS_AA(div_aa, /)
+AOPS_AK(add_ak, +)
+AOPS_AK(sub_ak, -)
+AOPS_AK(mul_ak, *)
+AOPS_AK(div_ak, /)
+AOPS_KA(add_ka, +)
+AOPS_KA(sub_ka, -)
+AOPS_KA(mul_ka, *)
+AOPS_KA(div_ka, /)
+
+#undef AOPS_AA
+#undef AOPS_AK
+#undef AOPS_KA
+
+/* a mod b as a - |b| * trunc(a / |b|), in blocks of AOPS_MOD_BLOCK.  A
+   block in which that cannot give the answer fmod() would (a result
+   outside (-|b|, |b|) or of the wrong sign, as when the quotient is too
+   large to be exact, or infinities) is redone with aops_fmod().  The
+   block is built up on the stack, as r may be a or b. */
+
+#define AOPS_MOD(R, A, B, BAD)                                          \
+    {                                                                   \
+      MYFLT x_ = (A), b_ = FABS(B), d_ = x_ - b_ * KTRUNC(x_ / b_);     \
+      BAD |= (b_ != FL(0.0)) & (!(FABS(d_) < b_) | (d_ * x_ < FL(0.0))); \
+      R = (b_ == FL(0.0) ? FL(0.0) : d_);                               \
+    }
+
+#define AOPS_MOD_LOOP(A, B)                                             \
+    MYFLT   d[AOPS_MOD_BLOCK];                                          \
+    int     i, j, m, bad;                                               \
+    for (j = 0; j < n; j += AOPS_MOD_BLOCK) {                           \
+      m = (n - j < AOPS_MOD_BLOCK ? n - j : AOPS_MOD_BLOCK);            \
+      bad = 0;                                                          \
+      for (i = 0; i < m; i++)                                           \
+        AOPS_MOD(d[i], A, B, bad)                                       \
+      if (UNLIKELY(bad))                                                \
+        for (i = 0; i < m; i++)                                         \
+          d[i] = aops_fmod(A, B);                                       \
+      memcpy(&r[j], d, m * sizeof(MYFLT));                              \
+    }
+
+KERNEL void KNAME(mod_aa)(MYFLT *r, const MYFLT *a, const MYFLT *b, int n)
+{
+    AOPS_MOD_LOOP(a[j + i], b[j + i])
+}
+
+KERNEL void KNAME(mod_ak)(MYFLT *r, const MYFLT *a, MYFLT b, int n)
+{
+    AOPS_MOD_LOOP(a[j + i], b)
+}
+
+KERNEL void KNAME(mod_ka)(MYFLT *r, MYFLT a, const MYFLT *b, int n)
+{
+    AOPS_MOD_LOOP(a, b[j + i])
+}
+
+#undef AOPS_MOD_LOOP
+#undef AOPS_MOD
+
+KERNEL void KNAME(divz_aa)(MYFLT *r, const MYFLT *a, const MYFLT *b,
+                           MYFLT def, int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+      r[i] = (b[i] == FL(0.0) ? def : a[i] / b[i]);
+}
+
+KERNEL void KNAME(divz_ka)(MYFLT *r, MYFLT a, const MYFLT *b,
+                           MYFLT def, int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+      r[i] = (b[i] == FL(0.0) ? def : a / b[i]);
+}
+
+/* scale * exp(a * LOG10D20).  Where the includer defines AOPS_VECTOR_EXP
+   (for instruction sets with vectors wide enough to repay it), exp() is
+   evaluated in double precision as 2^k * p(f), |f| <= ln(2)/2, and p the
+   Taylor series to degree 13.  It agrees with the C library to about a
+   unit in the last place; results that would be subnormal are returned
+   as zero.  The argument is clamped to the range in a separate pass, as
+   the compiler will not vectorise a loop in which it can see the clamped
+   value as a constant. */
+
+#ifndef AOPS_VECTOR_EXP
+KERNEL void KNAME(ampdb)(MYFLT *r, const MYFLT *a, MYFLT scale, int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+      r[i] = scale * EXP(a[i] * LOG10D20);
+}
+#else
+KERNEL void KNAME(ampdb)(MYFLT *r, const MYFLT *a, MYFLT scale, int n)
+{
+    double  y[64];
+    int     i, j, m;
+    for (j = 0; j < n; j += 64) {
+      m = (n - j < 64 ? n - j : 64);
+      for (i = 0; i < m; i++) {
+        double x = (double) a[j + i] * LOG10D20;
+        x = (x >= -708.396418532264 ? x : -708.396418532264); /* and NaN */
+        y[i] = (x <= 709.782712893384 ? x : 709.782712893384);
+      }
+      for (i = 0; i < m; i++) {
+        double   x = (double) a[j + i] * LOG10D20, k, f, p, s;
+        int32_t  ki;
+        uint64_t e1, e2;
+        double   s2;
+        k = y[i] * 1.4426950408889634;
+        ki = (int32_t) (k + (k < 0.0 ? -0.5 : 0.5));
+        k = (double) ki;
+        f = (y[i] - k * 6.93147180369123816490e-01)
+            - k * 1.90821492927058770002e-10;
+        p =         1.0 / 6227020800.0;
+        p = p * f + 1.0 / 479001600.0;
+        p = p * f + 1.0 / 39916800.0;
+        p = p * f + 1.0 / 3628800.0;
+        p = p * f + 1.0 / 362880.0;
+        p = p * f + 1.0 / 40320.0;
+        p = p * f + 1.0 / 5040.0;
+        p = p * f + 1.0 / 720.0;
+        p = p * f + 1.0 / 120.0;
+        p = p * f + 1.0 / 24.0;
+        p = p * f + 1.0 / 6.0;
+        p = p * f + 0.5;
+        p = p * f + 1.0;
+        p = p * f + 1.0;
+        /* 2^k as a product of two, as k runs from -1022 to 1024 */
+        e1 = (uint64_t) (uint32_t) ((ki >> 1) + 1023) << 52;
+        e2 = (uint64_t) (uint32_t) (ki - (ki >> 1) + 1023) << 52;
+        memcpy(&s, &e1, sizeof(double));
+        memcpy(&s2, &e2, sizeof(double));
+        /* p is finite here: zero it below the range, and push it to
+           infinity above it or to NaN for NaN input by addition */
+        p = p * s * s2 * (x < -708.396418532264 ? 0.0 : 1.0);
+        p += (x > 709.782712893384 ? HUGE_VAL : 0.0);
+        p += (x != x ? x : 0.0);
+        r[j + i] = scale * (MYFLT) p;
+      }
+    }
+}
+
+#endif  /* AOPS_VECTOR_EXP */
+
+KERNEL void KNAME(cpsoct)(MYFLT *r, const MYFLT *a, const MYFLT *cpsocfrc,
+                          int n)
+{
+    int i;
+    for (i = 0; i < n; i++) {
+      int loct = (int) (a[i] * OCTRES);
+      r[i] = (MYFLT) (1 << (loct >> 13)) * cpsocfrc[loct & 8191];
+    }
+}
+
+KERNEL void KNAME(int_trunc)(MYFLT *r, const MYFLT *a, int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+      r[i] = KTRUNC(a[i]);
+}
+
+/* the fraction with the sign of a, zero for values too large to have
+   one, as modf() */
+
+KERNEL void KNAME(frac)(MYFLT *r, const MYFLT *a, int n)
+{
+    int i;
+    for (i = 0; i < n; i++) {
+      MYFLT x = a[i];
+      MYFLT f = (FABS(x) >= KINTBIG ? FL(0.0) : x - KTRUNC(x));
+      r[i] = KCOPYSIGN(f, x);
+    }
+}
+
+KERNEL void KNAME(int_round)(MYFLT *r, const MYFLT *a, int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+      r[i] = (MYFLT) MYFLT2LRND(a[i]);
+}
+
+KERNEL void KNAME(int_floor)(MYFLT *r, const MYFLT *a, int n)
+{
+    int i;
+    for (i = 0; i < n; i++) {
+      double x = (double) a[i];
+      r[i] = (MYFLT) (int32_t) (x + (x >= 0.0 ? 0.0 : -0.99999999));
+    }
+}
+
+KERNEL void KNAME(int_ceil)(MYFLT *r, const MYFLT *a, int n)
+{
+    int i;
+    for (i = 0; i < n; i++) {
+      double x = (double) a[i];
+      r[i] = (MYFLT) (int32_t) (x + (x >= 0.0 ? 0.99999999 : 0.0));
+    }
+}
@@ -26,11 +26,174 @@
 #include "diskin2.h"
 #include <math.h>
 
-typedef struct DISKIN_INST_ {
+/* io thread state, one per engine (and one for the array variant) */
+typedef struct DISKIN_WAKE_ {
   CSOUND *csound;
-  DISKIN2 *diskin;
-  struct DISKIN_INST_ *nxt;
-} DISKIN_INST;
+  DISKIN_IO *top;           /* the instances, in the order they started */
+  void   *thread;
+  volatile int running;
+  void   *lock;            /* the io thread sleeps on this thread lock */
+  void   *mutex;           /* held to change the list, never across reads */
+  volatile int pending;    /* a wake-up has been posted */
+  void   (*fill)(CSOUND *, void *);     /* tops up the ring of an owner */
+} DISKIN_WAKE;
+
+#ifdef HAVE_ATOMIC_BUILTIN
+#define DISKIN_BARRIER() __sync_synchronize()
+#else
+#define DISKIN_BARRIER()
+#endif
+
+/* ring size multiplier for transposed playback: each output frame costs
+   |kTranspose| file frames, so faster playback gets a longer lead time */
+static int diskin2_speed_factor(MYFLT transpose)
+{
+    MYFLT tr = FABS(transpose);
+    if (tr <= FL(1.0)) return 1;
+    if (tr >= FL(8.0)) return 8;
+    return (int) CEIL(tr);
+}
+
+/* called from the performance thread once a low-watermark's worth of
+   frames has been consumed; never blocks on the io thread */
+static void diskin2_wake_io(CSOUND *csound, DISKIN_WAKE *wake)
+{
+    if (wake != NULL && !wake->pending) {
+      wake->pending = 1;
+      csound->NotifyThreadLock(wake->lock);
+    }
+}
+
+#ifndef __EMSCRIPTEN__
+
+/* Sleeps until an instance drains past its low watermark (or a timeout
+   expires as a safety net) and then tops up every ring.  The list lock is
+   taken only to find the next instance and mark it busy, so starting and
+   stopping instances never waits for the disk; an instance removed or
+   added during a pass may be skipped or filled twice in it, which the
+   next pass or wake-up makes good.  Since the io thread renders at the
+   current signed increment, readahead follows the playback speed and
+   direction. */
+
+static uintptr_t diskin_io_thread(void *p)
+{
+    DISKIN_WAKE *wake = (DISKIN_WAKE *) p;
+    CSOUND *csound = wake->csound;
+    DISKIN_IO *io;
+    int i, k, timeout = 8000*csound->ksmps/csound->esr;
+    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+    while (wake->running) {
+      csound->WaitThreadLock(wake->lock, (size_t) (timeout > 0 ? timeout : 1));
+      wake->pending = 0;
+      for (k = 0; wake->running; k++) {
+        csound->LockMutex(wake->mutex);
+        for (io = wake->top, i = 0; io != NULL && i < k; i++)
+          io = io->nxt;
+        if (io != NULL)
+          io->busy = 1;
+        csound->UnlockMutex(wake->mutex);
+        if (io == NULL)
+          break;
+        wake->fill(csound, io->owner);
+        DISKIN_BARRIER();
+        io->busy = 0;
+      }
+    }
+    return 0;
+}
+
+/* stops the io thread when the engine is reset; by then every instance
+   has been deinitialised */
+
+static int diskin2_io_stop(CSOUND *csound, void *p)
+{
+    DISKIN_WAKE *wake = (DISKIN_WAKE *) p;
+    wake->running = 0;
+    csound->NotifyThreadLock(wake->lock);
+    csound->JoinThread(wake->thread);
+    csound->NotifyThreadLock(wake->lock);   /* release before destroy */
+    csound->DestroyThreadLock(wake->lock);
+    csound->DestroyMutex(wake->mutex);
+    return OK;
+}
+
+/* the io thread state named 'name', started on first use */
+
+static DISKIN_WAKE *diskin2_io_get(CSOUND *csound, const char *name,
+                                   void (*fill)(CSOUND *, void *))
+{
+    DISKIN_WAKE *wake;
+    if ((wake = (DISKIN_WAKE *)
+         csound->QueryGlobalVariable(csound, name)) != NULL)
+      return wake;
+    if (csound->CreateGlobalVariable(csound, name, sizeof(DISKIN_WAKE)) != 0)
+      return NULL;
+    wake = (DISKIN_WAKE *) csound->QueryGlobalVariable(csound, name);
+    wake->csound = csound;
+    wake->top = NULL;
+    wake->fill = fill;
+    wake->running = 1;
+    wake->lock = csound->CreateThreadLock();
+    wake->mutex = csound->Create_Mutex(0);
+    wake->thread = (wake->lock != NULL && wake->mutex != NULL ?
+                    csound->CreateThread(diskin_io_thread, wake) : NULL);
+    if (wake->thread == NULL) {
+      if (wake->mutex != NULL) csound->DestroyMutex(wake->mutex);
+      if (wake->lock != NULL) csound->DestroyThreadLock(wake->lock);
+      csound->DestroyGlobalVariable(csound, name);
+      return NULL;
+    }
+    csound->RegisterResetCallback(csound, wake, diskin2_io_stop);
+    return wake;
+}
+
+#else
+
+/* no threads: every instance reads synchronously */
+
+static DISKIN_WAKE *diskin2_io_get(CSOUND *csound, const char *name,
+                                   void (*fill)(CSOUND *, void *))
+{
+    (void) csound; (void) name; (void) fill;
+    return NULL;
+}
+
+#endif
+
+/* appends an instance to the io thread's list */
+
+static void diskin2_io_add(CSOUND *csound, DISKIN_WAKE *wake,
+                           DISKIN_IO *io, void *owner)
+{
+    DISKIN_IO **pp;
+    io->owner = owner;
+    io->nxt = NULL;
+    io->busy = 0;
+    csound->LockMutex(wake->mutex);
+    for (pp = &(wake->top); *pp != NULL; pp = &((*pp)->nxt))
+      ;
+    *pp = io;
+    csound->UnlockMutex(wake->mutex);
+}
+
+/* takes an instance off the list; if the io thread is filling it at the
+   time, waits for that one fill to end, as the file is closed next */
+
+static void diskin2_io_remove(CSOUND *csound, DISKIN_WAKE *wake,
+                              DISKIN_IO *io)
+{
+    DISKIN_IO **pp;
+    csound->LockMutex(wake->mutex);
+    for (pp = &(wake->top); *pp != NULL; pp = &((*pp)->nxt))
+      if (*pp == io) {
+        *pp = io->nxt;
+        break;
+      }
+    csound->UnlockMutex(wake->mutex);
+    while (io->busy)
+      csound->Sleep(0);
+    DISKIN_BARRIER();
+}
 
 
 static CS_NOINLINE void diskin2_read_buffer(CSOUND *csound,
@@ -293,6 +456,8 @@ int soundin(CSOUND *csound, DISKIN2 *p){
 }
 
 int diskin2_async_deinit(CSOUND *csound, void *p);
+static void diskin_file_fill(CSOUND *csound, DISKIN2 *p);
+static void diskin_io_fill(CSOUND *csound, void *p);
 
 static int diskin2_init_(CSOUND *csound, DISKIN2 *p, int stringname)
 {
@@ -300,6 +465,7 @@ static int diskin2_init_(CSOUND *csound, DISKIN2 *p, int stringname)
     char    name[1024];
     void    *fd;
     SF_INFO sfinfo;
+    DISKIN_WAKE *wake;
     int     n;
 
     /* check number of channels */
@@ -313,6 +479,7 @@ static int diskin2_init_(CSOUND *csound, DISKIN2 *p, int stringname)
       /* skip initialisation if requested */
       if (*(p->iSkipInit) != FL(0.0))
         return OK;
+      diskin2_async_deinit(csound, p);
       fdclose(csound, &(p->fdch));
     }
     /* set default format parameters */
@@ -412,13 +579,16 @@ static int diskin2_init_(CSOUND *csound, DISKIN2 *p, int stringname)
 
     memset(p->buf, 0, n*sizeof(MYFLT));
 
-    // create circular buffer, on fail set mode to synchronous
+    // create circular buffer of whole frames, on fail set mode to synchronous
+    n = p->bufSize * 2 * diskin2_speed_factor(*(p->kTranspose));
     if (csound->realtime_audio_flag==1 && p->fforceSync==0 &&
-        (p->cb = csound->CreateCircularBuffer(csound,
-                                              p->bufSize*p->nChannels*2,
-                                              sizeof(MYFLT))) != NULL){
-      DISKIN_INST **top, *current;
-      int *start;
+        (wake = diskin2_io_get(csound, "DISKIN_WAKE", diskin_io_fill))
+        != NULL &&
+        (p->cb = csound->CreateCircularBuffer(csound, n,
+                                              sizeof(MYFLT)*p->nChannels))
+        != NULL){
+      p->lowWater = n / 2;
+      p->consumed = 0;
       // allocate buffer
       n = CS_KSMPS*sizeof(MYFLT)*p->nChannels;
       if (n != (int)p->auxData2.size)
@@ -426,41 +596,11 @@ static int diskin2_init_(CSOUND *csound, DISKIN2 *p, int stringname)
       p->aOut_buf = (MYFLT *) (p->auxData2.auxp);
       memset(p->aOut_buf, 0, n);
       p->aOut_bufsize = CS_KSMPS;
-
-#ifndef __EMSCRIPTEN__
-      if ((top=(DISKIN_INST **)csound->QueryGlobalVariable(csound,
-                                                           "DISKIN_INST")) == NULL){
-        csound->CreateGlobalVariable(csound, "DISKIN_INST", sizeof(DISKIN_INST *));
-        top = (DISKIN_INST **) csound->QueryGlobalVariable(csound, "DISKIN_INST");
-        *top = (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-        csound->CreateGlobalVariable(csound, "DISKIN_PTHREAD", sizeof(pthread_t));
-        csound->CreateGlobalVariable(csound, "DISKIN_THREAD_START", sizeof(int));
-        current = *top;
-      }
-      else
-#endif
-        {
-          current = *top;
-          while(current->nxt != NULL) { /* find next empty slot in chain */
-            current = current->nxt;
-          }
-          current->nxt = (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-          current = current->nxt;
-        }
-      current->csound = csound;
-      current->diskin = p;
-      current->nxt = NULL;
-
-#ifndef __EMSCRIPTEN__
-      if ( *(start = csound->QueryGlobalVariable(csound,
-                                                 "DISKIN_THREAD_START")) == 0) {
-        void *diskin_io_thread(void *p);
-        *start = 1;
-        pthread_create((pthread_t *)csound->QueryGlobalVariable(csound,
-                                                                "DISKIN_PTHREAD"),
-                       NULL, diskin_io_thread, *top);
-      }
-#endif
+      p->aOut_pending = p->aOut_pos = 0;
+      /* prime the ring so that playback starts without a gap */
+      diskin_file_fill(csound, p);
+      p->wake = wake;
+      diskin2_io_add(csound, wake, &(p->io), p);
       csound->RegisterDeinitCallback(csound, p, diskin2_async_deinit);
       p->async = 1;
 
@@ -495,37 +635,14 @@ static int diskin2_init_(CSOUND *csound, DISKIN2 *p, int stringname)
 }
 
 int diskin2_async_deinit(CSOUND *csound,  void *p){
+    DISKIN2 *q = (DISKIN2 *) p;
 
-    DISKIN_INST **top, *current, *prv;
-
-    if ((top = (DISKIN_INST **)
-         csound->QueryGlobalVariable(csound, "DISKIN_INST")) == NULL) return NOTOK;
-    current = *top;
-    prv = NULL;
-    while(current->diskin != (DISKIN2 *)p) {
-      prv = current;
-      current = current->nxt;
-    }
-    if (prv == NULL) *top = current->nxt;
-    else prv->nxt = current->nxt;
-
-#ifndef __EMSCRIPTEN__
-    if (*top == NULL) {
-      int *start; pthread_t *pt;
-
-      start = (int *) csound->QueryGlobalVariable(csound,"DISKIN_THREAD_START");
-      *start = 0;
-      pt = (pthread_t *) csound->QueryGlobalVariable(csound,"DISKIN_PTHREAD");
-      //csound->Message(csound, "dealloc %p %d\n", start, *start);
-      pthread_join(*pt, NULL);
-      csound->DestroyGlobalVariable(csound, "DISKIN_PTHREAD");
-      csound->DestroyGlobalVariable(csound, "DISKIN_THREAD_START");
-      csound->DestroyGlobalVariable(csound, "DISKIN_INST");
-    }
-#endif
-    csound->Free(csound, current);
-    csound->DestroyCircularBuffer(csound, ((DISKIN2 *)p)->cb);
-
+    if (!q->async)
+      return OK;
+    diskin2_io_remove(csound, (DISKIN_WAKE *) q->wake, &(q->io));
+    csound->DestroyCircularBuffer(csound, q->cb);
+    q->cb = NULL;
+    q->async = 0;
     return OK;
 }
 
@@ -735,7 +852,7 @@ int diskin2_perf_synchronous(CSOUND *csound, DISKIN2 *p)
 int diskin_file_read(CSOUND *csound, DISKIN2 *p)
 {
     /* nsmps is bufsize in frames */
-    int nsmps = p->aOut_bufsize - p->h.insdshead->ksmps_offset;
+    int nsmps = p->aOut_bufsize;
     int i, nn;
     int chn, chans = p->nChannels;
     double  d, frac_d, x, c, v, pidwarp_d;
@@ -906,32 +1023,45 @@ int diskin_file_read(CSOUND *csound, DISKIN2 *p)
         diskin2_file_pos_inc(p, &ndx);
       }
     }
-    {
-      /* write to circular buffer */
-      int lc, mc=0, nc=nsmps*p->nChannels;
-      int *start = csound->QueryGlobalVariable(csound,"DISKIN_THREAD_START");
-      do{
-        lc = csound->WriteCircularBuffer(csound, p->cb, &aOut[mc], nc);
-        nc -= lc;
-        mc += lc;
-      } while(nc && *start);
-    }
     return OK;
  file_error:
     csound->ErrorMsg(csound, Str("diskin2: file descriptor closed or invalid\n"));
     return NOTOK;
 }
 
+/* Render blocks into the ring until it is full. A block that only fits
+   partially is kept pending and completed on the next call, so the io
+   thread never spins on a full ring. */
+
+static void diskin_file_fill(CSOUND *csound, DISKIN2 *p)
+{
+    int n, chans = p->nChannels;
+    while (1) {
+      if (p->aOut_pending == 0) {
+        if (diskin_file_read(csound, p) != OK)
+          return;
+        p->aOut_pending = (int) p->aOut_bufsize;
+        p->aOut_pos = 0;
+      }
+      n = csound->WriteCircularBuffer(csound, p->cb,
+                                      &(p->aOut_buf[p->aOut_pos * chans]),
+                                      p->aOut_pending);
+      p->aOut_pending -= n;
+      p->aOut_pos += n;
+      if (p->aOut_pending)
+        return;
+    }
+}
 
 int diskin2_perf_asynchronous(CSOUND *csound, DISKIN2 *p)
 {
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t nn, nsmps = CS_KSMPS;
-    MYFLT samp;
-    int chn;
-    void *cb = p->cb;
+    int chn, i, n;
+    void *cb = p->cb, *ptr;
     int chans = p->nChannels;
+    MYFLT *frames, scl = csound->e0dbfs;
 
     if (offset || early) {
       for (chn = 0; chn < chans; chn++)
@@ -945,39 +1075,37 @@ int diskin2_perf_asynchronous(CSOUND *csound, DISKIN2 *p)
       return csound->PerfError(csound, p->h.insdshead,
                                Str("diskin2: not initialised"));
     }
-    for (nn = offset; nn < nsmps; nn++){
-
+    /* deinterleave straight out of the ring, at most two segments */
+    nn = offset;
+    while (nn < nsmps &&
+           (n = csound->AcquireReadCircularBuffer(csound, cb, &ptr,
+                                                  (int) (nsmps - nn))) > 0) {
+      frames = (MYFLT *) ptr;
       for (chn = 0; chn < chans; chn++) {
-        //int i =0;
-        //do {
-        // i =
-        csound->ReadCircularBuffer(csound, cb, &samp, 1);
-        //} while(i==0);
-        p->aOut[chn][nn] = csound->e0dbfs*samp;
+        MYFLT *out = &(p->aOut[chn][nn]);
+        for (i = 0; i < n; i++)
+          out[i] = scl * frames[i * chans + chn];
       }
+      csound->CommitReadCircularBuffer(csound, cb, n);
+      nn += n;
+      p->consumed += n;
+    }
+    /* io thread fell behind: output silence rather than stale data */
+    for (chn = 0; chn < chans; chn++)
+      for (i = nn; i < (int) nsmps; i++)
+        p->aOut[chn][i] = FL(0.0);
+    if (p->consumed >= p->lowWater) {
+      p->consumed = 0;
+      diskin2_wake_io(csound, (DISKIN_WAKE *) p->wake);
     }
     return OK;
 }
 
-
-void *diskin_io_thread(void *p){
-    DISKIN_INST *current = (DISKIN_INST *) p;
-    int wakeup = 1000*current->csound->ksmps/current->csound->esr;
-    int *start =
-      current->csound->QueryGlobalVariable(current->csound,"DISKIN_THREAD_START");
-    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
-    while(*start){
-      current = (DISKIN_INST *) p;
-      csoundSleep(wakeup > 0 ? wakeup : 1);
-      while(current != NULL){
-        diskin_file_read(current->csound, current->diskin);
-        current = current->nxt;
-      }
-    }
-    return NULL;
+static void diskin_io_fill(CSOUND *csound, void *p)
+{
+    diskin_file_fill(csound, (DISKIN2 *) p);
 }
 
-
 int diskin2_perf(CSOUND *csound, DISKIN2 *p) {
     if (!p->async) return diskin2_perf_synchronous(csound, p);
     else return diskin2_perf_asynchronous(csound, p);
@@ -985,6 +1113,18 @@ int diskin2_perf(CSOUND *csound, DISKIN2 *p) {
 
 
 
+/* write a buffer of samples, through the async i/o service when */
+/* performing in real time                                       */
+
+static inline void soundout_write(CSOUND *csound, SNDCOM *q,
+                                  MYFLT *buf, int n)
+{
+    if (q->async)
+      csound->WriteAsync(csound, q->fd, buf, n);
+    else
+      sf_write_MYFLT(q->sf, buf, (sf_count_t) n);
+}
+
 static int soundout_deinit(CSOUND *csound, void *pp)
 {
     char    *opname = csound->GetOpcodeName(pp);
@@ -1000,10 +1140,10 @@ static int soundout_deinit(CSOUND *csound, void *pp)
       MYFLT *p0 = (MYFLT*) &(q->outbuf[0]);
       MYFLT *p1 = (MYFLT*) q->outbufp;
       if (p1 > p0) {
-        sf_write_MYFLT(q->sf, p0, (sf_count_t) ((MYFLT*) p1 - (MYFLT*) p0));
+        soundout_write(csound, q, p0, (int) ((MYFLT*) p1 - (MYFLT*) p0));
         q->outbufp = (MYFLT*) &(q->outbuf[0]);
       }
-      /* close file */
+      /* close file (this also writes out what is still queued) */
       csound->FileClose(csound, q->fd);
       q->sf = (SNDFILE*) NULL;
       q->fd = NULL;
@@ -1070,6 +1210,16 @@ static int sndo1set_(CSOUND *csound, void *pp, int stringname)
                                opname, (int) (*iformat + FL(0.5)));
     }
     sfinfo.format = TYPE2SF(filetyp) | FORMAT2SF(format);
+    q->async = (csound->realtime_audio_flag != 0);
+    if (q->async)
+      q->fd = csound->FileOpenAsync(csound, &(q->sf), CSFILE_SND_W, sfname,
+                                    &sfinfo, "SFDIR",
+                                    csound->type2csfiletype(filetyp, format),
+                                    SNDOUTSMPS, 0);
+    else
+      q->fd = csound->FileOpen2(csound, &(q->sf), CSFILE_SND_W, sfname,
+                                &sfinfo, "SFDIR",
+                                csound->type2csfiletype(filetyp, format), 0);
     if (q->fd == NULL) {
       return csound->InitError(csound, Str("%s cannot open %s"), opname, sfname);
     }
@@ -1112,8 +1262,8 @@ int soundout(CSOUND *csound, SNDOUT *p)
     if (UNLIKELY(early)) nsmps -= early;
     for (nn = offset; nn < nsmps; nn++) {
       if (UNLIKELY(p->c.outbufp >= p->c.bufend)) {
-
-        sf_write_MYFLT(p->c.sf, p->c.outbuf, p->c.bufend - p->c.outbuf);
+        soundout_write(csound, &(p->c), p->c.outbuf,
+                       (int) (p->c.bufend - p->c.outbuf));
         p->c.outbufp = p->c.outbuf;
       }
       *(p->c.outbufp++) = p->asig[nn];
@@ -1134,7 +1284,8 @@ int soundouts(CSOUND *csound, SNDOUTS *p)
     if (UNLIKELY(early)) nsmps -= early;
     for (nn = offset; nn < nsmps; nn++) {
       if (UNLIKELY(p->c.outbufp >= p->c.bufend)) {
-        sf_write_MYFLT(p->c.sf, p->c.outbuf, p->c.bufend - p->c.outbuf);
+        soundout_write(csound, &(p->c), p->c.outbuf,
+                       (int) (p->c.bufend - p->c.outbuf));
         p->c.outbufp = p->c.outbuf;
       }
       *(p->c.outbufp++) = p->asig1[nn];
@@ -1296,40 +1447,14 @@ static inline void diskin2_get_sample_array(CSOUND *csound,
 }
 
 int diskin2_async_deinit_array(CSOUND *csound,  void *p){
+    DISKIN2_ARRAY *q = (DISKIN2_ARRAY *) p;
 
-    DISKIN_INST **top, *current, *prv;
-
-    if ((top = (DISKIN_INST **)
-         csound->QueryGlobalVariable(csound, "DISKIN_INST_ARRAY")) == NULL)
-      return NOTOK;
-    current = *top;
-    prv = NULL;
-    while(current->diskin != (DISKIN2 *)p) {
-      prv = current;
-      current = current->nxt;
-    }
-    if (prv == NULL) *top = current->nxt;
-    else prv->nxt = current->nxt;
-
-#ifndef __EMSCRIPTEN__
-    if (*top == NULL) {
-      int *start; pthread_t *pt;
-
-      start = (int *) csound->QueryGlobalVariable(csound,
-                                                  "DISKIN_THREAD_START_ARRAY");
-      *start = 0;
-      pt = (pthread_t *) csound->QueryGlobalVariable(csound,"DISKIN_PTHREAD_ARRAY");
-      //csound->Message(csound, "dealloc %p %d\n", start, *start);
-      pthread_join(*pt, NULL);
-      csound->DestroyGlobalVariable(csound, "DISKIN_PTHREAD_ARRAY");
-      csound->DestroyGlobalVariable(csound, "DISKIN_THREAD_START_ARRAY");
-      csound->DestroyGlobalVariable(csound, "DISKIN_INST_ARRAY");
-    }
-#endif
-
-    csound->Free(csound, current);
-    csound->DestroyCircularBuffer(csound, ((DISKIN2_ARRAY *)p)->cb);
-
+    if (!q->async)
+      return OK;
+    diskin2_io_remove(csound, (DISKIN_WAKE *) q->wake, &(q->io));
+    csound->DestroyCircularBuffer(csound, q->cb);
+    q->cb = NULL;
+    q->async = 0;
     return OK;
 }
 
@@ -1337,7 +1462,7 @@ int diskin2_async_deinit_array(CSOUND *csound,  void *p){
 int diskin_file_read_array(CSOUND *csound, DISKIN2_ARRAY *p)
 {
     /* nsmps is bufsize in frames */
-    int nsmps = p->aOut_bufsize - p->h.insdshead->ksmps_offset;
+    int nsmps = p->aOut_bufsize;
     int i, nn;
     int chn, chans = p->nChannels;
     double  d, frac_d, x, c, v, pidwarp_d;
@@ -1508,40 +1633,36 @@ int diskin_file_read_array(CSOUND *csound, DISKIN2_ARRAY *p)
         diskin2_file_pos_inc_array(p, &ndx);
       }
     }
-    {
-      /* write to circular buffer */
-      int lc, mc=0, nc=nsmps*p->nChannels;
-      int *start = csound->QueryGlobalVariable(csound,"DISKIN_THREAD_START");
-      do{
-        lc = csound->WriteCircularBuffer(csound, p->cb, &aOut[mc], nc);
-        nc -= lc;
-        mc += lc;
-      } while(nc && *start);
-    }
     return OK;
  file_error:
     csound->ErrorMsg(csound, Str("diskin2: file descriptor closed or invalid\n"));
     return NOTOK;
 }
 
-void *diskin_io_thread_array(void *p){
-    DISKIN_INST *current = (DISKIN_INST *) p;
-    int wakeup = 1000*current->csound->ksmps/current->csound->esr;
-    int *start =
-      current->csound->QueryGlobalVariable(current->csound,
-                                           "DISKIN_THREAD_START_ARRAY");
-    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
-    while(*start){
-      current = (DISKIN_INST *) p;
-      csoundSleep(wakeup > 0 ? wakeup : 1);
-      while(current != NULL){
-        diskin_file_read_array(current->csound, (DISKIN2_ARRAY *)current->diskin);
-        current = current->nxt;
-      }
+static void diskin_file_fill_array(CSOUND *csound, DISKIN2_ARRAY *p)
+{
+    int n, chans = p->nChannels;
+    while (1) {
+      if (p->aOut_pending == 0) {
+        if (diskin_file_read_array(csound, p) != OK)
+          return;
+        p->aOut_pending = (int) p->aOut_bufsize;
+        p->aOut_pos = 0;
+      }
+      n = csound->WriteCircularBuffer(csound, p->cb,
+                                      &(p->aOut_buf[p->aOut_pos * chans]),
+                                      p->aOut_pending);
+      p->aOut_pending -= n;
+      p->aOut_pos += n;
+      if (p->aOut_pending)
+        return;
     }
-    return NULL;
 }
 
+static void diskin_io_fill_array(CSOUND *csound, void *p)
+{
+    diskin_file_fill_array(csound, (DISKIN2_ARRAY *) p);
+}
 
 static int diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p, int stringname)
 {
@@ -1549,6 +1670,7 @@ static int diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p, int stringname)
     char    name[1024];
     void    *fd;
     SF_INFO sfinfo;
+    DISKIN_WAKE *wake;
     int     n;
     ARRAYDAT *t = p->aOut;
 
@@ -1557,6 +1679,7 @@ static int diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p, int stringname)
       /* skip initialisation if requested */
       if (*(p->iSkipInit) != FL(0.0))
         return OK;
+      diskin2_async_deinit_array(csound, p);
       fdclose(csound, &(p->fdch));
     }
     // to handle raw files number of channels
@@ -1676,13 +1799,16 @@ static int diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p, int stringname)
 
     memset(p->buf, 0, n*sizeof(MYFLT));
 
-    // create circular buffer, on fail set mode to synchronous
+    // create circular buffer of whole frames, on fail set mode to synchronous
+    n = p->bufSize * 2 * diskin2_speed_factor(*(p->kTranspose));
     if (csound->realtime_audio_flag==1 && p->fforceSync==0 &&
-        (p->cb = csound->CreateCircularBuffer(csound,
-                                              p->bufSize*p->nChannels*2,
-                                              sizeof(MYFLT))) != NULL){
-      DISKIN_INST **top, *current;
-      int *start;
+        (wake = diskin2_io_get(csound, "DISKIN_WAKE_ARRAY",
+                               diskin_io_fill_array)) != NULL &&
+        (p->cb = csound->CreateCircularBuffer(csound, n,
+                                              sizeof(MYFLT)*p->nChannels))
+        != NULL){
+      p->lowWater = n / 2;
+      p->consumed = 0;
       // allocate buffer
       n = CS_KSMPS*sizeof(MYFLT)*p->nChannels;
       if (n != (int)p->auxData2.size)
@@ -1690,48 +1816,11 @@ static int diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p, int stringname)
       p->aOut_buf = (MYFLT *) (p->auxData2.auxp);
       memset(p->aOut_buf, 0, n);
       p->aOut_bufsize = CS_KSMPS;
-
-#ifndef __EMSCRIPTEN__
-      if ((top=(DISKIN_INST **)
-           csound->QueryGlobalVariable(csound,
-                                       "DISKIN_INST_ARRAY")) == NULL){
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_INST_ARRAY", sizeof(DISKIN_INST *));
-        top = (DISKIN_INST **) csound->QueryGlobalVariable(csound,
-                                                           "DISKIN_INST_ARRAY");
-        *top = (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_PTHREAD_ARRAY", sizeof(pthread_t));
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_THREAD_START_ARRAY", sizeof(int));
-        current = *top;
-      }
-      else
-#endif
-        {
-          current = *top;
-          while(current->nxt != NULL) { /* find next empty slot in chain */
-            current = current->nxt;
-          }
-          current->nxt =
-            (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-          current = current->nxt;
-        }
-      current->csound = csound;
-      current->diskin =  (DISKIN2 *) p;
-      current->nxt = NULL;
-
-#ifndef __EMSCRIPTEN__
-      if (*(start =
-            csound->QueryGlobalVariable(csound,
-                                        "DISKIN_THREAD_START_ARRAY")) == 0) {
-        void *diskin_io_thread(void *p);
-        *start = 1;
-        pthread_create((pthread_t *)csound->QueryGlobalVariable(csound,
-                                                       "DISKIN_PTHREAD_ARRAY"),
-                       NULL, diskin_io_thread_array, *top);
-      }
-#endif
+      p->aOut_pending = p->aOut_pos = 0;
+      /* prime the ring so that playback starts without a gap */
+      diskin_file_fill_array(csound, p);
+      p->wake = wake;
+      diskin2_io_add(csound, wake, &(p->io), p);
       csound->RegisterDeinitCallback(csound, (DISKIN2 *) p,
                                      diskin2_async_deinit_array);
       p->async = 1;
@@ -1961,11 +2050,11 @@ int diskin2_perf_asynchronous_array(CSOUND *csound, DISKIN2_ARRAY *p)
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t nn, nsmps = CS_KSMPS, ksmps = CS_KSMPS;
-    MYFLT samp;
-    int chn;
-    void *cb = p->cb;
+    int chn, i, n;
+    void *cb = p->cb, *ptr;
     int chans = p->nChannels;
     MYFLT *aOut = (MYFLT *) p->aOut->data;
+    MYFLT *frames, scl = csound->e0dbfs;
 
     if (offset || early) {
       for (chn = 0; chn < chans; chn++)
@@ -1979,16 +2068,28 @@ int diskin2_perf_asynchronous_array(CSOUND *csound, DISKIN2_ARRAY *p)
       return csound->PerfError(csound, p->h.insdshead,
                                Str("diskin2: not initialised"));
     }
-    for (nn = offset; nn < nsmps; nn++){
-
+    /* deinterleave straight out of the ring, at most two segments */
+    nn = offset;
+    while (nn < nsmps &&
+           (n = csound->AcquireReadCircularBuffer(csound, cb, &ptr,
+                                                  (int) (nsmps - nn))) > 0) {
+      frames = (MYFLT *) ptr;
       for (chn = 0; chn < chans; chn++) {
-        //int i =0;
-        //do {
-        // i =
-        csound->ReadCircularBuffer(csound, cb, &samp, 1);
-        //} while(i==0);
-        aOut[chn*ksmps+nn] = csound->e0dbfs*samp;
+        MYFLT *out = &(aOut[chn*ksmps+nn]);
+        for (i = 0; i < n; i++)
+          out[i] = scl * frames[i * chans + chn];
       }
+      csound->CommitReadCircularBuffer(csound, cb, n);
+      nn += n;
+      p->consumed += n;
+    }
+    /* io thread fell behind: output silence rather than stale data */
+    for (chn = 0; chn < chans; chn++)
+      for (i = nn; i < (int) nsmps; i++)
+        aOut[chn*ksmps+i] = FL(0.0);
+    if (p->consumed >= p->lowWater) {
+      p->consumed = 0;
+      diskin2_wake_io(csound, (DISKIN_WAKE *) p->wake);
     }
     return OK;
 }
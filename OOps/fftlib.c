@@ -3201,8 +3201,15 @@ static inline int ConvertFFTSize(CSOUND *csound, int N)
 static inline void getTablePointers(CSOUND *p, MYFLT **ct, int16 **bt,
                                     int cn, int bn)
 {
-  if (!(p->FFT_max_size & (1 << cn)))
-    fftInit(p, cn);
+  if (UNLIKELY(!(p->FFT_max_size & (1 << cn)))) {
+    /* instances may be set up from more than one thread */
+    if (p->fftPlanLock != NULL)
+      csoundLockMutex(p->fftPlanLock);
+    if (!(p->FFT_max_size & (1 << cn)))
+      fftInit(p, cn);
+    if (p->fftPlanLock != NULL)
+      csoundUnlockMutex(p->fftPlanLock);
+  }
   *ct = ((MYFLT**) p->FFT_table_1)[cn];
   *bt = ((int16**) p->FFT_table_2)[bn];
 }
@@ -3359,6 +3366,7 @@ typedef struct _FFT_SETUP{
   MYFLT *buffer;
   int    lib;
   int    d;
+  struct _FFT_PLAN *plan;
 } CSOUND_FFT_SETUP;
 
 
@@ -3427,27 +3435,128 @@ void *align_alloc(CSOUND *csound, size_t nb_bytes){
   return p;
 }
 
-int setupDispose(CSOUND *csound, void *pp){
-  CSOUND_FFT_SETUP *setup =(CSOUND_FFT_SETUP *) pp;
-  switch(setup->lib){
+static void align_free(CSOUND *csound, void *p){
+  if (p != NULL)
+    csound->Free(csound, *((void **) p - 1));
+}
+
+/*
+  Plan cache. The backend setups (pffft twiddles, vDSP state) depend only
+  on the FFT size and backend, so one is made for each pair and shared by
+  all the handles that csoundRealFFT2Setup() gives out, which only keep
+  the direction and a work buffer of their own (handles may be used from
+  different threads). The plans count the handles that use them; one no
+  longer in use is kept until a plan has to be made for another size, so
+  that an instance set up again for the same size finds it, and all are
+  freed at reset. The tables of the built-in FFT are already kept per
+  engine, and only need the lock while they are made.
+*/
+typedef struct _FFT_PLAN {
+  int    N, M;
+  int    lib;
+  int    refcount;
+  void   *setup;
+  struct _FFT_PLAN *nxt;
+} CSOUND_FFT_PLAN;
+
+static void planDestroy(CSOUND_FFT_PLAN *plan){
+  switch(plan->lib){
 #if defined(__MACH__) && !defined(IOS)
   case VDSP_LIB:
-    vDSP_destroy_fftsetupD(
 #ifdef USE_DOUBLE
-                           (FFTSetupD)
+    vDSP_destroy_fftsetupD((FFTSetupD) plan->setup);
 #else
-                           (FFTSetup)
+    vDSP_destroy_fftsetup((FFTSetup) plan->setup);
 #endif
-                           setup->setup);
     break;
 #endif
   case PFFT_LIB:
-    pffft_destroy_setup((PFFFT_Setup *)setup->setup);
+    pffft_destroy_setup((PFFFT_Setup *) plan->setup);
     break;
   }
+}
+
+static int planCacheDispose(CSOUND *csound, void *pp){
+  CSOUND_FFT_PLAN *plan = (CSOUND_FFT_PLAN *) csound->fftPlans, *nxt;
+  IGN(pp);
+  while(plan != NULL){
+    nxt = plan->nxt;
+    planDestroy(plan);
+    csound->Free(csound, plan);
+    plan = nxt;
+  }
+  csound->fftPlans = NULL;
+  csound->fftPlansReset = 0;
   return OK;
 }
 
+static inline void planLock(CSOUND *csound){
+  if(csound->fftPlanLock != NULL)
+    csoundLockMutex(csound->fftPlanLock);
+}
+
+static inline void planUnlock(CSOUND *csound){
+  if(csound->fftPlanLock != NULL)
+    csoundUnlockMutex(csound->fftPlanLock);
+}
+
+static CSOUND_FFT_PLAN *planAcquire(CSOUND *csound, int FFTsize, int lib){
+  CSOUND_FFT_PLAN *plan, **pp;
+  planLock(csound);
+  for(plan = (CSOUND_FFT_PLAN *) csound->fftPlans;
+      plan != NULL; plan = plan->nxt)
+    if(plan->N == FFTsize && plan->lib == lib){
+      plan->refcount++;
+      planUnlock(csound);
+      return plan;
+    }
+  /* a miss: drop the plans nobody uses */
+  for(pp = (CSOUND_FFT_PLAN **) &csound->fftPlans; *pp != NULL; ){
+    plan = *pp;
+    if(plan->refcount <= 0){
+      *pp = plan->nxt;
+      planDestroy(plan);
+      csound->Free(csound, plan);
+    }
+    else pp = &plan->nxt;
+  }
+  plan = (CSOUND_FFT_PLAN *)
+    csound->Calloc(csound, sizeof(CSOUND_FFT_PLAN));
+  plan->N = FFTsize;
+  plan->lib = lib;
+  plan->refcount = 1;
+  switch(lib){
+#if defined(__MACH__) && !defined(IOS)
+  case VDSP_LIB:
+    plan->M = ConvertFFTSize(csound, FFTsize);
+    plan->setup = (void *)
+#ifdef USE_DOUBLE
+      vDSP_create_fftsetupD(plan->M,kFFTRadix2);
+#else
+      vDSP_create_fftsetup(plan->M,kFFTRadix2);
+#endif
+    break;
+#endif
+  case PFFT_LIB:
+    plan->setup = (void *) pffft_new_setup(FFTsize,PFFFT_REAL);
+    break;
+  }
+  if(!csound->fftPlansReset){
+    csound->RegisterResetCallback(csound, NULL, planCacheDispose);
+    csound->fftPlansReset = 1;
+  }
+  plan->nxt = (CSOUND_FFT_PLAN *) csound->fftPlans;
+  csound->fftPlans = (void *) plan;
+  planUnlock(csound);
+  return plan;
+}
+
+static void planRelease(CSOUND *csound, CSOUND_FFT_PLAN *plan){
+  planLock(csound);
+  plan->refcount--;
+  planUnlock(csound);
+}
+
 void *csoundRealFFT2Setup(CSOUND *csound,
                          int FFTsize,
                          int d){
@@ -3468,22 +3577,18 @@ void *csoundRealFFT2Setup(CSOUND *csound,
   switch(lib){
 #if defined(__MACH__) && !defined(IOS)
   case VDSP_LIB:
-    setup->M = ConvertFFTSize(csound, FFTsize);
-    setup->setup = (void *)
-#ifdef USE_DOUBLE
-      vDSP_create_fftsetupD(setup->M,kFFTRadix2);
-#else
-      vDSP_create_fftsetup(setup->M,kFFTRadix2);
-#endif
-      setup->d = (d ==  FFT_FWD ?
+    setup->plan = planAcquire(csound, FFTsize, lib);
+    setup->setup = setup->plan->setup;
+    setup->M = setup->plan->M;
+    setup->d = (d ==  FFT_FWD ?
                 kFFTDirection_Forward :
                 kFFTDirection_Inverse);
     setup->lib = lib;
     break;
 #endif
   case PFFT_LIB:
-    setup->setup = (void *)
-      pffft_new_setup(FFTsize,PFFFT_REAL);
+    setup->plan = planAcquire(csound, FFTsize, lib);
+    setup->setup = setup->plan->setup;
     setup->d = (d ==  FFT_FWD ?
                 PFFFT_FORWARD :
                 PFFFT_BACKWARD);
@@ -3495,12 +3600,22 @@ void *csoundRealFFT2Setup(CSOUND *csound,
     return (void *) setup;
   }
   setup->buffer = (MYFLT *) align_alloc(csound, sizeof(MYFLT)*FFTsize);
-  csound->RegisterResetCallback(csound, (void*) setup,
-                                (int (*)(CSOUND *, void *))
-                                setupDispose);
   return (void *) setup;
 }
 
+void csoundRealFFT2Release(CSOUND *csound, void *p){
+  CSOUND_FFT_SETUP *setup = (CSOUND_FFT_SETUP *) p;
+  if(setup == NULL)
+    return;
+  if(setup->plan != NULL){
+    planRelease(csound, setup->plan);
+    align_free(csound, setup->buffer);
+  }
+  else if(setup->buffer != NULL)     /* DCT work buffer */
+    csound->Free(csound, setup->buffer);
+  csound->Free(csound, setup);
+}
+
 void csoundRealFFT2(CSOUND *csound,
                      void *p, MYFLT *sig){
   CSOUND_FFT_SETUP *setup =
@@ -988,6 +988,20 @@ int pvoc_fseek(CSOUND *csound, int ifd, int offset)
     return 0;
 }
 
+/* full path name of an open file, and byte offset of its frame data */
+
+const char *pvoc_datalocation(CSOUND *csound, int ifd, int32 *offset)
+{
+    PVOCFILE  *p = pvsys_getFileHandle(csound, ifd);
+
+    if (UNLIKELY(p == NULL || p->fd == NULL)) {
+      csound->pvErrorCode = -38;
+      return NULL;
+    }
+    *offset = p->datachunkoffset;
+    return csound->GetFileName(p->fd);
+}
+
 /* may be more to do in here later on */
 
 int pvsys_release(CSOUND *csound)
@@ -35,8 +35,81 @@ static  void    hamming(MYFLT *win, int winLen, int even);
 static  void    vonhann(MYFLT *win, int winLen, int even);
 
 static  void    generate_frame(CSOUND *, PVSANAL *p);
+        int     pvsanalset(CSOUND *, PVSANAL *p);
 static  void    process_frame(CSOUND *, PVSYNTH *p);
 
+/* The sliding analysis and synthesis call kernels from pvsanal_kernels.h,
+   compiled once for the baseline instruction set of the build and, where
+   the compiler supports them, for AVX2 and AVX-512; the widest set the
+   CPU has is selected on first use. */
+
+#define KERNEL      static
+#define KNAME(x)    x##_generic
+#include "pvsanal_kernels.h"
+#undef KNAME
+#undef KERNEL
+
+typedef struct {
+    void (*sdft_anal)(SDFT *, SDFT_PART *);
+    void (*sdft_synth)(const CMPLX *, double *, double *, int32, int32, double);
+} SDFT_KERNELS;
+
+static const SDFT_KERNELS kernels_generic = {
+    sdft_anal_generic, sdft_synth_generic
+};
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#define HAVE_AVX2_KERNELS 1
+#define KERNEL      static __attribute__ ((target ("avx2")))
+#define KNAME(x)    x##_avx2
+#include "pvsanal_kernels.h"
+#undef KNAME
+#undef KERNEL
+
+static const SDFT_KERNELS kernels_avx2 = {
+    sdft_anal_avx2, sdft_synth_avx2
+};
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    !defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 8
+#define HAVE_AVX512_KERNELS 1
+#define KERNEL      static \
+                    __attribute__ ((target ("avx512f,prefer-vector-width=512")))
+#define KNAME(x)    x##_avx512
+#include "pvsanal_kernels.h"
+#undef KNAME
+#undef KERNEL
+
+static const SDFT_KERNELS kernels_avx512 = {
+    sdft_anal_avx512, sdft_synth_avx512
+};
+#endif
+
+static const SDFT_KERNELS *volatile kernels = NULL;
+
+static const SDFT_KERNELS *get_kernels(void)
+{
+    const SDFT_KERNELS *k = kernels;
+    if (UNLIKELY(k == NULL)) {
+      k = &kernels_generic;
+#if defined(HAVE_AVX2_KERNELS) || defined(HAVE_AVX512_KERNELS)
+      __builtin_cpu_init();
+#endif
+#ifdef HAVE_AVX2_KERNELS
+      if (__builtin_cpu_supports("avx2"))
+        k = &kernels_avx2;
+#endif
+#ifdef HAVE_AVX512_KERNELS
+      if (__builtin_cpu_supports("avx512f"))
+        k = &kernels_avx512;
+#endif
+      kernels = k;          /* every thread arrives at the same answer */
+    }
+    return k;
+}
+
 /* generate half-window */
 
 static CS_NOINLINE int PVS_CreateWindow(CSOUND *csound, MYFLT *buf,
@@ -94,18 +167,204 @@ static CS_NOINLINE int PVS_CreateWindow(CSOUND *csound, MYFLT *buf,
 }
 
 
+/* Sliding analysis (SDFT): the transform is brought up to date at every
+   sample, by rotating each bin after adding the change in the input.
+   The bins analysed may be limited to those from lobin to hibin (the
+   others have amplitude 0 and the frequency of the middle of the bin);
+   their transform, and the two bins either side needed by the window,
+   is split in partitions of at least SDFT_MINPART bins, up to one per
+   thread csound was given.  The performance thread computes the first
+   and hands the others to worker threads, one fewer than csound was
+   given, which the instances of the engine share; they are started by
+   the first instance to need them and stopped on reset, so that notes
+   neither start nor join threads.  A partition no worker has taken by
+   the time the first is done is computed in line. */
+
+#define SDFT_MINPART    256
+#define SDFT_POOL_GLOBAL "pvsanal::sdft_pool"
+
+typedef struct {
+    CSOUND  *csound;
+    int     nthreads;
+    void    *thread[SDFT_MAXPARTS];
+    void    *mutex, *wake, *done;
+    SDFT_PART *top;             /* partitions posted and not yet taken */
+    volatile int running;
+} SDFT_POOL;
+
+static uintptr_t sdft_worker(void *arg)
+{
+    SDFT_POOL *w = (SDFT_POOL *) arg;
+    CSOUND  *csound = w->csound;
+    const SDFT_KERNELS *k = get_kernels();
+    SDFT_PART *q;
+    int     more;
+
+    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+    while (w->running) {
+      csound->LockMutex(w->mutex);
+      if ((q = w->top) != NULL)
+        w->top = q->nxt;
+      more = (w->top != NULL);
+      csound->UnlockMutex(w->mutex);
+      if (q == NULL) {
+        csound->WaitThreadLock(w->wake, (size_t) 100);
+        continue;
+      }
+      if (more)
+        csound->NotifyThreadLock(w->wake);      /* for the next worker */
+      k->sdft_anal(q->sd, q);
+      csound->LockMutex(w->mutex);
+      q->sd->remaining--;
+      csound->UnlockMutex(w->mutex);
+      csound->NotifyThreadLock(w->done);
+    }
+    return (uintptr_t) 0;
+}
+
+static int sdft_pool_stop(CSOUND *csound, void *pp)
+{
+    SDFT_POOL *w = (SDFT_POOL *) pp;
+    int     k;
+
+    w->running = 0;
+    for (k = 0; k < w->nthreads; k++)
+      csound->NotifyThreadLock(w->wake);
+    for (k = 0; k < w->nthreads; k++)
+      csound->JoinThread(w->thread[k]);
+    csound->DestroyThreadLock(w->wake);
+    csound->DestroyThreadLock(w->done);
+    csound->DestroyMutex(w->mutex);
+    return OK;
+}
+
+/* the workers, started on first use; NULL if none could be */
+
+static SDFT_POOL *sdft_pool(CSOUND *csound)
+{
+    SDFT_POOL *w;
+    int     k, n;
+
+    w = (SDFT_POOL *) csound->QueryGlobalVariable(csound, SDFT_POOL_GLOBAL);
+    if (w != NULL)
+      return (w->nthreads > 0 ? w : NULL);
+    if (UNLIKELY(csound->CreateGlobalVariable(csound, SDFT_POOL_GLOBAL,
+                                              sizeof(SDFT_POOL)) != 0))
+      return NULL;
+    w = (SDFT_POOL *) csound->QueryGlobalVariable(csound, SDFT_POOL_GLOBAL);
+    w->csound = csound;
+    w->running = 1;
+    w->mutex = csound->Create_Mutex(0);
+    w->wake = csound->CreateThreadLock();
+    w->done = csound->CreateThreadLock();
+    csound->WaitThreadLock(w->wake, (size_t) 0);        /* unsignalled */
+    n = csound->oparms->numThreads - 1;
+    if (n > SDFT_MAXPARTS - 1)
+      n = SDFT_MAXPARTS - 1;
+    for (k = 0; k < n; k++) {
+      w->thread[k] = csound->CreateThread(sdft_worker, (void *) w);
+      if (UNLIKELY(w->thread[k] == NULL)) {
+        csound->Warning(csound, Str("pvsanal: could not start worker thread, "
+                                    "computing the bins in line"));
+        break;
+      }
+    }
+    w->nthreads = k;
+    csound->RegisterResetCallback(csound, (void *) w, sdft_pool_stop);
+    return (k > 0 ? w : NULL);
+}
+
+static void sdft_window(CSOUND *csound, SDFT *sd, int wintype)
+{
+    /* Rectang :Fw_t =     F_t                          */
+    /* Hamming :Fw_t = 0.54F_t - 0.23[ F_{t-1}+F_{t+1}] */
+    /* Hann    :Fw_t = 0.5 F_t - 0.25[ F_{t-1}+F_{t+1}] */
+    /* Blackman:Fw_t = 0.42F_t - 0.25[ F_{t-1}+F_{t+1}]+0.04[F_{t-2}+F_{t+2}] */
+    /* Blackman_exact:Fw_t = 0.42659071367153912296F_t
+       - 0.24828030954428202923 [F_{t-1}+F_{t+1}]
+       + 0.038424333619948409286 [F_{t-2}+F_{t+2}]      */
+    /* Nuttall_C3:Fw_t = 0.375  F_t - 0.25[ F_{t-1}+F_{t+1}] +
+                                    0.0625 [F_{t-2}+F_{t+2}] */
+    /* BHarris_3:Fw_t = 0.44959 F_t - 0.24682[ F_{t-1}+F_{t+1}] +
+                                    0.02838 [F_{t-2}+F_{t+2}] */
+    /* BHarris_min:Fw_t = 0.42323 F_t - 0.2486703 [ F_{t-1}+F_{t+1}] +
+                                    0.0391396 [F_{t-2}+F_{t+2}] */
+    sd->nterms = 5;
+    sd->avg1 = 0;
+    sd->a2 = FL(0.0);
+    switch (wintype) {
+    case PVS_WIN_HAMMING:
+      sd->nterms = 3;
+      sd->a0 = FL(0.54); sd->a1 = FL(0.23);
+      break;
+    case PVS_WIN_HANN:
+      sd->nterms = 3;
+      sd->a0 = FL(0.5); sd->a1 = FL(0.25);
+      break;
+    default:
+      csound->Warning(csound,
+                      Str("Unknown window type; replaced by rectangular\n"));
+      /* fall through */
+    case PVS_WIN_RECT:
+      sd->nterms = 1;
+      sd->a0 = FL(1.0); sd->a1 = FL(0.0);
+      break;
+    case PVS_WIN_BLACKMAN:
+      sd->a0 = FL(0.42); sd->a1 = FL(0.25); sd->a2 = FL(0.04);
+      break;
+    case PVS_WIN_BLACKMAN_EXACT:
+      sd->a0 = FL(0.42659071367153912296);
+      sd->a1 = FL(0.49656061908856405847)*FL(0.5);
+      sd->a2 = FL(0.076848667239896818573)*FL(0.5);
+      break;
+    case PVS_WIN_NUTTALLC3:
+      sd->a0 = FL(0.375); sd->a1 = FL(0.5)*FL(0.5); sd->a2 = FL(0.125)*FL(0.5);
+      sd->avg1 = 1;
+      break;
+    case PVS_WIN_BHARRIS_3:
+      sd->a0 = FL(0.44959);
+      sd->a1 = FL(0.49364)*FL(0.5); sd->a2 = FL(0.05677)*FL(0.5);
+      sd->avg1 = 1;
+      break;
+    case PVS_WIN_BHARRIS_MIN:
+      sd->a0 = FL(0.42323);
+      sd->a1 = FL(0.4973406)*FL(0.5); sd->a2 = FL(0.0782793)*FL(0.5);
+      sd->avg1 = 1;
+      break;
+    }
+    sd->e1 = sd->a1 + sd->a1;
+    sd->e2 = sd->a2 + sd->a2;
+}
+
+#define SDFT_ALIGN(n)   (((n) + (size_t) 63) & ~((size_t) 63))
+
 int pvssanalset(CSOUND *csound, PVSANAL *p)
 {
     /* opcode params */
     int N = (int) (FL(0.5)+*(p->winsize));
     int NB;
-    int i;
+    int i, j, k;
     int wintype = (int) (FL(0.5)+*p->wintype);
+    int lo = (int) *p->lobin, hi = (int) *p->hibin;
+    int elo, ehi, nparts, nbins;
+    double *c, *s;
+    SDFT *sd;
+    char *mem;
+    MYFLT *state;
 
     /* deal with iinit and iformat later on! */
 
     N = N + N%2;               /* Make N even */
     NB = N/2+1;                 /* Number of bins */
+    if (hi <= 0 || hi > NB-1) hi = NB-1;
+    if (lo < 0) lo = 0;
+    if (UNLIKELY(lo > hi))
+      return csound->InitError(csound,
+                               Str("pvsanal: no bins from %d to %d\n"), lo, hi);
+    if (UNLIKELY(NB < 5))
+      return csound->InitError(csound,
+                               Str("pvsanal: window of %d is too small "
+                                   "for sliding\n"), N);
 
     /* Need space for NB complex numbers for each of ksmps */
     if (p->fsig->frame.auxp==NULL ||
@@ -118,25 +377,21 @@ int pvssanalset(CSOUND *csound, PVSANAL *p)
       csound->AuxAlloc(csound, N*sizeof(MYFLT),&p->input);
     else memset(p->input.auxp, 0, N*sizeof(MYFLT));
     csound->AuxAlloc(csound, NB * sizeof(double), &p->oldInPhase);
-   if (p->analwinbuf.auxp==NULL ||
-        NB*sizeof(CMPLX) > (unsigned int)p->analwinbuf.size)
-      csound->AuxAlloc(csound, NB*sizeof(CMPLX),&p->analwinbuf);
-    else memset(p->analwinbuf.auxp, 0, NB*sizeof(CMPLX));
     p->inptr = 0;                 /* Pointer in circular buffer */
     p->fsig->NB = p->Ii = NB;
     p->fsig->wintype = wintype;
     p->fsig->format = PVS_AMP_FREQ;      /* only this, for now */
     p->fsig->N = p->nI  = N;
     p->fsig->sliding = 1;
-    /* Need space for NB sines, cosines and a scatch phase area */
+    /* Need space for NB sines and cosines */
     if (p->trig.auxp==NULL ||
         (2*NB)*sizeof(double) > (unsigned int)p->trig.size)
       csound->AuxAlloc(csound,(2*NB)*sizeof(double),&p->trig);
     {
       double dc = cos(TWOPI/(double)N);
       double ds = sin(TWOPI/(double)N);
-      double *c = (double *)(p->trig.auxp);
-      double *s = c+NB;
+      c = (double *)(p->trig.auxp);
+      s = c+NB;
       p->cosine = c;
       p->sine = s;
       c[0] = 1.0; s[0] = 0.0; // assignment to s unnecessary as auxalloc zeros
@@ -152,13 +407,105 @@ int pvssanalset(CSOUND *csound, PVSANAL *p)
           c[i] = dc*c[i-1] - ds*s[i-1];
           s[i] = ds*c[i-1] + dc*s[i-1];
       }
-/*       for (i=0; i<NB; i++)  */
-/*         printf("c[%d] = %f   \ts[%d] = %f\n", i, c[i], i, s[i]); */
+    }
+    /* bins not analysed: nothing at the middle of the bin */
+    for (i = 0; i < (int) CS_KSMPS; i++) {
+      CMPLX *ff = (CMPLX*)(p->fsig->frame.auxp) + i*NB;
+      for (j = 0; j < NB; j++)
+        if (j < lo || j > hi)
+          ff[j].im = (MYFLT) ((double) j * csound->esr / N);
+    }
+
+    /* the partitions, of the bins analysed and the two either side */
+    elo = (lo > 2 ? lo - 2 : 0);
+    ehi = (hi + 3 < NB ? hi + 3 : NB);
+    nparts = csound->oparms->numThreads;
+    if (nparts > (ehi - elo) / SDFT_MINPART)
+      nparts = (ehi - elo) / SDFT_MINPART;
+    if (nparts > SDFT_MAXPARTS)
+      nparts = SDFT_MAXPARTS;
+    if (nparts < 1)
+      nparts = 1;
+    nbins = ehi - elo + 4 * nparts;
+    csound->AuxAlloc(csound, SDFT_ALIGN(sizeof(SDFT)) +
+                     SDFT_ALIGN(CS_KSMPS * sizeof(MYFLT)) +
+                     nbins * (2 * sizeof(double) + 4 * sizeof(MYFLT)),
+                     &p->sdft);
+    sd = (SDFT *) p->sdft.auxp;
+    mem = (char *) sd + SDFT_ALIGN(sizeof(SDFT));
+    sd->csound = csound;
+    sd->N = N;
+    sd->NB = NB;
+    sd->esr = (double) csound->esr;
+    sd->h = (double *) p->oldInPhase.auxp;
+    sd->dx = (MYFLT *) mem;
+    mem += SDFT_ALIGN(CS_KSMPS * sizeof(MYFLT));
+    sd->nparts = nparts;
+    sd->pool = (nparts > 1 ? (void *) sdft_pool(csound) : NULL);
+    sd->remaining = 0;
+    sd->state = state = (MYFLT *) (mem + nbins * 2 * sizeof(double));
+    sd->stateSize = 2 * nbins;
+    sdft_window(csound, sd, wintype);
+    for (k = 0; k < nparts; k++) {
+      SDFT_PART *q = &sd->part[k];
+      int plo = elo + (ehi - elo) * k / nparts;
+      int phi = elo + (ehi - elo) * (k + 1) / nparts;
+      q->sd = sd;
+      q->base = plo - 2;
+      q->len = phi - plo + 4;
+      q->o0 = (plo > lo ? plo : lo) - q->base;
+      q->o1 = (phi < hi + 1 ? phi : hi + 1) - q->base;
+      if (q->o1 < q->o0)
+        q->o1 = q->o0;
+      q->c = (double *) mem;
+      q->s = q->c + q->len;
+      mem += 2 * q->len * sizeof(double);
+      for (i = 0; i < q->len; i++) {
+        j = q->base + i;
+        if (j >= elo && j < ehi) {
+          q->c[i] = c[j];
+          q->s[i] = s[j];
+        }
+      }
+      q->re = state;
+      q->im = state + q->len;
+      state += 2 * q->len;
+    }
+    for (k = 0; k < nparts; k++) {      /* scratch, after the state */
+      SDFT_PART *q = &sd->part[k];
+      q->yr = state;
+      q->yi = state + q->len;
+      state += 2 * q->len;
     }
     return OK;
 }
 
-int pvsanalset(CSOUND *csound, PVSANAL *p)
+/* the bins either side of each partition, from its neighbours */
+
+static void sdft_halos(SDFT *sd)
+{
+    int k, b;
+
+    for (k = 0; k < sd->nparts; k++) {
+      SDFT_PART *q = &sd->part[k];
+      if (k > 0) {
+        const SDFT_PART *l = &sd->part[k-1];
+        for (b = 0; b < 2; b++) {
+          q->re[b] = l->re[q->base + b - l->base];
+          q->im[b] = l->im[q->base + b - l->base];
+        }
+      }
+      if (k < sd->nparts - 1) {
+        const SDFT_PART *r = &sd->part[k+1];
+        for (b = q->len - 2; b < q->len; b++) {
+          q->re[b] = r->re[q->base + b - r->base];
+          q->im[b] = r->im[q->base + b - r->base];
+        }
+      }
+    }
+}
+
+static int pvsanalset_(CSOUND *csound, PVSANAL *p)
 {
     MYFLT *analwinhalf,*analwinbase;
     MYFLT sum;
@@ -262,57 +609,102 @@ int pvsanalset(CSOUND *csound, PVSANAL *p)
     p->fsig->format = PVS_AMP_FREQ;      /* only this, for now */
     p->fsig->sliding = 0;
 
+    csound->RealFFT2Release(csound, p->setup);
+    p->setup = NULL;
     if (!(N & (N - 1))) /* if pow of two use this */
-     p->setup = csound->RealFFT2Setup(csound,N,FFT_FWD);
+      p->setup = csound->RealFFT2Setup(csound,N,FFT_FWD);
     return OK;
 }
 
-static void generate_frame(CSOUND *csound, PVSANAL *p)
+/* Several pvsanal of an instrument on the same signal with the same
+   parameters do the same analysis: a pvsanal that follows another on the
+   same input variable copies the frames of the first instead.  It keeps
+   its own input buffer (or, sliding, copies the whole state), so it can
+   carry on alone as soon as its input is not the one the first was
+   given, as when the variable is written in between, or one of them is
+   not performed on a cycle the other is; it does not go back to sharing
+   after that.  Only the opcodes of one instance are searched: those of
+   other instances may be performed at the same time as this one by the
+   threads of the engine, and would have to be waited for. */
+
+static void find_shared(CSOUND *csound, PVSANAL *p)
+{
+    OPDS    *o;
+    PVSANAL *q;
+
+    for (o = p->h.insdshead->nxti; o != NULL && o != &(p->h); o = o->nxti) {
+      if (o->iopadr != (SUBR) pvsanalset)
+        continue;
+      q = (PVSANAL *) o;
+      if (q->share != NULL || q->input.auxp == NULL || q->ain != p->ain ||
+          *q->fftsize != *p->fftsize || *q->overlap != *p->overlap ||
+          *q->winsize != *p->winsize || *q->wintype != *p->wintype ||
+          *q->lobin != *p->lobin || *q->hibin != *p->hibin ||
+          q->fsig->sliding != p->fsig->sliding || q->fsig->N != p->fsig->N)
+        continue;
+      if (q->inblk.auxp == NULL ||
+          CS_KSMPS*sizeof(MYFLT) > (unsigned int)q->inblk.size)
+        csound->AuxAlloc(csound, CS_KSMPS*sizeof(MYFLT), &q->inblk);
+      q->followed = 1;
+      p->share = q;
+      return;
+    }
+}
+
+int pvsanalset(CSOUND *csound, PVSANAL *p)
+{
+    int ret = pvsanalset_(csound, p);
+
+    p->share = NULL;
+    p->followed = 0;
+    p->runs = 0;
+    if (ret == OK)
+      find_shared(csound, p);
+    return ret;
+}
+
+/* at the start of a performance: still the input of the one shared? */
+
+static void check_shared(CSOUND *csound, PVSANAL *p)
+{
+    PVSANAL *q = (PVSANAL *) p->share;
+
+    if (q->runs != p->runs + 1 ||
+        memcmp(q->inblk.auxp, p->ain, CS_KSMPS*sizeof(MYFLT)) != 0)
+      p->share = NULL;
+}
+
+/* analysis: The analysis subroutine computes the complex output at
+   time n of (N/2 + 1) of the phase vocoder channels.  It operates
+   on input samples (n - analWinLen) thru (n + analWinLen) and
+   expects to find these in input[(n +- analWinLen) mod ibuflen].
+   It expects analWindow to point to the center of a
+   symmetric window of length (2 * analWinLen +1).  It is the
+   responsibility of the main program to ensure that these values
+   are correct!  The results are returned in anal as succesive
+   pairs of real and imaginary values for the lowest (N/2 + 1)
+   channels.   The subroutines fft and reals together implement
+   one efficient FFT call for a real input sequence.
+
+   The windowing is done in runs in which neither the input nor the
+   output position wraps, and the phase unwrapping in a pass of its own
+   after the magnitudes and phases, so that both loops can be
+   vectorised. */
+
+static void analyse_frame(CSOUND *csound, PVSANAL *p)
 {
-  int got, tocp,i,j,k,ii;
+    int i,j,k,m,n,ii;
     int N = p->fsig->N;
     int N2 = N/2;
     int32 buflen = p->buflen;
     int32 analWinLen = p->fsig->winsize/2;
-    int32 synWinLen = analWinLen;
     float *ofp;                 /* RWD MUST be 32bit */
-    MYFLT *fp;
     MYFLT *anal = (MYFLT *) (p->analbuf.auxp);
     MYFLT *input = (MYFLT *) (p->input.auxp);
     MYFLT *analWindow = (MYFLT *) (p->analwinbuf.auxp) + analWinLen;
     MYFLT *oldInPhase = (MYFLT *) (p->oldInPhase.auxp);
     MYFLT angleDif,real,imag,phase;
-    double rratio;
-
-    got = p->fsig->overlap;      /*always assume */
-    fp = (MYFLT *) (p->overlapbuf.auxp);
-    tocp = (got<= input + buflen - p->nextIn ? got : input + buflen - p->nextIn);
-    got -= tocp;
-    while (tocp-- > 0)
-      *(p->nextIn++) = *fp++;
-
-    if (got > 0) {
-      p->nextIn -= buflen;
-      while (got-- > 0)
-        *p->nextIn++ = *fp++;
-    }
-    if (p->nextIn >= (input + buflen))
-      p->nextIn -= buflen;
 
-    /* analysis: The analysis subroutine computes the complex output at
-       time n of (N/2 + 1) of the phase vocoder channels.  It operates
-       on input samples (n - analWinLen) thru (n + analWinLen) and
-       expects to find these in input[(n +- analWinLen) mod ibuflen].
-       It expects analWindow to point to the center of a
-       symmetric window of length (2 * analWinLen +1).  It is the
-       responsibility of the main program to ensure that these values
-       are correct!  The results are returned in anal as succesive
-       pairs of real and imaginary values for the lowest (N/2 + 1)
-       channels.   The subroutines fft and reals together implement
-       one efficient FFT call for a real input sequence.  */
-
-    /* for (i = 0; i < N+2; i++)
-     *(anal + i) = FL(0.0);  */     /*initialize*/
     memset(anal, 0, sizeof(MYFLT)*(N+2));
 
     j = (p->nI - analWinLen - 1 + buflen) % buflen;     /*input pntr*/
@@ -321,13 +713,23 @@ static void generate_frame(CSOUND *csound, PVSANAL *p)
     while (k < 0)
       k += N;
     k = k % N;
-    for (i = -analWinLen; i <= analWinLen; i++) {
-      if (UNLIKELY(++j >= buflen))
+    if (UNLIKELY(++j >= buflen))
+      j -= buflen;
+    if (UNLIKELY(++k >= N))
+      k -= N;
+    for (i = -analWinLen, n = 2*analWinLen + 1; n > 0; i += m, n -= m) {
+      int t;
+      m = n;
+      if (m > buflen - j)
+        m = buflen - j;
+      if (m > N - k)
+        m = N - k;
+      for (t = 0; t < m; t++)
+        anal[k + t] += analWindow[i + t] * input[j + t];
+      if ((j += m) >= buflen)
         j -= buflen;
-      if (UNLIKELY(++k >= N))
+      if ((k += m) >= N)
         k -= N;
-      /* *(anal + k) += *(analWindow + i) * *(input + j); */
-      anal[k] += analWindow[i] * input[j];
     }
     if (!(N & (N - 1))) {
       /* csound->RealFFT(csound, anal, N);*/
@@ -340,70 +742,65 @@ static void generate_frame(CSOUND *csound, PVSANAL *p)
     /* conversion: The real and imaginary values in anal are converted to
        magnitude and angle-difference-per-second (assuming an
        intermediate sampling rate of rIn) and are returned in
-       anal. */
-#ifdef NOTDEF
-    /* may support this  later on */
-    if (format == PVS_AMP_PHASE) {
-      /* PVOCEX uses plain (wrapped) phase format, ref Soundhack */
-      for (i=0,i0=anal,i1=anal+1,oi=p->oldInPhase;
-           i <= N2;
-           i++,i0+=2,i1+=2, oi++) {
-        real = *i0;
-        imag = *i1;
-        *i0 = HYPOT(real, imag);
-        /* phase unwrapping */
-        /*if (*i0 == 0.)*/
-        if (UNLIKELY(*i0 < FL(1.0E-10)))
-          /* angleDif = 0.0f; */
-          phase = FL(0.0);
-
-        else {
-
-          phase = ATAN2(imag,real);
-
-          /*angleDif  = (phase = (float)rratio) - *oi;
-           *oi = phase;
-           phase = (MYFLT)rratio;
-           */
-        }
-
-        *i1 = phase;
-      }
+       anal.  A bin of no magnitude keeps its old phase. */
+    for (i=ii=0; i <= N2; i++,ii+=2) {
+      real = anal[ii];
+      imag = anal[ii+1];
+      anal[ii] = HYPOT(real, imag);
+      if (UNLIKELY(anal[ii] < FL(1.0E-10)))
+        anal[ii+1] = oldInPhase[i];
+      else
+        anal[ii+1] = (MYFLT) atan2((double)imag,(double)real);
     }
-#endif
-    /*if (format==PVS_AMP_FREQ) {*/
-    for (i=ii=0    /*,i0=anal,i1=anal+1,oi=oldInPhase*/;
-         i <= N2;
-         i++,ii+=2 /*i0+=2,i1+=2, oi++*/) {
-      real = anal[ii] /* *i0 */;
-      imag = anal[ii+1] /* *i1 */;
-      /**i0*/ anal[ii] = HYPOT(real, imag);
-      /* phase unwrapping */
-      /*if (*i0 == 0.)*/
-      if (UNLIKELY(/* *i0 */ anal[ii] < FL(1.0E-10)))
-        angleDif = FL(0.0);
-      else {
-        rratio =  atan2((double)imag,(double)real);
-        angleDif  = (phase = (MYFLT)rratio) - /**oi*/ oldInPhase[i];
-        /* *oi */ oldInPhase[i] = phase;
-      }
-
-      if (angleDif > PI_F)
-        angleDif = angleDif - TWOPI_F;
-      if (angleDif < -PI_F)
-        angleDif = angleDif + TWOPI_F;
-
+    /* phase unwrapping */
+    for (i=ii=0; i <= N2; i++,ii+=2) {
+      phase = anal[ii+1];
+      angleDif = phase - oldInPhase[i];
+      oldInPhase[i] = phase;
+      angleDif += (angleDif > PI_F ? -TWOPI_F : FL(0.0));
+      angleDif += (angleDif < -PI_F ? TWOPI_F : FL(0.0));
       /* add in filter center freq.*/
-      /* *i1 */ anal[ii+1]  = angleDif * p->RoverTwoPi + ((MYFLT) i * p->Fexact);
-
+      anal[ii+1] = angleDif * p->RoverTwoPi + ((MYFLT) i * p->Fexact);
     }
-    /* } */
     /* else must be PVOC_COMPLEX */
-    fp = anal;
     ofp = (float *) (p->fsig->frame.auxp);      /* RWD MUST be 32bit */
     for (i=0;i < N+2;i++)
-      /* *ofp++ = (float)(*fp++); */
-      ofp[i] = (float) fp[i];
+      ofp[i] = (float) anal[i];
+}
+
+static void generate_frame(CSOUND *csound, PVSANAL *p)
+{
+    int got, tocp;
+    int N = p->fsig->N;
+    int32 buflen = p->buflen;
+    int32 synWinLen = p->fsig->winsize/2;
+    MYFLT *fp;
+    MYFLT *input = (MYFLT *) (p->input.auxp);
+
+    got = p->fsig->overlap;      /*always assume */
+    fp = (MYFLT *) (p->overlapbuf.auxp);
+    tocp = (got<= input + buflen - p->nextIn ? got : input + buflen - p->nextIn);
+    got -= tocp;
+    while (tocp-- > 0)
+      *(p->nextIn++) = *fp++;
+
+    if (got > 0) {
+      p->nextIn -= buflen;
+      while (got-- > 0)
+        *p->nextIn++ = *fp++;
+    }
+    if (p->nextIn >= (input + buflen))
+      p->nextIn -= buflen;
+
+    if (p->share != NULL) {
+      /* the frame of the analysis this one shares, made this cycle */
+      PVSANAL *q = (PVSANAL *) p->share;
+      memcpy(p->fsig->frame.auxp, q->fsig->frame.auxp, (N+2)*sizeof(float));
+      memcpy(p->oldInPhase.auxp, q->oldInPhase.auxp,
+             (N/2+1)*sizeof(MYFLT));
+    }
+    else
+      analyse_frame(csound, p);
 
     p->nI += p->fsig->overlap;                          /* increment time */
     if (p->nI > (synWinLen + p->fsig->overlap))
@@ -438,34 +835,53 @@ static void anal_tick(CSOUND *csound, PVSANAL *p,MYFLT samp)
 
 }
 
-static inline double mod2Pi(double x)
+/* one cycle of the partitions, the first in line and the others on the
+   workers; those not taken by the time the first is done are taken back */
+
+static void sdft_pool_anal(CSOUND *csound, SDFT_POOL *w, SDFT *sd,
+                           const SDFT_KERNELS *kern)
 {
-    x = fmod(x,TWOPI);
-    if (x <= -PI) {
-        return x + TWOPI;
+    SDFT_PART *q, **qq;
+    int     k;
+
+    csound->LockMutex(w->mutex);
+    sd->remaining = sd->nparts - 1;
+    for (k = sd->nparts - 1; k > 0; k--) {
+      sd->part[k].nxt = w->top;
+      w->top = &sd->part[k];
     }
-    else if (x > PI) {
-        return x - TWOPI;
+    csound->UnlockMutex(w->mutex);
+    csound->NotifyThreadLock(w->wake);
+    kern->sdft_anal(sd, &sd->part[0]);
+    for (;;) {
+      csound->LockMutex(w->mutex);
+      for (qq = &(w->top); *qq != NULL && (*qq)->sd != sd; qq = &((*qq)->nxt))
+        ;
+      if ((q = *qq) != NULL)
+        *qq = q->nxt;
+      csound->UnlockMutex(w->mutex);
+      if (q == NULL)
+        break;
+      kern->sdft_anal(sd, q);
+      csound->LockMutex(w->mutex);
+      sd->remaining--;
+      csound->UnlockMutex(w->mutex);
     }
-    else
-      return x;
+    while (sd->remaining > 0)
+      csound->WaitThreadLock(w->done, (size_t) 1);
 }
 
 int pvssanal(CSOUND *csound, PVSANAL *p)
 {
     MYFLT *ain;
-    int NB = p->Ii, loc;
-    int N = p->fsig->N;
+    int loc, k;
     MYFLT *data = (MYFLT*)(p->input.auxp);
-    CMPLX *fw = (CMPLX*)(p->analwinbuf.auxp);
-    double *c = p->cosine;
-    double *s = p->sine;
-    double *h = (double*)p->oldInPhase.auxp;
+    SDFT *sd = (SDFT*)(p->sdft.auxp);
+    const SDFT_KERNELS *kern = get_kernels();
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t i, nsmps = CS_KSMPS;
-    int wintype = p->fsig->wintype;
-    if (UNLIKELY(data==NULL)) {
+    if (UNLIKELY(data==NULL || sd==NULL)) {
       return csound->PerfError(csound,p->h.insdshead,
                                Str("pvsanal: Not Initialised.\n"));
     }
@@ -473,199 +889,21 @@ int pvssanal(CSOUND *csound, PVSANAL *p)
     loc = p->inptr;             /* Circular buffer */
     nsmps -= early;
     for (i=offset; i < nsmps; i++) {
-      MYFLT re, im, dx;
-      CMPLX* ff;
-      int j;
-
-/*       printf("%d: in = %f\n", i, *ain); */
-      dx = *ain - data[loc];    /* Change in sample */
-      data[loc] = *ain++;       /* Remember input sample */
-      /* get the frame for this sample */
-      ff = (CMPLX*)(p->fsig->frame.auxp) + i*NB;
-      /* fw is the current frame at this sample */
-      for (j = 0; j < NB; j++) {
-        double ci = c[j], si = s[j];
-        re = fw[j].re + dx;
-        im = fw[j].im;
-        fw[j].re = ci*re - si*im;
-        fw[j].im = ci*im + si*re;
-      }
+      sd->dx[i] = ain[i] - data[loc];   /* Change in sample */
+      data[loc] = ain[i];               /* Remember input sample */
       loc++; if (UNLIKELY(loc==p->nI)) loc = 0; /* Circular buffer */
-      /* apply window and transfer to ff buffer*/
-      /* Rectang :Fw_t =     F_t                          */
-      /* Hamming :Fw_t = 0.54F_t - 0.23[ F_{t-1}+F_{t+1}] */
-      /* Hamming :Fw_t = 0.5 F_t - 0.25[ F_{t-1}+F_{t+1}] */
-      /* Blackman:Fw_t = 0.42F_t - 0.25[ F_{t-1}+F_{t+1}]+0.04[F_{t-2}+F_{t+2}] */
-      /* Blackman_exact:Fw_t = 0.42659071367153912296F_t
-         - 0.24828030954428202923 [F_{t-1}+F_{t+1}]
-         + 0.038424333619948409286 [F_{t-2}+F_{t+2}]      */
-      /* Nuttall_C3:Fw_t = 0.375  F_t - 0.25[ F_{t-1}+F_{t+1}] +
-                                      0.0625 [F_{t-2}+F_{t+2}] */
-      /* BHarris_3:Fw_t = 0.44959 F_t - 0.24682[ F_{t-1}+F_{t+1}] +
-                                      0.02838 [F_{t-2}+F_{t+2}] */
-      /* BHarris_min:Fw_t = 0.42323 F_t - 0.2486703 [ F_{t-1}+F_{t+1}] +
-                                      0.0391396 [F_{t-2}+F_{t+2}] */
-      switch (wintype) {
-      case PVS_WIN_HAMMING:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.54)*fw[j].re;
-          ff[j].im = FL(0.54)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.23)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.23)*(fw[j+1].im + fw[j-1].im);
-        }
-        ff[0].re -= FL(0.46)*fw[1].re;
-        ff[NB-1].re -= FL(0.46)*fw[NB-2].re;
-        break;
-      case PVS_WIN_HANN:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.5)*fw[j].re;
-          ff[j].im = FL(0.5)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.25)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.25)*(fw[j+1].im + fw[j-1].im);
-        }
-        ff[0].re -= FL(0.5)*fw[1].re;
-        ff[NB-1].re -= FL(0.5)*fw[NB-2].re;
-        break;
-      default:
-        csound->Warning(csound,
-                        Str("Unknown window type; replaced by rectangular\n"));
-      case PVS_WIN_RECT:
-        memcpy(ff, fw, NB*sizeof(CMPLX));
-        /* for (j=0; j<NB; j++) { */
-        /*   ff[j].re = fw[j].re; */
-        /*   ff[j].im = fw[j].im; */
-        /* } */
-        break;
-      case PVS_WIN_BLACKMAN:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.42)*fw[j].re;
-          ff[j].im = FL(0.42)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.25)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.25)*(fw[j+1].im + fw[j-1].im);
-        }
-        for (j=2; j<NB-2; j++) {
-          ff[j].re += FL(0.04)*(fw[j+2].re + fw[j-2].re);
-          ff[j].im += FL(0.04)*(fw[j+2].im + fw[j-2].im);
-        }
-        ff[0].re    += -FL(0.5)*fw[1].re + FL(0.08)*fw[2].re;
-        ff[NB-1].re += -FL(0.5)*fw[NB-2].re + FL(0.08)*fw[NB-3].re;
-        ff[1].re    += -FL(0.5)*fw[2].re + FL(0.08)*fw[3].re;
-        ff[NB-2].re += -FL(0.5)*fw[NB-3].re + FL(0.08)*fw[NB-4].re;
-        break;
-    case PVS_WIN_BLACKMAN_EXACT:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.42659071367153912296)*fw[j].re;
-          ff[j].im = FL(0.42659071367153912296)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.49656061908856405847)*FL(0.5)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.49656061908856405847)*FL(0.5)*(fw[j+1].im + fw[j-1].im);
-        }
-        for (j=2; j<NB-2; j++) {
-          ff[j].re += FL(0.076848667239896818573)*FL(0.5)*(fw[j+2].re + fw[j-2].re);
-          ff[j].im += FL(0.076848667239896818573)*FL(0.5)*(fw[j+2].im + fw[j-2].im);
-        }
-        ff[0].re    += -FL(0.49656061908856405847) * fw[1].re
-                      + FL(0.076848667239896818573) * fw[2].re;
-        ff[NB-1].re += -FL(0.49656061908856405847) * fw[NB-2].re
-                      + FL(0.076848667239896818573) * fw[NB-3].re;
-        ff[1].re    += -FL(0.49656061908856405847) * fw[2].re
-                      + FL(0.076848667239896818573) * fw[3].re;
-        ff[NB-2].re += -FL(0.49656061908856405847) * fw[NB-3].re
-                      + FL(0.076848667239896818573) * fw[NB-4].re;
-        break;
-      case PVS_WIN_NUTTALLC3:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.375)*fw[j].re;
-          ff[j].im = FL(0.375)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.5)*FL(0.5)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.5)*FL(0.5)*(fw[j+1].im + fw[j-1].im);
-        }
-        for (j=2; j<NB-2; j++) {
-          ff[j].re += FL(0.125)*FL(0.5)*(fw[j+2].re + fw[j-2].re);
-          ff[j].im += FL(0.125)*FL(0.5)*(fw[j+2].im + fw[j-2].im);
-        }
-        ff[0].re    += -FL(0.5) * fw[1].re    + FL(0.125) * fw[2].re;
-        ff[NB-1].re += -FL(0.5) * fw[NB-2].re + FL(0.125) * fw[NB-3].re;
-        ff[1].re    += -FL(0.5) * fw[2].re    + FL(0.125) * fw[3].re;
-        ff[NB-2].re += -FL(0.5) * fw[NB-3].re + FL(0.125) * fw[NB-4].re;
-        ff[1].re = 0.5 * (fw[2].re + fw[0].re); /* HACK???? */
-        ff[1].im = 0.5 * (fw[2].im + fw[0].im);
-        break;
-      case PVS_WIN_BHARRIS_3:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.44959)*fw[j].re;
-          ff[j].im = FL(0.44959)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.49364)*FL(0.5)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.49364)*FL(0.5)*(fw[j+1].im + fw[j-1].im);
-        }
-        for (j=2; j<NB-2; j++) {
-          ff[j].re += FL(0.05677)*FL(0.5)*(fw[j+2].re + fw[j-2].re);
-          ff[j].im += FL(0.05677)*FL(0.5)*(fw[j+2].im + fw[j-2].im);
-        }
-        ff[0].re    += -FL(0.49364) * fw[1].re    + FL(0.05677) * fw[2].re;
-        ff[NB-1].re += -FL(0.49364) * fw[NB-2].re + FL(0.05677) * fw[NB-3].re;
-        ff[1].re    += -FL(0.49364) * fw[2].re    + FL(0.05677) * fw[3].re;
-        ff[NB-2].re += -FL(0.49364) * fw[NB-3].re + FL(0.05677) * fw[NB-4].re;
-        ff[1].re = 0.5 * (fw[2].re + fw[0].re); /* HACK???? */
-        ff[1].im = 0.5 * (fw[2].im + fw[0].im);
-        break;
-      case PVS_WIN_BHARRIS_MIN:
-        for (j=0; j<NB; j++) {
-          ff[j].re = FL(0.42323)*fw[j].re;
-          ff[j].im = FL(0.42323)*fw[j].im;
-        }
-        for (j=1; j<NB-1; j++) {
-          ff[j].re -= FL(0.4973406)*FL(0.5)*(fw[j+1].re + fw[j-1].re);
-          ff[j].im -= FL(0.4973406)*FL(0.5)*(fw[j+1].im + fw[j-1].im);
-        }
-        for (j=2; j<NB-2; j++) {
-          ff[j].re += FL(0.0782793)*FL(0.5)*(fw[j+2].re + fw[j-2].re);
-          ff[j].im += FL(0.0782793)*FL(0.5)*(fw[j+2].im + fw[j-2].im);
-        }
-        ff[0].re    += -FL(0.4973406) * fw[1].re    + FL(0.0782793) * fw[2].re;
-        ff[NB-1].re += -FL(0.4973406) * fw[NB-2].re + FL(0.0782793) * fw[NB-3].re;
-        ff[1].re    += -FL(0.4973406) * fw[2].re    + FL(0.0782793) * fw[3].re;
-        ff[NB-2].re += -FL(0.4973406) * fw[NB-3].re + FL(0.0782793) * fw[NB-4].re;
-        ff[1].re = 0.5 * (fw[2].re + fw[0].re); /* HACK???? */
-        ff[1].im = 0.5 * (fw[2].im + fw[0].im);
-        break;
-      }
-/*       if (i==9) { */
-/*         printf("Frame as Amp/Freq %d\n", i); */
-/*         for (j = 0; j < NB; j++) */
-/*           printf("%d: %f\t%f\n", j, ff[j].re, ff[j].im); */
-/*       } */
-      for (j = 0; j < NB; j++) { /* Convert to AMP_FREQ */
-        double thismag = hypot(ff[j].re, ff[j].im);
-        double phase = atan2(ff[j].im, ff[j].re);
-        double angleDif  = phase -  h[j];
-        h[j] = phase;
-            /*subtract expected phase difference */
-        angleDif -= (double)j * TWOPI/N;
-        angleDif =  mod2Pi(angleDif);
-        angleDif =  angleDif * N /TWOPI;
-        ff[j].re = thismag;
-        ff[j].im = csound->esr * (j + angleDif)/N;
-      }
-/*       if (i==9) { */
-/*         printf("Frame as Amp/Freq %d\n", i); */
-/*         for (j = 0; j < NB; j++) */
-/*           printf("%d: %f\t%f\n", j, ff[j].re, ff[j].im); */
-/*       } */
     }
-
     p->inptr = loc;
+    /* the frames of the samples, a partition at a time */
+    sd->frame = (CMPLX*)(p->fsig->frame.auxp);
+    sd->i0 = offset;
+    sd->i1 = nsmps;
+    sdft_halos(sd);
+    if (sd->pool != NULL)
+      sdft_pool_anal(csound, (SDFT_POOL *) sd->pool, sd, kern);
+    else
+      for (k = 0; k < sd->nparts; k++)
+        kern->sdft_anal(sd, &sd->part[k]);
     return OK;
 }
 
@@ -682,10 +920,29 @@ int pvsanal(CSOUND *csound, PVSANAL *p)
       return csound->PerfError(csound,p->h.insdshead,
                                Str("pvsanal: Not Initialised.\n"));
     }
+    if (p->share != NULL)
+      check_shared(csound, p);
+    p->runs++;
+    if (p->followed)
+      memcpy(p->inblk.auxp, ain, nsmps*sizeof(MYFLT));
     {
       int overlap = (int)*p->overlap;
-      if (overlap<(int)nsmps || overlap<10) /* 10 is a guess.... */
+      if (overlap<(int)nsmps || overlap<10) { /* 10 is a guess.... */
+        if (p->share != NULL) {
+          /* sliding: the state of the one shared, all of it */
+          PVSANAL *q = (PVSANAL *) p->share;
+          int N = p->fsig->N, NB = p->Ii;
+          SDFT *ps = (SDFT *) p->sdft.auxp, *qs = (SDFT *) q->sdft.auxp;
+          memcpy(p->input.auxp, q->input.auxp, N*sizeof(MYFLT));
+          memcpy(ps->state, qs->state, ps->stateSize*sizeof(MYFLT));
+          memcpy(p->oldInPhase.auxp, q->oldInPhase.auxp, NB*sizeof(double));
+          memcpy(p->fsig->frame.auxp, q->fsig->frame.auxp,
+                 nsmps*(N+2)*sizeof(MYFLT));
+          p->inptr = q->inptr;
+          return OK;
+        }
         return pvssanal(csound, p);
+      }
     }
     nsmps -= early;
     for (i=offset; i < nsmps; i++)
@@ -833,6 +1090,8 @@ int pvsynthset(CSOUND *csound, PVSYNTH *p)
     p->nextOut = (MYFLT *) (p->output.auxp);
     p->buflen = buflen;
 
+    csound->RealFFT2Release(csound, p->setup);
+    p->setup = NULL;
     if (!(N & (N - 1))) /* if pow of two use this */
       p->setup = csound->RealFFT2Setup(csound,N,FFT_INV);
     return OK;
@@ -1013,24 +1272,13 @@ int pvssynth(CSOUND *csound, PVSYNTH *p)
     CMPLX *ff;
     double *h = (double*)p->oldOutPhase.auxp;
     double *output = (double*)p->output.auxp;
+    const SDFT_KERNELS *kern = get_kernels();
 
     /* Get real part from AMP/FREQ */
     for (i=0; i<ksmps; i++) {
       MYFLT a;
       ff = (CMPLX*)(p->fsig->frame.auxp) + i*NB;
-      for (k=0; k<NB; k++) {
-        double tmp, phase;
-
-        tmp = ff[k].im; /* Actually frequency */
-        /* subtract bin mid frequency */
-        tmp -= (double)k * csound->esr/N;
-        /* get bin deviation from freq deviation */
-        tmp *= TWOPI /csound->esr;
-        /* add the overlap phase advance back in */
-        tmp += (double)k*TWOPI/N;
-        h[k] = phase = mod2Pi(h[k] + tmp);
-        output[k] = ff[k].re*cos(phase);
-      }
+      kern->sdft_synth(ff, h, output, NB, N, (double) csound->esr);
       a = FL(0.0);
       for (k=1; k<NB-1; k++) {
         a -= output[k];
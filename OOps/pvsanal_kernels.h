@@ -0,0 +1,292 @@
+/*
+    pvsanal_kernels.h:
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+
+/* Kernels of the sliding DFT (SDFT) of pvsanal and pvsynth, included by
+   pvsanal.c once for every instruction set it dispatches to (and by the
+   benchmark in tests/c), in the manner of aops_kernels.h: the includer
+   defines KNAME(x) and KERNEL.
+
+   The bins of the analysis are split in partitions, each kept in arrays
+   of its own, real and imaginary parts apart, with the two bins either
+   side of it that the windowing needs.  Those are brought up to date from
+   the neighbouring partitions at the start of every cycle and then
+   updated along with the partition's own, so that the partitions can be
+   run at the same time, and give the same results however the bins are
+   split.  Bins of no partition (outside the range analysed) are zero.
+
+   The loops are written to be vectorised: atan2(), hypot() and cos() are
+   replaced by the inline polynomial versions below, good to a couple of
+   units in the last place, and exceptional cases handled by selects
+   (pvsanal.c is built with -fno-trapping-math). */
+
+#ifndef PVSANAL_KERNELS_DEFS
+#define PVSANAL_KERNELS_DEFS
+
+#define SDFT_MAXPARTS   16
+
+struct SDFT_;
+
+typedef struct SDFT_PART_ {
+    struct SDFT_ *sd;
+    int32   base;             /* bin at index 0 of the arrays (may be < 0) */
+    int32   len;              /* bins kept: the partition's and 2 each side */
+    int32   o0, o1;           /* indices of the bins output                */
+    MYFLT   *re, *im;         /* transform at the last sample              */
+    MYFLT   *yr, *yi;         /* windowed, at the current sample           */
+    double  *c, *s;           /* rotation of each bin per sample           */
+    struct SDFT_PART_ *nxt;   /* next in the queue of the worker threads   */
+} SDFT_PART;
+
+typedef struct SDFT_ {
+    CSOUND  *csound;
+    int32   N, NB;
+    int32   nterms;           /* window: 1, 3 or 5 bins of the transform   */
+    int32   avg1;             /* bin 1 windowed as the average of 0 and 2  */
+    MYFLT   a0, a1, a2;       /* window coefficients                       */
+    MYFLT   e1, e2;           /* and those of bins 0 and NB-1              */
+    double  esr;
+    double  *h;               /* phase of each bin at the last sample      */
+    MYFLT   *dx;              /* change of the input at each sample        */
+    CMPLX   *frame;           /* output frames, one per sample             */
+    int32   i0, i1;           /* samples of the cycle                      */
+    int32   nparts;
+    void    *pool;            /* the worker threads, if nparts > 1         */
+    volatile int32 remaining; /* partitions of the cycle not yet done      */
+    MYFLT   *state;           /* re and im of all partitions, together     */
+    size_t  stateSize;        /* in MYFLTs                                 */
+    SDFT_PART part[SDFT_MAXPARTS];
+} SDFT;
+
+/* x wrapped to (-PI, PI]: the remainder of x / TWOPI, as fmod() (and
+   exactly that for |x| < 4 * PI), brought into range.  No branches or
+   library calls, so that the loops using it can be vectorised; valid
+   for |x| < 2^31 * TWOPI. */
+
+static inline double mod2Pi(double x)
+{
+    x -= TWOPI * (double) (int32_t) (x * (1.0 / TWOPI));
+    x += (x <= -PI ? TWOPI : 0.0);
+    x -= (x > PI ? TWOPI : 0.0);
+    return x;
+}
+
+/* atan2(), from the rational approximation of atan() of the Cephes
+   library on 0 to 0.66, after reduction to 0 to 1 (by the octant) and
+   then (by atan(t) = PI/4 + atan((t - 1) / (t + 1))) to that range */
+
+static inline double sdft_atan2(double y, double x)
+{
+    double  ax = fabs(x), ay = fabs(y);
+    double  mx = (ax > ay ? ax : ay), mn = (ax > ay ? ay : ax);
+    double  t = mn / (mx > 0.0 ? mx : 1.0);
+    int     big = (t > 0.66);
+    double  u = (big ? t - 1.0 : t) / (big ? t + 1.0 : 1.0);
+    double  z = u * u, p, q, r;
+
+    p = ((((-8.750608600031904122785e-1 * z
+            - 1.615753718733365076637e1) * z
+           - 7.500855792314704667340e1) * z
+          - 1.228866684490136173410e2) * z
+         - 6.485021904942025371773e1) * z;
+    q = ((((z + 2.485846490142306297962e1) * z
+           + 1.650270098316988542046e2) * z
+          + 4.328810604912902668951e2) * z
+         + 4.853903996359136964868e2) * z
+      + 1.945506571482613964425e2;
+    r = u + u * (p / q);
+    r += (big ? PI * 0.25 + 3.061616997868382943065e-17 : 0.0);
+    r = (ay > ax ? PI * 0.5 - r : r);
+    r = (copysign(1.0, x) < 0.0 ? PI - r : r);
+    return copysign(r, y);
+}
+
+/* cos() for |x| <= PI, by the Cephes polynomials for sin() and cos() on
+   -PI/4 to PI/4, after reduction by the nearest multiple of PI/2 */
+
+static inline double sdft_cos(double x)
+{
+    double  ax = fabs(x);
+    double  j = (double) (int32_t) (ax * (2.0 / PI) + 0.5);
+    double  r = (ax - j * 1.57079632673412561417e+00)
+                    - j * 6.07710050650619224932e-11;
+    double  z = r * r, sn, cs;
+
+    sn = r + r * z * (((((1.58962301576546568060e-10 * z
+                          - 2.50507477628578072866e-8) * z
+                         + 2.75573136213857245213e-6) * z
+                        - 1.98412698295895385996e-4) * z
+                       + 8.33333333332211858878e-3) * z
+                      - 1.66666666666666307295e-1);
+    cs = 1.0 - 0.5 * z + z * z * (((((-1.13585365213876817300e-11 * z
+                                      + 2.08757008419747316778e-9) * z
+                                     - 2.75573141792967388112e-7) * z
+                                    + 2.48015872888517045348e-5) * z
+                                   - 1.38888888888730564116e-3) * z
+                                  + 4.16666666666665929218e-2);
+    return (j == 0.0 ? cs : (j == 1.0 ? -sn : -cs));
+}
+
+/* the bins the windowing of the transform treats apart: 0 and NB-1, and
+   with the windows of 5 bins, 1 and NB-2, as pvssanal() always has */
+
+static inline void sdft_window_edges(const SDFT *sd, const SDFT_PART *q)
+{
+    const MYFLT *f = q->re, *g = q->im;
+    MYFLT   *yr = q->yr, *yi = q->yi;
+    MYFLT   a0 = sd->a0, a1 = sd->a1, e1 = sd->e1, e2 = sd->e2;
+    int32   b;
+
+    if (sd->nterms == 1)
+      return;
+    b = -q->base;                                       /* bin 0 */
+    if (b >= q->o0 && b < q->o1) {
+      yr[b] = a0 * f[b];
+      yr[b] += (sd->nterms == 5 ? -e1 * f[b+1] + e2 * f[b+2] : -e1 * f[b+1]);
+      yi[b] = a0 * g[b];
+    }
+    b = sd->NB - 1 - q->base;                           /* bin NB-1 */
+    if (b >= q->o0 && b < q->o1) {
+      yr[b] = a0 * f[b];
+      yr[b] += (sd->nterms == 5 ? -e1 * f[b-1] + e2 * f[b-2] : -e1 * f[b-1]);
+      yi[b] = a0 * g[b];
+    }
+    if (sd->nterms != 5)
+      return;
+    b = 1 - q->base;                                    /* bin 1 */
+    if (b >= q->o0 && b < q->o1) {
+      if (sd->avg1) {
+        yr[b] = 0.5 * (f[b+1] + f[b-1]);
+        yi[b] = 0.5 * (g[b+1] + g[b-1]);
+      }
+      else {
+        yr[b] = a0 * f[b];
+        yr[b] -= a1 * (f[b+1] + f[b-1]);
+        yr[b] += -e1 * f[b+1] + e2 * f[b+2];
+        yi[b] = a0 * g[b];
+        yi[b] -= a1 * (g[b+1] + g[b-1]);
+      }
+    }
+    b = sd->NB - 2 - q->base;                           /* bin NB-2 */
+    if (b >= q->o0 && b < q->o1) {
+      yr[b] = a0 * f[b];
+      yr[b] -= a1 * (f[b+1] + f[b-1]);
+      yr[b] += -e1 * f[b-1] + e2 * f[b-2];
+      yi[b] = a0 * g[b];
+      yi[b] -= a1 * (g[b+1] + g[b-1]);
+    }
+}
+#endif  /* PVSANAL_KERNELS_DEFS */
+
+/* One partition of the analysis for the samples i0 to i1 - 1 of the
+   cycle: slide the transform along by a sample, window it and convert
+   the bins output to amplitude and frequency in the frame of the
+   sample. */
+
+KERNEL void KNAME(sdft_anal)(SDFT *sd, SDFT_PART *q)
+{
+    int32   i, b, len = q->len, o0 = q->o0, o1 = q->o1;
+    int32   N = sd->N, nterms = sd->nterms, first = q->base + o0;
+    MYFLT   *re = q->re, *im = q->im, *yr = q->yr, *yi = q->yi;
+    MYFLT   a0 = sd->a0, a1 = sd->a1, a2 = sd->a2;
+    const double *c = q->c, *s = q->s;
+    double  *h = sd->h + first;
+    double  esr = sd->esr;
+
+    for (i = sd->i0; i < sd->i1; i++) {
+      MYFLT dx = sd->dx[i];
+      CMPLX *ff = sd->frame + (size_t) i * sd->NB + first;
+
+      for (b = 0; b < len; b++) {
+        MYFLT r = re[b] + dx, m = im[b];
+        re[b] = c[b] * r - s[b] * m;
+        im[b] = c[b] * m + s[b] * r;
+      }
+      /* Rectang :Fw_t =     F_t                          */
+      /* Hamming :Fw_t = 0.54F_t - 0.23[ F_{t-1}+F_{t+1}] */
+      /* Hann    :Fw_t = 0.5 F_t - 0.25[ F_{t-1}+F_{t+1}] */
+      /* Blackman:Fw_t = 0.42F_t - 0.25[ F_{t-1}+F_{t+1}]+0.04[F_{t-2}+F_{t+2}] */
+      /* and the other windows of 5 bins (see pvssanalset()) likewise */
+      switch (nterms) {
+      case 1:
+        for (b = o0; b < o1; b++) {
+          yr[b] = re[b];
+          yi[b] = im[b];
+        }
+        break;
+      case 3:
+        for (b = o0; b < o1; b++) {
+          MYFLT tr = a0 * re[b], ti = a0 * im[b];
+          tr -= a1 * (re[b+1] + re[b-1]);
+          ti -= a1 * (im[b+1] + im[b-1]);
+          yr[b] = tr;
+          yi[b] = ti;
+        }
+        break;
+      default:
+        for (b = o0; b < o1; b++) {
+          MYFLT tr = a0 * re[b], ti = a0 * im[b];
+          tr -= a1 * (re[b+1] + re[b-1]);
+          ti -= a1 * (im[b+1] + im[b-1]);
+          tr += a2 * (re[b+2] + re[b-2]);
+          ti += a2 * (im[b+2] + im[b-2]);
+          yr[b] = tr;
+          yi[b] = ti;
+        }
+      }
+      sdft_window_edges(sd, q);
+      for (b = o0; b < o1; b++) {         /* Convert to AMP_FREQ */
+        double x = yr[b], y = yi[b];
+        double phase = sdft_atan2(y, x);
+        double angleDif = phase - h[b - o0];
+        int32  j = q->base + b;
+        h[b - o0] = phase;
+        /* subtract expected phase difference */
+        angleDif -= (double) j * TWOPI/N;
+        angleDif = mod2Pi(angleDif);
+        angleDif = angleDif * N / TWOPI;
+        ff[b - o0].re = (MYFLT) sqrt(x * x + y * y);
+        ff[b - o0].im = (MYFLT) (esr * (j + angleDif) / N);
+      }
+    }
+}
+
+/* The bins of the frame ff of a sample as cosines, in output, advancing
+   the phases h by the frequencies. */
+
+KERNEL void KNAME(sdft_synth)(const CMPLX *ff, double *h, double *output,
+                              int32 NB, int32 N, double esr)
+{
+    int32   k;
+
+    for (k = 0; k < NB; k++) {
+      double tmp, phase;
+
+      tmp = ff[k].im; /* Actually frequency */
+      /* subtract bin mid frequency */
+      tmp -= (double) k * esr / N;
+      /* get bin deviation from freq deviation */
+      tmp *= TWOPI / esr;
+      /* add the overlap phase advance back in */
+      tmp += (double) k * TWOPI / N;
+      h[k] = phase = mod2Pi(h[k] + tmp);
+      output[k] = ff[k].re * sdft_cos(phase);
+    }
+}
@@ -37,6 +37,88 @@
 /* part would then be exactly 1.0, still giving a correct output value */
 #define MYFLOOR(x) (x >= FL(0.0) ? (int32)x : (int32)((double)x - 0.99999999))
 
+/* The a-rate table readers and oscillators run through the kernels of
+   ugens2_kernels.h, compiled for the baseline instruction set and, on
+   x86, for AVX2 and AVX-512, where the table reads are done by gather
+   instructions; the widest set the CPU has is selected on first use. */
+
+typedef struct {
+    int32 (*osc)(MYFLT *, const MYFLT *, int32, int32, const MYFLT *, MYFLT,
+                 int, MYFLT, const MYFLT *, int);
+    int32 (*osci)(MYFLT *, const MYFLT *, int32, int32, const MYFLT *, MYFLT,
+                  int, int32, MYFLT, MYFLT, const MYFLT *, int);
+    void (*tab)(MYFLT *, const MYFLT *, const MYFLT *, MYFLT, MYFLT,
+                int32, int32, int, int);
+    void (*tabi)(MYFLT *, const MYFLT *, const MYFLT *, MYFLT, MYFLT,
+                 int32, int32, int, int);
+    void (*tab3)(MYFLT *, const MYFLT *, const MYFLT *, MYFLT, MYFLT,
+                 int32, int32, int, int);
+} UGENS2_KERNELS;
+
+#define UGENS2_KERNEL_TABLE(S) {                                        \
+    ug2_osc_##S, ug2_osci_##S, ug2_tab_##S, ug2_tabi_##S, ug2_tab3_##S  \
+}
+
+#define KERNEL      static
+#define KNAME(x)    ug2_##x##_generic
+#include "ugens2_kernels.h"
+#undef KNAME
+#undef KERNEL
+
+static const UGENS2_KERNELS kernels_generic = UGENS2_KERNEL_TABLE(generic);
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#define HAVE_AVX2_KERNELS 1
+#define KERNEL      static __attribute__ ((target ("avx2")))
+#define KNAME(x)    ug2_##x##_avx2
+#define UG2_GATHER  2
+#include "ugens2_kernels.h"
+#undef KNAME
+#undef UG2_GATHER
+#undef KERNEL
+
+static const UGENS2_KERNELS kernels_avx2 = UGENS2_KERNEL_TABLE(avx2);
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    !defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 8
+#define HAVE_AVX512_KERNELS 1
+#define KERNEL      static \
+                    __attribute__ ((target ("avx512f,prefer-vector-width=512")))
+#define KNAME(x)    ug2_##x##_avx512
+#define UG2_GATHER  3
+#include "ugens2_kernels.h"
+#undef KNAME
+#undef UG2_GATHER
+#undef KERNEL
+
+static const UGENS2_KERNELS kernels_avx512 = UGENS2_KERNEL_TABLE(avx512);
+#endif
+
+static const UGENS2_KERNELS *volatile kernels = NULL;
+
+static const UGENS2_KERNELS *get_kernels(void)
+{
+    const UGENS2_KERNELS *k = kernels;
+    if (UNLIKELY(k == NULL)) {
+      k = &kernels_generic;
+#if defined(HAVE_AVX2_KERNELS) || defined(HAVE_AVX512_KERNELS)
+      __builtin_cpu_init();
+#endif
+#ifdef HAVE_AVX2_KERNELS
+      if (__builtin_cpu_supports("avx2"))
+        k = &kernels_avx2;
+#endif
+#ifdef HAVE_AVX512_KERNELS
+      if (__builtin_cpu_supports("avx512f"))
+        k = &kernels_avx512;
+#endif
+      kernels = k;          /* every thread arrives at the same answer */
+    }
+    return k;
+}
+
 
 
 int phsset(CSOUND *csound, PHSOR *p)
@@ -487,13 +569,10 @@ int ktable(CSOUND *csound, TABLE   *p)
 int tablefn(CSOUND *csound, TABLE *p)
 {
     FUNC        *ftp;
-    MYFLT       *rslt, *pxndx, *tab;
-    int32       indx, mask, length;
+    MYFLT       *rslt;
     uint32_t    koffset = p->h.insdshead->ksmps_offset;
     uint32_t    early  = p->h.insdshead->ksmps_no_end;
-    uint32_t    n, nsmps = CS_KSMPS;
-    MYFLT       ndx, xbmul, offset;
-    int         wrap = p->wrap;
+    uint32_t    nsmps = CS_KSMPS;
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;            /* RWD fix */
@@ -503,35 +582,13 @@ int tablefn(CSOUND *csound, TABLE *p)
       nsmps -= early;
       memset(&rslt[nsmps], '\0', early*sizeof(MYFLT));
     }
-    length = ftp->flen;
-    pxndx = p->xndx;
-    xbmul = (MYFLT)p->xbmul;
-    offset = p->offset;
-    mask = ftp->lenmask;
-    tab = ftp->ftable;
-    for (n=koffset; n<nsmps; n++) {
-      /* Read in the next raw index and increment the pointer ready
-       * for the next cycle.
-       *
-       * Then multiply the ndx by the denormalising factor and add in
-       * the offset.  */
-
-      ndx = (pxndx[n] * xbmul) + offset;
-      indx = (int32) MYFLOOR((double)ndx);
-
-      /* Limit = non-wrap.  Limits to 0 and (length - 1), or does the
-       * wrap code.  See notes above in ktable().  */
-      if (!wrap) {
-        if (UNLIKELY(indx > length - 1))
-          indx = length - 1;
-        else if (UNLIKELY(indx < (int32)0))
-          indx = 0L;
-      }
-      /* do the wrap code only if we are not doing the non-wrap code.  */
-      else
-        indx &= mask;
-      rslt[n] = tab[indx];
-    }
+    /* Multiply each raw index by the denormalising factor and add in
+     * the offset, then limit to 0 and (length - 1) if not wrapping
+     * (see notes above in ktable()), or else do the wrap code.  */
+    if (LIKELY(koffset < nsmps))
+      get_kernels()->tab(&rslt[koffset], ftp->ftable, &p->xndx[koffset],
+                         (MYFLT)p->xbmul, p->offset, ftp->flen,
+                         ftp->lenmask, p->wrap, nsmps-koffset);
     return OK;
  err1:
     return csound->PerfError(csound, p->h.insdshead,
@@ -731,12 +788,10 @@ int ktabl3(CSOUND *csound, TABLE   *p)
 int tabli(CSOUND *csound, TABLE   *p)
 {
     FUNC        *ftp;
-    int32        indx, mask, length;
     uint32_t     koffset = p->h.insdshead->ksmps_offset;
     uint32_t     early  = p->h.insdshead->ksmps_no_end;
-    uint32_t     n, nsmps = CS_KSMPS;
-    MYFLT       *rslt, *pxndx, *tab;
-    MYFLT        fract, v1, v2, ndx, xbmul, offset;
+    uint32_t     nsmps = CS_KSMPS;
+    MYFLT       *rslt;
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
@@ -746,58 +801,13 @@ int tabli(CSOUND *csound, TABLE   *p)
       nsmps -= early;
       memset(&rslt[nsmps], '\0', early*sizeof(MYFLT));
     }
-    length = ftp->flen;
-    pxndx  = p->xndx;
-    xbmul  = (MYFLT)p->xbmul;
-    offset = p->offset;
-    mask   = ftp->lenmask;
-    tab    = ftp->ftable;
-    /* As for ktabli() code to handle non wrap mode, and wrap mode.  */
-    if (!p->wrap) {
-      for (n=koffset; n<nsmps; n++) {
-        /* Read in the next raw index and increment the pointer ready
-         * for the next cycle.
-         * Then multiply the ndx by the denormalising factor and add in
-         * the offset.  */
-        ndx = (pxndx[n] * xbmul) + offset;
-        indx = (int32) ndx;
-        if (UNLIKELY(indx <= 0L)) {
-          rslt[n] = tab[0];
-          continue;
-        }
-        if (UNLIKELY(indx >= length)) {
-          rslt[n] = tab[length];
-          continue;
-        }
-        /* We need to generate a fraction - How much above indx is ndx?
-         * It will be between 0 and just below 1.0.  */
-        fract = ndx - indx;
-        /* As for ktabli(), read two values and interpolate between
-         * them.  */
-        v1 = tab[indx];
-        v2 = tab[indx + 1];
-        rslt[n] = v1 + (v2 - v1)*fract;
-      }
-    }
-    else {                      /* wrap mode */
-      for (n=koffset; n<nsmps; n++) {
-        /* Read in the next raw index and increment the pointer ready
-         * for the next cycle.
-         * Then multiply the ndx by the denormalising factor and add in
-         * the offset.  */
-        ndx = (pxndx[n] * xbmul) + offset;
-        indx = (int32) MYFLOOR(ndx);
-        /* We need to generate a fraction - How much above indx is ndx?
-         * It will be between 0 and just below 1.0.  */
-        fract = ndx - indx;
-        indx &= mask;
-        /* As for ktabli(), read two values and interpolate between
-         * them.  */
-        v1 = tab[indx];
-        v2 = tab[indx + 1];
-        rslt[n] = v1 + (v2 - v1)*fract;
-      }
-    }
+    /* As for ktabli(): in non wrap mode the result is the first value
+     * for indices up to 0 and the guard point from the length on,
+     * otherwise two values are read and interpolated between.  */
+    if (LIKELY(koffset < nsmps))
+      get_kernels()->tabi(&rslt[koffset], ftp->ftable, &p->xndx[koffset],
+                          (MYFLT)p->xbmul, p->offset, ftp->flen,
+                          ftp->lenmask, p->wrap, nsmps-koffset);
     return OK;
  err1:
     return csound->PerfError(csound, p->h.insdshead,
@@ -807,13 +817,10 @@ int tabli(CSOUND *csound, TABLE   *p)
 int tabl3(CSOUND *csound, TABLE *p)     /* Like tabli but cubic interpolation */
 {
     FUNC        *ftp;
-    int32        indx, mask, length;
     uint32_t     koffset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t     n, nsmps = CS_KSMPS;
-    MYFLT       *rslt, *pxndx, *tab;
-    MYFLT        fract, v1, v2, ndx, xbmul, offset;
-    int          wrap = p->wrap;
+    uint32_t     nsmps = CS_KSMPS;
+    MYFLT       *rslt;
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
@@ -823,55 +830,12 @@ int tabl3(CSOUND *csound, TABLE *p)     /* Like tabli but cubic interpolation */
       nsmps -= early;
       memset(&rslt[nsmps], '\0', early*sizeof(MYFLT));
     }
-    length = ftp->flen;
-    pxndx = p->xndx;
-    xbmul = (MYFLT)p->xbmul;
-    offset = p->offset;
-    mask = ftp->lenmask;
-    tab = ftp->ftable;
-    for (n=koffset; n<nsmps; n++) {
-      /* Read in the next raw index and increment the pointer ready
-       * for the next cycle.
-       * Then multiply the ndx by the denormalising factor and add in
-       * the offset.  */
-
-      ndx = (pxndx[n] * xbmul) + offset;
-      indx = (int32) MYFLOOR((double)ndx);
-
-      /* We need to generate a fraction - How much above indx is ndx?
-       * It will be between 0 and just below 1.0.  */
-      fract = ndx - indx;
-      /* As for ktabli() code to handle non wrap mode, and wrap mode.  */
-      if (!wrap) {
-        if (UNLIKELY(ndx > length)) {
-          indx  = length - 1;
-          fract = FL(1.0);
-        }
-        else if (UNLIKELY(indx < 0L)) {
-          indx  = 0L;
-          fract = FL(0.0);
-        }
-      }
-      else
-        indx &= mask;
-      /* interpolate with cubic if we can */
-      if (UNLIKELY(indx <1 || indx == length-1 || length<4)) {
-        /* Too short or at ends */
-        v1 = tab[indx];
-        v2 = tab[indx + 1];
-        rslt[n] = v1 + (v2 - v1)*fract;
-      }
-      else {
-        MYFLT ym1 = tab[indx-1], y0 = tab[indx];
-        MYFLT y1 = tab[indx+1], y2 = tab[indx+2];
-        MYFLT frsq = fract*fract;
-        MYFLT frcu = frsq*ym1;
-        MYFLT t1 = y2 + y0+y0+y0;
-        rslt[n] = y0 + FL(0.5)*frcu +
-          fract*(y1 - frcu/FL(6.0) - t1/FL(6.0) - ym1/FL(3.0)) +
-          frsq*fract*(t1/FL(6.0) - FL(0.5)*y1) + frsq*(FL(0.5)* y1 - y0);
-      }
-    }
+    /* cubic interpolation where the four points are in the table,
+     * linear at the ends or if the table is too short */
+    if (LIKELY(koffset < nsmps))
+      get_kernels()->tab3(&rslt[koffset], ftp->ftable, &p->xndx[koffset],
+                          (MYFLT)p->xbmul, p->offset, ftp->flen,
+                          ftp->lenmask, p->wrap, nsmps-koffset);
     return OK;
  err1:
     return csound->PerfError(csound, p->h.insdshead,
@@ -1223,32 +1187,26 @@ int koscil(CSOUND *csound, OSC *p)
 int osckk(CSOUND *csound, OSC *p)
 {
     FUNC    *ftp;
-    MYFLT   amp, *ar, *ftbl;
-    int32   phs, inc, lobits;
+    MYFLT   *ar;
+    int32    phs, inc;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
+    uint32_t nsmps = CS_KSMPS;
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ftbl = ftp->ftable;
     phs = p->lphs;
     inc = MYFLT2LONG(*p->xcps * csound->sicvt);
-    lobits = ftp->lobits;
-    amp = *p->xamp;
     ar = p->sr;
     if (UNLIKELY(offset)) memset(ar, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
-
-    for (n=offset;n<nsmps;n++) {
-      ar[n] = ftbl[phs >> lobits] * amp;
-      /* phs += inc; */
-      /* phs &= PHMASK; */
-      phs = (phs+inc)&PHMASK;
-    }
+    if (LIKELY(offset < nsmps))
+      phs = get_kernels()->osc(&ar[offset], ftp->ftable, phs, inc,
+                               NULL, csound->sicvt, ftp->lobits,
+                               *p->xamp, NULL, nsmps-offset);
     p->lphs = phs;
     return OK;
  err1:
@@ -1259,19 +1217,14 @@ int osckk(CSOUND *csound, OSC *p)
 int oscka(CSOUND *csound, OSC *p)
 {
     FUNC    *ftp;
-    MYFLT   *ar, amp, *cpsp, *ftbl;
-    int32    phs, lobits;
+    MYFLT   *ar;
+    int32    phs, inc = 0;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
-    MYFLT   sicvt = csound->sicvt;
+    uint32_t nsmps = CS_KSMPS;
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ftbl = ftp->ftable;
-    lobits = ftp->lobits;
-    amp = *p->xamp;
-    cpsp = p->xcps;
     phs = p->lphs;
     ar = p->sr;
     if (UNLIKELY(offset)) memset(ar, '\0', offset*sizeof(MYFLT));
@@ -1279,12 +1232,10 @@ int oscka(CSOUND *csound, OSC *p)
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n=offset;n<nsmps;n++) {
-      int32 inc = MYFLT2LONG(cpsp[n] * sicvt);
-      ar[n] = ftbl[phs >> lobits] * amp;
-      phs += inc;
-      phs &= PHMASK;
-    }
+    if (LIKELY(offset < nsmps))
+      phs = get_kernels()->osc(&ar[offset], ftp->ftable, phs, inc,
+                               &p->xcps[offset], csound->sicvt, ftp->lobits,
+                               *p->xamp, NULL, nsmps-offset);
     p->lphs = phs;
     return OK;
  err1:
@@ -1295,29 +1246,26 @@ int oscka(CSOUND *csound, OSC *p)
 int oscak(CSOUND *csound, OSC *p)
 {
     FUNC    *ftp;
-    MYFLT   *ar, *ampp, *ftbl;
-    int32    phs, inc, lobits;
+    MYFLT   *ar;
+    int32    phs, inc;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
+    uint32_t nsmps = CS_KSMPS;
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ftbl = ftp->ftable;
-    lobits = ftp->lobits;
     phs = p->lphs;
     inc = MYFLT2LONG(*p->xcps * csound->sicvt);
-    ampp = p->xamp;
     ar = p->sr;
     if (UNLIKELY(offset)) memset(ar, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n=offset;n<nsmps;n++) {
-      ar[n] = ftbl[phs >> lobits] * ampp[n];
-      phs = (phs+inc) & PHMASK;
-    }
+    if (LIKELY(offset < nsmps))
+      phs = get_kernels()->osc(&ar[offset], ftp->ftable, phs, inc,
+                               NULL, csound->sicvt, ftp->lobits,
+                               FL(1.0), &p->xamp[offset], nsmps-offset);
     p->lphs = phs;
     return OK;
  err1:
@@ -1328,31 +1276,25 @@ int oscak(CSOUND *csound, OSC *p)
 int oscaa(CSOUND *csound, OSC *p)
 {
     FUNC    *ftp;
-    MYFLT   *ar, *ampp, *cpsp, *ftbl;
-    int32    phs, lobits;
+    MYFLT   *ar;
+    int32    phs, inc = 0;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
-    MYFLT   sicvt = csound->sicvt;
+    uint32_t nsmps = CS_KSMPS;
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ftbl = ftp->ftable;
-    lobits = ftp->lobits;
     phs = p->lphs;
-    ampp = p->xamp;
-    cpsp = p->xcps;
     ar = p->sr;
     if (UNLIKELY(offset)) memset(ar, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n=offset;n<nsmps;n++) {
-      int32 inc = MYFLT2LONG(cpsp[n] * sicvt);
-      ar[n] = ftbl[phs >> lobits] * ampp[n];
-      phs = (phs+inc) & PHMASK;
-    }
+    if (LIKELY(offset < nsmps))
+      phs = get_kernels()->osc(&ar[offset], ftp->ftable, phs, inc,
+                               &p->xcps[offset], csound->sicvt, ftp->lobits,
+                               FL(1.0), &p->xamp[offset], nsmps-offset);
     p->lphs = phs;
     return OK;
  err1:
@@ -1386,31 +1328,27 @@ int koscli(CSOUND *csound, OSC   *p)
 int osckki(CSOUND *csound, OSC   *p)
 {
     FUNC    *ftp;
-    MYFLT   fract, v1, amp, *ar, *ft, *ftab;
-    int32   phs, inc, lobits;
+    MYFLT   *ar;
+    int32    phs, inc;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
+    uint32_t nsmps = CS_KSMPS;
 
-    if (UNLIKELY((ftp = p->ftp)==NULL)) goto err1;
-    lobits = ftp->lobits;
+    ftp = p->ftp;
+    if (UNLIKELY(ftp==NULL)) goto err1;
     phs = p->lphs;
     inc = MYFLT2LONG(*p->xcps * csound->sicvt);
-    amp = *p->xamp;
     ar = p->sr;
     if (UNLIKELY(offset)) memset(ar, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
-    ft = ftp->ftable;
-    for (n=offset; n<nsmps; n++) {
-      fract = PFRAC(phs);
-      ftab = ft + (phs >> lobits);
-      v1 = ftab[0];
-      ar[n] = (v1 + (ftab[1] - v1) * fract) * amp;
-      phs = (phs+inc) & PHMASK;
-    }
+    if (LIKELY(offset < nsmps))
+      phs = get_kernels()->osci(&ar[offset], ftp->ftable, phs, inc,
+                                NULL, csound->sicvt, ftp->lobits,
+                                ftp->lomask, ftp->lodiv,
+                                *p->xamp, NULL, nsmps-offset);
     p->lphs = phs;
     return OK;
  err1:
@@ -1421,18 +1359,14 @@ int osckki(CSOUND *csound, OSC   *p)
 int osckai(CSOUND *csound, OSC   *p)
 {
     FUNC    *ftp;
-    MYFLT   *ar, amp, *cpsp, fract, v1, *ftab, *ft;
-    int32    phs, lobits;
+    MYFLT   *ar;
+    int32    phs, inc = 0;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
-    MYFLT   sicvt = csound->sicvt;
+    uint32_t nsmps = CS_KSMPS;
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    lobits = ftp->lobits;
-    amp = *p->xamp;
-    cpsp = p->xcps;
     phs = p->lphs;
     ar = p->sr;
     if (UNLIKELY(offset)) memset(ar, '\0', offset*sizeof(MYFLT));
@@ -1440,17 +1374,11 @@ int osckai(CSOUND *csound, OSC   *p)
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
-    ft = ftp->ftable;
-    for (n=offset;n<nsmps;n++) {
-      int32 inc;
-      inc = MYFLT2LONG(cpsp[n] * sicvt);
-      fract = PFRAC(phs);
-      ftab = ft + (phs >> lobits);
-      v1 = ftab[0];
-      ar[n] = (v1 + (ftab[1] - v1) * fract) * amp;
-      phs += inc;
-      phs &= PHMASK;
-    }
+    if (LIKELY(offset < nsmps))
+      phs = get_kernels()->osci(&ar[offset], ftp->ftable, phs, inc,
+                                &p->xcps[offset], csound->sicvt, ftp->lobits,
+                                ftp->lomask, ftp->lodiv,
+                                *p->xamp, NULL, nsmps-offset);
     p->lphs = phs;
     return OK;
  err1:
@@ -1461,32 +1389,27 @@ int osckai(CSOUND *csound, OSC   *p)
 int oscaki(CSOUND *csound, OSC   *p)
 {
     FUNC    *ftp;
-    MYFLT    v1, fract, *ar, *ampp, *ftab, *ft;
-    int32    phs, inc, lobits;
+    MYFLT   *ar;
+    int32    phs, inc;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
+    uint32_t nsmps = CS_KSMPS;
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    lobits = ftp->lobits;
     phs = p->lphs;
     inc = MYFLT2LONG(*p->xcps * csound->sicvt);
-    ampp = p->xamp;
     ar = p->sr;
     if (UNLIKELY(offset)) memset(ar, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
-    ft = ftp->ftable;
-    for (n=offset;n<nsmps;n++) {
-      fract = (MYFLT) PFRAC(phs);
-      ftab = ft + (phs >> lobits);
-      v1 = ftab[0];
-      ar[n] = (v1 + (ftab[1] - v1) * fract) * ampp[n];
-      phs = (phs+inc) & PHMASK;
-    }
+    if (LIKELY(offset < nsmps))
+      phs = get_kernels()->osci(&ar[offset], ftp->ftable, phs, inc,
+                                NULL, csound->sicvt, ftp->lobits,
+                                ftp->lomask, ftp->lodiv,
+                                FL(1.0), &p->xamp[offset], nsmps-offset);
     p->lphs = phs;
     return OK;
  err1:
@@ -1497,35 +1420,26 @@ int oscaki(CSOUND *csound, OSC   *p)
 int oscaai(CSOUND *csound, OSC   *p)
 {
     FUNC    *ftp;
-    MYFLT   v1, fract, *ar, *ampp, *cpsp, *ftab, *ft;
-    int32   phs, lobits;
+    MYFLT   *ar;
+    int32    phs, inc = 0;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
-    MYFLT   sicvt = csound->sicvt;
+    uint32_t nsmps = CS_KSMPS;
 
     ftp = p->ftp;
     if (UNLIKELY(ftp==NULL)) goto err1;
-    ft = ftp->ftable;
-    lobits = ftp->lobits;
     phs = p->lphs;
-    ampp = p->xamp;
-    cpsp = p->xcps;
     ar = p->sr;
     if (UNLIKELY(offset)) memset(ar, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n=offset;n<nsmps;n++) {
-      int32 inc;
-      inc = MYFLT2LONG(cpsp[n] * sicvt);
-      fract = (MYFLT) PFRAC(phs);
-      ftab = ft + (phs >> lobits);
-      v1 = ftab[0];
-      ar[n] = (v1 + (ftab[1] - v1) * fract) * ampp[n];
-      phs = (phs+inc) & PHMASK;
-    }
+    if (LIKELY(offset < nsmps))
+      phs = get_kernels()->osci(&ar[offset], ftp->ftable, phs, inc,
+                                &p->xcps[offset], csound->sicvt, ftp->lobits,
+                                ftp->lomask, ftp->lodiv,
+                                FL(1.0), &p->xamp[offset], nsmps-offset);
     p->lphs = phs;
     return OK;
  err1:
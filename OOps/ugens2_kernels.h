@@ -0,0 +1,389 @@
+/*
+    ugens2_kernels.h:
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+
+/* Kernels for the table reading opcodes and the oscil family, included
+   by ugens2.c once for every instruction set it dispatches to (and by
+   the benchmark in tests/c).  The includer defines KNAME(x) and KERNEL
+   as for aops_kernels.h, and UG2_GATHER to 2 or 3 where the table reads
+   may use the AVX2 or AVX-512 gather instructions, which the compiler
+   will not generate by itself.
+
+   With gathers, a kernel works through its n samples in blocks of
+   UG2_BLOCK: a first pass works out the table indices and fractions of
+   the block into arrays on the stack, the table values are then
+   gathered from those indices, and a last pass interpolates.  The first
+   and last passes have no calls and make their choices by selects so
+   that the compiler vectorises them (ugens2.c is built with
+   -fno-trapping-math).  Without gathers the extra passes cost more than
+   they save, and the kernels are the single loops the opcodes had
+   before; so too are the oscillators with a-rate frequency, whose
+   phases have to be summed one after another.  The results are the
+   same, to the bit, whichever is used (ugens2.c is built with
+   -ffp-contract=off, so that multiplies and adds are not fused on
+   instruction sets that can). */
+
+#ifndef UGENS2_KERNELS_DEFS
+#define UGENS2_KERNELS_DEFS
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#define UG2_BLOCK   64
+
+/* floor, as MYFLOOR() in ugens2.c, by a select of constants rather than
+   of expressions, which vectorises */
+#define UG2_FLOOR(x)                                                    \
+    ((int32) ((double) (x) + ((double) (x) >= 0.0 ? 0.0 : -0.99999999)))
+
+/* the cubic through ym1, y0, y1 and y2 at fract between y0 and y1 */
+#define UG2_CUBIC(R, YM1, Y0, Y1, Y2, FRACT)                            \
+    {                                                                   \
+      MYFLT ym1_ = (YM1), y0_ = (Y0), y1_ = (Y1), y2_ = (Y2);           \
+      MYFLT f_ = (FRACT), frsq_ = f_ * f_, frcu_ = frsq_ * ym1_;        \
+      MYFLT t1_ = y2_ + y0_ + y0_ + y0_;                                \
+      R = y0_ + FL(0.5) * frcu_ +                                       \
+        f_ * (y1_ - frcu_ / FL(6.0) - t1_ / FL(6.0) - ym1_ / FL(3.0)) + \
+        frsq_ * f_ * (t1_ / FL(6.0) - FL(0.5) * y1_) +                  \
+        frsq_ * (FL(0.5) * y1_ - y0_);                                  \
+    }
+#endif  /* UGENS2_KERNELS_DEFS */
+
+#ifdef UG2_GATHER
+/* d[i] = t[ix[i]] */
+
+KERNEL void KNAME(gather)(MYFLT *d, const MYFLT *t, const int32 *ix, int n)
+{
+    int i = 0;
+#if UG2_GATHER == 3
+#  ifdef USE_DOUBLE
+    for ( ; i + 8 <= n; i += 8)
+      _mm512_storeu_pd(&d[i],
+          _mm512_i32gather_pd(_mm256_loadu_si256((const __m256i *) &ix[i]),
+                              t, 8));
+#  else
+    for ( ; i + 16 <= n; i += 16)
+      _mm512_storeu_ps(&d[i],
+          _mm512_i32gather_ps(_mm512_loadu_si512((const void *) &ix[i]),
+                              t, 4));
+#  endif
+#elif UG2_GATHER == 2
+#  ifdef USE_DOUBLE
+    for ( ; i + 4 <= n; i += 4)
+      _mm256_storeu_pd(&d[i],
+          _mm256_i32gather_pd(t, _mm_loadu_si128((const __m128i *) &ix[i]),
+                              8));
+#  else
+    for ( ; i + 8 <= n; i += 8)
+      _mm256_storeu_ps(&d[i],
+          _mm256_i32gather_ps(t, _mm256_loadu_si256((const __m256i *) &ix[i]),
+                              4));
+#  endif
+#endif
+    for ( ; i < n; i++)
+      d[i] = t[ix[i]];
+}
+#endif
+
+/* oscil: r[i] = ftbl[phase >> lobits] * amplitude, from the phase phs
+   advanced by a k-rate increment inc or, if cps is not NULL, by
+   cps[i] * sicvt, and with the amplitude amp or, if ampp is not NULL,
+   ampp[i]; returns the phase after the last sample */
+
+#define UG2_OSC_LOOP(READ, AMP)                                         \
+    for (i = 0; i < n; i++) {                                           \
+      ftab = ftbl + (phs >> lobits);                                    \
+      r[i] = (READ) * (AMP);                                            \
+      phs = (phs + (cps ? MYFLT2LONG(cps[i] * sicvt) : inc)) & PHMASK;  \
+    }
+
+#define UG2_OSC(READ)                                                   \
+    {                                                                   \
+      const MYFLT *ftab;                                                \
+      int         i;                                                    \
+      if (ampp == NULL)                                                 \
+        UG2_OSC_LOOP(READ, amp)                                         \
+      else                                                              \
+        UG2_OSC_LOOP(READ, ampp[i])                                     \
+      return phs;                                                       \
+    }
+
+#ifdef UG2_GATHER
+/* The k-rate phases of a block, by wrapping unsigned arithmetic as the
+   phase wraps modulo PHMASK + 1, a power of two, so that they need not
+   be summed one by one; returns the phase after the last. */
+
+KERNEL int32 KNAME(osc_phase)(int32 *ph, int32 phs, int32 inc, int n)
+{
+    uint32_t p0 = (uint32_t) phs, ui = (uint32_t) inc;
+    int      i;
+    for (i = 0; i < n; i++)
+      ph[i] = (int32) ((p0 + (uint32_t) i * ui) & PHMASK);
+    return (int32) ((p0 + (uint32_t) n * ui) & PHMASK);
+}
+#endif
+
+KERNEL int32 KNAME(osc)(MYFLT *r, const MYFLT *ftbl, int32 phs, int32 inc,
+                        const MYFLT *cps, MYFLT sicvt, int lobits,
+                        MYFLT amp, const MYFLT *ampp, int n)
+{
+#ifdef UG2_GATHER
+    int32   ph[UG2_BLOCK];
+    int     i, j, m;
+    if (cps == NULL) {
+      for (j = 0; j < n; j += UG2_BLOCK) {
+        m = (n - j < UG2_BLOCK ? n - j : UG2_BLOCK);
+        phs = KNAME(osc_phase)(ph, phs, inc, m);
+        for (i = 0; i < m; i++)
+          ph[i] >>= lobits;
+        KNAME(gather)(&r[j], ftbl, ph, m);
+        if (ampp == NULL)
+          for (i = 0; i < m; i++)
+            r[j + i] *= amp;
+        else
+          for (i = 0; i < m; i++)
+            r[j + i] *= ampp[j + i];
+      }
+      return phs;
+    }
+#endif
+    UG2_OSC(ftab[0])
+}
+
+/* oscili: as osc() with linear interpolation by the low bits of the
+   phase, lomask and lodiv of the table */
+
+KERNEL int32 KNAME(osci)(MYFLT *r, const MYFLT *ftbl, int32 phs, int32 inc,
+                         const MYFLT *cps, MYFLT sicvt, int lobits,
+                         int32 lomask, MYFLT lodiv,
+                         MYFLT amp, const MYFLT *ampp, int n)
+{
+#ifdef UG2_GATHER
+    int32   ph[UG2_BLOCK];
+    MYFLT   fract[UG2_BLOCK], v1[UG2_BLOCK], v2[UG2_BLOCK];
+    int     i, j, m;
+    if (cps == NULL) {
+      for (j = 0; j < n; j += UG2_BLOCK) {
+        m = (n - j < UG2_BLOCK ? n - j : UG2_BLOCK);
+        phs = KNAME(osc_phase)(ph, phs, inc, m);
+        for (i = 0; i < m; i++) {
+          fract[i] = (MYFLT) (ph[i] & lomask) * lodiv;
+          ph[i] >>= lobits;
+        }
+        KNAME(gather)(v1, ftbl, ph, m);
+        KNAME(gather)(v2, ftbl + 1, ph, m);
+        if (ampp == NULL)
+          for (i = 0; i < m; i++)
+            r[j + i] = (v1[i] + (v2[i] - v1[i]) * fract[i]) * amp;
+        else
+          for (i = 0; i < m; i++)
+            r[j + i] = (v1[i] + (v2[i] - v1[i]) * fract[i]) * ampp[j + i];
+      }
+      return phs;
+    }
+#endif
+    UG2_OSC(ftab[0] + (ftab[1] - ftab[0]) * ((MYFLT) (phs & lomask) * lodiv))
+}
+
+#undef UG2_OSC
+#undef UG2_OSC_LOOP
+
+/* table: r[i] = tab[floor(x[i] * xbmul + offset)], the index limited to
+   0 ... length - 1, or if wrap is set masked by mask */
+
+KERNEL void KNAME(tab)(MYFLT *r, const MYFLT *tab, const MYFLT *x,
+                       MYFLT xbmul, MYFLT offset, int32 length, int32 mask,
+                       int wrap, int n)
+{
+#ifdef UG2_GATHER
+    int32   ix[UG2_BLOCK];
+    int     i, j, m;
+    for (j = 0; j < n; j += UG2_BLOCK) {
+      m = (n - j < UG2_BLOCK ? n - j : UG2_BLOCK);
+      if (!wrap)
+        for (i = 0; i < m; i++) {
+          int32 indx = UG2_FLOOR((x[j + i] * xbmul) + offset);
+          indx = (indx > length - 1 ? length - 1 : indx);
+          ix[i] = (indx < 0 ? 0 : indx);
+        }
+      else
+        for (i = 0; i < m; i++)
+          ix[i] = UG2_FLOOR((x[j + i] * xbmul) + offset) & mask;
+      KNAME(gather)(&r[j], tab, ix, m);
+    }
+#else
+    int     i;
+    for (i = 0; i < n; i++) {
+      int32 indx = UG2_FLOOR((x[i] * xbmul) + offset);
+      if (!wrap) {
+        if (UNLIKELY(indx > length - 1))
+          indx = length - 1;
+        else if (UNLIKELY(indx < (int32)0))
+          indx = 0L;
+      }
+      else
+        indx &= mask;
+      r[i] = tab[indx];
+    }
+#endif
+}
+
+/* tablei: as tab() with linear interpolation.  Without wrap the result
+   is tab[0] for indices up to 0 and tab[length] from length, which is
+   what interpolating between two reads of the same point gives. */
+
+KERNEL void KNAME(tabi)(MYFLT *r, const MYFLT *tab, const MYFLT *x,
+                        MYFLT xbmul, MYFLT offset, int32 length, int32 mask,
+                        int wrap, int n)
+{
+#ifdef UG2_GATHER
+    int32   i1[UG2_BLOCK], i2[UG2_BLOCK];
+    MYFLT   fract[UG2_BLOCK], v1[UG2_BLOCK], v2[UG2_BLOCK];
+    int     i, j, m;
+    for (j = 0; j < n; j += UG2_BLOCK) {
+      m = (n - j < UG2_BLOCK ? n - j : UG2_BLOCK);
+      if (!wrap)
+        for (i = 0; i < m; i++) {
+          MYFLT ndx = (x[j + i] * xbmul) + offset;
+          int32 indx = (int32) ndx;
+          int32 k = (indx <= 0 ? 0 : indx);
+          k = (k >= length ? length : k);
+          i1[i] = k;
+          i2[i] = (k == indx ? indx + 1 : k);
+          fract[i] = (ndx - indx) * (k == indx ? FL(1.0) : FL(0.0));
+        }
+      else
+        for (i = 0; i < m; i++) {
+          MYFLT ndx = (x[j + i] * xbmul) + offset;
+          int32 indx = UG2_FLOOR(ndx);
+          fract[i] = ndx - indx;
+          i1[i] = indx & mask;
+          i2[i] = i1[i] + 1;
+        }
+      KNAME(gather)(v1, tab, i1, m);
+      KNAME(gather)(v2, tab, i2, m);
+      for (i = 0; i < m; i++)
+        r[j + i] = v1[i] + (v2[i] - v1[i]) * fract[i];
+    }
+#else
+    int     i;
+    if (!wrap) {
+      for (i = 0; i < n; i++) {
+        MYFLT ndx = (x[i] * xbmul) + offset, v1;
+        int32 indx = (int32) ndx;
+        if (UNLIKELY(indx <= 0L))
+          r[i] = tab[0];
+        else if (UNLIKELY(indx >= length))
+          r[i] = tab[length];
+        else {
+          v1 = tab[indx];
+          r[i] = v1 + (tab[indx + 1] - v1) * (ndx - indx);
+        }
+      }
+    }
+    else {
+      for (i = 0; i < n; i++) {
+        MYFLT ndx = (x[i] * xbmul) + offset, v1;
+        int32 indx = UG2_FLOOR(ndx);
+        MYFLT fract = ndx - indx;
+        indx &= mask;
+        v1 = tab[indx];
+        r[i] = v1 + (tab[indx + 1] - v1) * fract;
+      }
+    }
+#endif
+}
+
+/* table3: as tabi() with cubic interpolation, and linear interpolation
+   where one of the four points would fall outside the table */
+
+KERNEL void KNAME(tab3)(MYFLT *r, const MYFLT *tab, const MYFLT *x,
+                        MYFLT xbmul, MYFLT offset, int32 length, int32 mask,
+                        int wrap, int n)
+{
+#ifdef UG2_GATHER
+    int32   im1[UG2_BLOCK], i0[UG2_BLOCK], i2[UG2_BLOCK];
+    int32   lin[UG2_BLOCK];
+    MYFLT   fract[UG2_BLOCK];
+    MYFLT   ym1[UG2_BLOCK], y0[UG2_BLOCK], y1[UG2_BLOCK], y2[UG2_BLOCK];
+    int     i, j, m;
+    for (j = 0; j < n; j += UG2_BLOCK) {
+      m = (n - j < UG2_BLOCK ? n - j : UG2_BLOCK);
+      if (!wrap)
+        for (i = 0; i < m; i++) {
+          MYFLT ndx = (x[j + i] * xbmul) + offset;
+          int32 indx = UG2_FLOOR(ndx);
+          int   over = (ndx > length), under = (indx < 0);
+          fract[i] = (ndx - indx) * (over | under ? FL(0.0) : FL(1.0)) +
+                     (over ? FL(1.0) : FL(0.0));
+          i0[i] = (over ? length - 1 : (under ? 0 : indx));
+        }
+      else
+        for (i = 0; i < m; i++) {
+          MYFLT ndx = (x[j + i] * xbmul) + offset;
+          int32 indx = UG2_FLOOR(ndx);
+          fract[i] = ndx - indx;
+          i0[i] = indx & mask;
+        }
+      for (i = 0; i < m; i++) {
+        int32 indx = i0[i];
+        int32 l = (indx < 1) | (indx == length - 1) | (length < 4);
+        im1[i] = indx - 1 + l;
+        i2[i] = indx + 2 - l;
+        lin[i] = l;
+      }
+      KNAME(gather)(ym1, tab, im1, m);
+      KNAME(gather)(y0, tab, i0, m);
+      KNAME(gather)(y1, tab + 1, i0, m);
+      KNAME(gather)(y2, tab, i2, m);
+      for (i = 0; i < m; i++) {
+        MYFLT cub, lnr = y0[i] + (y1[i] - y0[i]) * fract[i];
+        UG2_CUBIC(cub, ym1[i], y0[i], y1[i], y2[i], fract[i])
+        r[j + i] = (lin[i] ? lnr : cub);
+      }
+    }
+#else
+    int     i;
+    for (i = 0; i < n; i++) {
+      MYFLT ndx = (x[i] * xbmul) + offset, fract;
+      int32 indx = UG2_FLOOR(ndx);
+      fract = ndx - indx;
+      if (!wrap) {
+        if (UNLIKELY(ndx > length)) {
+          indx  = length - 1;
+          fract = FL(1.0);
+        }
+        else if (UNLIKELY(indx < 0L)) {
+          indx  = 0L;
+          fract = FL(0.0);
+        }
+      }
+      else
+        indx &= mask;
+      if (UNLIKELY(indx < 1 || indx == length - 1 || length < 4)) {
+        MYFLT v1 = tab[indx];
+        r[i] = v1 + (tab[indx + 1] - v1) * fract;
+      }
+      else {
+        UG2_CUBIC(r[i], tab[indx - 1], tab[indx], tab[indx + 1], tab[indx + 2],
+                  fract)
+      }
+    }
+#endif
+}
@@ -789,10 +789,11 @@ static int OSC_list(CSOUND *csound, OSCLISTEN *p)
               return csound->PerfError(csound, p->h.insdshead,
                                        Str("OSC internal error"));
             }
+            /* before the header is replaced, while flen still describes
+               the old data, which may be mapped */
+            csound->FTReAlloc(csound, ftp, len-sizeof(FUNC)+sizeof(MYFLT*));
             memcpy(ftp, data, sizeof(FUNC)-sizeof(MYFLT*));
             ftp->fno = fno;
-            ftp->ftable = (MYFLT*)csound->ReAlloc(csound, ftp->ftable,
-                                                  len-sizeof(FUNC)+sizeof(MYFLT*));
             {
               MYFLT* dst = ftp->ftable;
               MYFLT* src = (MYFLT*)(&(data->ftable));
@@ -1483,6 +1483,7 @@ int init_rfft(CSOUND *csound, FFT *p){
                              Str("rfft: only one-dimensional arrays allowed"));
   if (isPowerOfTwo(N)){
     tabensure(csound, p->out,N);
+    csound->RealFFT2Release(csound, p->setup);
     p->setup = csound->RealFFT2Setup(csound, N, FFT_FWD);
   }
   else
@@ -1515,6 +1516,7 @@ int init_rifft(CSOUND *csound, FFT *p){
     return csound->InitError(csound,
                              Str("rifft: only one-dimensional arrays allowed"));
  if (isPowerOfTwo(N)){
+    csound->RealFFT2Release(csound, p->setup);
     p->setup = csound->RealFFT2Setup(csound, N, FFT_INV);
     tabensure(csound, p->out, N);
  }
@@ -1822,6 +1824,7 @@ typedef struct _pvsceps {
 int pvsceps_init(CSOUND *csound, PVSCEPS *p){
     int N = p->fin->N;
     if(isPowerOfTwo(N)){
+      csound->RealFFT2Release(csound, p->setup);
       p->setup = csound->RealFFT2Setup(csound, N/2, FFT_FWD);
       tabensure(csound, p->out, N/2+1);
     }
@@ -1862,6 +1865,7 @@ int init_ceps(CSOUND *csound, FFT *p){
       return csound->InitError(csound,
                                Str("FFT size too small (min 64 samples)\n"));
     if(isPowerOfTwo(N)){
+      csound->RealFFT2Release(csound, p->setup);
       p->setup = csound->RealFFT2Setup(csound, N, FFT_FWD);
       tabensure(csound, p->out, N+1);
     }
@@ -1894,6 +1898,7 @@ int perf_ceps(CSOUND *csound, FFT *p){
 int init_iceps(CSOUND *csound, FFT *p){
     int N = p->in->sizes[0]-1;
     if (LIKELY(isPowerOfTwo(N))) {
+      csound->RealFFT2Release(csound, p->setup);
       p->setup = csound->RealFFT2Setup(csound, N, FFT_INV);
       tabensure(csound, p->out, N+1);
     }
@@ -2095,6 +2100,7 @@ int init_dct(CSOUND *csound, FFT *p){
     return csound->InitError(csound,
                              Str("dct: only one-dimensional arrays allowed"));
     tabensure(csound, p->out, N);
+    csound->RealFFT2Release(csound, p->setup);
     p->setup =  csoundDCTSetup(csound,N,FFT_FWD);
     return OK;
    } else return
@@ -2123,6 +2129,7 @@ int init_dctinv(CSOUND *csound, FFT *p){
     return csound->InitError(csound,
                              Str("dctinv: only one-dimensional arrays allowed"));
     tabensure(csound, p->out, N);
+    csound->RealFFT2Release(csound, p->setup);
     p->setup =  csoundDCTSetup(csound,N,FFT_INV);
     return OK;
    } else
@@ -40,7 +40,7 @@
     /* where callers pass s/2+1, this recreates the parent fft frame size */
 
 /* assumes that FFTsize is an integer multiple of 4 */
-void Polar2Real_PVOC(CSOUND *csound, MYFLT *buf, int FFTsize)
+void Polar2Real_PVOC(CSOUND *csound, MYFLT *buf, int FFTsize, void *setup)
 {
     MYFLT re, im;
     int   i;
@@ -59,7 +59,7 @@ void Polar2Real_PVOC(CSOUND *csound, MYFLT *buf, int FFTsize)
     /* kill spurious imag at dc & fs/2 */
     buf[1] = buf[i]; buf[i] = buf[i + 1] = FL(0.0);
     /* calculate inverse FFT */
-    csound->InverseRealFFT(csound, buf, FFTsize);
+    csound->RealFFT2(csound, setup, buf);
 }
 
 #define MMmaskPhs(p,q,s) /* p is pha, q is as int, s is 1/PI */ \
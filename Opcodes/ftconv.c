@@ -22,11 +22,33 @@
 */
 
 #include "stdopcod.h"
+#include "irspec.h"
 #include <math.h>
 
 #define FTCONV_MAXCHN   8
+#define FTCONV_MAXLEVELS 16
 
+/* A tail level of the non-uniform mode: a uniformly partitioned
+   convolution with the IR from 'start' on, in partitions of partSize.
+   A level whose partitions are twice the head's begins at
+   2 * partSize - (head partition length) frames into the IR, so the
+   result of an input block is first needed one block after the block is
+   complete, which is the time a background level has to compute it. */
 typedef struct {
+    int     partSize;           /* partition length in sample frames        */
+    int     nPartitions;        /* number of partitions of this level       */
+    int     start;              /* IR position of the first partition       */
+    int     rbCnt;              /* ring buffer index                        */
+    int     bg;                 /* computed by the worker thread            */
+    uint32_t pos;               /* input ring position of the next block    */
+    uint32_t posted, done;      /* blocks handed to / finished by worker    */
+    MYFLT   *tmpBuf;
+    MYFLT   *ringBuf;
+    MYFLT   *IR_Data[FTCONV_MAXCHN];
+    void    *fwdsetup, *invsetup;
+} FTCONV_LEVEL;
+
+typedef struct FTCONV_ {
     OPDS    h;
     MYFLT   *aOut[FTCONV_MAXCHN];
     MYFLT   *aIn;
@@ -35,6 +57,7 @@ typedef struct {
     MYFLT   *iSkipSamples;
     MYFLT   *iTotLen;
     MYFLT   *iSkipInit;
+    MYFLT   *iMaxPartLen;
  /* ------------------------- */
     int     initDone;
     int     nChannels;
@@ -48,8 +71,33 @@ typedef struct {
     MYFLT   *outBuffers[FTCONV_MAXCHN]; /* output buffer (size=partSize*2)  */
     void  *fwdsetup, *invsetup;
     AUXCH   auxData;
+    IRSPEC  *spec;              /* cached IR spectra, of head and levels    */
+    /* non-uniform mode: tail levels after the head partitions above */
+    int     nLevels;
+    int     ringSize;           /* length of the rings below, power of two  */
+    uint32_t t;                 /* sample frames since initialisation       */
+    MYFLT   *inRing;            /* input signal                             */
+    MYFLT   *fgOut[FTCONV_MAXCHN];  /* output of the levels done in line    */
+    MYFLT   *bgOut[FTCONV_MAXCHN];  /* output of the worker thread          */
+    FTCONV_LEVEL level[FTCONV_MAXLEVELS];
+    void    *pool;              /* the worker's, while queued on it         */
+    struct FTCONV_ *nxt;        /* next instance queued on the worker       */
+    volatile int busy;          /* a block being computed by the worker     */
+    AUXCH   tailData;
 } FTCONV;
 
+/* One worker thread per engine computes the background levels of all
+   the instances queued on it.  It is started by the first instance that
+   needs it and stopped on reset. */
+typedef struct {
+    CSOUND  *csound;
+    FTCONV  *top;               /* queued instances                         */
+    void    *thread, *wakeLock, *doneLock, *mutex;
+    volatile int running;
+} FTCONV_POOL;
+
+#define FTCONV_POOL_GLOBAL  "ftconv::pool"
+
 static void multiply_fft_buffers(MYFLT *outBuf, MYFLT *ringBuf,
                                  MYFLT *IR_Data, int partSize, int nPartitions,
                                  int ringBuf_startPos)
@@ -118,7 +166,6 @@ static inline int buf_bytes_alloc(int nChannels, int partSize, int nPartitions)
 
     nSmps = (partSize << 1);                                /* tmpBuf     */
     nSmps += ((partSize << 1) * nPartitions);               /* ringBuf    */
-    nSmps += ((partSize << 1) * nChannels * nPartitions);   /* IR_Data    */
     nSmps += ((partSize << 1) * nChannels);                 /* outBuffers */
 
     return ((int) sizeof(MYFLT) * nSmps);
@@ -135,22 +182,381 @@ static void set_buf_pointers(FTCONV *p,
     ptr += (partSize << 1);
     p->ringBuf = ptr;
     ptr += ((partSize << 1) * nPartitions);
-    for (i = 0; i < nChannels; i++) {
-      p->IR_Data[i] = ptr;
-      ptr += ((partSize << 1) * nPartitions);
-    }
     for (i = 0; i < nChannels; i++) {
       p->outBuffers[i] = ptr;
       ptr += (partSize << 1);
     }
 }
 
+/* lay out the tail levels for an IR of n frames, a head partition length
+   of partSize and partitions of at most maxPartSize: the head keeps three
+   partitions, the levels after it have two partitions each of twice the
+   length of the one before, until maxPartSize, which takes the rest.
+   Returns the number of levels. */
+
+static int set_levels(FTCONV *p, int n, int partSize, int maxPartSize)
+{
+    FTCONV_LEVEL  *lv;
+    int           start = 3 * partSize, N = partSize << 1, nLevels = 0;
+
+    while (start < n && nLevels < FTCONV_MAXLEVELS) {
+      lv = &(p->level[nLevels++]);
+      lv->partSize = N;
+      lv->nPartitions = (n - start + (N - 1)) / N;
+      if (N < maxPartSize && nLevels < FTCONV_MAXLEVELS &&
+          lv->nPartitions > 2)
+        lv->nPartitions = 2;
+      lv->start = start;
+      start += lv->nPartitions * N;
+      N <<= 1;
+    }
+    return nLevels;
+}
+
+static int tail_bytes_alloc(FTCONV *p, int nChannels)
+{
+    int nSmps, i, N;
+
+    N = p->level[p->nLevels - 1].partSize;
+    p->ringSize = N << 2;
+    nSmps = p->ringSize * (1 + 2 * nChannels);      /* inRing, fgOut, bgOut */
+    for (i = 0; i < p->nLevels; i++) {
+      N = p->level[i].partSize << 1;
+      nSmps += N;                                   /* tmpBuf     */
+      nSmps += N * p->level[i].nPartitions;         /* ringBuf    */
+    }
+    return ((int) sizeof(MYFLT) * nSmps);
+}
+
+static void set_tail_pointers(FTCONV *p, int nChannels)
+{
+    MYFLT         *ptr = (MYFLT*) (p->tailData.auxp);
+    FTCONV_LEVEL  *lv;
+    int           i, j, N;
+
+    p->inRing = ptr;
+    ptr += p->ringSize;
+    for (j = 0; j < nChannels; j++) {
+      p->fgOut[j] = ptr;
+      ptr += p->ringSize;
+      p->bgOut[j] = ptr;
+      ptr += p->ringSize;
+    }
+    for (i = 0; i < p->nLevels; i++) {
+      lv = &(p->level[i]);
+      N = lv->partSize << 1;
+      lv->tmpBuf = ptr;
+      ptr += N;
+      lv->ringBuf = ptr;
+      ptr += N * lv->nPartitions;
+    }
+}
+
+/* the IR spectra of the head and of the levels, kept in the cache */
+
+static size_t ir_smps(FTCONV *p)
+{
+    size_t  nSmps;
+    int     i;
+
+    nSmps = (size_t) (p->partSize << 1) * p->nPartitions * p->nChannels;
+    for (i = 0; i < p->nLevels; i++)
+      nSmps += (size_t) (p->level[i].partSize << 1) *
+               p->level[i].nPartitions * p->nChannels;
+    return nSmps;
+}
+
+static void set_ir_pointers(FTCONV *p, MYFLT *ptr)
+{
+    FTCONV_LEVEL  *lv;
+    int           i, j;
+
+    for (j = 0; j < p->nChannels; j++) {
+      p->IR_Data[j] = ptr;
+      ptr += ((p->partSize << 1) * p->nPartitions);
+    }
+    for (i = 0; i < p->nLevels; i++) {
+      lv = &(p->level[i]);
+      for (j = 0; j < p->nChannels; j++) {
+        lv->IR_Data[j] = ptr;
+        ptr += ((lv->partSize << 1) * lv->nPartitions);
+      }
+    }
+}
+
+/* FFTs of nPartitions partitions of channel chn of the impulse response,
+   from frame 'start' (counted from the skipped samples) on, in reverse
+   partition order and scaled; frames from 'end' on are taken as zero */
+
+static void load_ir_partitions(CSOUND *csound, FTCONV *p, FUNC *ftp,
+                               MYFLT *IR_Data, void *fwdsetup, int chn,
+                               int skipSamples, int start, int end,
+                               int partSize, int nPartitions, MYFLT FFTscale)
+{
+    int i, k, n, frame;
+
+    i = ((skipSamples + start) * p->nChannels) + chn;   /* table read position */
+    n = (partSize << 1) * (nPartitions - 1);            /* IR write position */
+    frame = start;
+    do {
+      for (k = 0; k < partSize; k++) {
+        if (frame < end && i >= 0 && i < (int) ftp->flen)
+          IR_Data[n + k] = ftp->ftable[i] * FFTscale;
+        else
+          IR_Data[n + k] = FL(0.0);
+        i += p->nChannels;
+        frame++;
+      }
+      /* pad second half of IR to zero */
+      for (k = partSize; k < (partSize << 1); k++)
+        IR_Data[n + k] = FL(0.0);
+      /* calculate FFT */
+      csound->RealFFT2(csound, fwdsetup, &(IR_Data[n]));
+      n -= (partSize << 1);
+    } while (n >= 0);
+}
+
+/* one input block of a tail level: the block of the input ring at lv->pos
+   is transformed and convolved with the IR partitions of the level, and
+   the result added to 'out' from two block lengths after its start, the
+   first sample that needs it */
+
+static void level_block(CSOUND *csound, FTCONV *p, FTCONV_LEVEL *lv,
+                        MYFLT **out)
+{
+    MYFLT     *rBuf;
+    int       i, n, N = lv->partSize;
+    uint32_t  mask = (uint32_t) (p->ringSize - 1), pos = lv->pos;
+
+    rBuf = &(lv->ringBuf[lv->rbCnt * (N << 1)]);
+    for (i = 0; i < N; i++)
+      rBuf[i] = p->inRing[(pos + (uint32_t) i) & mask];
+    for (i = N; i < (N << 1); i++)
+      rBuf[i] = FL(0.0);            /* pad to double length */
+    csound->RealFFT2(csound, lv->fwdsetup, rBuf);
+    if (++lv->rbCnt >= lv->nPartitions)
+      lv->rbCnt = 0;
+    lv->pos += (uint32_t) N;
+    pos += (uint32_t) (N << 1);
+    for (n = 0; n < p->nChannels; n++) {
+      multiply_fft_buffers(lv->tmpBuf, lv->ringBuf, lv->IR_Data[n],
+                           N, lv->nPartitions, lv->rbCnt * (N << 1));
+      csound->RealFFT2(csound, lv->invsetup, lv->tmpBuf);
+      for (i = 0; i < (N << 1); i++)
+        out[n][(pos + (uint32_t) i) & mask] += lv->tmpBuf[i];
+    }
+}
+
+/* The worker takes the posted blocks of the background levels, those
+   of the shortest partitions first, as those are due soonest.  The list
+   lock is held only to choose a block, never while computing it. */
+
+static uintptr_t ftconv_worker(void *arg)
+{
+    FTCONV_POOL   *w = (FTCONV_POOL*) arg;
+    CSOUND        *csound = w->csound;
+    FTCONV        *p, *q;
+    FTCONV_LEVEL  *lv, *l;
+    int           i;
+
+    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+    while (w->running) {
+      csound->LockMutex(w->mutex);
+      p = NULL;
+      lv = NULL;
+      for (q = w->top; q != NULL; q = q->nxt) {
+        for (i = 0; i < q->nLevels; i++) {
+          l = &(q->level[i]);
+          if (l->bg && l->done != l->posted) {
+            if (lv == NULL || l->partSize < lv->partSize) {
+              lv = l;
+              p = q;
+            }
+            break;
+          }
+        }
+      }
+      if (p != NULL)
+        p->busy = 1;
+      csound->UnlockMutex(w->mutex);
+      if (p == NULL) {
+        csound->WaitThreadLock(w->wakeLock, (size_t) 10);
+        continue;
+      }
+      level_block(csound, p, lv, p->bgOut);
+      csound->LockMutex(w->mutex);
+      lv->done++;
+      p->busy = 0;
+      csound->UnlockMutex(w->mutex);
+      csound->NotifyThreadLock(w->doneLock);
+    }
+    return (uintptr_t) 0;
+}
+
+static int ftconv_pool_stop(CSOUND *csound, void *pp)
+{
+    FTCONV_POOL *w = (FTCONV_POOL*) pp;
+
+    w->running = 0;
+    csound->NotifyThreadLock(w->wakeLock);
+    csound->JoinThread(w->thread);
+    csound->DestroyThreadLock(w->wakeLock);
+    csound->DestroyThreadLock(w->doneLock);
+    csound->DestroyMutex(w->mutex);
+    return OK;
+}
+
+static FTCONV_POOL *ftconv_pool(CSOUND *csound)
+{
+    FTCONV_POOL *w;
+
+    w = (FTCONV_POOL*) csound->QueryGlobalVariable(csound, FTCONV_POOL_GLOBAL);
+    if (w != NULL)
+      return w;
+    if (UNLIKELY(csound->CreateGlobalVariable(csound, FTCONV_POOL_GLOBAL,
+                                              sizeof(FTCONV_POOL)) != 0))
+      return NULL;
+    w = (FTCONV_POOL*) csound->QueryGlobalVariable(csound, FTCONV_POOL_GLOBAL);
+    w->csound = csound;
+    w->running = 1;
+    w->wakeLock = csound->CreateThreadLock();
+    w->doneLock = csound->CreateThreadLock();
+    w->mutex = csound->Create_Mutex(0);
+    w->thread = csound->CreateThread(ftconv_worker, (void*) w);
+    if (UNLIKELY(w->thread == NULL)) {
+      csound->DestroyThreadLock(w->wakeLock);
+      csound->DestroyThreadLock(w->doneLock);
+      csound->DestroyMutex(w->mutex);
+      csound->DestroyGlobalVariable(csound, FTCONV_POOL_GLOBAL);
+      return NULL;
+    }
+    csound->RegisterResetCallback(csound, (void*) w, ftconv_pool_stop);
+    return w;
+}
+
+/* Takes the instance off the worker's queue.  Nothing is joined; only a
+   block that the worker is computing for the instance at the time is let
+   finish, as it writes to the instance's buffers.  Blocks posted and not
+   yet computed stay posted, for an init with iSkipInit to queue again. */
+
+static void ftconv_unqueue(CSOUND *csound, FTCONV *p)
+{
+    FTCONV      **qq;
+    FTCONV_POOL *w = (FTCONV_POOL*) p->pool;
+
+    if (w == NULL)
+      return;
+    csound->LockMutex(w->mutex);
+    for (qq = &(w->top); *qq != NULL; qq = &((*qq)->nxt)) {
+      if (*qq == p) {
+        *qq = p->nxt;
+        break;
+      }
+    }
+    csound->UnlockMutex(w->mutex);
+    while (p->busy)
+      csound->Sleep(0);
+    p->pool = NULL;
+}
+
+/* at the end of the note: off the queue, and the IR spectra let go of */
+
+static int ftconv_deinit(CSOUND *csound, void *pp)
+{
+    FTCONV  *p = (FTCONV*) pp;
+
+    ftconv_unqueue(csound, p);
+    irspec_release(csound, p->spec);
+    p->spec = NULL;
+    return OK;
+}
+
+/* levels with partitions of at least two k-periods go to the worker
+   thread; the others, and all of them if the thread cannot be started,
+   are computed in line */
+
+static void queue_levels(CSOUND *csound, FTCONV *p)
+{
+    FTCONV_POOL *w;
+    int         i, nbg = 0;
+
+    for (i = 0; i < p->nLevels; i++) {
+      p->level[i].bg = (p->level[i].partSize >= 2 * (int) CS_KSMPS);
+      nbg += p->level[i].bg;
+    }
+    if (!nbg)
+      return;
+    if (UNLIKELY((w = ftconv_pool(csound)) == NULL)) {
+      csound->Warning(csound, Str("ftconv: could not start worker thread, "
+                                  "computing all partitions in line"));
+      for (i = 0; i < p->nLevels; i++)
+        p->level[i].bg = 0;
+      return;
+    }
+    p->busy = 0;
+    p->pool = (void*) w;
+    csound->LockMutex(w->mutex);
+    p->nxt = w->top;
+    w->top = p;
+    csound->UnlockMutex(w->mutex);
+    csound->NotifyThreadLock(w->wakeLock);  /* blocks left from before */
+}
+
+/* the IR spectra: taken from the cache if the same table data has been
+   transformed with the same partitioning before, otherwise calculated and
+   added to it; the uniform layout reads whole partitions from the table,
+   the non-uniform one n frames */
+
+static void ftconv_spectra(CSOUND *csound, FTCONV *p, FUNC *ftp, int n,
+                           int skipSamples, int maxPartSize)
+{
+    IRSPEC  key;
+    int     i, j;
+    MYFLT   FFTscale;
+
+    memset(&key, 0, sizeof(IRSPEC));
+    key.kind = IRSPEC_FTCONV;
+    key.fno = ftp->fno;
+    key.flen = ftp->flen;
+    key.partSize = p->partSize;
+    key.maxPartSize = (p->nLevels > 0 ? maxPartSize : 0);
+    key.skip = skipSamples;
+    key.len = (p->nLevels > 0 ? n : p->nPartitions * p->partSize);
+    key.channel = p->nChannels;
+    key.hash = irspec_hash_table(ftp, key.skip, key.len, p->nChannels);
+    irspec_release(csound, p->spec);
+    p->spec = irspec_find(csound, &key);
+    if (p->spec != NULL) {
+      set_ir_pointers(p, p->spec->data);
+      return;
+    }
+    p->spec = irspec_new(csound, &key, ir_smps(p));
+    set_ir_pointers(p, p->spec->data);
+    /* calculate FFT of impulse response partitions, in reverse order */
+    /* also apply FFT amplitude scale here */
+    FFTscale = csound->GetInverseRealFFTScale(csound, (p->partSize << 1));
+    for (j = 0; j < p->nChannels; j++)
+      load_ir_partitions(csound, p, ftp, p->IR_Data[j], p->fwdsetup, j,
+                         skipSamples, 0, key.len,
+                         p->partSize, p->nPartitions, FFTscale);
+    for (i = 0; i < p->nLevels; i++) {
+      FTCONV_LEVEL *lv = &(p->level[i]);
+      FFTscale = csound->GetInverseRealFFTScale(csound, lv->partSize << 1);
+      for (j = 0; j < p->nChannels; j++)
+        load_ir_partitions(csound, p, ftp, lv->IR_Data[j], lv->fwdsetup, j,
+                           skipSamples, lv->start, n,
+                           lv->partSize, lv->nPartitions, FFTscale);
+    }
+    irspec_insert(csound, p->spec);
+}
+
 static int ftconv_init(CSOUND *csound, FTCONV *p)
 {
     FUNC    *ftp;
-    int     i, j, k, n, nBytes, skipSamples;
-    MYFLT   FFTscale;
+    int     i, j, n, nBytes, tailBytes, skipSamples, maxPartSize;
 
+    /* off the worker's queue if the instance is initialised again */
+    ftconv_unqueue(csound, p);
     /* check parameters */
     p->nChannels = (int) p->OUTOCOUNT;
     if (UNLIKELY(p->nChannels < 1 || p->nChannels > FTCONV_MAXCHN)) {
@@ -162,6 +568,13 @@ static int ftconv_init(CSOUND *csound, FTCONV *p)
       return csound->InitError(csound, Str("ftconv: invalid impulse response "
                                            "partition length"));
     }
+    /* maximum partition length of the non-uniform mode */
+    maxPartSize = MYFLT2LRND(*(p->iMaxPartLen));
+    if (maxPartSize > p->partSize &&
+        UNLIKELY((maxPartSize & (maxPartSize - 1)) != 0)) {
+      return csound->InitError(csound, Str("ftconv: invalid maximum "
+                                           "partition length"));
+    }
     ftp = csound->FTnp2Find(csound, p->iFTNum);
     if (UNLIKELY(ftp == NULL))
       return NOTOK; /* ftfind should already have printed the error message */
@@ -177,12 +590,29 @@ static int ftconv_init(CSOUND *csound, FTCONV *p)
                                    " IR data for convolution"));
     }
     p->nPartitions = (n + (p->partSize - 1)) / p->partSize;
+    p->nLevels = 0;
+    if (maxPartSize > p->partSize && p->nPartitions > 3) {
+      p->nPartitions = 3;
+      p->nLevels = set_levels(p, n, p->partSize, maxPartSize);
+    }
     /* calculate the amount of aux space to allocate (in bytes) */
     nBytes = buf_bytes_alloc(p->nChannels, p->partSize, p->nPartitions);
-    if (nBytes != (int) p->auxData.size)
+    tailBytes = (p->nLevels > 0 ? tail_bytes_alloc(p, p->nChannels) : 0);
+    if (nBytes != (int) p->auxData.size ||
+        (tailBytes > 0 && tailBytes != (int) p->tailData.size)) {
       csound->AuxAlloc(csound, (int32) nBytes, &(p->auxData));
-    else if (p->initDone > 0 && *(p->iSkipInit) != FL(0.0))
+      if (tailBytes > 0)
+        csound->AuxAlloc(csound, (int32) tailBytes, &(p->tailData));
+    }
+    else if (p->initDone > 0 && *(p->iSkipInit) != FL(0.0)) {
+      /* the spectra were let go of at the end of the last note */
+      if (p->spec == NULL)
+        ftconv_spectra(csound, p, ftp, n, skipSamples, maxPartSize);
+      if (p->nLevels > 0)
+        queue_levels(csound, p);
+      csound->RegisterDeinitCallback(csound, p, ftconv_deinit);
       return OK;    /* skip initialisation if requested */
+    }
     /* if skipping samples: check for possible truncation of IR */
     /*
       if (skipSamples > 0 && (csound->oparms->msglevel & WARNMSG)) {
@@ -201,48 +631,100 @@ static int ftconv_init(CSOUND *csound, FTCONV *p)
     /* initialise buffer pointers */
     set_buf_pointers(p, p->nChannels, p->partSize, p->nPartitions);
     /* clear ring buffer to zero */
-    n = (p->partSize << 1) * p->nPartitions;
-    memset(p->ringBuf, 0, n*sizeof(MYFLT));
+    memset(p->ringBuf, 0, (p->partSize << 1) * p->nPartitions * sizeof(MYFLT));
     /* for (i = 0; i < n; i++) */
     /*   p->ringBuf[i] = FL(0.0); */
     /* initialise buffer index */
     p->cnt = 0;
     p->rbCnt = 0;
-    /* calculate FFT of impulse response partitions, in reverse order */
-    /* also apply FFT amplitude scale here */
-    FFTscale = csound->GetInverseRealFFTScale(csound, (p->partSize << 1));
+    /* FFT setups */
+    csound->RealFFT2Release(csound, p->fwdsetup);
     p->fwdsetup = csound->RealFFT2Setup(csound,(p->partSize << 1), FFT_FWD);
+    csound->RealFFT2Release(csound, p->invsetup);
     p->invsetup = csound->RealFFT2Setup(csound,(p->partSize << 1), FFT_INV);
-    for (j = 0; j < p->nChannels; j++) {
-      i = (skipSamples * p->nChannels) + j;           /* table read position */
-      n = (p->partSize << 1) * (p->nPartitions - 1);  /* IR write position */
-      do {
-        for (k = 0; k < p->partSize; k++) {
-          if (i >= 0 && i < (int) ftp->flen)
-            p->IR_Data[j][n + k] = ftp->ftable[i] * FFTscale;
-          else
-            p->IR_Data[j][n + k] = FL(0.0);
-          i += p->nChannels;
-        }
-        /* pad second half of IR to zero */
-        for (k = p->partSize; k < (p->partSize << 1); k++)
-          p->IR_Data[j][n + k] = FL(0.0);
-        /* calculate FFT */
-        csound->RealFFT2(csound, p->fwdsetup, &(p->IR_Data[j][n]));
-        n -= (p->partSize << 1);
-      } while (n >= 0);
-    }
     /* clear output buffers to zero */
     /*memset(p->outBuffers, 0, p->nChannels*(p->partSize << 1)*sizeof(MYFLT));*/
     for (j = 0; j < p->nChannels; j++) {
       for (i = 0; i < (p->partSize << 1); i++)
         p->outBuffers[j][i] = FL(0.0);
     }
+    /* the tail levels, if any */
+    if (p->nLevels > 0) {
+      set_tail_pointers(p, p->nChannels);
+      memset(p->tailData.auxp, 0, tailBytes);
+      p->t = 0;
+      for (i = 0; i < p->nLevels; i++) {
+        FTCONV_LEVEL *lv = &(p->level[i]);
+        int N2 = lv->partSize << 1;
+        lv->rbCnt = 0;
+        lv->pos = 0;
+        lv->posted = lv->done = 0;
+        csound->RealFFT2Release(csound, lv->fwdsetup);
+        lv->fwdsetup = csound->RealFFT2Setup(csound, N2, FFT_FWD);
+        csound->RealFFT2Release(csound, lv->invsetup);
+        lv->invsetup = csound->RealFFT2Setup(csound, N2, FFT_INV);
+      }
+    }
+    ftconv_spectra(csound, p, ftp, n, skipSamples, maxPartSize);
+    if (p->nLevels > 0)
+      queue_levels(csound, p);
+    csound->RegisterDeinitCallback(csound, p, ftconv_deinit);
     p->initDone = 1;
 
     return OK;
 }
 
+/* before the output at a boundary of a background level, the block the
+   worker was given one block earlier must be done */
+
+static void wait_levels(CSOUND *csound, FTCONV *p)
+{
+    FTCONV_POOL   *w = (FTCONV_POOL*) p->pool;
+    FTCONV_LEVEL  *lv;
+    int           i;
+    uint32_t      pending;
+
+    for (i = 0; i < p->nLevels; i++) {
+      lv = &(p->level[i]);
+      if (!lv->bg || (p->t & (uint32_t) (lv->partSize - 1)) != 0)
+        continue;
+      for (;;) {
+        csound->LockMutex(w->mutex);
+        pending = lv->posted - lv->done;
+        csound->UnlockMutex(w->mutex);
+        if (pending <= 1)
+          break;
+        csound->WaitThreadLock(w->doneLock, (size_t) 1);
+      }
+    }
+}
+
+/* at the end of each head partition: hand the completed blocks of the
+   tail levels to the worker, or compute them */
+
+static void post_levels(CSOUND *csound, FTCONV *p)
+{
+    FTCONV_POOL   *w = (FTCONV_POOL*) p->pool;
+    FTCONV_LEVEL  *lv;
+    int           i, wake = 0;
+
+    for (i = 0; i < p->nLevels; i++) {
+      lv = &(p->level[i]);
+      if ((p->t & (uint32_t) (lv->partSize - 1)) != 0)
+        continue;
+      if (lv->bg) {
+        csound->LockMutex(w->mutex);
+        lv->posted++;
+        csound->UnlockMutex(w->mutex);
+        wake = 1;
+      }
+      else
+        level_block(csound, p, lv, p->fgOut);
+    }
+    if (wake)
+      csound->NotifyThreadLock(w->wakeLock);
+}
+
 static int ftconv_perf(CSOUND *csound, FTCONV *p)
 {
     MYFLT         *x, *rBuf;
@@ -265,9 +747,24 @@ static int ftconv_perf(CSOUND *csound, FTCONV *p)
     for (nn = offset; nn < nsmps; nn++) {
       /* store input signal in buffer */
       rBuf[p->cnt] = p->aIn[nn];
-      /* copy output signals from buffer */
-      for (n = 0; n < p->nChannels; n++)
-        p->aOut[n][nn] = p->outBuffers[n][p->cnt];
+      if (p->nLevels > 0) {
+        /* non-uniform: add the output of the tail levels */
+        uint32_t m = p->t & (uint32_t) (p->ringSize - 1);
+        if (p->cnt == 0 && p->pool != NULL)
+          wait_levels(csound, p);
+        p->inRing[m] = p->aIn[nn];
+        for (n = 0; n < p->nChannels; n++) {
+          p->aOut[n][nn] = p->outBuffers[n][p->cnt]
+                           + p->fgOut[n][m] + p->bgOut[n][m];
+          p->fgOut[n][m] = p->bgOut[n][m] = FL(0.0);
+        }
+        p->t++;
+      }
+      else {
+        /* copy output signals from buffer */
+        for (n = 0; n < p->nChannels; n++)
+          p->aOut[n][nn] = p->outBuffers[n][p->cnt];
+      }
       /* is input buffer full ? */
       if (++p->cnt < nSamples)
         continue;                   /* no, continue with next sample */
@@ -297,6 +794,8 @@ static int ftconv_perf(CSOUND *csound, FTCONV *p)
           x[i + nSamples] = p->tmpBuf[i + nSamples];
         }
       }
+      if (p->nLevels > 0)
+        post_levels(csound, p);
     }
     return OK;
  err1:
@@ -309,7 +808,7 @@ static int ftconv_perf(CSOUND *csound, FTCONV *p)
 int ftconv_init_(CSOUND *csound)
 {
     return csound->AppendOpcode(csound, "ftconv",
-                                (int) sizeof(FTCONV), TR, 5, "mmmmmmmm", "aiiooo",
+                                (int) sizeof(FTCONV), TR, 5, "mmmmmmmm", "aiioooo",
                                 (int (*)(CSOUND *, void *)) ftconv_init,
                                 (int (*)(CSOUND *, void *)) NULL,
                                 (int (*)(CSOUND *, void *)) ftconv_perf);
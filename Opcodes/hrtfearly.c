@@ -226,6 +226,9 @@ typedef struct
   /* file pointers*/
   float *fpbeginl, *fpbeginr;
 
+  /* FFT setups, for irlength and irlengthpad */
+  void *invsetup, *fwdsetuppad, *invsetuppad;
+
 } early;
 
 static int early_init(CSOUND *csound, early *p)
@@ -339,6 +342,12 @@ static int early_init(CSOUND *csound, early *p)
     /* setup structure values */
     p->irlength = irlength;
     p->irlengthpad = irlengthpad;
+    csound->RealFFT2Release(csound, p->invsetup);
+    p->invsetup = csound->RealFFT2Setup(csound, irlength, FFT_INV);
+    csound->RealFFT2Release(csound, p->fwdsetuppad);
+    p->fwdsetuppad = csound->RealFFT2Setup(csound, irlengthpad, FFT_FWD);
+    csound->RealFFT2Release(csound, p->invsetuppad);
+    p->invsetuppad = csound->RealFFT2Setup(csound, irlengthpad, FFT_INV);
     p->overlapsize = overlapsize;
     p->c = 344.0;
 
@@ -1487,10 +1496,8 @@ static int early_process(CSOUND *csound, early *p)
                     hrtfrinterp[i + 1] = magr * FL(sin(phaser));
                   }
 
-                  csound->InverseRealFFT(csound, hrtflinterp,
-                                         irlength);
-                  csound->InverseRealFFT(csound, hrtfrinterp,
-                                         irlength);
+                  csound->RealFFT2(csound, p->invsetup, hrtflinterp);
+                  csound->RealFFT2(csound, p->invsetup, hrtfrinterp);
 
                   /* wall filters... */
                   /* all 4 walls are the same! (trivial to
@@ -1627,8 +1634,8 @@ static int early_process(CSOUND *csound, early *p)
                   }
 
                   /* back to freq domain */
-                  csound->RealFFT(csound, hrtflpad, irlengthpad);
-                  csound->RealFFT(csound, hrtfrpad, irlengthpad);
+                  csound->RealFFT2(csound, p->fwdsetuppad, hrtflpad);
+                  csound->RealFFT2(csound, p->fwdsetuppad, hrtfrpad);
 
                   /* store */
                   for (i = 0; i < irlengthpad; i++) {
@@ -1665,7 +1672,7 @@ static int early_process(CSOUND *csound, early *p)
               for (i = irlength; i <  irlengthpad; i++)
                 inbufpad[i] = FL(0.0);
 
-              csound->RealFFT(csound, inbufpad, irlengthpad);
+              csound->RealFFT2(csound, p->fwdsetuppad, inbufpad);
 
               for (i = 0; i < irlengthpad; i ++) {
                 hrtflpad[i] = hrtflpadspec[M * irlengthpad + i];
@@ -1678,8 +1685,8 @@ static int early_process(CSOUND *csound, early *p)
               csound->RealFFTMult(csound, outrspec, hrtfrpad,
                                   inbufpad, irlengthpad, FL(1.0));
 
-              csound->InverseRealFFT(csound, outlspec, irlengthpad);
-              csound->InverseRealFFT(csound, outrspec, irlengthpad);
+              csound->RealFFT2(csound, p->invsetuppad, outlspec);
+              csound->RealFFT2(csound, p->invsetuppad, outrspec);
 
               /* scale */
               for (i = 0; i < irlengthpad; i++) {
@@ -1712,10 +1719,8 @@ static int early_process(CSOUND *csound, early *p)
                                     inbufpad, irlengthpad, FL(1.0));
 
                 /* ifft, back to time domain */
-                csound->InverseRealFFT(csound, outlspecold,
-                                       irlengthpad);
-                csound->InverseRealFFT(csound, outrspecold,
-                                       irlengthpad);
+                csound->RealFFT2(csound, p->invsetuppad, outlspecold);
+                csound->RealFFT2(csound, p->invsetuppad, outrspecold);
 
                 /* scale */
                 for (i = 0; i < irlengthpad; i++) {
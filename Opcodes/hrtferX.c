@@ -141,6 +141,10 @@ static int hrtferxkSet(CSOUND *csound, HRTFER *p)
     /* } */
     memset(p->bl, 0, FILT_LENm1*sizeof(MYFLT));
     memset(p->br, 0, FILT_LENm1*sizeof(MYFLT));
+    csound->RealFFT2Release(csound, p->fwdsetup);
+    p->fwdsetup = csound->RealFFT2Setup(csound, BUF_LEN, FFT_FWD);
+    csound->RealFFT2Release(csound, p->invsetup);
+    p->invsetup = csound->RealFFT2Setup(csound, BUF_LEN, FFT_INV);
     return OK;
 }
 
@@ -256,8 +260,8 @@ static int hrtferxk(CSOUND *csound, HRTFER *p)
         /**************
         FFT xl and xr here
         ***************/
-    csound->RealFFT(csound, xl, BUF_LEN);
-    csound->RealFFT(csound, xr, BUF_LEN);
+    csound->RealFFT2(csound, p->fwdsetup, xl);
+    csound->RealFFT2(csound, p->fwdsetup, xr);
 
         /* If azimuth called for right side of head, use left side
            measurements and flip output channels.
@@ -328,15 +332,15 @@ static int hrtferxk(CSOUND *csound, HRTFER *p)
               /* pad x to BUF_LEN with zeros for Moore FFT */
         for (i = FILT_LEN; i <  BUF_LEN; i++)
           x[i] = FL(0.0);
-        csound->RealFFT(csound, x, BUF_LEN);
+        csound->RealFFT2(csound, p->fwdsetup, x);
 
               /* complex multiplication, y = hrtf_data * x */
         csound->RealFFTMult(csound, yl, hrtf_data.left, x, BUF_LEN, FL(1.0));
         csound->RealFFTMult(csound, yr, hrtf_data.right, x, BUF_LEN, FL(1.0));
 
               /* convolution is the inverse FFT of above result (yl,yr) */
-        csound->InverseRealFFT(csound, yl, BUF_LEN);
-        csound->InverseRealFFT(csound, yr, BUF_LEN);
+        csound->RealFFT2(csound, p->invsetup, yl);
+        csound->RealFFT2(csound, p->invsetup, yr);
             /* overlap-add the results */
         for (i = 0; i < FILT_LENm1; i++) {
           yl[i] += bl[i];
@@ -39,4 +39,5 @@ typedef struct {
   MYFLT         outl[BUF_LEN], outr[BUF_LEN];
   MYFLT         x[BUF_LEN], yl[BUF_LEN], yr[BUF_LEN];
   MYFLT         bl[FILT_LENm1], br[FILT_LENm1];
+  void          *fwdsetup, *invsetup;         /* FFT setups */
 } HRTFER;
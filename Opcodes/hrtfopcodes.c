@@ -23,6 +23,7 @@
 
 #include "csoundCore.h"
 #include "interlocks.h"
+#include "irspec.h"
 
 #include <math.h>
 /* definitions */
@@ -52,9 +53,17 @@ static const float nonlinitd96k[5] =
 static const int elevationarray[14] =
   {56, 60, 72, 72, 72, 72, 72, 60, 56, 45, 36, 24, 12, 1 };
 
+/* points stored in the data files, and measured in all: see hrtf_grid() */
+#define HRTF_NSTORED (368)
+#define HRTF_NPOINTS (710)
+
+/* first point of each elevation in the full circles */
+static const int elevationoffset[14] =
+  {0, 56, 116, 188, 260, 332, 404, 476, 536, 592, 637, 673, 697, 709};
+
 /* assumed mit hrtf data will be used here. Otherwise delay data would need
    to be extracted and replaced here... */
-static const float minphasedels[368] =
+static const float minphasedels[HRTF_NSTORED] =
 {
   0.000000f, 0.000045f, 0.000091f, 0.000136f, 0.000159f, 0.000204f,
   0.000249f, 0.000272f, 0.000295f, 0.000317f, 0.000363f, 0.000385f,
@@ -141,6 +150,333 @@ static int swap4bytes(CSOUND* csound, MEMFIL* mfp)
 static int (*swap4bytes)(CSOUND*, MEMFIL*) = NULL;
 #endif
 
+/* The spectra of all measured points, shared by the instances that read
+   the same pair of data files (kept in the IR spectrum cache).  The files
+   hold half circles only: (elevationarray[i] / 2) + 1 points from 0
+   degrees for elevation i, the others being the mirror images of these
+   with the ears switched.  The grid is of the full circles, mirrored once
+   on loading.  For each point and ear it holds nbins = irlength / 2 + 1
+   magnitudes (0 Hz, the bins, Nyquist) and then the unit phasors of the
+   measured phases, real parts and then imaginary parts; 0 Hz and Nyquist
+   are stored as real values, so that their phasors are 1 or -1.  After
+   the spectra come the minimum phase delays of the points.  A point is
+   read at an offset, and the interpolation of magnitudes and the phase
+   truncation are straight loops over the bins. */
+
+static inline const MYFLT *hrtf_point(const MYFLT *grid, int nbins,
+                                      int point, int ear)
+{
+    return grid + (size_t)(2 * point + ear) * 3 * nbins;
+}
+
+static inline const MYFLT *hrtf_delays(const MYFLT *grid, int nbins)
+{
+    return grid + (size_t)HRTF_NPOINTS * 6 * nbins;
+}
+
+static int hrtf_grid(CSOUND *csound, IRSPEC **spec,
+                     STRINGDAT *ifilel, STRINGDAT *ifiler, int irlength)
+{
+    /* left and right data files: spectral mag, phase format. */
+    MEMFIL *fpl = NULL, *fpr = NULL;
+    char filel[MAXNAME], filer[MAXNAME], name[2 * MAXNAME + 1];
+    const float *fpindexl, *fpindexr, *data;
+    int nbins = irlength / 2 + 1;
+    int i, j, k, ear, mirror, stored, src, point;
+    MYFLT *grid, *mag, *re, *im;
+    IRSPEC key;
+
+    /* copy in string name */
+    strncpy(filel, (char*) ifilel->data, MAXNAME-1); filel[MAXNAME-1] = '\0';
+    strncpy(filer, (char*) ifiler->data, MAXNAME-1); filer[MAXNAME-1] = '\0';
+
+    /* reading files, with byte swap */
+    fpl = csound->ldmemfile2withCB(csound, filel, CSFTYPE_FLOATS_BINARY,
+                                   swap4bytes);
+    if (UNLIKELY(fpl == NULL))
+      return
+        csound->InitError(csound,
+                          Str("\n\n\nCannot load left data file, exiting\n\n"));
+
+    fpr = csound->ldmemfile2withCB(csound, filer, CSFTYPE_FLOATS_BINARY,
+                                   swap4bytes);
+    if (UNLIKELY(fpr == NULL))
+      return
+        csound->InitError(csound,
+                          Str("\n\n\nCannot load right data file, exiting\n\n"));
+
+    if (UNLIKELY(fpl->length < (int32)(HRTF_NSTORED * irlength * sizeof(float)) ||
+                 fpr->length < (int32)(HRTF_NSTORED * irlength * sizeof(float))))
+      return
+        csound->InitError(csound,
+                          Str("HRTF data files too short for the sr of %d "
+                              "point impulses"), irlength);
+
+    memset(&key, 0, sizeof(IRSPEC));
+    key.kind = IRSPEC_HRTF;
+    snprintf(name, sizeof(name), "%s|%s", filel, filer);
+    key.name = name;
+    key.partSize = irlength;
+    key.channel = 2;
+    irspec_release(csound, *spec);
+    *spec = irspec_find(csound, &key);
+    if (*spec != NULL)
+      return OK;
+
+    *spec = irspec_new(csound, &key, (size_t)HRTF_NPOINTS * (6 * nbins + 1));
+    (*spec)->nChannels = 2;
+    (*spec)->nPartitions = HRTF_NPOINTS;
+    grid = (*spec)->data;
+    fpindexl = (const float *) fpl->beginp;
+    fpindexr = (const float *) fpr->beginp;
+
+    for (i = 0, stored = 0; i < 14; stored += elevationarray[i] / 2 + 1, i++)
+      for (j = 0; j < elevationarray[i]; j++) {
+        point = elevationoffset[i] + j;
+        /* switch l and r in the mirrored half */
+        mirror = (j > elevationarray[i] / 2);
+        src = stored + (mirror ? elevationarray[i] - j : j);
+        for (ear = 0; ear < 2; ear++) {
+          data = ((ear == 0) != mirror ? fpindexl : fpindexr) +
+            (size_t)src * irlength;
+          mag = (MYFLT *) hrtf_point(grid, nbins, point, ear);
+          re = mag + nbins;
+          im = re + nbins;
+          mag[0] = FABS((MYFLT) data[0]);
+          re[0] = (data[0] < 0.0f ? -FL(1.0) : FL(1.0));
+          im[0] = FL(0.0);
+          mag[nbins - 1] = FABS((MYFLT) data[1]);
+          re[nbins - 1] = (data[1] < 0.0f ? -FL(1.0) : FL(1.0));
+          im[nbins - 1] = FL(0.0);
+          for (k = 1; k < nbins - 1; k++) {
+            mag[k] = (MYFLT) data[2 * k];
+            re[k] = COS((MYFLT) data[2 * k + 1]);
+            im[k] = SIN((MYFLT) data[2 * k + 1]);
+          }
+        }
+        grid[(size_t)HRTF_NPOINTS * 6 * nbins + point] =
+          (MYFLT) minphasedels[src];
+      }
+    irspec_insert(csound, *spec);
+    return OK;
+}
+
+/* the hold of an instance on the spectra ends with the note */
+
+static void hrtf_grid_release(CSOUND *csound, IRSPEC **spec)
+{
+    irspec_release(csound, *spec);
+    *spec = NULL;
+}
+
+/* the 4 points nearest to a direction, 2 at the elevation below it and 2
+   above, with the weights to interpolate them; and the nearest point */
+
+typedef struct {
+    int low1, low2, high1, high2, nearest;
+    MYFLT angleindex2per, angleindex4per, elevindexhighper;
+} HRTFLOC;
+
+static void hrtf_locate(MYFLT angle, MYFLT elev, HRTFLOC *loc)
+{
+    MYFLT elevindexstore, angleindexlowstore, angleindexhighstore;
+    int elevindex, elevindexlow, elevindexhigh, angleindex,
+      angleindex1, angleindex3;
+
+    /* two nearest elev indices to avoid recalculating */
+    elevindexstore = (elev - minelev) / elevincrement;
+    elevindexlow = (int)elevindexstore;
+
+    if(elevindexlow < 13)
+      elevindexhigh = elevindexlow + 1;
+    /* highest index reached */
+    else
+      elevindexhigh = elevindexlow;
+
+    /* get percentage value for interpolation */
+    loc->elevindexhighper = elevindexstore - elevindexlow;
+
+    /* lookup indices, used to check for crossfade */
+    elevindex = (int)(elevindexstore + FL(0.5));
+
+    angleindex = (int)(angle / (FL(360.0) / elevationarray[elevindex])
+                       + FL(0.5));
+    angleindex = angleindex % elevationarray[elevindex];
+    loc->nearest = elevationoffset[elevindex] + angleindex;
+
+    /* avoid recalculation */
+    angleindexlowstore = angle / (FL(360.0) / elevationarray[elevindexlow]);
+    angleindexhighstore = angle / (FL(360.0) / elevationarray[elevindexhigh]);
+
+    /* 4 closest indices, 2 low and 2 high */
+    angleindex1 = (int)angleindexlowstore;
+    angleindex3 = (int)angleindexhighstore;
+
+    /* angle percentages for interp */
+    loc->angleindex2per = angleindexlowstore - angleindex1;
+    loc->angleindex4per = angleindexhighstore - angleindex3;
+
+    loc->low1 = elevationoffset[elevindexlow] +
+      angleindex1 % elevationarray[elevindexlow];
+    loc->low2 = elevationoffset[elevindexlow] +
+      (angleindex1 + 1) % elevationarray[elevindexlow];
+    loc->high1 = elevationoffset[elevindexhigh] +
+      angleindex3 % elevationarray[elevindexhigh];
+    loc->high2 = elevationoffset[elevindexhigh] +
+      (angleindex3 + 1) % elevationarray[elevindexhigh];
+}
+
+/* magnitudes of both ears, interpolated from the 4 nearest points */
+
+static void hrtf_interp(const MYFLT *grid, int nbins, const HRTFLOC *loc,
+                        MYFLT *magl, MYFLT *magr)
+{
+    MYFLT angleindex2per = loc->angleindex2per;
+    MYFLT angleindex4per = loc->angleindex4per;
+    MYFLT elevindexhighper = loc->elevindexhighper;
+    MYFLT maglow, maghigh, *mag;
+    const MYFLT *low1, *low2, *high1, *high2;
+    int ear, k;
+
+    for (ear = 0; ear < 2; ear++) {
+      low1 = hrtf_point(grid, nbins, loc->low1, ear);
+      low2 = hrtf_point(grid, nbins, loc->low2, ear);
+      high1 = hrtf_point(grid, nbins, loc->high1, ear);
+      high2 = hrtf_point(grid, nbins, loc->high2, ear);
+      mag = (ear == 0 ? magl : magr);
+      for (k = 0; k < nbins; k++) {
+        maglow = low1[k] + (low2[k] - low1[k]) * angleindex2per;
+        maghigh = high1[k] + (high2[k] - high1[k]) * angleindex4per;
+        mag[k] = maglow + (maghigh - maglow) * elevindexhighper;
+      }
+    }
+}
+
+/* packed spectrum of magnitudes mag with the phases of a point (phase
+   truncation) */
+
+static void hrtf_rect(const MYFLT *mag, const MYFLT *point, int nbins,
+                      MYFLT *out)
+{
+    const MYFLT *re = point + nbins, *im = re + nbins;
+    int k;
+
+    /* 0 Hz and Nyq: if neg real, 180 degree phase */
+    out[0] = mag[0] * re[0];
+    out[1] = mag[nbins - 1] * re[nbins - 1];
+    for (k = 1; k < nbins - 1; k++) {
+      out[2 * k] = mag[k] * re[k];
+      out[2 * k + 1] = mag[k] * im[k];
+    }
+}
+
+/* packed log magnitudes and 0 phases, for the min phase process: do not
+   allow log(0.0) */
+
+static void hrtf_logmag(const MYFLT *mag, int nbins, MYFLT *out)
+{
+    int k;
+
+    out[0] = LOG(mag[0] == FL(0.0) ? FL(0.00000001) : mag[0]);
+    out[1] = LOG(mag[nbins - 1] == FL(0.0) ? FL(0.00000001) : mag[nbins - 1]);
+    for (k = 1; k < nbins - 1; k++) {
+      out[2 * k] = LOG(mag[k] == FL(0.0) ? FL(0.00000001) : mag[k]);
+      out[2 * k + 1] = FL(0.0);
+    }
+}
+
+/* packed spectra of magnitudes magl, magr with the phases of the
+   woodworth model of the itd of a head of radius r */
+
+static void hrtf_woodworth(const MYFLT *magl, const MYFLT *magr, int nbins,
+                           MYFLT sr, MYFLT sroverN, MYFLT angle, MYFLT elev,
+                           MYFLT r, MYFLT *hrtfl, MYFLT *hrtfr)
+{
+    MYFLT radianangle, radianelev, itd = FL(0.0), itdww, freq, phase, re, im;
+    const float *nonlin;
+    int k;
+
+    /* ITD formula, check which ear is relevant to calculate angle from */
+    if(angle > FL(180.0))
+      radianangle = (angle - FL(180.0)) * PI_F / FL(180.0);
+    else
+      radianangle = angle * PI_F / FL(180.0);
+    /* degrees to radians */
+    radianelev = elev * PI_F / FL(180.0);
+
+    /* get in correct range for formula */
+    if(radianangle > PI_F / FL(2.0))
+      radianangle = FL(PI) - radianangle;
+
+    /* woodworth formula for itd */
+    itdww = (radianangle + SIN(radianangle)) * r * COS(radianelev) / c;
+
+    if(sr == 96000)
+      nonlin = nonlinitd96k;
+    else if(sr == 48000)
+      nonlin = nonlinitd48k;
+    else
+      nonlin = nonlinitd;
+
+    /* 0 Hz and Nyq: magnitudes */
+    hrtfl[0] = magl[0];
+    hrtfl[1] = magl[nbins - 1];
+    hrtfr[0] = magr[0];
+    hrtfr[1] = magr[nbins - 1];
+
+    for(k = 1; k < nbins - 1; k++)
+      {
+        freq = k * sroverN;
+
+        /* non linear itd...last value in array = 1.0, so back to itdww */
+        if(k < 6)
+          itd = itdww * nonlin[k - 1];
+
+        /* the phases of the ears are opposite */
+        phase = TWOPI_F * freq * (itd / 2);
+        re = COS(phase);
+        im = SIN(phase);
+
+        /* polar to rectangular */
+        hrtfl[2 * k] = magl[k] * re;
+        hrtfr[2 * k] = magr[k] * re;
+        if(angle > FL(180.))
+          {
+            hrtfl[2 * k + 1] = magl[k] * im;
+            hrtfr[2 * k + 1] = magr[k] * -im;
+          }
+        else
+          {
+            hrtfl[2 * k + 1] = magl[k] * -im;
+            hrtfr[2 * k + 1] = magr[k] * im;
+          }
+      }
+}
+
+/* spectra of both ears times the input spectrum, in the packed format of
+   csound->RealFFTMult(), in one pass over the input */
+
+static void hrtf_specmult(MYFLT *outl, MYFLT *outr,
+                          const MYFLT *hrtfl, const MYFLT *hrtfr,
+                          const MYFLT *insig, int n)
+{
+    MYFLT re, im;
+    int i;
+
+    outl[0] = hrtfl[0] * insig[0];
+    outl[1] = hrtfl[1] * insig[1];
+    outr[0] = hrtfr[0] * insig[0];
+    outr[1] = hrtfr[1] * insig[1];
+    for (i = 2; i < n; i += 2) {
+      re = insig[i];
+      im = insig[i + 1];
+      outl[i] = (hrtfl[i] * re) - (hrtfl[i + 1] * im);
+      outl[i + 1] = (hrtfl[i] * im) + (re * hrtfl[i + 1]);
+      outr[i] = (hrtfr[i] * re) - (hrtfr[i + 1] * im);
+      outr[i + 1] = (hrtfr[i] * im) + (re * hrtfr[i + 1]);
+    }
+}
+
 /* Csound hrtf magnitude interpolation, phase truncation object */
 
 /* aleft,aright hrtfmove asrc, kaz, kel, ifilel->data, ifiler [, imode = 0,
@@ -160,15 +496,17 @@ typedef struct
         /* check if relative source has changed! */
         MYFLT anglev, elevv;
 
-        float *fpbeginl,*fpbeginr;
+        /* shared spectra of the measured points */
+        IRSPEC *grid;
 
         /* see definitions in INIT */
-        int irlength, irlengthpad, overlapsize;
+        int irlength, irlengthpad, overlapsize, nbins;
 
         MYFLT sr;
 
-        /* old indices for checking if changes occur in trajectory. */
-        int oldelevindex, oldangleindex;
+        /* old nearest point for checking if changes occur in trajectory,
+           and the point of the current phase */
+        int oldpoint, phasepoint;
 
         int counter;
 
@@ -202,10 +540,8 @@ typedef struct
         /* old overlap data for longer crossfades */
         AUXCH overlapoldl, overlapoldr;
 
-        /* interpolation buffers */
-        AUXCH lowl1, lowr1, lowl2, lowr2, highl1, highr1, highl2, highr2;
-        /* current phase buffers */
-        AUXCH currentphasel, currentphaser;
+        /* interpolated magnitudes */
+        AUXCH magl, magr;
 
         /* min phase buffers */
         AUXCH logmagl,logmagr,xhatwinl,xhatwinr,expxhatwinl,expxhatwinr;
@@ -216,15 +552,20 @@ typedef struct
         /* delay */
         AUXCH delmeml, delmemr;
         int ptl, ptr, mdtl, mdtr;
+        /* FFT setups, for irlength and irlengthpad */
+        void *fwdsetup, *invsetup, *fwdsetuppad, *invsetuppad;
 }
 hrtfmove;
 
+static int hrtfmove_deinit(CSOUND *csound, void *p)
+{
+    hrtf_grid_release(csound, &((hrtfmove *) p)->grid);
+    return OK;
+}
+
 static int hrtfmove_init(CSOUND *csound, hrtfmove *p)
 {
-    /* left and right data files: spectral mag, phase format. */
-    MEMFIL *fpl = NULL,*fpr = NULL;
-    int i;
-    char filel[MAXNAME],filer[MAXNAME];
+    int i, nbins;
 
     int mode = (int)*p->omode;
     int fade = (int)*p->ofade;
@@ -276,36 +617,28 @@ static int hrtfmove_init(CSOUND *csound, hrtfmove *p)
         overlapsize = (irlength - 1);
       }
 
-    /* copy in string name */
-    strncpy(filel, (char*) p->ifilel->data, MAXNAME-1); filel[MAXNAME-1]='\0';
-    strncpy(filer, (char*) p->ifiler->data, MAXNAME-1); filel[MAXNAME-1]='\0';
-
-    /* reading files, with byte swap */
-    fpl = csound->ldmemfile2withCB(csound, filel, CSFTYPE_FLOATS_BINARY,
-                                   swap4bytes);
-    if (UNLIKELY(fpl == NULL))
-      return
-        csound->InitError(csound,
-                          Str("\n\n\nCannot load left data file, exiting\n\n"));
-
-    fpr = csound->ldmemfile2withCB(csound, filer, CSFTYPE_FLOATS_BINARY,
-                                   swap4bytes);
-    if (UNLIKELY(fpr == NULL))
-      return
-        csound->InitError(csound,
-                          Str("\n\n\nCannot load right data file, exiting\n\n"));
+    /* the spectra of the data files, shared */
+    if (UNLIKELY(hrtf_grid(csound, &p->grid, p->ifilel, p->ifiler,
+                           irlength) != OK))
+      return NOTOK;
+    csound->RegisterDeinitCallback(csound, p, hrtfmove_deinit);
 
     p->irlength = irlength;
     p->irlengthpad = irlengthpad;
+    csound->RealFFT2Release(csound, p->fwdsetup);
+    p->fwdsetup = csound->RealFFT2Setup(csound, irlength, FFT_FWD);
+    csound->RealFFT2Release(csound, p->invsetup);
+    p->invsetup = csound->RealFFT2Setup(csound, irlength, FFT_INV);
+    csound->RealFFT2Release(csound, p->fwdsetuppad);
+    p->fwdsetuppad = csound->RealFFT2Setup(csound, irlengthpad, FFT_FWD);
+    csound->RealFFT2Release(csound, p->invsetuppad);
+    p->invsetuppad = csound->RealFFT2Setup(csound, irlengthpad, FFT_INV);
     p->overlapsize = overlapsize;
+    p->nbins = nbins = irlength / 2 + 1;
 
     /* the amount of buffers to fade over. */
     p->fadebuffer = (int)fade*irlength;
 
-    /* file handles */
-    p->fpbeginl = (float *) fpl->beginp;
-    p->fpbeginr = (float *) fpr->beginp;
-
     /* common buffers (used by both min phase and phasetrunc) */
     if (!p->insig.auxp || p->insig.size < irlength * sizeof(MYFLT))
       csound->AuxAlloc(csound, irlength*sizeof(MYFLT), &p->insig);
@@ -345,38 +678,14 @@ static int hrtfmove_init(CSOUND *csound, hrtfmove *p)
     memset(p->overlapl.auxp, 0, overlapsize * sizeof(MYFLT));
     memset(p->overlapr.auxp, 0, overlapsize * sizeof(MYFLT));
 
-    /* interpolation values */
-    if (!p->lowl1.auxp || p->lowl1.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->lowl1);
-    if (!p->lowr1.auxp || p->lowr1.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->lowr1);
-    if (!p->lowl2.auxp || p->lowl2.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->lowl2);
-    if (!p->lowr2.auxp || p->lowr2.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->lowr2);
-    if (!p->highl1.auxp || p->highl1.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->highl1);
-    if (!p->highr1.auxp || p->highr1.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->highr1);
-    if (!p->highl2.auxp || p->highl2.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->highl2);
-    if (!p->highr2.auxp || p->highr2.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->highr2);
-    if (!p->currentphasel.auxp || p->currentphasel.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength*sizeof(MYFLT), &p->currentphasel);
-    if (!p->currentphaser.auxp || p->currentphaser.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength*sizeof(MYFLT), &p->currentphaser);
-
-    memset(p->lowl1.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->lowr1.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->lowl2.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->lowr2.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->highl1.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->highl2.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->highr1.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->highr2.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->currentphasel.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->currentphaser.auxp, 0, irlength * sizeof(MYFLT));
+    /* interpolated magnitudes */
+    if (!p->magl.auxp || p->magl.size < nbins * sizeof(MYFLT))
+      csound->AuxAlloc(csound, nbins * sizeof(MYFLT), &p->magl);
+    if (!p->magr.auxp || p->magr.size < nbins * sizeof(MYFLT))
+      csound->AuxAlloc(csound, nbins * sizeof(MYFLT), &p->magr);
+
+    memset(p->magl.auxp, 0, nbins * sizeof(MYFLT));
+    memset(p->magr.auxp, 0, nbins * sizeof(MYFLT));
 
     /* phase truncation buffers and variables */
     if (!p->oldhrtflpad.auxp || p->oldhrtflpad.size < irlengthpad * sizeof(MYFLT))
@@ -413,8 +722,8 @@ static int hrtfmove_init(CSOUND *csound, hrtfmove *p)
 
     /* need to be a value that is not possible for first check to avoid
        phase not being read. */
-    p->oldelevindex = -1;
-    p->oldangleindex = -1;
+    p->oldpoint = -1;
+    p->phasepoint = 0;
 
     /* buffer declaration for min phase calculations */
     if (!p->logmagl.auxp || p->logmagl.size < irlength * sizeof(MYFLT))
@@ -506,11 +815,12 @@ static int hrtfmove_process(CSOUND *csound, hrtfmove *p)
 
     int counter = p->counter;
 
-    /* pointers into HRTF files: floating point data (even in 64 bit csound) */
-    float *fpindexl;
-    float *fpindexr;
+    /* shared spectra of the measured points */
+    const MYFLT *grid = p->grid->data;
+    int nbins = p->nbins;
+    HRTFLOC loc;
 
-    int i,elevindex, angleindex, skip = 0;
+    int i;
 
     int minphase = p->minphase;
     int phasetrunc = p->phasetrunc;
@@ -521,28 +831,9 @@ static int hrtfmove_process(CSOUND *csound, hrtfmove *p)
     int irlengthpad = p->irlengthpad;
     int overlapsize = p->overlapsize;
 
-    /* local variables, mainly used for simplification */
-    MYFLT elevindexstore;
-    MYFLT angleindexlowstore;
-    MYFLT angleindexhighstore;
-
-    /* interpolation values */
-    MYFLT *lowl1 = (MYFLT *)p->lowl1.auxp;
-    MYFLT *lowr1 = (MYFLT *)p->lowr1.auxp;
-    MYFLT *lowl2 = (MYFLT *)p->lowl2.auxp;
-    MYFLT *lowr2 = (MYFLT *)p->lowr2.auxp;
-    MYFLT *highl1 = (MYFLT *)p->highl1.auxp;
-    MYFLT *highr1 = (MYFLT *)p->highr1.auxp;
-    MYFLT *highl2 = (MYFLT *)p->highl2.auxp;
-    MYFLT *highr2 = (MYFLT *)p->highr2.auxp;
-    MYFLT *currentphasel = (MYFLT *)p->currentphasel.auxp;
-    MYFLT *currentphaser = (MYFLT *)p->currentphaser.auxp;
-
-    /* local interpolation values */
-    MYFLT elevindexhighper, angleindex2per, angleindex4per;
-    int elevindexlow, elevindexhigh, angleindex1, angleindex2,
-      angleindex3, angleindex4;
-    MYFLT magl,magr,phasel,phaser, magllow, magrlow, maglhigh, magrhigh;
+    /* interpolated magnitudes */
+    MYFLT *magl = (MYFLT *)p->magl.auxp;
+    MYFLT *magr = (MYFLT *)p->magr.auxp;
 
     /* phase truncation buffers and variables */
     MYFLT *oldhrtflpad = (MYFLT *)p->oldhrtflpad.auxp;
@@ -554,9 +845,6 @@ static int hrtfmove_process(CSOUND *csound, hrtfmove *p)
     MYFLT *overlapoldl = (MYFLT *)p->overlapoldl.auxp;
     MYFLT *overlapoldr = (MYFLT *)p->overlapoldr.auxp;
 
-    int oldelevindex = p ->oldelevindex;
-    int oldangleindex = p ->oldangleindex;
-
     int cross = p ->cross;
     int l = p->l;
     int initialfade = p->initialfade;
@@ -581,7 +869,8 @@ static int hrtfmove_process(CSOUND *csound, hrtfmove *p)
     /* min phase delay variables */
     MYFLT *delmeml = (MYFLT *)p->delmeml.auxp;
     MYFLT *delmemr = (MYFLT *)p->delmemr.auxp;
-    MYFLT delaylow1, delaylow2, delayhigh1, delayhigh2, delaylow, delayhigh;
+    const MYFLT *delays = hrtf_delays(grid, nbins);
+    MYFLT delaylow, delayhigh;
     MYFLT delayfloat = p->delayfloat;
     int ptl = p->ptl;
     int ptr = p->ptr;
@@ -593,10 +882,6 @@ static int hrtfmove_process(CSOUND *csound, hrtfmove *p)
     uint32_t j, nsmps = CS_KSMPS;
     MYFLT outvdl, outvdr, vdtl, vdtr, fracl, fracr, rpl, rpr;
 
-    /* start indices at correct value (start of file)/ zero indices. */
-    fpindexl = (float *) p->fpbeginl;
-    fpindexr = (float *) p->fpbeginr;
-
     if (UNLIKELY(offset)) {
       memset(outsigl, '\0', offset*sizeof(MYFLT));
       memset(outsigr, '\0', offset*sizeof(MYFLT));
@@ -642,52 +927,13 @@ static int hrtfmove_process(CSOUND *csound, hrtfmove *p)
             /* only update if location changes! */
             if(angle != p->anglev || elev != p->elevv)
               {
-                /* two nearest elev indices to avoid recalculating */
-                elevindexstore = (elev - minelev) / elevincrement;
-                elevindexlow = (int)elevindexstore;
-
-                if(elevindexlow < 13)
-                  elevindexhigh = elevindexlow + 1;
-                /* highest index reached */
-                else
-                  elevindexhigh = elevindexlow;
-
-                /* get percentage value for interpolation */
-                elevindexhighper = elevindexstore - elevindexlow;
-
-                /* read using an index system based on number of points
-                   measured per elevation at mit */
-                /* lookup indices, used to check for crossfade */
-                elevindex = (int)(elevindexstore + FL(0.5));
-
-                angleindex = (int)(angle / (FL(360.0) / elevationarray[elevindex])
-                                   + FL(0.5));
-                angleindex = angleindex % elevationarray[elevindex];
-
-                /* avoid recalculation */
-                angleindexlowstore = angle / (FL(360.0) /
-                                              elevationarray[elevindexlow]);
-                angleindexhighstore = angle / (FL(360.) /
-                                               elevationarray[elevindexhigh]);
-
-                /* 4 closest indices, 2 low and 2 high */
-                angleindex1 = (int)angleindexlowstore;
-
-                angleindex2 = angleindex1 + 1;
-                angleindex2 = angleindex2 % elevationarray[elevindexlow];
-
-                angleindex3 = (int)angleindexhighstore;
-
-                angleindex4 = angleindex3 + 1;
-                angleindex4 = angleindex4 % elevationarray[elevindexhigh];
-
-                /* angle percentages for interp */
-                angleindex2per = angleindexlowstore - angleindex1;
-                angleindex4per = angleindexhighstore - angleindex3;
+                /* 4 nearest points, and the nearest one, used to check
+                   for crossfade */
+                hrtf_locate(angle, elev, &loc);
 
                 if(phasetrunc)
                   {
-                    if(angleindex!=oldangleindex || elevindex!=oldelevindex)
+                    if(loc.nearest != p->oldpoint)
                       {
                         /* store last point and turn crossfade on, provided that
                            initialfade value indicates first block processed! */
@@ -708,285 +954,33 @@ static int hrtfmove_process(CSOUND *csound, hrtfmove *p)
                             l = 0;
                             crossfade = 1;
                             /* store old data */
-                            for(i = 0; i < irlengthpad; i++)
-                              {
-                                oldhrtflpad[i] = hrtflpad[i];
-                                oldhrtfrpad[i] = hrtfrpad[i];
-                              }
+                            memcpy(oldhrtflpad, hrtflpad,
+                                   irlengthpad * sizeof(MYFLT));
+                            memcpy(oldhrtfrpad, hrtfrpad,
+                                   irlengthpad * sizeof(MYFLT));
                           }
 
                         /* store point for current phase as trajectory comes
                            closer to a new index */
-                        skip = 0;
-                        /* store current phase */
-                        if(angleindex > elevationarray[elevindex] / 2)
-                          {
-                            for(i = 0; i < elevindex; i++)
-                              skip +=((int)(elevationarray[i] / 2) + 1) * irlength;
-                            for (i = 0;
-                                 i < (elevationarray[elevindex] - angleindex);
-                                 i++)
-                              skip += irlength;
-                            for(i = 0; i < irlength; i++)
-                              {
-                                currentphasel[i] = fpindexr[skip + i];
-                                currentphaser[i] = fpindexl[skip + i];
-                              }
-                          }
-                        else
-                          {
-                            for(i = 0; i < elevindex; i++)
-                              skip +=((int)(elevationarray[i] / 2) + 1) * irlength;
-                            for (i = 0; i < angleindex; i++)
-                              skip += irlength;
-                            for(i = 0; i < irlength; i++)
-                              {
-                                currentphasel[i] = fpindexl[skip+i];
-                                currentphaser[i] = fpindexr[skip+i];
-                              }
-                          }
+                        p->phasepoint = loc.nearest;
                       }
                   }
                 /* for next check */
-                p->oldelevindex = elevindex;
-                p->oldangleindex = angleindex;
-
-                /* read 4 nearest HRTFs */
-                skip = 0;
-                /* switch l and r */
-                if(angleindex1 > elevationarray[elevindexlow] / 2)
-                  {
-                    for(i = 0; i < elevindexlow; i++)
-                      skip +=((int)(elevationarray[i] / 2) + 1) * irlength;
-                    for (i = 0;
-                         i < (elevationarray[elevindexlow] - angleindex1);
-                         i++)
-                      skip += irlength;
-                    for(i = 0; i < irlength; i++)
-                      {
-                        lowl1[i] = fpindexr[skip+i];
-                        lowr1[i] = fpindexl[skip+i];
-                      }
-                  }
-                else
-                  {
-                    for(i = 0; i < elevindexlow; i++)
-                      skip +=((int)(elevationarray[i] / 2) + 1) * irlength;
-                    for (i = 0; i < angleindex1; i++)
-                      skip += irlength;
-                    for(i = 0; i < irlength; i++)
-                      {
-                        lowl1[i] = fpindexl[skip+i];
-                        lowr1[i] = fpindexr[skip+i];
-                      }
-                  }
-
-                skip = 0;
-                if(angleindex2 > elevationarray[elevindexlow] / 2)
-                  {
-                    for(i = 0; i < elevindexlow; i++)
-                      skip +=((int)(elevationarray[i] / 2) + 1) * irlength;
-                    for (i = 0;
-                         i < (elevationarray[elevindexlow] - angleindex2);
-                         i++)
-                      skip += irlength;
-                    for(i = 0; i < irlength; i++)
-                      {
-                        lowl2[i] = fpindexr[skip+i];
-                        lowr2[i] = fpindexl[skip+i];
-                      }
-                  }
-                else
-                  {
-                    for(i = 0; i < elevindexlow; i++)
-                      skip +=((int)(elevationarray[i] / 2) + 1) * irlength;
-                    for (i = 0; i < angleindex2; i++)
-                      skip += irlength;
-                    for(i = 0; i < irlength; i++)
-                      {
-                        lowl2[i] = fpindexl[skip+i];
-                        lowr2[i] = fpindexr[skip+i];
-                      }
-                  }
-
-                skip = 0;
-                if(angleindex3 > elevationarray[elevindexhigh] / 2)
-                  {
-                    for(i = 0; i < elevindexhigh; i++)
-                      skip +=((int)(elevationarray[i] / 2) + 1) * irlength;
-                    for (i = 0;
-                         i < (elevationarray[elevindexhigh] - angleindex3);
-                         i++)
-                      skip += irlength;
-                    for(i = 0; i < irlength; i++)
-                      {
-                        highl1[i] = fpindexr[skip+i];
-                        highr1[i] = fpindexl[skip+i];
-                      }
-                  }
-                else
-                  {
-                    for(i = 0; i < elevindexhigh; i++)
-                      skip +=((int)(elevationarray[i] / 2) + 1) * irlength;
-                    for (i = 0; i < angleindex3; i++)
-                      skip += irlength;
-                    for(i = 0; i < irlength; i++)
-                      {
-                        highl1[i] = fpindexl[skip+i];
-                        highr1[i] = fpindexr[skip+i];
-                      }
-                  }
-
-                skip = 0;
-                if(angleindex4 > elevationarray[elevindexhigh] / 2)
-                  {
-                    for(i = 0; i < elevindexhigh; i++)
-                      skip +=((int)(elevationarray[i] / 2) + 1) * irlength;
-                    for (i = 0;
-                         i < (elevationarray[elevindexhigh] - angleindex4);
-                         i++)
-                      skip += irlength;
-                    for(i = 0; i < irlength; i++)
-                      {
-                        highl2[i] = fpindexr[skip+i];
-                        highr2[i] = fpindexl[skip+i];
-                      }
-                  }
-                else
-                  {
-                    for(i = 0; i < elevindexhigh; i++)
-                      skip +=((int)(elevationarray[i] / 2) + 1) * irlength;
-                    for (i = 0; i < angleindex4; i++)
-                      skip += irlength;
-                    for(i = 0; i < irlength; i++)
-                      {
-                        highl2[i] = fpindexl[skip+i];
-                        highr2[i] = fpindexr[skip+i];
-                      }
-                  }
+                p->oldpoint = loc.nearest;
 
-                /* interpolation */
-                /* 0 Hz and Nyq...absoulute values for mag */
-                magllow = FABS(lowl1[0]) + (FABS(lowl2[0]) - FABS(lowl1[0])) *
-                  angleindex2per;
-                maglhigh = FABS(highl1[0]) + (FABS(highl2[0]) - FABS(highl1[0]))
-                  * angleindex4per;
-                magl = magllow + (maglhigh - magllow) * elevindexhighper;
-                if(minphase)
-                  {
-                    logmagl[0] = LOG((magl == FL(0.0) ? FL(0.00000001) : magl));
-                  }
-                /* this is where real values of 0hz and nyq needed:
-                   if neg real, 180 degree phase */
-                /* if data was complex, mag interp would use fabs()
-                   inherently, phase would be 0/pi */
-                /* if pi, real is negative! */
-                else
-                  {
-                    if(currentphasel[0] < FL(0.0))
-                      hrtflfloat[0] = -magl;
-                    else
-                      hrtflfloat[0] = magl;
-                  }
-
-                magllow = FABS(lowl1[1]) + (FABS(lowl2[1]) - FABS(lowl1[1])) *
-                  angleindex2per;
-                maglhigh = FABS(highl1[1]) + (FABS(highl2[1]) - FABS(highl1[1])) *
-                  angleindex4per;
-                magl = magllow + (maglhigh-magllow) * elevindexhighper;
-                if(minphase)
-                  {
-                    logmagl[1] = LOG(magl == FL(0.0) ? FL(0.00000001) : magl);
-                  }
-                else
-
-                  {
-                    if(currentphasel[1] < FL(0.0))
-                      hrtflfloat[1] = -magl;
-                    else
-                      hrtflfloat[1] = magl;
-                  }
-
-                magrlow = FABS(lowr1[0]) + (FABS(lowr2[0]) - FABS(lowr1[0])) *
-                  angleindex2per;
-                magrhigh = FABS(highr1[0]) + (FABS(highr2[0]) - FABS(highr1[0])) *
-                  angleindex4per;
-                magr = magrlow + (magrhigh - magrlow) * elevindexhighper;
-                if(minphase)
-                  {
-                    logmagr[0] = LOG(magr == FL(0.0) ? FL(0.00000001) : magr);
-                  }
-                else
-                  {
-                    if(currentphaser[0] < FL(0.0))
-                      hrtfrfloat[0] = -magr;
-                    else
-                      hrtfrfloat[0] = magr;
-                  }
+                /* interpolation of the magnitudes */
+                hrtf_interp(grid, nbins, &loc, magl, magr);
 
-                magrlow = FABS(lowr1[1]) + (FABS(lowr2[1]) - FABS(lowr1[1]))  *
-                  angleindex2per;
-                magrhigh = FABS(highr1[1]) + (FABS(highr2[1]) - FABS(highr1[1])) *
-                  angleindex4per;
-                magr = magrlow + (magrhigh - magrlow) * elevindexhighper;
                 if(minphase)
                   {
-                    logmagr[1] = LOG(magr == FL(0.0) ? FL(0.00000001) : magr);
-                  }
-                else
-                  {
-                    if(currentphaser[1] < FL(0.0))
-                      hrtfrfloat[1] = -magr;
-                    else
-                      hrtfrfloat[1] = magr;
-                  }
-
-                /* remaining values */
-                for(i = 2; i < irlength; i += 2)
-                  {
-                    /* interpolate high and low mags */
-                    magllow = lowl1[i] + (lowl2[i] - lowl1[i]) * angleindex2per;
-                    maglhigh = highl1[i] + (highl2[i] - highl1[i]) * angleindex4per;
-
-                    magrlow = lowr1[i] + (lowr2[i] - lowr1[i]) * angleindex2per;
-                    magrhigh = highr1[i] + (highr2[i] - highr1[i]) * angleindex4per;
-
-                    /* interpolate high and low results */
-                    magl = magllow + (maglhigh - magllow) * elevindexhighper;
-                    magr = magrlow + (magrhigh - magrlow) * elevindexhighper;
+                    /* store log magnitudes, 0 phases for ifft */
+                    hrtf_logmag(magl, nbins, logmagl);
+                    hrtf_logmag(magr, nbins, logmagr);
 
-                    if(phasetrunc)
-                      {
-                        /* use current phase, back to rectangular */
-                        phasel = currentphasel[i + 1];
-                        phaser = currentphaser[i + 1];
-
-                        /* polar to rectangular */
-                        hrtflfloat[i] = magl * COS(phasel);
-                        hrtflfloat[i+1] = magl * SIN(phasel);
-
-                        hrtfrfloat[i] = magr * COS(phaser);
-                        hrtfrfloat[i+1] = magr * SIN(phaser);
-                      }
-
-                    if(minphase)
-                      {
-                        /* store log magnitudes, 0 phases for ifft, do not
-                           allow log(0.0) */
-                        logmagl[i] = LOG(magl == FL(0.0) ? FL(0.00000001) : magl);
-                        logmagr[i] = LOG(magr == FL(0.0) ? FL(0.00000001) : magr);
-
-                        logmagl[i + 1] = FL(0.0);
-                        logmagr[i + 1] = FL(0.0);
-                      }
-                  }
-
-                if(minphase)
-                  {
                     /* ifft!...see Oppehneim and Schafer for min phase
                        process...based on real cepstrum method */
-                    csound->InverseRealFFT(csound, logmagl, irlength);
-                    csound->InverseRealFFT(csound, logmagr, irlength);
+                    csound->RealFFT2(csound, p->invsetup, logmagl);
+                    csound->RealFFT2(csound, p->invsetup, logmagr);
 
                     /* window, note no need to scale on csound iffts... */
                     for(i = 0; i < irlength; i++)
@@ -996,8 +990,8 @@ static int hrtfmove_process(CSOUND *csound, hrtfmove *p)
                       }
 
                     /* fft */
-                    csound->RealFFT(csound, xhatwinl, irlength);
-                    csound->RealFFT(csound, xhatwinr, irlength);
+                    csound->RealFFT2(csound, p->fwdsetup, xhatwinl);
+                    csound->RealFFT2(csound, p->fwdsetup, xhatwinr);
 
                     /* exponential of result */
                     /* 0 hz and nyq purely real... */
@@ -1016,137 +1010,53 @@ static int hrtfmove_process(CSOUND *csound, hrtfmove *p)
                       }
 
                     /* ifft for output buffers */
-                    csound->InverseRealFFT(csound, expxhatwinl, irlength);
-                    csound->InverseRealFFT(csound, expxhatwinr, irlength);
+                    csound->RealFFT2(csound, p->invsetup, expxhatwinl);
+                    csound->RealFFT2(csound, p->invsetup, expxhatwinr);
 
                     /* output */
-                    for(i= 0; i < irlength; i++)
-                      {
-                        hrtflpad[i] = expxhatwinl[i];
-                        hrtfrpad[i] = expxhatwinr[i];
-                      }
+                    memcpy(hrtflpad, expxhatwinl, irlength * sizeof(MYFLT));
+                    memcpy(hrtfrpad, expxhatwinr, irlength * sizeof(MYFLT));
                   }
 
                 /* use current phase and interped mag directly */
                 if(phasetrunc)
                   {
-                    /* ifft */
-                    csound->InverseRealFFT(csound, hrtflfloat, irlength);
-                    csound->InverseRealFFT(csound, hrtfrfloat, irlength);
-
-                    for (i = 0; i < irlength; i++)
-                      {
-                        /* scale and pad buffers with zeros to fftbuff */
-                        hrtflpad[i] = hrtflfloat[i];
-                        hrtfrpad[i] = hrtfrfloat[i];
-                      }
-                  }
-
-                /* zero pad impulse */
-                for(i = irlength; i < irlengthpad; i++)
-                  {
-                    hrtflpad[i] = FL(0.0);
-                    hrtfrpad[i] = FL(0.0);
-                  }
-
-                /* back to freq domain */
-                csound->RealFFT(csound, hrtflpad, irlengthpad);
-                csound->RealFFT(csound, hrtfrpad, irlengthpad);
-
-                if(minphase)
-                  {
-                    /* read delay data: 4 nearest points, as above */
-                    /* point 1 */
-                    skip = 0;
-                    if(angleindex1 > elevationarray[elevindexlow] / 2)
-                      {
-                        for (i = 0; i < elevindexlow; i++)
-                          skip += ((int)(elevationarray[i] / 2) + 1);
-                        for(i = 0;
-                            i < (elevationarray[elevindexlow] - angleindex1);
-                            i++)
-                          skip++;
-                        delaylow1 = minphasedels[skip];
-                      }
-                    else
-                      {
-                        for (i = 0; i < elevindexlow; i++)
-                          skip += ((int)(elevationarray[i] / 2) + 1);
-                        for(i = 0; i < angleindex1; i++)
-                          skip++;
-                        delaylow1 = minphasedels[skip];
-                      }
-
-                    /* point 2 */
-                    skip = 0;
-                    if(angleindex2 > elevationarray[elevindexlow] / 2)
-                      {
-                        for (i = 0; i < elevindexlow; i++)
-                          skip += ((int)(elevationarray[i] / 2) + 1);
-                        for(i = 0;
-                            i < (elevationarray[elevindexlow] - angleindex2);
-                            i++)
-                          skip++;
-                        delaylow2 = minphasedels[skip];
-                      }
-                    else
-                      {
-                        for (i = 0; i < elevindexlow; i++)
-                          skip += ((int)(elevationarray[i] / 2) + 1);
-                        for (i = 0; i < angleindex2; i++)
-                          skip++;
-                        delaylow2 = minphasedels[skip];
-                      }
+                    /* polar to rectangular */
+                    hrtf_rect(magl, hrtf_point(grid, nbins, p->phasepoint, 0),
+                              nbins, hrtflfloat);
+                    hrtf_rect(magr, hrtf_point(grid, nbins, p->phasepoint, 1),
+                              nbins, hrtfrfloat);
 
-                    /* point 3 */
-                    skip = 0;
-                    if(angleindex3 > elevationarray[elevindexhigh] / 2)
-                      {
-                        for (i = 0; i < elevindexhigh; i++)
-                          skip += ((int)(elevationarray[i] / 2) + 1);
-                        for(i = 0;
-                            i < (elevationarray[elevindexhigh] - angleindex3);
-                            i++)
-                          skip++;
-                        delayhigh1  =minphasedels[skip];
-                      }
-                    else
-                      {
-                        for (i = 0; i < elevindexhigh; i++)
-                          skip += ((int)(elevationarray[i] / 2) + 1);
-                        for (i = 0; i < angleindex3; i++)
-                          skip++;
-                        delayhigh1 = minphasedels[skip];
-                      }
+                    /* ifft */
+                    csound->RealFFT2(csound, p->invsetup, hrtflfloat);
+                    csound->RealFFT2(csound, p->invsetup, hrtfrfloat);
 
-                    /* point 4 */
-                    skip = 0;
-                    if(angleindex4 > elevationarray[elevindexhigh] / 2)
-                      {
-                        for (i = 0; i < elevindexhigh; i++)
-                          skip += ((int)(elevationarray[i] / 2) + 1);
-                        for(i = 0;
-                            i < (elevationarray[elevindexhigh] - angleindex4);
-                            i++)
-                          skip++;
-                        delayhigh2 = minphasedels[skip];
-                      }
-                    else
-                      {
-                        for (i = 0; i < elevindexhigh; i++)
-                          skip += ((int)(elevationarray[i] / 2) + 1);
-                        for (i = 0; i < angleindex4; i++)
-                          skip++;
-                        delayhigh2 = minphasedels[skip];
-                      }
+                    memcpy(hrtflpad, hrtflfloat, irlength * sizeof(MYFLT));
+                    memcpy(hrtfrpad, hrtfrfloat, irlength * sizeof(MYFLT));
+                  }
+
+                /* zero pad impulse */
+                for(i = irlength; i < irlengthpad; i++)
+                  {
+                    hrtflpad[i] = FL(0.0);
+                    hrtfrpad[i] = FL(0.0);
+                  }
 
-                    /* delay interp */
-                    delaylow = delaylow1 + ((delaylow2 - delaylow1) *
-                                            angleindex2per);
-                    delayhigh = delayhigh1 + ((delayhigh2 - delayhigh1) *
-                                              angleindex4per);
+                /* back to freq domain */
+                csound->RealFFT2(csound, p->fwdsetuppad, hrtflpad);
+                csound->RealFFT2(csound, p->fwdsetuppad, hrtfrpad);
+
+                if(minphase)
+                  {
+                    /* delay interp: 4 nearest points, as above */
+                    delaylow = delays[loc.low1] + ((delays[loc.low2] -
+                                                    delays[loc.low1]) *
+                                                   loc.angleindex2per);
+                    delayhigh = delays[loc.high1] + ((delays[loc.high2] -
+                                                      delays[loc.high1]) *
+                                                     loc.angleindex4per);
                     delayfloat = delaylow + ((delayhigh - delaylow) *
-                                             elevindexhighper);
+                                             loc.elevindexhighper);
 
                     p->delayfloat = delayfloat;
                   }
@@ -1184,17 +1094,15 @@ static int hrtfmove_process(CSOUND *csound, hrtfmove *p)
             for (i = irlength; i < irlengthpad; i++)
               complexinsig[i] = FL(0.0);
 
-            csound->RealFFT(csound, complexinsig, irlengthpad);
+            csound->RealFFT2(csound, p->fwdsetuppad, complexinsig);
 
             /* complex mult function... */
-            csound->RealFFTMult(csound, outspecl, hrtflpad, complexinsig,
-                                irlengthpad, FL(1.0));
-            csound->RealFFTMult(csound, outspecr, hrtfrpad, complexinsig,
-                                irlengthpad, FL(1.0));
+            hrtf_specmult(outspecl, outspecr, hrtflpad, hrtfrpad,
+                          complexinsig, irlengthpad);
 
             /* convolution is the inverse FFT of above result */
-            csound->InverseRealFFT(csound, outspecl, irlengthpad);
-            csound->InverseRealFFT(csound, outspecr, irlengthpad);
+            csound->RealFFT2(csound, p->invsetuppad, outspecl);
+            csound->RealFFT2(csound, p->invsetuppad, outspecr);
 
             /* real values, scaled (by a little more than usual to ensure
                no clipping) sr related */
@@ -1211,13 +1119,11 @@ static int hrtfmove_process(CSOUND *csound, hrtfmove *p)
                   {
                     crossout = 1;
 
-                    csound->RealFFTMult(csound, outspecoldl, oldhrtflpad,
-                                        complexinsig, irlengthpad, FL(1.0));
-                    csound->RealFFTMult(csound, outspecoldr, oldhrtfrpad,
-                                        complexinsig, irlengthpad, FL(1.0));
+                    hrtf_specmult(outspecoldl, outspecoldr, oldhrtflpad,
+                                  oldhrtfrpad, complexinsig, irlengthpad);
 
-                    csound->InverseRealFFT(csound, outspecoldl, irlengthpad);
-                    csound->InverseRealFFT(csound, outspecoldr, irlengthpad);
+                    csound->RealFFT2(csound, p->invsetuppad, outspecoldl);
+                    csound->RealFFT2(csound, p->invsetuppad, outspecoldr);
 
                     /* scaled */
                     for(i = 0; i < irlengthpad; i++)
@@ -1351,6 +1257,9 @@ typedef struct
         STRINGDAT *ifilel, *ifiler;
         MYFLT *oradius, *osr;
 
+        /* shared spectra of the measured points */
+        IRSPEC *grid;
+
         /*see definitions in INIT*/
         int irlength, irlengthpad, overlapsize;
         MYFLT sroverN;
@@ -1374,29 +1283,27 @@ typedef struct
         /* overlap data */
         AUXCH overlapl, overlapr;
 
-        /* interpolation buffers */
-        AUXCH lowl1, lowr1, lowl2, lowr2, highl1, highr1, highl2, highr2;
+        /* interpolated magnitudes */
+        AUXCH magl, magr;
 
         /* buffers for impulse shift */
         AUXCH leftshiftbuffer, rightshiftbuffer;
+        /* FFT setups, for irlength and irlengthpad */
+        void *invsetup, *fwdsetuppad, *invsetuppad;
 }
 hrtfstat;
 
+static int hrtfstat_deinit(CSOUND *csound, void *p)
+{
+    hrtf_grid_release(csound, &((hrtfstat *) p)->grid);
+    return OK;
+}
+
 static int hrtfstat_init(CSOUND *csound, hrtfstat *p)
 {
-    /* left and right data files: spectral mag, phase format. */
-    MEMFIL *fpl = NULL, *fpr = NULL;
-    char filel[MAXNAME], filer[MAXNAME];
-
-    /* interpolation values */
-    MYFLT *lowl1;
-    MYFLT *lowr1;
-    MYFLT *lowl2;
-    MYFLT *lowr2;
-    MYFLT *highl1;
-    MYFLT *highr1;
-    MYFLT *highl2;
-    MYFLT *highr2;
+    /* interpolated magnitudes */
+    MYFLT *magl;
+    MYFLT *magr;
 
     MYFLT *hrtflfloat;
     MYFLT *hrtfrfloat;
@@ -1409,28 +1316,13 @@ static int hrtfstat_init(CSOUND *csound, hrtfstat *p)
     MYFLT r = *p->oradius;
     MYFLT sr = *p->osr;
 
-        /* pointers into HRTF files */
-    float *fpindexl=NULL;
-    float *fpindexr=NULL;
-
     /* time domain impulse length, padded, overlap add */
-    int irlength=0, irlengthpad=0, overlapsize=0;
-
-    int i, skip = 0;
+    int irlength=0, irlengthpad=0, overlapsize=0, nbins;
 
-    /* local interpolation values */
-    MYFLT elevindexhighper, angleindex2per, angleindex4per;
-    int elevindexlow, elevindexhigh, angleindex1, angleindex2,
-      angleindex3, angleindex4;
-    MYFLT magl, magr, phasel, phaser, magllow, magrlow, maglhigh, magrhigh;
-
-    /* local variables, mainly used for simplification */
-    MYFLT elevindexstore;
-    MYFLT angleindexlowstore;
-    MYFLT angleindexhighstore;
+    int i;
 
-    /* woodworth values */
-    MYFLT radianangle, radianelev, itd=0, itdww, freq;
+    /* the 4 nearest points */
+    HRTFLOC loc;
 
     /* shift */
     int shift;
@@ -1461,35 +1353,24 @@ static int hrtfstat_init(CSOUND *csound, hrtfstat *p)
         overlapsize = (irlength - 1);
       }
 
-    /* copy in string name... */
-    strncpy(filel, (char*) p->ifilel->data, MAXNAME-1); filel[MAXNAME-1]='\0';
-    strncpy(filer, (char*) p->ifiler->data, MAXNAME-1); filel[MAXNAME-1]='\0';
-
-    /* reading files, with byte swap */
-    fpl = csound->ldmemfile2withCB(csound, filel, CSFTYPE_FLOATS_BINARY,
-                                   swap4bytes);
-    if (UNLIKELY(fpl == NULL))
-      return
-        csound->InitError(csound,
-                          Str("\n\n\nCannot load left data file, exiting\n\n"));
-
-    fpr = csound->ldmemfile2withCB(csound, filer, CSFTYPE_FLOATS_BINARY,
-                                   swap4bytes);
-    if (UNLIKELY(fpr == NULL))
-      return
-        csound->InitError(csound,
-                          Str("\n\n\nCannot load right data file, exiting\n\n"));
+    /* the spectra of the data files, shared */
+    if (UNLIKELY(hrtf_grid(csound, &p->grid, p->ifilel, p->ifiler,
+                           irlength) != OK))
+      return NOTOK;
+    csound->RegisterDeinitCallback(csound, p, hrtfstat_deinit);
 
     p->irlength = irlength;
     p->irlengthpad = irlengthpad;
+    csound->RealFFT2Release(csound, p->invsetup);
+    p->invsetup = csound->RealFFT2Setup(csound, irlength, FFT_INV);
+    csound->RealFFT2Release(csound, p->fwdsetuppad);
+    p->fwdsetuppad = csound->RealFFT2Setup(csound, irlengthpad, FFT_FWD);
+    csound->RealFFT2Release(csound, p->invsetuppad);
+    p->invsetuppad = csound->RealFFT2Setup(csound, irlengthpad, FFT_INV);
     p->overlapsize = overlapsize;
 
     p->sroverN = sr/irlength;
-
-    /* start indices at correct value (start of file)/ zero indices.
-       (do not need to store here, as only accessing in INIT) */
-    fpindexl = (float *) fpl->beginp;
-    fpindexr = (float *) fpr->beginp;
+    nbins = irlength / 2 + 1;
 
     /* buffers */
     if (!p->insig.auxp || p->insig.size < irlength * sizeof(MYFLT))
@@ -1530,33 +1411,11 @@ static int hrtfstat_init(CSOUND *csound, hrtfstat *p)
     memset(p->overlapl.auxp, 0, overlapsize * sizeof(MYFLT));
     memset(p->overlapr.auxp, 0, overlapsize * sizeof(MYFLT));
 
-    /* interpolation values */
-    if (!p->lowl1.auxp || p->lowl1.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->lowl1);
-    if (!p->lowr1.auxp || p->lowr1.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->lowr1);
-    if (!p->lowl2.auxp || p->lowl2.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->lowl2);
-    if (!p->lowr2.auxp || p->lowr2.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->lowr2);
-    if (!p->highl1.auxp || p->highl1.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->highl1);
-    if (!p->highr1.auxp || p->highr1.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->highr1);
-    if (!p->highl2.auxp || p->highl2.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->highl2);
-    if (!p->highr2.auxp || p->highr2.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->highr2);
-
-    /* best to zero, for future changes (filled in init) */
-    memset(p->lowl1.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->lowr1.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->lowl2.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->lowr2.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->highl1.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->highl2.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->highr1.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->highr2.auxp, 0, irlength * sizeof(MYFLT));
+    /* interpolated magnitudes */
+    if (!p->magl.auxp || p->magl.size < nbins * sizeof(MYFLT))
+      csound->AuxAlloc(csound, nbins * sizeof(MYFLT), &p->magl);
+    if (!p->magr.auxp || p->magr.size < nbins * sizeof(MYFLT))
+      csound->AuxAlloc(csound, nbins * sizeof(MYFLT), &p->magr);
 
     /* shift buffers */
     if (!p->leftshiftbuffer.auxp ||
@@ -1569,14 +1428,8 @@ static int hrtfstat_init(CSOUND *csound, hrtfstat *p)
     memset(p->leftshiftbuffer.auxp, 0, irlength * sizeof(MYFLT));
     memset(p->rightshiftbuffer.auxp, 0, irlength * sizeof(MYFLT));
 
-    lowl1 = (MYFLT *)p->lowl1.auxp;
-    lowr1 = (MYFLT *)p->lowr1.auxp;
-    lowl2 = (MYFLT *)p->lowl2.auxp;
-    lowr2 = (MYFLT *)p->lowr2.auxp;
-    highl1 = (MYFLT *)p->highl1.auxp;
-    highr1 = (MYFLT *)p->highr1.auxp;
-    highl2 = (MYFLT *)p->highl2.auxp;
-    highr2 = (MYFLT *)p->highr2.auxp;
+    magl = (MYFLT *)p->magl.auxp;
+    magr = (MYFLT *)p->magr.auxp;
 
     leftshiftbuffer = (MYFLT *)p->leftshiftbuffer.auxp;
     rightshiftbuffer = (MYFLT *)p->rightshiftbuffer.auxp;
@@ -1600,238 +1453,16 @@ static int hrtfstat_init(CSOUND *csound, hrtfstat *p)
     while(angle >= FL(360.0))
       angle -= FL(360.0);
 
-    /* two nearest elev indices to avoid recalculating */
-    elevindexstore = (elev - minelev) / elevincrement;
-    elevindexlow = (int)elevindexstore;
-
-    if(elevindexlow < 13)
-      elevindexhigh = elevindexlow + 1;
-    /* highest index reached */
-    else
-      elevindexhigh = elevindexlow;
-
-    /* get percentage value for interpolation */
-    elevindexhighper = elevindexstore - elevindexlow;
-
-    /* avoid recalculation */
-    angleindexlowstore = angle / (FL(360.0) / elevationarray[elevindexlow]);
-    angleindexhighstore = angle / (FL(360.0) / elevationarray[elevindexhigh]);
-
-    /* 4 closest indices, 2 low and 2 high */
-    angleindex1 = (int)angleindexlowstore;
-
-    angleindex2 = angleindex1 + 1;
-    angleindex2 = angleindex2 % elevationarray[elevindexlow];
-
-    angleindex3 = (int)angleindexhighstore;
-
-    angleindex4 = angleindex3 + 1;
-    angleindex4 = angleindex4 % elevationarray[elevindexhigh];
-
-    /* angle percentages for interp */
-    angleindex2per = angleindexlowstore - angleindex1;
-    angleindex4per = angleindexhighstore - angleindex3;
-
-    /* read 4 nearest HRTFs */
-    skip = 0;
-    /* switch l and r */
-    if(angleindex1 > elevationarray[elevindexlow] / 2)
-      {
-        for(i = 0; i < elevindexlow; i++)
-          skip +=((int)(elevationarray[i] / 2) + 1) * irlength;
-        for (i = 0; i < (elevationarray[elevindexlow] - angleindex1); i++)
-          skip += irlength;
-        for(i = 0; i < irlength; i++)
-          {
-            lowl1[i] = fpindexr[skip + i];
-            lowr1[i] = fpindexl[skip + i];
-          }
-      }
-    else
-      {
-        for(i = 0; i < elevindexlow; i++)
-          skip +=((int)(elevationarray[i] / 2) + 1) * irlength;
-        for (i = 0; i < angleindex1; i++)
-          skip += irlength;
-        for(i = 0; i < irlength; i++)
-          {
-            lowl1[i] = fpindexl[skip + i];
-            lowr1[i] = fpindexr[skip + i];
-          }
-      }
-
-    skip = 0;
-    if(angleindex2 > elevationarray[elevindexlow] / 2)
-      {
-        for(i = 0; i < elevindexlow; i++)
-          skip +=((int)(elevationarray[i] / 2) + 1) * irlength;
-        for (i = 0; i < (elevationarray[elevindexlow] - angleindex2); i++)
-          skip += irlength;
-        for(i = 0; i < irlength; i++)
-          {
-            lowl2[i] = fpindexr[skip + i];
-            lowr2[i] = fpindexl[skip + i];
-          }
-      }
-    else
-      {
-        for(i = 0; i < elevindexlow; i++)
-          skip +=((int)(elevationarray[i] / 2) + 1) * irlength;
-        for (i = 0; i < angleindex2; i++)
-          skip += irlength;
-        for(i = 0; i < irlength; i++)
-          {
-            lowl2[i] = fpindexl[skip + i];
-            lowr2[i] = fpindexr[skip + i];
-          }
-      }
-
-    skip = 0;
-    if(angleindex3 > elevationarray[elevindexhigh] / 2)
-      {
-        for(i = 0; i < elevindexhigh; i++)
-          skip += ((int)(elevationarray[i] / 2) + 1) * irlength;
-        for (i = 0; i < (elevationarray[elevindexhigh] - angleindex3); i++)
-          skip += irlength;
-        for(i = 0; i < irlength; i++)
-          {
-            highl1[i] = fpindexr[skip + i];
-            highr1[i] = fpindexl[skip + i];
-          }
-      }
-    else
-      {
-        for(i = 0; i < elevindexhigh; i++)
-          skip +=((int)(elevationarray[i] / 2) + 1) * irlength;
-        for (i = 0; i < angleindex3; i++)
-          skip += irlength;
-        for(i = 0; i < irlength; i++)
-          {
-            highl1[i] = fpindexl[skip + i];
-            highr1[i] = fpindexr[skip + i];
-          }
-      }
-
-    skip = 0;
-    if(angleindex4 > elevationarray[elevindexhigh] / 2)
-      {
-        for(i = 0; i < elevindexhigh; i++)
-          skip +=((int)(elevationarray[i] / 2) + 1) * irlength;
-        for (i = 0; i < (elevationarray[elevindexhigh] - angleindex4); i++)
-          skip += irlength;
-        for(i = 0; i < irlength; i++)
-          {
-            highl2[i] = fpindexr[skip + i];
-            highr2[i] = fpindexl[skip + i];
-          }
-      }
-    else
-      {
-        for(i = 0; i < elevindexhigh; i++)
-          skip +=((int)(elevationarray[i] / 2) + 1) * irlength;
-        for (i = 0; i < angleindex4; i++)
-          skip += irlength;
-        for(i = 0; i < irlength; i++)
-          {
-            highl2[i] = fpindexl[skip + i];
-            highr2[i] = fpindexr[skip + i];
-          }
-      }
-
-    /* woodworth process */
-    /* ITD formula, check which ear is relevant to calculate angle from */
-    if(angle > FL(180.0))
-      radianangle = (angle - FL(180.0)) * PI_F / FL(180.0);
-    else
-      radianangle = angle * PI_F / FL(180.0);
-    /* degrees to radians */
-    radianelev = elev * PI_F / FL(180.0);
-
-    /* get in correct range for formula */
-    if(radianangle > PI_F / FL(2.0))
-      radianangle = FL(PI) - radianangle;
-
-    /* woodworth formula for itd */
-    itdww = (radianangle + SIN(radianangle)) * r * COS(radianelev) / c;
-
-    /* 0 Hz and Nyq... */
-    /* these are real values...may be neg (implying phase of pi:
-       in phase truncation), so need fabs... */
-    magllow = FABS(lowl1[0]) + (FABS(lowl2[0]) - FABS(lowl1[0])) * angleindex2per;
-    maglhigh = FABS(highl1[0]) + (FABS(highl2[0]) - FABS(highl1[0])) *
-      angleindex4per;
-    hrtflfloat[0] = magllow + (maglhigh - magllow) * elevindexhighper;
-
-    magllow = FABS(lowl1[1]) + (FABS(lowl2[1]) - FABS(lowl1[1])) * angleindex2per;
-    maglhigh = FABS(highl1[1]) + (FABS(highl2[1]) - FABS(highl1[1])) *
-      angleindex4per;
-    hrtflfloat[1] = magllow + (maglhigh - magllow) * elevindexhighper;
-
-    magrlow = FABS(lowr1[0]) + (FABS(lowr2[0]) - FABS(lowr1[0])) * angleindex2per;
-    magrhigh = FABS(highr1[0]) + (FABS(highr2[0]) - FABS(highr1[0])) *
-      angleindex4per;
-    hrtfrfloat[0] = magrlow + (magrhigh - magrlow) * elevindexhighper;
-
-    magrlow = FABS(lowr1[1]) + (FABS(lowr2[1]) - FABS(lowr1[1])) * angleindex2per;
-    magrhigh = FABS(highr1[1]) + (FABS(highr2[1]) - FABS(highr1[1])) *
-      angleindex4per;
-    hrtfrfloat[1] = magrlow + (magrhigh - magrlow) * elevindexhighper;
-
-    /* magnitude interpolation */
-    for(i = 2; i < irlength; i+=2)
-      {
-        /* interpolate high and low mags */
-        magllow = lowl1[i] + (lowl2[i] - lowl1[i]) * angleindex2per;
-        maglhigh = highl1[i]+(highl2[i] - highl1[i]) * angleindex4per;
-
-        magrlow = lowr1[i] + (lowr2[i] - lowr1[i]) * angleindex2per;
-        magrhigh = highr1[i] + (highr2[i] - highr1[i]) * angleindex4per;
-
-        /* interpolate high and low results */
-        magl = magllow + (maglhigh - magllow) * elevindexhighper;
-        magr = magrlow + (magrhigh - magrlow) * elevindexhighper;
-
-        freq = (i / 2) * p->sroverN;
-
-        /* non linear itd...last value in array = 1.0, so back to itdww */
-        if(p->sr == 96000)
-          {
-            if ((i / 2) < 6)
-              itd = itdww * nonlinitd96k[(i / 2) - 1];
-          }
-        else if(p->sr == 48000)
-          {
-            if ((i / 2) < 6)
-              itd = itdww * nonlinitd48k[(i / 2) - 1];
-          }
-        else if(p->sr == 44100)
-          {
-            if((i / 2) < 6)
-              itd = itdww * nonlinitd[(i / 2) - 1];
-          }
-
-        if(angle > FL(180.))
-          {
-            phasel = TWOPI_F * freq * (itd / 2);
-            phaser = TWOPI_F * freq * -(itd / 2);
-          }
-        else
-          {
-            phasel = TWOPI_F * freq * -(itd / 2);
-            phaser = TWOPI_F * freq * (itd / 2);
-          }
-
-        /* polar to rectangular */
-        hrtflfloat[i] = magl * COS(phasel);
-        hrtflfloat[i+1] = magl * SIN(phasel);
-
-        hrtfrfloat[i] = magr * COS(phaser);
-        hrtfrfloat[i+1] = magr * SIN(phaser);
-      }
+    /* magnitude interpolation of the 4 nearest points, woodworth
+       phase */
+    hrtf_locate(angle, elev, &loc);
+    hrtf_interp((const MYFLT *)p->grid->data, nbins, &loc, magl, magr);
+    hrtf_woodworth(magl, magr, nbins, sr, p->sroverN, angle, elev, r,
+                   hrtflfloat, hrtfrfloat);
 
     /* ifft */
-    csound->InverseRealFFT(csound, hrtflfloat, irlength);
-    csound->InverseRealFFT(csound, hrtfrfloat, irlength);
+    csound->RealFFT2(csound, p->invsetup, hrtflfloat);
+    csound->RealFFT2(csound, p->invsetup, hrtfrfloat);
 
     for (i = 0; i < irlength; i++)
       {
@@ -1863,8 +1494,8 @@ static int hrtfstat_init(CSOUND *csound, hrtfstat *p)
       }
 
     /* back to freq domain */
-    csound->RealFFT(csound, hrtflpad, irlengthpad);
-    csound->RealFFT(csound, hrtfrpad, irlengthpad);
+    csound->RealFFT2(csound, p->fwdsetuppad, hrtflpad);
+    csound->RealFFT2(csound, p->fwdsetuppad, hrtfrpad);
 
         /* initialize counter */
     p->counter = 0;
@@ -1943,17 +1574,15 @@ static int hrtfstat_process(CSOUND *csound, hrtfstat *p)
             for (i = irlength; i <  irlengthpad; i++)
               complexinsig[i] = FL(0.0);
 
-            csound->RealFFT(csound, complexinsig, irlengthpad);
+            csound->RealFFT2(csound, p->fwdsetuppad, complexinsig);
 
             /* complex multiplication */
-            csound->RealFFTMult(csound, outspecl, hrtflpad, complexinsig,
-                                irlengthpad, FL(1.0));
-            csound->RealFFTMult(csound, outspecr, hrtfrpad, complexinsig,
-                                irlengthpad, FL(1.0));
+            hrtf_specmult(outspecl, outspecr, hrtflpad, hrtfrpad,
+                          complexinsig, irlengthpad);
 
             /* convolution is the inverse FFT of above result */
-            csound->InverseRealFFT(csound, outspecl, irlengthpad);
-            csound->InverseRealFFT(csound, outspecr, irlengthpad);
+            csound->RealFFT2(csound, p->invsetuppad, outspecl);
+            csound->RealFFT2(csound, p->invsetuppad, outspecr);
 
             /* scaled by a factor related to sr...? */
             for(i = 0; i < irlengthpad; i++)
@@ -2005,8 +1634,11 @@ MYFLT *ooverlap, *oradius, *osr;
         /* check if relative source has changed! */
         MYFLT anglev, elevv;
 
+        /* shared spectra of the measured points */
+        IRSPEC *grid;
+
         /* see definitions in INIT */
-        int irlength;
+        int irlength, nbins;
         MYFLT sroverN;
         MYFLT sr;
 
@@ -2017,8 +1649,6 @@ MYFLT *ooverlap, *oradius, *osr;
 
         int hopsize;
 
-        float *fpbeginl,*fpbeginr;
-
         /* to keep track of process */
         int counter, t;
 
@@ -2034,26 +1664,29 @@ MYFLT *ooverlap, *oradius, *osr;
         /* spectral data */
         AUXCH outspecl, outspecr;
 
-        /* interpolation buffers */
-        AUXCH lowl1,lowr1,lowl2,lowr2,highl1,highr1,highl2,highr2;
+        /* interpolated magnitudes */
+        AUXCH magl, magr;
 
         /* stft window */
         AUXCH win;
         /* used for skipping into next stft array on way in and out */
         AUXCH overlapskipin, overlapskipout;
 
+        /* FFT setups */
+        void *fwdsetup, *invsetup;
 }
 hrtfmove2;
 
-static int hrtfmove2_init(CSOUND *csound, hrtfmove2 *p)
+static int hrtfmove2_deinit(CSOUND *csound, void *p)
 {
-    /* left and right data files: spectral mag, phase format. */
-    MEMFIL *fpl = NULL, *fpr = NULL;
-
-    char filel[MAXNAME], filer[MAXNAME];
+    hrtf_grid_release(csound, &((hrtfmove2 *) p)->grid);
+    return OK;
+}
 
+static int hrtfmove2_init(CSOUND *csound, hrtfmove2 *p)
+{
     /* time domain impulse length */
-    int irlength=0;
+    int irlength=0, nbins;
 
     /* stft window */
     MYFLT *win;
@@ -2083,31 +1716,19 @@ static int hrtfmove2_init(CSOUND *csound, hrtfmove2 *p)
     else if(sr == 96000)
       irlength = 256;
 
-    /* copy in string name... */
-    strncpy(filel, (char*) p->ifilel->data, MAXNAME-1); filel[MAXNAME-1] = '\0';
-    strncpy(filer, (char*) p->ifiler->data, MAXNAME-1); filer[MAXNAME-1] = '\0';
-
-    /* reading files, with byte swap */
-    fpl = csound->ldmemfile2withCB(csound, filel, CSFTYPE_FLOATS_BINARY,
-                                   swap4bytes);
-    if (UNLIKELY(fpl == NULL))
-     return
-        csound->InitError(csound,
-                          Str("\n\n\nCannot load left data file, exiting\n\n"));
-
-    fpr = csound->ldmemfile2withCB(csound, filer, CSFTYPE_FLOATS_BINARY,
-                                   swap4bytes);
-    if (UNLIKELY(fpr == NULL))
-      return
-        csound->InitError(csound,
-                          Str("\n\n\nCannot load right data file, exiting\n\n"));
+    /* the spectra of the data files, shared */
+    if (UNLIKELY(hrtf_grid(csound, &p->grid, p->ifilel, p->ifiler,
+                           irlength) != OK))
+      return NOTOK;
+    csound->RegisterDeinitCallback(csound, p, hrtfmove2_deinit);
 
     p->irlength = irlength;
+    p->nbins = nbins = irlength / 2 + 1;
     p->sroverN = sr / irlength;
-
-    /* file handles */
-    p->fpbeginl = (float *) fpl->beginp;
-    p->fpbeginr = (float *) fpr->beginp;
+    csound->RealFFT2Release(csound, p->fwdsetup);
+    p->fwdsetup = csound->RealFFT2Setup(csound, irlength, FFT_FWD);
+    csound->RealFFT2Release(csound, p->invsetup);
+    p->invsetup = csound->RealFFT2Setup(csound, irlength, FFT_INV);
 
     if(overlap != 2 && overlap != 4 && overlap != 8 && overlap != 16)
       overlap = 4;
@@ -2147,32 +1768,14 @@ static int hrtfmove2_init(CSOUND *csound, hrtfmove2 *p)
     memset(p->outspecl.auxp, 0, irlength * sizeof(MYFLT));
     memset(p->outspecr.auxp, 0, irlength * sizeof(MYFLT));
 
-    /* interpolation values */
-    if (!p->lowl1.auxp || p->lowl1.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->lowl1);
-    if (!p->lowr1.auxp || p->lowr1.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->lowr1);
-    if (!p->lowl2.auxp || p->lowl2.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->lowl2);
-    if (!p->lowr2.auxp || p->lowr2.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->lowr2);
-    if (!p->highl1.auxp || p->highl1.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->highl1);
-    if (!p->highr1.auxp || p->highr1.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->highr1);
-    if (!p->highl2.auxp || p->highl2.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->highl2);
-    if (!p->highr2.auxp || p->highr2.size < irlength * sizeof(MYFLT))
-      csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->highr2);
-
-    memset(p->lowl1.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->lowr1.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->lowl2.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->lowr2.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->highl1.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->highl2.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->highr1.auxp, 0, irlength * sizeof(MYFLT));
-    memset(p->highr2.auxp, 0, irlength * sizeof(MYFLT));
+    /* interpolated magnitudes */
+    if (!p->magl.auxp || p->magl.size < nbins * sizeof(MYFLT))
+      csound->AuxAlloc(csound, nbins * sizeof(MYFLT), &p->magl);
+    if (!p->magr.auxp || p->magr.size < nbins * sizeof(MYFLT))
+      csound->AuxAlloc(csound, nbins * sizeof(MYFLT), &p->magr);
+
+    memset(p->magl.auxp, 0, nbins * sizeof(MYFLT));
+    memset(p->magr.auxp, 0, nbins * sizeof(MYFLT));
 
     if (!p->win.auxp || p->win.size < irlength * sizeof(MYFLT))
       csound->AuxAlloc(csound, irlength * sizeof(MYFLT), &p->win);
@@ -2251,46 +1854,22 @@ static int hrtfmove2_process(CSOUND *csound, hrtfmove2 *p)
     int counter = p ->counter;
     int t = p ->t;
 
-        /* pointers into HRTF files */
-    float *fpindexl;
-    float *fpindexr;
+    /* shared spectra of the measured points */
+    const MYFLT *grid = p->grid->data;
+    int nbins = p->nbins;
+    HRTFLOC loc;
 
-    int i, skip = 0;
+    int i;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t j, nsmps = CS_KSMPS;
 
-    /* interpolation values */
-    MYFLT *lowl1 = (MYFLT *)p->lowl1.auxp;
-    MYFLT *lowr1 = (MYFLT *)p->lowr1.auxp;
-    MYFLT *lowl2 = (MYFLT *)p->lowl2.auxp;
-    MYFLT *lowr2 = (MYFLT *)p->lowr2.auxp;
-    MYFLT *highl1 = (MYFLT *)p->highl1.auxp;
-    MYFLT *highr1 = (MYFLT *)p->highr1.auxp;
-    MYFLT *highl2 = (MYFLT *)p->highl2.auxp;
-    MYFLT *highr2 = (MYFLT *)p->highr2.auxp;
-
-    /* local interpolation values */
-    MYFLT elevindexhighper, angleindex2per, angleindex4per;
-    int elevindexlow, elevindexhigh, angleindex1, angleindex2,
-      angleindex3, angleindex4;
-    MYFLT magl, magr, phasel, phaser, magllow, magrlow, maglhigh, magrhigh;
-
-    /* woodworth values */
-    MYFLT radianangle, radianelev, itd=0, itdww, freq;
+    /* interpolated magnitudes */
+    MYFLT *magl = (MYFLT *)p->magl.auxp;
+    MYFLT *magr = (MYFLT *)p->magr.auxp;
 
     int irlength = p->irlength;
 
-    /* local variables, mainly used for simplification */
-    MYFLT elevindexstore;
-    MYFLT angleindexlowstore;
-    MYFLT angleindexhighstore;
-
-
-    /* start indices at correct value (start of file)/ zero indices. */
-    fpindexl = (float *) p->fpbeginl;
-    fpindexr = (float *) p->fpbeginr;
-
     if (UNLIKELY(offset)) {
       memset(outsigl, '\0', offset*sizeof(MYFLT));
       memset(outsigr, '\0', offset*sizeof(MYFLT));
@@ -2329,249 +1908,12 @@ static int hrtfmove2_process(CSOUND *csound, hrtfmove2 *p)
 
             if(angle != p->anglev || elev != p->elevv)
               {
-                /* two nearest elev indices to avoid recalculating */
-                elevindexstore = (elev - minelev) / elevincrement;
-                elevindexlow = (int)elevindexstore;
-
-                if(elevindexlow < 13)
-                  elevindexhigh = elevindexlow + 1;
-                /* highest index reached */
-                else
-                  elevindexhigh = elevindexlow;
-
-                /* get percentage value for interpolation */
-                elevindexhighper = elevindexstore - elevindexlow;
-
-                /* avoid recalculation */
-                angleindexlowstore = angle / (FL(360.0) /
-                                              elevationarray[elevindexlow]);
-                angleindexhighstore = angle / (FL(360.0) /
-                                               elevationarray[elevindexhigh]);
-
-                /* 4 closest indices, 2 low and 2 high */
-                angleindex1 = (int)angleindexlowstore;
-
-                angleindex2 = angleindex1 + 1;
-                angleindex2 = angleindex2 % elevationarray[elevindexlow];
-
-                angleindex3 = (int)angleindexhighstore;
-
-                angleindex4 = angleindex3 + 1;
-                angleindex4 = angleindex4 % elevationarray[elevindexhigh];
-
-                /* angle percentages for interp */
-                angleindex2per = angleindexlowstore - angleindex1;
-                angleindex4per = angleindexhighstore - angleindex3;
-
-                /* read 4 nearest HRTFs */
-                skip = 0;
-                /* switch l and r */
-                if(angleindex1 > elevationarray[elevindexlow] / 2)
-                  {
-                    for(i = 0; i < elevindexlow; i++)
-                      skip += ((int)(elevationarray[i] / 2) + 1) * irlength;
-                    for (i = 0;
-                         i < (elevationarray[elevindexlow] - angleindex1);
-                         i++)
-                      skip += irlength;
-                    for(i = 0; i < irlength; i++)
-                      {
-                        lowl1[i] = fpindexr[skip + i];
-                        lowr1[i] = fpindexl[skip + i];
-                      }
-                  }
-                else
-                  {
-                    for(i = 0; i < elevindexlow; i++)
-                      skip += ((int)(elevationarray[i] / 2) + 1) * irlength;
-                    for (i = 0; i < angleindex1; i++)
-                      skip += irlength;
-                    for(i = 0; i < irlength; i++)
-                      {
-                        lowl1[i] = fpindexl[skip + i];
-                        lowr1[i] = fpindexr[skip + i];
-                      }
-                  }
-
-                skip = 0;
-                if(angleindex2 > elevationarray[elevindexlow] / 2)
-                  {
-                    for(i = 0; i < elevindexlow; i++)
-                      skip += ((int)(elevationarray[i] / 2) + 1) * irlength;
-                    for (i = 0;
-                         i < (elevationarray[elevindexlow] - angleindex2);
-                         i++)
-                      skip += irlength;
-                    for(i = 0; i < irlength; i++)
-                      {
-                        lowl2[i] = fpindexr[skip + i];
-                        lowr2[i] = fpindexl[skip + i];
-                      }
-                  }
-                else
-                  {
-                    for(i = 0; i < elevindexlow; i++)
-                      skip += ((int)(elevationarray[i] / 2) + 1) * irlength;
-                    for (i = 0; i < angleindex2; i++)
-                      skip += irlength;
-                    for(i = 0; i < irlength; i++)
-                      {
-                        lowl2[i] = fpindexl[skip + i];
-                        lowr2[i] = fpindexr[skip + i];
-                      }
-                  }
-
-                skip = 0;
-                if(angleindex3 > elevationarray[elevindexhigh] / 2)
-                  {
-                    for(i = 0; i < elevindexhigh; i++)
-                      skip += ((int)(elevationarray[i] / 2) + 1) * irlength;
-                    for (i = 0;
-                         i < (elevationarray[elevindexhigh] - angleindex3);
-                         i++)
-                      skip += irlength;
-                    for(i = 0; i < irlength; i++)
-                      {
-                        highl1[i] = fpindexr[skip + i];
-                        highr1[i] = fpindexl[skip + i];
-                      }
-                  }
-                else
-                  {
-                    for(i = 0; i < elevindexhigh; i++)
-                      skip += ((int)(elevationarray[i] / 2) + 1) * irlength;
-                    for (i = 0; i < angleindex3; i++)
-                      skip += irlength;
-                    for(i = 0; i < irlength; i++)
-                      {
-                        highl1[i] = fpindexl[skip + i];
-                        highr1[i] = fpindexr[skip + i];
-                      }
-                  }
-
-                skip = 0;
-                if(angleindex4 > elevationarray[elevindexhigh] / 2)
-                  {
-                    for(i = 0; i < elevindexhigh; i++)
-                      skip += ((int)(elevationarray[i] / 2) + 1) * irlength;
-                    for (i = 0;
-                         i < (elevationarray[elevindexhigh] - angleindex4);
-                         i++)
-                      skip += irlength;
-                    for(i = 0; i < irlength; i++)
-                      {
-                        highl2[i] = fpindexr[skip + i];
-                        highr2[i] = fpindexl[skip + i];
-                      }
-                  }
-                else
-                  {
-                    for(i = 0; i < elevindexhigh; i++)
-                      skip += ((int)(elevationarray[i] / 2) + 1) * irlength;
-                    for (i = 0; i < angleindex4; i++)
-                      skip += irlength;
-                    for(i = 0; i < irlength; i++)
-                      {
-                        highl2[i] = fpindexl[skip + i];
-                        highr2[i] = fpindexr[skip + i];
-                      }
-                  }
-
-                /* woodworth process */
-                /* ITD formula, check which ear is relevant to calculate
-                   angle from */
-                if(angle > FL(180.0))
-                  radianangle = (angle - FL(180.0)) * PI_F / FL(180.0);
-                else
-                  radianangle = angle * PI_F / FL(180.0);  /* degrees to radians */
-                radianelev = elev * PI_F / FL(180.0);
-
-                /* get in correct range for formula */
-                if(radianangle > (PI_F / FL(2.0)))
-                  radianangle = FL(PI) - radianangle;
-
-                /* woodworth formula for itd */
-                itdww = (radianangle + SIN(radianangle)) * r * COS(radianelev) / c;
-
-                /* 0 Hz and Nyq... */
-                /* need fabs() here, to get mag, as 0hz and nyq stored as a
-                   real value, to allow for possible negative, implying phase
-                   of pi (in phase truncation) */
-                magllow = FABS(lowl1[0]) + (FABS(lowl2[0]) - FABS(lowl1[0])) *
-                  angleindex2per;
-                maglhigh = FABS(highl1[0]) + (FABS(highl2[0]) - FABS(highl1[0])) *
-                  angleindex4per;
-                hrtflfloat[0] = magllow + (maglhigh - magllow) * elevindexhighper;
-
-                magllow = FABS(lowl1[1]) + (FABS(lowl2[1]) - FABS(lowl1[1])) *
-                  angleindex2per;
-                maglhigh = FABS(highl1[1]) + (FABS(highl2[1]) - FABS(highl1[1])) *
-                  angleindex4per;
-                hrtflfloat[1] = magllow + (maglhigh - magllow) * elevindexhighper;
-
-                magrlow = FABS(lowr1[0]) + (FABS(lowr2[0]) - FABS(lowr1[0])) *
-                  angleindex2per;
-                magrhigh = FABS(highr1[0]) + (FABS(highr2[0]) - FABS(highr1[0])) *
-                  angleindex4per;
-                hrtfrfloat[0] = magrlow + (magrhigh - magrlow) * elevindexhighper;
-
-                magrlow = FABS(lowr1[1]) + (FABS(lowr2[1]) - FABS(lowr1[1])) *
-                  angleindex2per;
-                magrhigh = FABS(highr1[1]) + (FABS(highr2[1]) - FABS(highr1[1])) *
-                  angleindex4per;
-                hrtfrfloat[1] = magrlow + (magrhigh - magrlow) * elevindexhighper;
-
-                /* magnitude interpolation */
-                for(i = 2; i < irlength; i += 2)
-                  {
-                    /* interpolate high and low mags */
-                    magllow = lowl1[i] + (lowl2[i] - lowl1[i]) * angleindex2per;
-                    maglhigh = highl1[i] + (highl2[i] - highl1[i]) * angleindex4per;
-
-                    magrlow = lowr1[i] + (lowr2[i] - lowr1[i]) * angleindex2per;
-                    magrhigh = highr1[i] + (highr2[i] - highr1[i]) * angleindex4per;
-
-                    /* interpolate high and low results */
-                    magl = magllow + (maglhigh - magllow) * elevindexhighper;
-                    magr = magrlow + (magrhigh - magrlow) * elevindexhighper;
-
-                    freq = (i / 2) * sroverN;
-
-                    /* non linear itd...last value in array = 1.0,
-                       so back to itdww */
-                    if(p->sr == 96000)
-                      {
-                        if ((i / 2) < 6)
-                          itd = itdww * nonlinitd96k[(i / 2) - 1];
-                      }
-                    else if(p->sr == 48000)
-                      {
-                        if ((i / 2) < 6)
-                          itd = itdww * nonlinitd48k[(i / 2) - 1];
-                      }
-                    else if(p->sr == 44100)
-                      {
-                        if((i / 2) < 6)
-                          itd = itdww * nonlinitd[(i / 2) - 1];
-                      }
-
-                    if(angle > FL(180.))
-                      {
-                        phasel = TWOPI_F * freq * (itd / 2);
-                        phaser = TWOPI_F * freq * -(itd / 2);}
-                    else
-                      {
-                        phasel = TWOPI_F * freq * -(itd / 2);
-                        phaser = TWOPI_F * freq * (itd / 2);
-                      }
-
-                    /* polar to rectangular */
-                    hrtflfloat[i] = magl * COS(phasel);
-                    hrtflfloat[i+1] = magl * SIN(phasel);
-
-                    hrtfrfloat[i] = magr * COS(phaser);
-                    hrtfrfloat[i+1] = magr * SIN(phaser);
-                  }
+                /* magnitude interpolation of the 4 nearest points,
+                   woodworth phase */
+                hrtf_locate(angle, elev, &loc);
+                hrtf_interp(grid, nbins, &loc, magl, magr);
+                hrtf_woodworth(magl, magr, nbins, sr, sroverN, angle, elev, r,
+                               hrtflfloat, hrtfrfloat);
 
                 p->elevv = elev;
                 p->anglev = angle;
@@ -2589,16 +1931,14 @@ static int hrtfmove2_process(CSOUND *csound, hrtfmove2 *p)
             /* zero the current input sigframe time pointer */
             overlapskipin[t] = 0;
 
-            csound->RealFFT(csound, complexinsig, irlength);
+            csound->RealFFT2(csound, p->fwdsetup, complexinsig);
 
-            csound->RealFFTMult(csound, outspecl, hrtflfloat,
-                                complexinsig, irlength, FL(1.0));
-            csound->RealFFTMult(csound, outspecr, hrtfrfloat,
-                                complexinsig, irlength, FL(1.0));
+            hrtf_specmult(outspecl, outspecr, hrtflfloat, hrtfrfloat,
+                          complexinsig, irlength);
 
             /* convolution is the inverse FFT of above result */
-            csound->InverseRealFFT(csound, outspecl, irlength);
-            csound->InverseRealFFT(csound, outspecr, irlength);
+            csound->RealFFT2(csound, p->invsetup, outspecl);
+            csound->RealFFT2(csound, p->invsetup, outspecr);
 
             /* need scaling based on overlap (more overlaps -> louder) and sr... */
             for(i = 0; i < irlength; i++)
@@ -222,6 +222,9 @@ typedef struct
 
     MYFLT sr;
 
+    /* FFT setups, for irlength and irlengthpad */
+    void *invsetup, *fwdsetuppad, *invsetuppad;
+
 }hrtfreverb;
 
 int hrtfreverb_init(CSOUND *csound, hrtfreverb *p)
@@ -338,6 +341,12 @@ int hrtfreverb_init(CSOUND *csound, hrtfreverb *p)
     /* setup structure values */
     p->irlength = irlength;
     p->irlengthpad = irlengthpad;
+    csound->RealFFT2Release(csound, p->invsetup);
+    p->invsetup = csound->RealFFT2Setup(csound, irlength, FFT_INV);
+    csound->RealFFT2Release(csound, p->fwdsetuppad);
+    p->fwdsetuppad = csound->RealFFT2Setup(csound, irlengthpad, FFT_FWD);
+    csound->RealFFT2Release(csound, p->invsetuppad);
+    p->invsetuppad = csound->RealFFT2Setup(csound, irlengthpad, FFT_INV);
     p->overlapsize = overlapsize;
 
     /* allocate memory */
@@ -798,9 +807,9 @@ int hrtfreverb_init(CSOUND *csound, hrtfreverb *p)
       }
 
     /* no need to go back to rectangular for fft, as phase = 0, so same */
-    csound->InverseRealFFT(csound, HRTFavep, irlength);
-    csound->InverseRealFFT(csound, coherup, irlength);
-    csound->InverseRealFFT(csound, cohervp, irlength);
+    csound->RealFFT2(csound, p->invsetup, HRTFavep);
+    csound->RealFFT2(csound, p->invsetup, coherup);
+    csound->RealFFT2(csound, p->invsetup, cohervp);
 
     filtoutp = (MYFLT *)p->filtout.auxp;
     filtuoutp = (MYFLT *)p->filtuout.auxp;
@@ -830,9 +839,9 @@ int hrtfreverb_init(CSOUND *csound, hrtfreverb *p)
         filtvpadp[i] = FL(0.0);
       }
 
-    csound->RealFFT(csound, filtpadp, irlengthpad);
-    csound->RealFFT(csound, filtupadp, irlengthpad);
-    csound->RealFFT(csound, filtvpadp, irlengthpad);
+    csound->RealFFT2(csound, p->fwdsetuppad, filtpadp);
+    csound->RealFFT2(csound, p->fwdsetuppad, filtupadp);
+    csound->RealFFT2(csound, p->fwdsetuppad, filtvpadp);
 
     T = FL(1.0) / sr;
 
@@ -1214,8 +1223,8 @@ int hrtfreverb_process(CSOUND *csound, hrtfreverb *p)
               }
 
             /* fft result from matrices */
-            csound->RealFFT(csound, matrixlup, irlengthpad);
-            csound->RealFFT(csound, matrixrvp, irlengthpad);
+            csound->RealFFT2(csound, p->fwdsetuppad, matrixlup);
+            csound->RealFFT2(csound, p->fwdsetuppad, matrixrvp);
 
             /* convolution: spectral multiplication */
             csound->RealFFTMult(csound, matrixlup, matrixlup,
@@ -1224,8 +1233,8 @@ int hrtfreverb_process(CSOUND *csound, hrtfreverb *p)
                                 filtvpadp, irlengthpad, FL(1.0));
 
             /* ifft result */
-            csound->InverseRealFFT(csound, matrixlup, irlengthpad);
-            csound->InverseRealFFT(csound, matrixrvp, irlengthpad);
+            csound->RealFFT2(csound, p->invsetuppad, matrixlup);
+            csound->RealFFT2(csound, p->invsetuppad, matrixrvp);
 
             for(j = 0; j < irlength; j++)
               {
@@ -1256,8 +1265,8 @@ int hrtfreverb_process(CSOUND *csound, hrtfreverb *p)
               }
 
             /* fft result from matrices */
-            csound->RealFFT(csound, hrtflp, irlengthpad);
-            csound->RealFFT(csound, hrtfrp, irlengthpad);
+            csound->RealFFT2(csound, p->fwdsetuppad, hrtflp);
+            csound->RealFFT2(csound, p->fwdsetuppad, hrtfrp);
 
             /* convolution: spectral multiplication */
             csound->RealFFTMult(csound, hrtflp, hrtflp, filtpadp,
@@ -1266,8 +1275,8 @@ int hrtfreverb_process(CSOUND *csound, hrtfreverb *p)
                                 irlengthpad, FL(1.0));
 
             /* ifft result */
-            csound->InverseRealFFT(csound, hrtflp, irlengthpad);
-            csound->InverseRealFFT(csound, hrtfrp, irlengthpad);
+            csound->RealFFT2(csound, p->invsetuppad, hrtflp);
+            csound->RealFFT2(csound, p->invsetuppad, hrtfrp);
 
             /* scale */
             for(j = 0; j < irlengthpad; j++)
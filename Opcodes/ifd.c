@@ -155,6 +155,7 @@ static int ifd_init(CSOUND * csound, IFD * p)
 
   p->factor = CS_ESR / TWOPI_F;
   p->fund = CS_ESR / fftsize;
+  csound->RealFFT2Release(csound, p->setup);
   p->setup = csound->RealFFT2Setup(csound, fftsize, FFT_FWD);
   return OK;
 }
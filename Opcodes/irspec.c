@@ -0,0 +1,159 @@
+/*
+    irspec.c:
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+
+#include "csoundCore.h"
+#include "irspec.h"
+
+/* The list of entries is a global variable of the instance, and the
+   entries are allocated with csound->Malloc(), so that all of it goes
+   away on reset. */
+
+#define IRSPEC_GLOBAL   "irspec::cache"
+
+static IRSPEC **irspec_list(CSOUND *csound)
+{
+    IRSPEC  **pp;
+
+    pp = (IRSPEC**) csound->QueryGlobalVariable(csound, IRSPEC_GLOBAL);
+    if (pp == NULL) {
+      if (UNLIKELY(csound->CreateGlobalVariable(csound, IRSPEC_GLOBAL,
+                                                sizeof(IRSPEC*)) != 0))
+        return NULL;
+      pp = (IRSPEC**) csound->QueryGlobalVariable(csound, IRSPEC_GLOBAL);
+    }
+    return pp;
+}
+
+/* FNV-1a, a word at a time */
+
+uint64_t irspec_hash_table(FUNC *ftp, int32 skip, int32 n, int32 nChannels)
+{
+    uint64_t  h = (uint64_t) 0xcbf29ce484222325ULL;
+    int32     i, end;
+    union {
+      MYFLT     f;
+#ifdef USE_DOUBLE
+      uint64_t  w;
+#else
+      uint32_t  w;
+#endif
+    } u;
+
+    i = skip * nChannels;
+    end = (skip + n) * nChannels;
+    if (i < 0)
+      i = 0;
+    if (end > (int32) ftp->flen)
+      end = (int32) ftp->flen;
+    for ( ; i < end; i++) {
+      u.f = ftp->ftable[i];
+      h = (h ^ (uint64_t) u.w) * (uint64_t) 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static int same_source(const IRSPEC *a, const IRSPEC *b)
+{
+    if (a->kind != b->kind)
+      return 0;
+    if (a->name != NULL || b->name != NULL)
+      return (a->name != NULL && b->name != NULL && !strcmp(a->name, b->name));
+    return (a->fno == b->fno);
+}
+
+static int same_key(const IRSPEC *a, const IRSPEC *b)
+{
+    return (same_source(a, b) && a->flen == b->flen && a->hash == b->hash &&
+            a->partSize == b->partSize && a->maxPartSize == b->maxPartSize &&
+            a->skip == b->skip && a->len == b->len &&
+            a->channel == b->channel);
+}
+
+IRSPEC *irspec_find(CSOUND *csound, const IRSPEC *key)
+{
+    IRSPEC  **pp = irspec_list(csound), *s;
+
+    if (pp == NULL)
+      return NULL;
+    for (s = *pp; s != NULL; s = s->nxt) {
+      if (same_key(s, key)) {
+        s->refCount++;
+        return s;
+      }
+    }
+    return NULL;
+}
+
+IRSPEC *irspec_new(CSOUND *csound, const IRSPEC *key, size_t nSmps)
+{
+    IRSPEC  *s;
+
+    s = (IRSPEC*) csound->Calloc(csound, sizeof(IRSPEC));
+    *s = *key;
+    if (key->name != NULL) {
+      s->name = (char*) csound->Malloc(csound, strlen(key->name) + 1);
+      strcpy(s->name, key->name);
+    }
+    s->nSmps = nSmps;
+    s->data = (MYFLT*) csound->Calloc(csound, nSmps * sizeof(MYFLT));
+    s->refCount = 1;
+    s->linked = 0;
+    s->nxt = NULL;
+    return s;
+}
+
+static void irspec_free(CSOUND *csound, IRSPEC *s)
+{
+    if (s->name != NULL)
+      csound->Free(csound, s->name);
+    csound->Free(csound, s->data);
+    csound->Free(csound, s);
+}
+
+void irspec_insert(CSOUND *csound, IRSPEC *s)
+{
+    IRSPEC  **pp = irspec_list(csound), **q, *t;
+
+    if (UNLIKELY(pp == NULL))
+      return;           /* not cached: freed when released */
+    /* entries of the same source that nothing holds are out of date,
+       or of a partitioning no longer used */
+    q = pp;
+    while ((t = *q) != NULL) {
+      if (t->refCount == 0 && same_source(t, s)) {
+        *q = t->nxt;
+        irspec_free(csound, t);
+      }
+      else
+        q = &(t->nxt);
+    }
+    s->linked = 1;
+    s->nxt = *pp;
+    *pp = s;
+}
+
+void irspec_release(CSOUND *csound, IRSPEC *s)
+{
+    if (s == NULL)
+      return;
+    if (--s->refCount == 0 && !s->linked)
+      irspec_free(csound, s);
+}
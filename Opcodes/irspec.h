@@ -0,0 +1,79 @@
+/*
+    irspec.h:
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+    02111-1307 USA
+*/
+
+#ifndef CSOUND_IRSPEC_H
+#define CSOUND_IRSPEC_H
+
+/* Cache of the partition spectra of impulse responses, shared read only
+   by the instances of the partitioned convolution opcodes.  An entry is
+   found by its key: the source (a sound file by name, or a function
+   table by number and a hash of the data read from it, so that a table
+   rewritten or replaced is transformed again) and the parameters of the
+   partitioning.  The HRTF opcodes keep their grid of spectra here too,
+   by the names of the pair of data files.  The layout of the data is up
+   to the opcode; opcodes of different layouts use different 'kind's.
+   An instance holds its entry from init to the end of the note (its
+   deinit callback releases it).  Entries stay in the cache until reset;
+   an entry not held by any instance is dropped when another entry of the
+   same source is added. */
+
+typedef struct IRSPEC_ {
+    /* key */
+    int32   kind;               /* opcode layout, IRSPEC_FTCONV, ...        */
+    char    *name;              /* source file name, or NULL for a table    */
+    int32   fno;                /* source table number                      */
+    uint32  flen;               /* table length                             */
+    uint64_t hash;              /* of the table data read                   */
+    int32   partSize;           /* partition length in sample frames        */
+    int32   maxPartSize;        /* longest partition, non-uniform layouts   */
+    int32   skip, len;          /* frames skipped at the start, and used    */
+    int32   channel;            /* channels, or channel selected            */
+    /* value */
+    int32   nChannels;          /* channels of the spectra                  */
+    int32   nPartitions;        /* partitions per channel                   */
+    size_t  nSmps;
+    MYFLT   *data;
+    int     refCount;           /* instances holding the entry              */
+    int     linked;
+    struct IRSPEC_ *nxt;
+} IRSPEC;
+
+#define IRSPEC_FTCONV       1
+#define IRSPEC_PCONVOLVE    2
+#define IRSPEC_HRTF         3
+
+/* hash of n frames of nChannels channels of table ftp, from frame skip */
+uint64_t irspec_hash_table(FUNC *ftp, int32 skip, int32 n, int32 nChannels);
+
+/* the entry matching the key fields of 'key', held for the caller, or
+   NULL if there is none */
+IRSPEC *irspec_find(CSOUND *, const IRSPEC *key);
+
+/* a new entry with the key of 'key' and nSmps samples of data, held for
+   the caller, who fills in the data and then adds it to the cache with
+   irspec_insert() (or frees it with irspec_release()) */
+IRSPEC *irspec_new(CSOUND *, const IRSPEC *key, size_t nSmps);
+void irspec_insert(CSOUND *, IRSPEC *);
+
+/* let go of an entry (NULL is ignored) */
+void irspec_release(CSOUND *, IRSPEC *);
+
+#endif  /* CSOUND_IRSPEC_H */
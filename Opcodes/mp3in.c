@@ -424,7 +424,9 @@ static int sinit(CSOUND *csound, DATASPACE *p)
     /*clock_gettime(CLOCK_MONOTONIC, &ts);
       dtime = ts.tv_sec + 1e-9*ts.tv_nsec - dtime;
       csound->Message(csound, "SINIT time %f ms", dtime*1000);*/
+    csound->RealFFT2Release(csound, p->fwdsetup);
     p->fwdsetup = csound->RealFFT2Setup(csound,N,FFT_FWD);
+    csound->RealFFT2Release(csound, p->invsetup);
     p->invsetup = csound->RealFFT2Setup(csound,N,FFT_INV);
     return OK;
 }
@@ -1290,7 +1292,9 @@ static int player_init(CSOUND *csound, PLAYER *p){
   p->fw = pffft_aligned_malloc(p->p->N*sizeof(float));
 #else
   while(!p->p->N) usleep(1000);
+  csound->RealFFT2Release(csound, p->fwdsetup);
   p->fwdsetup = csound->RealFFT2Setup(csound,p->p->N,FFT_FWD);
+  csound->RealFFT2Release(csound, p->invsetup);
   p->invsetup = csound->RealFFT2Setup(csound,p->p->N,FFT_INV);
 #endif
   p->start_flag = 1;
@@ -2094,7 +2098,9 @@ static int player_init2(CSOUND *csound, PLAYER *p){
   p->fw = pffft_aligned_malloc(p->p->N*sizeof(float));
 #else
   while(!p->p->N) usleep(1000);
+  csound->RealFFT2Release(csound, p->fwdsetup);
   p->fwdsetup = csound->RealFFT2Setup(csound,p->p->N,FFT_FWD);
+  csound->RealFFT2Release(csound, p->invsetup);
   p->invsetup = csound->RealFFT2Setup(csound,p->p->N,FFT_INV);
 #endif
   p->start_flag = 1;
@@ -607,7 +607,9 @@ static int grain2set(CSOUND *csound, GRAIN2 *p)
     /* allocate space */
 
     if (p->nr_osc == -1) return OK;                 /* no oscillators */
-    n = (uint32_t) p->nr_osc * (int32) sizeof(GRAIN2_OSC);
+    /* the oscillators, the grains they start next, and the scheduling */
+    n = (uint32_t) p->nr_osc * (int32) sizeof(GRAIN2_OSC) * 2;
+    n += ((uint32_t) p->nr_osc * 2 + CS_KSMPS + 1) * (int32) sizeof(int);
     if ((p->auxdata.auxp == NULL) || (p->auxdata.size < n))
       csound->AuxAlloc(csound, n, &(p->auxdata));
     p->osc = (GRAIN2_OSC *) p->auxdata.auxp;
@@ -670,18 +672,50 @@ static void grain2_init_grain(GRAIN2 *p, GRAIN2_OSC *o)
     }
 }
 
+/* render oscillator o from sample n0 up to (not including) n1 */
+
+static void grain2_render(MYFLT *aout, int n0, int n1, GRAIN2_OSC *o,
+                          uint32 w_frq, MYFLT *ft, uint32 mask, uint32 lobits,
+                          MYFLT pfrac, int g_interp, MYFLT *w_ft,
+                          uint32 w_mask, uint32 w_lobits, MYFLT w_pfrac,
+                          int w_interp)
+{
+    int     nn;
+    uint32  n, g_ph = o->grain_phs, g_frq = o->grain_frq_int;
+    uint32  w_ph = o->window_phs;
+    MYFLT   a, k;
+
+    for (nn = n0; nn < n1; nn++) {
+      /* grain waveform */
+      n = g_ph >> lobits; k = ft[n++];
+      if (g_interp)
+        k += (ft[n] - k) * (MYFLT) ((int32) (g_ph & mask)) * pfrac;
+      g_ph += g_frq;
+      g_ph &= OSCBNK_PHSMSK;
+      /* window waveform */
+      n = w_ph >> w_lobits; a = w_ft[n++];
+      if (w_interp)
+        a += (w_ft[n] - a) * (MYFLT) ((int32) (w_ph & w_mask)) * w_pfrac;
+      w_ph += w_frq;
+      /* mix to output */
+      aout[nn] += a * k;
+    }
+    o->grain_phs = g_ph; o->window_phs = w_ph;
+}
+
 /* ---- grain2 opcode ---- */
 
 static int grain2(CSOUND *csound, GRAIN2 *p)
 {
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t nn, nsmps = CS_KSMPS;
-    int         i, w_interp, g_interp, f_nolock;
-    MYFLT       *aout, *ft, *w_ft, grain_frq, frq_scl, pfrac, w_pfrac, f, a, k;
-    uint32 n, mask, lobits, w_mask, w_lobits;
+    uint32_t nsmps = CS_KSMPS;
+    int         i, j, nr_osc, w_interp, g_interp, f_nolock;
+    int         n0, n1, chunk, *at, *order, *cnt;
+    MYFLT       *aout, *ft, *w_ft, grain_frq, frq_scl, pfrac, w_pfrac, f;
+    uint32 d, mask, lobits, w_mask, w_lobits;
     uint32 g_frq, w_frq;
-    GRAIN2_OSC  *o;
+    GRAIN2_OSC  *o, *nxt;
     FUNC        *ftp;
 
     /* assign object data to local variables */
@@ -732,36 +766,59 @@ static int grain2(CSOUND *csound, GRAIN2 *p)
         o[i].grain_frq_int = OSCBNK_PHS2INT(f);
       }
     }
-    aout = p->ar;                       /* audio output         */
-    for (nn = offset; nn<nsmps; nn++) {
-      i = p->nr_osc;
-      do {
-        /* grain waveform */
-        n = o->grain_phs >> lobits; k = ft[n++];
-        if (g_interp)
-          k += (ft[n] - k) * (MYFLT) ((int32) (o->grain_phs & mask)) * pfrac;
-        o->grain_phs += o->grain_frq_int;
-        o->grain_phs &= OSCBNK_PHSMSK;
-        /* window waveform */
-        n = o->window_phs >> w_lobits; a = w_ft[n++];
-        if (w_interp)
-          a += (w_ft[n] - a) * (MYFLT) ((int32) (o->window_phs & w_mask))
-               * w_pfrac;
-        o->window_phs += w_frq;
-        /* mix to output */
-        aout[nn] += a * k;
-        if (o->window_phs >= OSCBNK_PHSMAX) {
-          o->window_phs &= OSCBNK_PHSMSK;       /* new grain    */
-          grain2_init_grain(p, o);
-          /* grain frequency */
-          if (f_nolock) {
-            f = grain_frq + frq_scl * o->grain_frq_flt;
-            o->grain_frq_int = OSCBNK_PHS2INT(f);
-          }
+    /* The oscillators are rendered one after the other, over chunks of
+       the k-period short enough for a window to wrap at most once. The
+       grains that start in a chunk are set up before it is rendered, in
+       the order they start in, so that the random numbers are drawn as
+       when all oscillators took a turn at each sample. */
+    nr_osc = p->nr_osc;
+    nxt    = o + nr_osc;                /* the grains started next      */
+    at     = (int *) (nxt + nr_osc);    /* the sample a grain starts at */
+    order  = at + nr_osc;
+    cnt    = order + nr_osc;
+    chunk  = (w_frq ? (int) (OSCBNK_PHSMAX / w_frq) : (int) nsmps);
+    for (n0 = (int) offset; n0 < (int) nsmps; n0 = n1) {
+      n1 = ((int) nsmps - n0 > chunk ? n0 + chunk : (int) nsmps);
+      memset(cnt, 0, (n1 - n0 + 1) * sizeof(int));
+      for (i = 0; i < nr_osc; i++) {
+        at[i] = -1;
+        if (!w_frq) continue;
+        /* samples to go before the window wraps */
+        d = (OSCBNK_PHSMAX - 1UL - o[i].window_phs) / w_frq;
+        if (d < (uint32) (n1 - n0)) {
+          at[i] = n0 + (int) d;
+          cnt[d + 1]++;
         }
-        o++;            /* next grain */
-      } while (--i);
-      o -= p->nr_osc;
+      }
+      for (j = 0; j < n1 - n0; j++)
+        cnt[j + 1] += cnt[j];
+      for (i = 0; i < nr_osc; i++)
+        if (at[i] >= 0) order[cnt[at[i] - n0]++] = i;
+      for (j = 0; j < cnt[n1 - n0 - 1]; j++) {
+        grain2_init_grain(p, nxt + order[j]);   /* new grain    */
+        /* grain frequency */
+        if (f_nolock) {
+          f = grain_frq + frq_scl * nxt[order[j]].grain_frq_flt;
+          nxt[order[j]].grain_frq_int = OSCBNK_PHS2INT(f);
+        }
+      }
+      for (i = 0; i < nr_osc; i++) {
+        if (at[i] < 0) {
+          grain2_render(aout, n0, n1, o + i, w_frq, ft, mask, lobits, pfrac,
+                        g_interp, w_ft, w_mask, w_lobits, w_pfrac, w_interp);
+          continue;
+        }
+        grain2_render(aout, n0, at[i] + 1, o + i, w_frq, ft, mask, lobits,
+                      pfrac, g_interp, w_ft, w_mask, w_lobits, w_pfrac,
+                      w_interp);
+        o[i].window_phs &= OSCBNK_PHSMSK;
+        o[i].grain_phs = nxt[i].grain_phs;
+        o[i].grain_frq_int = nxt[i].grain_frq_int;
+        if (f_nolock) o[i].grain_frq_flt = nxt[i].grain_frq_flt;
+        grain2_render(aout, at[i] + 1, n1, o + i, w_frq, ft, mask, lobits,
+                      pfrac, g_interp, w_ft, w_mask, w_lobits, w_pfrac,
+                      w_interp);
+      }
     }
     return OK;
  err1:
@@ -844,7 +901,7 @@ static int grain3(CSOUND *csound, GRAIN3 *p)
     int           i, w_interp, g_interp, f_nolock;
     MYFLT         *aout0, *aout, *ft, *w_ft, frq_scl, pfrac, w_pfrac, f, a, k;
     MYFLT         wfdivxf, w_frq_f, x_frq_f;
-    uint32        n, mask, lobits, w_mask, w_lobits;
+    uint32        n, m, mask, lobits, w_mask, w_lobits;
     uint32        *phs, frq, x_ph, x_frq, g_ph, g_frq, w_ph, w_frq;
     GRAIN2_OSC    *o;
     FUNC          *ftp;
@@ -972,7 +1029,11 @@ static int grain3(CSOUND *csound, GRAIN3 *p)
       }
 
       if (o == p->osc_end) {            /* no active grains     */
-        x_ph += x_frq; nn--; aout0++; phs++; continue;
+        /* skip to the sample the next grain starts at */
+        m = nn - offset;
+        if (x_frq && (n = (OSCBNK_PHSMAX - 1UL - x_ph) / x_frq + 1UL) < m)
+          m = n;
+        x_ph += m * x_frq; nn -= m; aout0 += m; phs += m; continue;
       }
 
       g_ph = o->grain_phs;              /* grain phase          */
@@ -987,8 +1048,14 @@ static int grain3(CSOUND *csound, GRAIN3 *p)
       }
       w_ph = o->window_phs;             /* window phase         */
 
-      /* render grain */
-      aout = aout0; i = nn;
+      /* render grain, up to the sample it ends at */
+      m = nn;
+      if (w_frq && (n = (OSCBNK_PHSMAX - 1UL - w_ph) / w_frq + 1UL) <= m) {
+        m = n;
+        if (++(p->osc_start) > p->osc_max)
+          p->osc_start = p->osc;
+      }
+      aout = aout0; i = (int) m;
       while (i--) {
         /* window waveform */
         n = w_ph >> w_lobits; a = w_ft[n++];
@@ -1002,12 +1069,7 @@ static int grain3(CSOUND *csound, GRAIN3 *p)
         *(aout++) += a * k;
         /* update phase */
         g_ph = (g_ph + g_frq) & OSCBNK_PHSMSK;
-        /* check for end of grain */
-        if ((w_ph += w_frq) >= OSCBNK_PHSMAX) {
-          if (++(p->osc_start) > p->osc_max)
-            p->osc_start = p->osc;
-          break;
-        }
+        w_ph += w_frq;
       }
       /* save phase */
       o->grain_phs = g_ph; o->window_phs = w_ph;
@@ -40,55 +40,50 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
     if (index > (unsigned)(to) || index < (unsigned)(from)) \
         index = (unsigned)(from);
 
-/* here follows routines for maintaining a linked list of grains */
+/* here follows routines for maintaining the pool of grains */
 
-/* initialises a linked list of NODEs */
+/* initialises the pool, all its grains free */
 static void init_pool(GRAINPOOL *s, unsigned max_grains)
 {
     unsigned i;
-    NODE **p = &s->grainlist;
-    NODE *grainpool = (NODE *)s->mempool;
 
     s->free_nodes = max_grains;
-    /* build list of grains in pool */
-    for (i = 0; i < max_grains; ++i) {
-        NODE *node;
-        *p = grainpool + i;
-        node = *p;
-        node->next = NULL;
-        p = &(node->next);
-    }
+    s->active = 0;
+    /* free grains are taken from the end of the list */
+    for (i = 0; i < max_grains; ++i)
+        s->freelist[i] = max_grains - 1 - i;
 }
 
-/* returns pointer to new node */
-static NODE *get_grain(GRAINPOOL *s)
+/* returns index of a free grain */
+static unsigned get_grain(GRAINPOOL *s)
 {
-    NODE *ret = s->grainlist;
-
-    if (s->grainlist)
-        s->grainlist = s->grainlist->next;
-    s->free_nodes--;
-    return ret;
+    return s->freelist[--s->free_nodes];
 }
 
-/* returns a NODE to the pool. function returns pointer to next node */
-static NODE *return_grain(GRAINPOOL *s, NODE *c)
+/* returns a grain to the pool */
+static void return_grain(GRAINPOOL *s, unsigned slot)
 {
-    NODE *oldnext = c->next;
+    s->freelist[s->free_nodes++] = slot;
+}
 
-    c->next = s->grainlist;
-    s->grainlist = c;
-    s->free_nodes++;
-    return oldnext;
+/* puts a grain into play, as the newest */
+static void add_grain(GRAINPOOL *s, unsigned slot, unsigned start,
+                      unsigned stop)
+{
+    s->slot[s->active] = slot;
+    s->start[s->active] = start;
+    s->stop[s->active] = stop;
+    s->active++;
 }
 
 /* return oldest grain to the pool, we use this when we're out of grains */
-static void kill_oldest_grain(GRAINPOOL *s, NODE *n)
+static void kill_oldest_grain(GRAINPOOL *s)
 {
-    while (n->next->next)
-        n = n->next;
-    return_grain(s, n->next);
-    n->next = NULL;
+    return_grain(s, s->slot[0]);
+    s->active--;
+    memmove(s->slot, s->slot + 1, s->active*sizeof(unsigned));
+    memmove(s->start, s->start + 1, s->active*sizeof(unsigned));
+    memmove(s->stop, s->stop + 1, s->active*sizeof(unsigned));
 }
 
 static int setup_globals(CSOUND *csound, PARTIKKEL *p)
@@ -220,12 +215,12 @@ static inline MYFLT dsf(FUNC *tab, GRAIN *grain, double beta, MYFLT zscale,
 static int partikkel_init(CSOUND *csound, PARTIKKEL *p)
 {
     uint32_t size;
+    unsigned max_grains;
     int ret;
 
     if ((ret = setup_globals(csound, p)) != OK)
         return ret;
 
-    p->grainroot = NULL;
     /* set grainphase to 1.0 to make grain scheduler create a grain immediately
      * after starting opcode */
     p->grainphase = 1.0;
@@ -303,22 +298,34 @@ static int partikkel_init(CSOUND *csound, PARTIKKEL *p)
     p->synced = 0;
     p->graininc = 0.0;
 
-    /* allocate memory for the grain mix buffer */
-    size = CS_KSMPS*sizeof(MYFLT);
+    /* allocate memory for the grain mix buffer and the scratch after it,
+     * the buffer given the room of doubles to keep the ones after aligned */
+    size = CS_KSMPS*(10*sizeof(double) + sizeof(unsigned));
     if (p->aux.auxp == NULL || p->aux.size < size)
         csound->AuxAlloc(csound, size, &p->aux);
     else
       memset(p->aux.auxp, 0, size);
+    p->wavphs = (double *)p->aux.auxp + CS_KSMPS;
+    p->envphs = p->wavphs + 5*CS_KSMPS;
+    p->trigphase = p->envphs + CS_KSMPS;
+    p->triginc = p->trigphase + CS_KSMPS;
+    p->trigfreq = p->triginc + CS_KSMPS;
+    p->trigsmps = (unsigned *)(p->trigfreq + CS_KSMPS);
 
     /* allocate memory for the grain pool and initialize it*/
     if (UNLIKELY(*p->max_grains < FL(1.0)))
         return INITERROR("maximum number of grains needs to be non-zero "
                          "and positive");
-    size = ((unsigned)*p->max_grains)*sizeof(NODE);
+    max_grains = (unsigned)*p->max_grains;
+    size = max_grains*(sizeof(GRAIN) + 4*sizeof(unsigned));
     if (p->aux2.auxp == NULL || p->aux2.size < size)
         csound->AuxAlloc(csound, size, &p->aux2);
-    p->gpool.mempool = p->aux2.auxp;
-    init_pool(&p->gpool, (unsigned)*p->max_grains);
+    p->gpool.grains = (GRAIN *)p->aux2.auxp;
+    p->gpool.freelist = (unsigned *)(p->gpool.grains + max_grains);
+    p->gpool.slot = p->gpool.freelist + max_grains;
+    p->gpool.start = p->gpool.slot + max_grains;
+    p->gpool.stop = p->gpool.start + max_grains;
+    init_pool(&p->gpool, max_grains);
 
     /* find out which of the xrate parameters are arate */
     p->grainfreq_arate = IS_ASIG_ARG(p->grainfreq) ? 1 : 0;
@@ -327,15 +334,18 @@ static int partikkel_init(CSOUND *csound, PARTIKKEL *p)
     return OK;
 }
 
-/* n is sample number for which the grain is to be scheduled
- * offset is time offset for grain in seconds, passed separately for hints */
-static int schedule_grain(CSOUND *csound, PARTIKKEL *p, NODE *node, int32 n,
-                          double offset)
+/* slot is the free grain to use
+ * n is sample number for which the grain is to be scheduled
+ * offset is time offset for grain in seconds, passed separately for hints
+ * grainphase and graininc are those of the grain clock at sample n */
+static int schedule_grain(CSOUND *csound, PARTIKKEL *p, unsigned slot,
+                          int32 n, double offset, double grainphase,
+                          double graininc)
 {
     /* make a new grain */
     MYFLT startfreqscale, endfreqscale;
     MYFLT maskgain, maskchannel;
-    GRAIN *grain = &node->grain;
+    GRAIN *grain = &p->gpool.grains[slot];
     unsigned int i;
     unsigned int chan;
     MYFLT graingain;
@@ -384,7 +394,7 @@ static int schedule_grain(CSOUND *csound, PARTIKKEL *p, NODE *node, int32 n,
     if ((fabs(graingain) < FL(1e-8)) || (frand() > 1.0 - *p->randommask)) {
         /* grain is either masked out or has a zero amplitude, so we cancel it
          * and proceed with scheduling our next grain */
-        return_grain(&p->gpool, node);
+        return_grain(&p->gpool, slot);
         return OK;
     }
 
@@ -396,7 +406,7 @@ static int schedule_grain(CSOUND *csound, PARTIKKEL *p, NODE *node, int32 n,
     /* place a grain in between two channels according to channel mask value */
     chan = (unsigned)maskchannel;
     if (UNLIKELY(chan >= p->num_outputs)) {
-        return_grain(&p->gpool, node);
+        return_grain(&p->gpool, slot);
         return PERFERROR("channel mask specifies non-existing output channel");
     }
     /* use panning law table if specified */
@@ -419,7 +429,7 @@ static int schedule_grain(CSOUND *csound, PARTIKKEL *p, NODE *node, int32 n,
     const double dur_samples = CS_ESR*(*p->duration)/1000.0;
     /* if grainlength is below one sample, we'll just cancel it */
     if (dur_samples < 1.0) {
-        return_grain(&p->gpool, node);
+        return_grain(&p->gpool, slot);
         return OK;
     }
     /* the grain is supposed to start at grainphase = 0, so calculate how far
@@ -428,12 +438,12 @@ static int schedule_grain(CSOUND *csound, PARTIKKEL *p, NODE *node, int32 n,
      * are probably not very synchronous, and will not benefit from this.
      * also only enable it for sufficiently high grain rates. current
      * threshold corresponds to around 150hz */
-    const double phase_corr = offset == 0.0 && p->graininc > 0.0032
-                            ? p->grainphase/p->graininc
+    const double phase_corr = offset == 0.0 && graininc > 0.0032
+                            ? grainphase/graininc
                             : 0.0;
     const double rcp_samples = 1.0/dur_samples;
-    grain->start = (unsigned)((double)n + offset*CS_ESR + phase_corr);
-    grain->stop = (unsigned)(grain->start + dur_samples - phase_corr) + 1;
+    const unsigned start = (unsigned)((double)n + offset*CS_ESR + phase_corr);
+    const unsigned stop = (unsigned)(start + dur_samples - phase_corr) + 1;
     /* set up the four wavetables and dsf to use in the grain */
     for (i = 0; i < 5; ++i) {
         WAVEDATA *curwav = &grain->wav[i];
@@ -536,19 +546,20 @@ static int schedule_grain(CSOUND *csound, PARTIKKEL *p, NODE *node, int32 n,
 
     grain->envinc = rcp_samples;
     grain->envphase = phase_corr*grain->envinc;
-    /* link new grain into the list */
-    node->next = p->grainroot;
-    p->grainroot = node;
+    /* put the new grain into play */
+    add_grain(&p->gpool, slot, start, stop);
     return OK;
 }
 
-/* this function schedules the grains that are bound to happen this k-period */
+/* this function schedules the grains that are bound to happen this k-period.
+ * a first pass runs the grain clock through the k-period and notes the
+ * samples at which it triggers grains, a second sets those grains up */
 static int schedule_grains(CSOUND *csound, PARTIKKEL *p)
 {
     uint32_t koffset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t n, nsmps = CS_KSMPS;
-    NODE *node;
+    unsigned t, triggers = 0;
     MYFLT **waveformparams = &p->waveform1;
     MYFLT grainfreq = fabs(*p->grainfreq);
 
@@ -568,7 +579,7 @@ static int schedule_grains(CSOUND *csound, PARTIKKEL *p)
         return PERFERROR("unable to load FM envelope table");
 
     if (UNLIKELY(early)) nsmps -= early;
-    /* start grain scheduling */
+    /* run the grain clock */
     for (n = koffset; n < nsmps; ++n) {
         if (p->sync[n] >= FL(1.0)) {
             /* we got a full sync pulse, hardsync grain clock if needed */
@@ -592,53 +603,15 @@ static int schedule_grains(CSOUND *csound, PARTIKKEL *p)
         }
 
         if (p->grainphase >= 1.0) {
-            double offset;
-
             do
                 p->grainphase -= 1.0;
             while (UNLIKELY(p->grainphase >= 1.0));
-            /* schedule new synchronous or synced grain */
-            /* first determine time offset for grain */
-            if (*p->distribution >= FL(0.0)) {
-                /* positive distrib, choose random point in table */
-                unsigned rnd = csound->RandMT(&p->randstate);
-                offset = p->disttab->ftable[rnd >> p->disttabshift];
-                offset *= *p->distribution;
-            } else {
-                /* negative distrib, choose sequential point in table */
-                offset = p->disttab->ftable[p->distindex++];
-                offset *= -*p->distribution;
-                if ((uint32_t)p->distindex >= p->disttab->flen)
-                    p->distindex = 0;
-            }
-            /* convert offset to seconds, also limiting it to 10 seconds to
-             * avoid accidentally filling grain pool with grains which will
-             * spawn in half a day */
-            if (grainfreq < FL(0.001)) {
-                /* avoid div by zero */
-                offset = 0;
-            } else {
-                offset /= grainfreq;
-                if (offset > 10.0) offset = 10.0;
-            }
-            /* check if there are any grains left in the pool */
-            if (!p->gpool.free_nodes) {
-                if (!p->out_of_voices_warning) {
-                    WARNING("maximum number of grains reached");
-                    p->out_of_voices_warning = 1; /* we only warn once */
-                }
-                kill_oldest_grain(&p->gpool, p->grainroot);
-            }
-            /* add a new grain */
-            node = get_grain(&p->gpool);
-            /* check first, in case we'll change the above behaviour of
-             * killing a grain */
-            if (node) {
-                int ret = schedule_grain(csound, p, node, n, offset);
-
-                if (ret != OK)
-                    return ret;
-            }
+            /* note a new synchronous or synced grain */
+            p->trigsmps[triggers] = n;
+            p->trigphase[triggers] = p->grainphase;
+            p->triginc[triggers] = p->graininc;
+            p->trigfreq[triggers] = grainfreq;
+            triggers++;
             /* create a sync pulse for use in partikkelsync */
             if (p->globals_entry)
                 p->globals_entry->synctab[n] = FL(1.0);
@@ -653,146 +626,253 @@ static int schedule_grains(CSOUND *csound, PARTIKKEL *p)
         p->graininc = grainfreq*csound->onedsr;
         p->grainphase += p->graininc;
     }
+
+    /* schedule the grains */
+    for (t = 0; t < triggers; ++t) {
+        double offset;
+        unsigned slot;
+        int ret;
+
+        /* first determine time offset for grain */
+        if (*p->distribution >= FL(0.0)) {
+            /* positive distrib, choose random point in table */
+            unsigned rnd = csound->RandMT(&p->randstate);
+            offset = p->disttab->ftable[rnd >> p->disttabshift];
+            offset *= *p->distribution;
+        } else {
+            /* negative distrib, choose sequential point in table */
+            offset = p->disttab->ftable[p->distindex++];
+            offset *= -*p->distribution;
+            if ((uint32_t)p->distindex >= p->disttab->flen)
+                p->distindex = 0;
+        }
+        /* convert offset to seconds, also limiting it to 10 seconds to
+         * avoid accidentally filling grain pool with grains which will
+         * spawn in half a day */
+        if (p->trigfreq[t] < FL(0.001)) {
+            /* avoid div by zero */
+            offset = 0;
+        } else {
+            offset /= p->trigfreq[t];
+            if (offset > 10.0) offset = 10.0;
+        }
+        /* check if there are any grains left in the pool */
+        if (!p->gpool.free_nodes) {
+            if (!p->out_of_voices_warning) {
+                WARNING("maximum number of grains reached");
+                p->out_of_voices_warning = 1; /* we only warn once */
+            }
+            kill_oldest_grain(&p->gpool);
+        }
+        /* add a new grain */
+        slot = get_grain(&p->gpool);
+        ret = schedule_grain(csound, p, slot, p->trigsmps[t], offset,
+                             p->trigphase[t], p->triginc[t]);
+        if (ret != OK)
+            return ret;
+    }
     return OK;
 }
 
 /* Main synthesis loops */
+/* everything about a grain that is summed sample by sample, its fm
+ * envelope, the phases of its waves and of its envelopes, is worked out
+ * first, all in one loop so that the sums overlap rather than wait on one
+ * another. the samples are then looked up from the phases, and the
+ * envelopes applied, in loops that carry nothing from one sample to the
+ * next. wave phases go to p->wavphs, envelope phases to p->envphs; past
+ * the end of the envelope the phase is clamped, which is noted by a phase
+ * of -1 */
+static inline void grain_phases(PARTIKKEL *p, GRAIN *grain, const MYFLT *fm,
+                                unsigned nsmps)
+{
+    unsigned n, i, w, nwaves = 0;
+    const FUNC *fmenvtab = grain->fmenvtab;
+    const MYFLT fmamp = grain->fmamp;
+    const double attacklen = grain->envattacklen;
+    const double decaystart = grain->envdecaystart;
+    const double envinc = grain->envinc;
+    double fmenvphase = grain->envphase, envphase = grain->envphase;
+    double *envphs = p->envphs;
+    double phase[5], delta[5], tablen[5], sweepdecay[5], sweepoffset[5];
+    double *phs[5];
+
+    for (i = 0; i < 5; ++i) {
+        WAVEDATA *wav = &grain->wav[i];
+
+        if (wav->table == NULL)
+            continue;
+        phase[nwaves] = wav->phase;
+        delta[nwaves] = wav->delta;
+        /* trainlet phase is in the range 0..1 */
+        tablen[nwaves] = i != WAV_TRAINLET ? (double)wav->table->flen : 1.0;
+        sweepdecay[nwaves] = wav->sweepdecay;
+        sweepoffset[nwaves] = wav->sweepoffset;
+        phs[nwaves] = p->wavphs + i*CS_KSMPS;
+        nwaves++;
+    }
+    for (n = 0; n < nsmps; ++n) {
+        MYFLT fmenv = fmenvtab->ftable[(size_t)(fmenvphase*FMAXLEN)
+                                       >> fmenvtab->lobits];
+
+        fmenvphase += envinc;
+        for (w = 0; w < nwaves; ++w) {
+            double ph = phase[w];
+
+            /* make sure phase accumulator stays within bounds */
+            while (UNLIKELY(ph >= tablen[w]))
+                ph -= tablen[w];
+            while (UNLIKELY(ph < 0.0))
+                ph += tablen[w];
+            phs[w][n] = ph;
+            phase[w] = ph + (delta[w] + delta[w]*fm[n]*fmamp*fmenv);
+            /* apply sweep */
+            delta[w] = delta[w]*sweepdecay[w] + sweepoffset[w];
+        }
+        if (envphase < attacklen || envphase < decaystart ||
+            envphase < 1.0) {
+            envphs[n] = envphase;
+        } else {
+            /* clamp envelope phase because of round-off errors */
+            envphs[n] = -1.0;
+            envphase = 1.0;
+        }
+        envphase += envinc;
+    }
+    for (i = 0, w = 0; i < 5; ++i) {
+        if (grain->wav[i].table == NULL)
+            continue;
+        grain->wav[i].phase = phase[w];
+        grain->wav[i].delta = delta[w];
+        w++;
+    }
+    grain->envphase = envphase;
+}
+
 /* NOTE: the main synthesis loop is duplicated for both wavetable and
  * trainlet synthesis for speed */
-static inline void render_wave(PARTIKKEL *p, GRAIN *grain, WAVEDATA *wav,
-                               MYFLT *buf, unsigned stop)
+static inline void render_wave(WAVEDATA *wav, const double *phs, MYFLT *buf,
+                               unsigned nsmps)
 {
     unsigned n;
-    double fmenvphase = grain->envphase;
+    const MYFLT *ftable = wav->table->ftable;
+    const MYFLT gain = wav->gain;
 
     /* wavetable synthesis */
-    for (n = grain->start; n < stop; ++n) {
-        double tablen = (double)wav->table->flen;
-        unsigned x0;
-        MYFLT frac, fmenv;
-
-        /* make sure phase accumulator stays within bounds */
-        while (UNLIKELY(wav->phase >= tablen))
-            wav->phase -= tablen;
-        while (UNLIKELY(wav->phase < 0.0))
-            wav->phase += tablen;
-
+    for (n = 0; n < nsmps; ++n) {
         /* sample table lookup with linear interpolation */
-        x0 = (unsigned)wav->phase;
-        frac = (MYFLT)(wav->phase - x0);
-        buf[n] += lrp(wav->table->ftable[x0], wav->table->ftable[x0 + 1],
-                      frac)*wav->gain;
-
-        fmenv = grain->fmenvtab->ftable[(size_t)(fmenvphase*FMAXLEN)
-                                        >> grain->fmenvtab->lobits];
-        fmenvphase += grain->envinc;
-        wav->phase += wav->delta + wav->delta*p->fm[n]*grain->fmamp*fmenv;
-        /* apply sweep */
-        wav->delta = wav->delta*wav->sweepdecay + wav->sweepoffset;
-     }
+        unsigned x0 = (unsigned)phs[n];
+        MYFLT frac = (MYFLT)(phs[n] - x0);
+        buf[n] += lrp(ftable[x0], ftable[x0 + 1], frac)*gain;
+    }
 }
 
 static inline void render_trainlet(PARTIKKEL *p, GRAIN *grain, WAVEDATA *wav,
-                                   MYFLT *buf, unsigned stop)
+                                   const double *phs, MYFLT *buf,
+                                   unsigned nsmps)
 {
     unsigned n;
-    double fmenvphase = grain->envphase;
-
-    /* trainlet synthesis */
-    for (n = grain->start; n < stop; ++n) {
-        MYFLT fmenv;
-
-        while (UNLIKELY(wav->phase >= 1.0))
-            wav->phase -= 1.0;
-        while (UNLIKELY(wav->phase < 0.0))
-            wav->phase += 1.0;
-
-        /* dsf/trainlet synthesis */
-        buf[n] += wav->gain*dsf(p->costab, grain, wav->phase, p->zscale,
-                                p->cosineshift);
-
-        fmenv = grain->fmenvtab->ftable[(size_t)(fmenvphase*FMAXLEN)
-                                        >> grain->fmenvtab->lobits];
-        fmenvphase += grain->envinc;
-        wav->phase += wav->delta + wav->delta*p->fm[n]*grain->fmamp*fmenv;
-        wav->delta = wav->delta*wav->sweepdecay + wav->sweepoffset;
-    }
+    const MYFLT gain = wav->gain;
+
+    /* dsf/trainlet synthesis */
+    for (n = 0; n < nsmps; ++n)
+        buf[n] += gain*dsf(p->costab, grain, phs[n], p->zscale,
+                           p->cosineshift);
 }
 
-/* do the actual waveform synthesis */
-static inline void render_grain(CSOUND *csound, PARTIKKEL *p, GRAIN *grain)
+/* do the actual waveform synthesis of the samples start to stop of this
+ * k-period */
+static inline void render_grain(CSOUND *csound, PARTIKKEL *p, GRAIN *grain,
+                                unsigned start, unsigned stop)
 {
     int i;
-    unsigned n;
-    MYFLT *out1 = *(&(p->output1) + grain->chan1);
-    MYFLT *out2 = *(&(p->output1) + grain->chan2);
-    unsigned stop = grain->stop > CS_KSMPS
-                    ? CS_KSMPS : grain->stop;
-    MYFLT *buf = (MYFLT *)p->aux.auxp;
-
-    if (grain->start >= CS_KSMPS)
+    unsigned n, nsmps;
+    MYFLT *out1 = *(&(p->output1) + grain->chan1) + start;
+    MYFLT *out2 = *(&(p->output1) + grain->chan2) + start;
+    MYFLT *buf = (MYFLT *)p->aux.auxp + start;
+    const double *envphs = p->envphs;
+    /* the wave phases are done with by the time the envelopes are applied,
+     * so that their room serves for the table indices and values of the
+     * envelopes */
+    int32 *envidx = (int32 *)p->wavphs, *env2idx = envidx + CS_KSMPS;
+    int32 *envsel = env2idx + CS_KSMPS;
+    MYFLT *env = (MYFLT *)(p->wavphs + 2*CS_KSMPS), *env2 = env + CS_KSMPS;
+    const MYFLT *atttab = p->env_attack_tab->ftable;
+    const MYFLT *dectab = p->env_decay_tab->ftable;
+    const MYFLT *env2tab = p->env2_tab->ftable;
+    /* table phase*FMAXLEN >> lobits, as phase*FMAXLEN/2^lobits truncated,
+     * which is the same for phases from 0 to 1 and vectorises */
+    const double attscale = ldexp(FMAXLEN, -p->env_attack_tab->lobits);
+    const double decscale = ldexp(FMAXLEN, -p->env_decay_tab->lobits);
+    const double env2scale = ldexp(FMAXLEN, -p->env2_tab->lobits);
+    const double attacklen = grain->envattacklen;
+    const double decaystart = grain->envdecaystart;
+    const double env2amount = grain->env2amount;
+    const MYFLT gain1 = grain->gain1, gain2 = grain->gain2;
+
+    if (start >= CS_KSMPS)
         return; /* grain starts at a later kperiod */
+    if (stop > CS_KSMPS)
+        stop = CS_KSMPS;
+    nsmps = stop - start;
+
+    grain_phases(p, grain, p->fm + start, nsmps);
     for (i = 0; i < 5; ++i) {
         WAVEDATA *curwav = &grain->wav[i];
+        const double *phs = p->wavphs + i*CS_KSMPS;
 
         /* check if ftable is to be rendered */
         if (curwav->table == NULL)
             continue;
 
         if (i != WAV_TRAINLET)
-            render_wave(p, grain, curwav, buf, stop);
+            render_wave(curwav, phs, buf, nsmps);
         else
-            render_trainlet(p, grain, curwav, buf, stop);
+            render_trainlet(p, grain, curwav, phs, buf, nsmps);
     }
 
-    /* apply envelopes */
-    for (n = grain->start; n < stop; ++n) {
-        MYFLT env, env2, output;
-        double envphase;
-        FUNC *envtable;
-
-        /* apply envelopes */
-        if (grain->envphase < grain->envattacklen) {
-            envtable = p->env_attack_tab;
-            envphase = grain->envphase/grain->envattacklen;
-        } else if (grain->envphase < grain->envdecaystart) {
-            /* for sustain, use last sample in attack table */
-            envtable = p->env_attack_tab;
-            envphase = 1.0;
-        } else if (grain->envphase < 1.0) {
-            envtable = p->env_decay_tab;
-            envphase = (grain->envphase - grain->envdecaystart)/(1.0 -
-                       grain->envdecaystart);
-        } else {
-            /* clamp envelope phase because of round-off errors */
-            envtable = grain->envdecaystart < 1.0 ?
-                       p->env_decay_tab : p->env_attack_tab;
-            envphase = grain->envphase = 1.0;
-        }
-
-        /* fetch envelope values */
-        env = envtable->ftable[(size_t)(envphase*FMAXLEN)
-                                >> envtable->lobits];
-        env2 = p->env2_tab->ftable[(size_t)(grain->envphase*FMAXLEN)
-                                   >> p->env2_tab->lobits];
-        env2 = FL(1.0) - grain->env2amount + grain->env2amount*env2;
-        grain->envphase += grain->envinc;
+    /* apply envelopes. first the tables and their indices */
+    for (n = 0; n < nsmps; ++n) {
+        double phase = envphs[n];
+        const int clamped = phase < 0.0;
+        const int attack = !clamped && phase < attacklen;
+        /* for sustain, use last sample in attack table */
+        const int sustain = !clamped && !attack && phase < decaystart;
+        const int decay = clamped ? decaystart < 1.0 : !attack && !sustain;
+        const double tabphase = attack ? phase/attacklen
+                                : decay && !clamped
+                                  ? (phase - decaystart)/(1.0 - decaystart)
+                                  : 1.0;
+
+        phase = clamped ? 1.0 : phase;
+        envsel[n] = decay;
+        envidx[n] = (int32)(tabphase*(decay ? decscale : attscale));
+        env2idx[n] = (int32)(phase*env2scale);
+    }
+    /* fetch envelope values */
+    for (n = 0; n < nsmps; ++n) {
+        env[n] = envsel[n] ? dectab[envidx[n]] : atttab[envidx[n]];
+        env2[n] = env2tab[env2idx[n]];
+    }
+    for (n = 0; n < nsmps; ++n) {
+        MYFLT e2 = FL(1.0) - env2amount + env2amount*env2[n];
         /* generate grain output sample */
-        output = buf[n]*env*env2;
+        MYFLT output = buf[n]*env[n]*e2;
+
         /* now distribute this grain to the output channels it's supposed to
          * end up in, as decided by the channel mask */
-        out1[n] += output*grain->gain1;
-        out2[n] += output*grain->gain2;
+        out1[n] += output*gain1;
+        out2[n] += output*gain2;
     }
     /* now clear the area we just worked in */
-    memset(buf + grain->start, 0, (stop - grain->start)*sizeof(MYFLT));
+    memset(buf, 0, nsmps*sizeof(MYFLT));
 }
 
 static int partikkel(CSOUND *csound, PARTIKKEL *p)
 {
     int ret;
-    unsigned int n;
-    NODE **nodeptr;
+    unsigned int i, j, n;
+    GRAINPOOL *s = &p->gpool;
     MYFLT **outputs = &p->output1;
 
     if (UNLIKELY(p->aux.auxp == NULL || p->aux2.auxp == NULL))
@@ -805,27 +885,25 @@ static int partikkel(CSOUND *csound, PARTIKKEL *p)
     for (n = 0; n < p->num_outputs; ++n)
         memset(outputs[n], 0, sizeof(MYFLT)*CS_KSMPS);
 
-    /* prepare to traverse grain list */
-    nodeptr = &p->grainroot;
-    while (*nodeptr) {
-        GRAIN *grain = &((*nodeptr)->grain);
-
-        /* render current grain to outputs */
-        render_grain(csound, p, grain);
-        /* check if grain is finished */
-        if (grain->stop <= CS_KSMPS) {
-            /* grain is finished, deactivate it */
-            *nodeptr = return_grain(&p->gpool, *nodeptr);
+    /* render grains to outputs, newest first */
+    for (i = s->active; i-- > 0; )
+        render_grain(csound, p, &s->grains[s->slot[i]], s->start[i],
+                     s->stop[i]);
+
+    /* deactivate finished grains, and extend the lifetime of the others
+     * with one k-period */
+    for (i = j = 0; i < s->active; ++i) {
+        if (s->stop[i] <= CS_KSMPS) {
+            return_grain(s, s->slot[i]);
         } else {
-            /* extend grain lifetime with one k-period and find next grain */
-            if (CS_KSMPS > grain->start)
-                grain->start = 0; /* grain is active */
-            else
-                grain->start -= CS_KSMPS; /* grain is not yet active */
-            grain->stop -= CS_KSMPS;
-            nodeptr = &((*nodeptr)->next);
+            s->slot[j] = s->slot[i];
+            /* grain is active, or not yet */
+            s->start[j] = CS_KSMPS > s->start[i] ? 0 : s->start[i] - CS_KSMPS;
+            s->stop[j] = s->stop[i] - CS_KSMPS;
+            ++j;
         }
     }
+    s->active = j;
     return OK;
 }
 
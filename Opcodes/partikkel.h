@@ -29,7 +29,6 @@ typedef struct {
 } WAVEDATA;
 
 typedef struct {
-    unsigned start, stop;
     double envphase, envinc;
     double envattacklen, envdecaystart;
     double env2amount;
@@ -45,16 +44,16 @@ typedef struct {
 /* which of the wav[] entries above correspond to the trainlet generator */
 #define WAV_TRAINLET 4
 
-/* support structs for the grain pool routines */
-typedef struct NODE {
-    GRAIN grain;
-    struct NODE *next;
-} NODE;
-
+/* support struct for the grain pool routines. the grains in play are kept
+ * oldest first in dense arrays, one per field that every k-period goes
+ * through, rather than in a list that has to be walked */
 typedef struct {
-    NODE *grainlist;
-    char *mempool;
+    GRAIN *grains;          /* storage for max_grains grains */
+    unsigned *freelist;     /* indices into grains[] of the free ones */
     unsigned free_nodes;
+    unsigned active;        /* number of grains in play */
+    unsigned *slot;         /* index into grains[] of each grain in play */
+    unsigned *start, *stop; /* sample of this k-period it starts, stops at */
 } GRAINPOOL;
 
 struct PARTIKKEL;
@@ -122,12 +121,18 @@ typedef struct PARTIKKEL {
     PARTIKKEL_GLOBALS *globals;
     PARTIKKEL_GLOBALS_ENTRY *globals_entry;
     GRAINPOOL gpool;
-    NODE *grainroot;
     int out_of_voices_warning;
     unsigned num_outputs;
     int grainfreq_arate;
     int synced;
     AUXCH aux, aux2;
+    /* per k-period scratch in aux, after the grain mix buffer: the phases
+     * of the waves and of the envelopes of a grain, sample by sample, and
+     * the samples at which grains are triggered with the state of the
+     * grain clock there */
+    double *wavphs, *envphs;
+    unsigned *trigsmps;
+    double *trigphase, *triginc, *trigfreq;
     CsoundRandMTState randstate;
     FUNC *wavetabs[4];
     FUNC *costab;
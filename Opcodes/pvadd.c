@@ -31,7 +31,8 @@
 #include "pvoc.h"
 #include <math.h>
 
-static int pvx_loadfile(CSOUND *csound, const char *fname, PVADD *p);
+static int pvx_loadfile(CSOUND *csound, const char *fname, PVADD *p,
+                        int stream);
 
 /* This is used in pvadd instead of the Fetch() from dsputil.c */
 void FetchInForAdd(float *inp, MYFLT *buf, int32 fsize,
@@ -87,7 +88,10 @@ int pvaddset_(CSOUND *csound, PVADD *p, int stringname)
     }
     else strncpy(pvfilnam, ((STRINGDAT *)p->ifilno)->data, MAXNAME-1);
 
-    if (UNLIKELY(pvx_loadfile(csound, pvfilnam, p) != OK))
+    /* spectral extraction and gating need the whole file, else stream it */
+    if (UNLIKELY(pvx_loadfile(csound, pvfilnam, p,
+                              !(*p->imode == 1 || *p->imode == 2 ||
+                                *p->igatefun > 0)) != OK))
       return NOTOK;
 
     memsize = (int32) (MAXBINS + PVFFTSIZE + PVFFTSIZE);
@@ -159,8 +163,15 @@ int pvadd(CSOUND *csound, PVADD *p)
         csound->Warning(csound, Str("PVADD ktimpnt truncated to last frame"));
       }
     }
-    FetchInForAdd(p->frPtr, p->buf, size, frIndx,
-                  (int) *p->ibinoffset, p->maxbin, binincr);
+    if (p->stream != NULL) {
+      int32 base = (int32) frIndx;
+      FetchInForAdd(csound->PVOCEX_StreamFrame(csound, p->stream, base),
+                    p->buf, size, frIndx - (MYFLT) base,
+                    (int) *p->ibinoffset, p->maxbin, binincr);
+    }
+    else
+      FetchInForAdd(p->frPtr, p->buf, size, frIndx,
+                    (int) *p->ibinoffset, p->maxbin, binincr);
 
     if (*p->igatefun > 0)
       PvAmpGate(p->buf, p->maxbin*2, p->AmpGateFunc, p->PvMaxAmp);
@@ -209,11 +220,29 @@ int pvaddset_S(CSOUND *csound, PVADD *p){
 }
 
 
-static int pvx_loadfile(CSOUND *csound, const char *fname, PVADD *p)
+static int pvx_stream_deinit(CSOUND *csound, void *p_)
+{
+    PVADD *p = (PVADD*) p_;
+
+    csound->PVOCEX_CloseStream(csound, p->stream);
+    p->stream = NULL;
+    return OK;
+}
+
+static int pvx_loadfile(CSOUND *csound, const char *fname, PVADD *p,
+                        int stream)
 {
     PVOCEX_MEMFILE  pp;
 
-    if (UNLIKELY(csound->PVOCEX_LoadFile(csound, fname, &pp) != 0)) {
+    if (p->stream != NULL)
+      pvx_stream_deinit(csound, p);
+    if (stream) {
+      if (UNLIKELY((p->stream = csound->PVOCEX_OpenStream(csound, fname,
+                                                          &pp)) == NULL))
+        return csound->InitError(csound, Str("PVADD cannot load %s"), fname);
+      csound->RegisterDeinitCallback(csound, p, pvx_stream_deinit);
+    }
+    else if (UNLIKELY(csound->PVOCEX_LoadFile(csound, fname, &pp) != 0)) {
       return csound->InitError(csound, Str("PVADD cannot load %s"), fname);
     }
     /* fft size must be <= PVFRAMSIZE (=8192) for Csound */
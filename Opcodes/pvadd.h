@@ -39,6 +39,7 @@ typedef struct {
     MYFLT   *oscphase, *buf, PvMaxAmp;
     MYFLT   frPrtim, asr;
     float   *frPtr, *pvcopy;
+    void    *stream;    /* PVOC-EX stream, if not loaded whole */
     int32   maxFr, frSiz, prFlg, mems;
     int     maxbin;
 } PVADD;
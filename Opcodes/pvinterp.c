@@ -239,6 +239,8 @@ int pvinterpset_(CSOUND *csound, PVINTERP *p, int stringname)
     /* for (i = 0; i< pvfrsiz(p); ++i) */
     /*   p->outBuf[i] = FL(0.0); */
     MakeSinc(p->pp);                    /* sinctab is same for all instances */
+    csound->RealFFT2Release(csound, p->setup);
+    p->setup = csound->RealFFT2Setup(csound, pvfrsiz(p), FFT_INV);
 
     return OK;
 }
@@ -303,7 +305,7 @@ int pvinterp(CSOUND *csound, PVINTERP *p)
     /* accumulate phase and wrap to range -PI to PI */
     RewrapPhase(buf, asize, p->lastPhase);
 
-    Polar2Real_PVOC(csound, buf, (int) size);
+    Polar2Real_PVOC(csound, buf, (int) size, p->setup);
 
     if (pex != FL(1.0))
       UDSample(p->pp, buf,
@@ -427,6 +429,8 @@ int pvcrossset_(CSOUND *csound, PVCROSS *p, int stringname)
     /* for (i = 0; i < pvfrsiz(p); ++i) */
     /*   p->outBuf[i] = FL(0.0); */
     MakeSinc(p->pp);                    /* sinctab is same for all instances */
+    csound->RealFFT2Release(csound, p->setup);
+    p->setup = csound->RealFFT2Setup(csound, pvfrsiz(p), FFT_INV);
     if (p->memenv.auxp == NULL || p->memenv.size < pvdasiz(p)*sizeof(MYFLT))
       csound->AuxAlloc(csound, pvdasiz(p) * sizeof(MYFLT), &p->memenv);
     return OK;
@@ -500,7 +504,7 @@ int pvcross(CSOUND *csound, PVCROSS *p)
       if (specwp > 0)
         PreWarpSpec(buf, asize, pex, (MYFLT *)p->memenv.auxp);
 
-      Polar2Real_PVOC(csound, buf, (int) size);
+      Polar2Real_PVOC(csound, buf, (int) size, p->setup);
 
       if (pex != FL(1.0))
         UDSample(p->pp, buf,
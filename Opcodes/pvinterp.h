@@ -55,6 +55,7 @@ typedef struct {
     MYFLT   *window;    /* [PVWINLEN]   Store 1/2 window */
     PVBUFREAD *pvbufread;
     PVOC_GLOBALS  *pp;
+    void    *setup;     /* inverse FFT */
 
 } PVINTERP;
 
@@ -77,6 +78,7 @@ typedef struct {
     MYFLT   *window;    /* [PVWINLEN]   Store 1/2 window */
     PVBUFREAD *pvbufread;
     PVOC_GLOBALS  *pp;
+    void    *setup;     /* inverse FFT */
     AUXCH memenv;
 } PVCROSS;
 
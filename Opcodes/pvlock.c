@@ -113,7 +113,9 @@ static int sinit(CSOUND *csound, DATASPACE *p)
   p->N = N;
   p->decim = decim;
 
+  csound->RealFFT2Release(csound, p->fwdsetup);
   p->fwdsetup = csound->RealFFT2Setup(csound, N, FFT_FWD);
+  csound->RealFFT2Release(csound, p->invsetup);
   p->invsetup = csound->RealFFT2Setup(csound, N, FFT_INV);
 
   return OK;
@@ -109,7 +109,13 @@ int pvread(CSOUND *csound, PVREAD *p)
         csound->Warning(csound, Str("PVOC ktimpnt truncated to last frame"));
       }
     }
-    FetchInOne(p->frPtr, &(buf[0]), size, frIndx, p->mybin);
+    if (p->stream != NULL) {
+      int32 base = (int32) frIndx;
+      FetchInOne(csound->PVOCEX_StreamFrame(csound, p->stream, base),
+                 &(buf[0]), size, frIndx - (MYFLT) base, p->mybin);
+    }
+    else
+      FetchInOne(p->frPtr, &(buf[0]), size, frIndx, p->mybin);
     *p->kfreq = buf[1];
     *p->kamp = buf[0];
     return OK;
@@ -117,13 +123,27 @@ int pvread(CSOUND *csound, PVREAD *p)
     return csound->PerfError(csound, p->h.insdshead, Str("PVOC timpnt < 0"));
 }
 
+static int pvocex_stream_deinit(CSOUND *csound, void *p_)
+{
+    PVREAD *p = (PVREAD*) p_;
+
+    csound->PVOCEX_CloseStream(csound, p->stream);
+    p->stream = NULL;
+    return OK;
+}
+
 static int pvocex_loadfile(CSOUND *csound, const char *fname, PVREAD *p)
 {
     PVOCEX_MEMFILE  pp;
 
-    if (UNLIKELY(csound->PVOCEX_LoadFile(csound, fname, &pp) != 0)) {
+    if (p->stream != NULL)
+      pvocex_stream_deinit(csound, p);
+    /* only one bin per frame is read, so stream rather than load the file */
+    if (UNLIKELY((p->stream = csound->PVOCEX_OpenStream(csound, fname,
+                                                        &pp)) == NULL)) {
       return csound->InitError(csound, Str("PVREAD cannot load %s"), fname);
     }
+    csound->RegisterDeinitCallback(csound, p, pvocex_stream_deinit);
     /* have to reject m/c files for now, until opcodes upgraded */
     if (UNLIKELY(pp.chans > 1)) {
       return csound->InitError(csound, Str("pvoc-ex file %s is not mono"), fname);
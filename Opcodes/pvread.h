@@ -31,6 +31,7 @@ typedef struct {
     /* base Frame (in frameData0) and maximum frame on file, ptr to fr, size */
     MYFLT   frPrtim, asr;
     float   *frPtr;
+    void    *stream;    /* PVOC-EX stream */
     int32   mybin;
 } PVREAD;
 
@@ -545,6 +545,7 @@ int pvstanalset(CSOUND *csound, PVST *p)
   p->pos =  *p->offset*CS_ESR;
   //printf("off: %f\n", *p->offset);
   p->accum = 0.0;
+  csound->RealFFT2Release(csound, p->fwdsetup);
   p->fwdsetup = csound->RealFFT2Setup(csound,N,FFT_FWD);
   return OK;
 }
@@ -1390,7 +1391,9 @@ static int pvsscaleset(CSOUND *csound, PVSSCALE *p)
       p->fenv.size < sizeof(MYFLT) * (N+2))
     csound->AuxAlloc(csound, sizeof(MYFLT) * (N + 2), &p->fenv);
   memset(p->fenv.auxp, 0, sizeof(MYFLT)*(N+2));
+  csound->RealFFT2Release(csound, p->fwdsetup);
   p->fwdsetup = csound->RealFFT2Setup(csound, N/2, FFT_FWD);
+  csound->RealFFT2Release(csound, p->invsetup);
   p->invsetup = csound->RealFFT2Setup(csound, N/2, FFT_INV);
   return OK;
 }
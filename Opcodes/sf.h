@@ -64,6 +64,7 @@ struct _instrType {
         char *name;
         BYTE splits_num;
         splitType *split;
+        int loaded;             /* splits filled in yet */
 } PACKED;
 typedef struct _instrType instrType;
 
@@ -91,6 +92,8 @@ struct _presetType {
         WORD bank;
         int layers_num;
         layerType *layer;
+        int sfndx;              /* SoundFont this preset belongs to */
+        int loaded;             /* layers filled in yet */
 } PACKED;
 typedef struct _presetType presetType;
 
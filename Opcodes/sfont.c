@@ -37,6 +37,7 @@
 #include <math.h>
 #include <ctype.h>
 #include <errno.h>
+#include <sys/stat.h>
 #include "sfenum.h"
 #include "sfont.h"
 
@@ -45,8 +46,10 @@
 
 
 static int chunk_read(CSOUND *, FILE *f, CHUNK *chunk);
+static int chunk_map(CSOUND *, FILE *f, CHUNK *chunk);
 static void fill_SfPointers(CSOUND *);
 static int  fill_SfStruct(CSOUND *);
+static void preset_free(CSOUND *, presetType *preset);
 static void layerDefaults(layerType *layer);
 static void splitDefaults(splitType *split);
 
@@ -67,6 +70,9 @@ typedef struct _sfontg {
   MYFLT pitches[128];
 } sfontg;
 
+static int preset_load(CSOUND *, sfontg *, presetType *preset);
+static int instr_load(CSOUND *, SFBANK *, instrType *instru);
+
 int sfont_ModuleDestroy(CSOUND *csound)
 {
     int j,k,l;
@@ -77,18 +83,17 @@ int sfont_ModuleDestroy(CSOUND *csound)
     sfArray = globals->sfArray;
 
     for (j=0; j<globals->currSFndx; j++) {
+      BYTE *data = sfArray[j].chunk.main_chunk.ckDATA;
       for (k=0; k< sfArray[j].presets_num; k++) {
-        for (l=0; l<sfArray[j].preset[k].layers_num; l++) {
-          csound->Free(csound, sfArray[j].preset[k].layer[l].split);
-        }
-        csound->Free(csound, sfArray[j].preset[k].layer);
+        preset_free(csound, &sfArray[j].preset[k]);
       }
       csound->Free(csound, sfArray[j].preset);
       for (l=0; l< sfArray[j].instrs_num; l++) {
         csound->Free(csound, sfArray[j].instr[l].split);
       }
       csound->Free(csound, sfArray[j].instr);
-      csound->Free(csound, sfArray[j].chunk.main_chunk.ckDATA);
+      if (data == NULL || !samplecache_unmap(csound, data - 8))
+        csound->Free(csound, data);
     }
     csound->Free(csound, sfArray);
     globals->currSFndx = 0;
@@ -99,12 +104,15 @@ int sfont_ModuleDestroy(CSOUND *csound)
     return 0;
 }
 
-static void SoundFontLoad(CSOUND *csound, char *fname)
+/* returns the index of the loaded SoundFont, or -1 on error */
+
+static int SoundFontLoad(CSOUND *csound, char *fname)
 {
     FILE *fil;
     void *fd;
     SFBANK *soundFont;
     sfontg *globals;
+    int j;
     globals = (sfontg *) (csound->QueryGlobalVariable(csound, "::sfontg"));
     soundFont = globals->soundFont;
     fd = csound->FileOpen2(csound, &fil, CSFILE_STD, fname, "rb",
@@ -113,7 +121,14 @@ static void SoundFontLoad(CSOUND *csound, char *fname)
       csound->ErrorMsg(csound,
                   Str("sfload: cannot open SoundFont file \"%s\" (error %s)"),
                   fname, strerror(errno));
-      return;
+      return -1;
+    }
+    /* a file loaded before is shared, its data is never modified */
+    for (j = 0; j < globals->currSFndx; j++) {
+      if (strncmp(globals->sfArray[j].name, csound->GetFileName(fd), 255) == 0) {
+        csound->FileClose(csound, fd);
+        return j;
+      }
     }
     soundFont = &globals->sfArray[globals->currSFndx];
     /* if (UNLIKELY(soundFont==NULL)){ */
@@ -122,12 +137,14 @@ static void SoundFontLoad(CSOUND *csound, char *fname)
     /* } */
     strncpy(soundFont->name, csound->GetFileName(fd), 255);
     soundFont->name[255]='\0';
-    if (UNLIKELY(chunk_read(csound, fil, &soundFont->chunk.main_chunk)<0))
+    if (!chunk_map(csound, fil, &soundFont->chunk.main_chunk) &&
+        UNLIKELY(chunk_read(csound, fil, &soundFont->chunk.main_chunk)<0))
       csound->Message(csound, Str("sfont: failed to read file\n"));
     csound->FileClose(csound, fd);
     globals->soundFont = soundFont;
     fill_SfPointers(csound);
     fill_SfStruct(csound);
+    return globals->currSFndx;
 }
 
 static int compare(presetType * elem1, presetType *elem2)
@@ -142,14 +159,13 @@ static int compare(presetType * elem1, presetType *elem2)
         ihandle SfLoad "filename"
 */
 
-static char *Gfname;            /* NOT THREAD SAFE */
-
 static int SfLoad_(CSOUND *csound, SFLOAD *p, int istring)
                                        /* open a file and return its handle */
 {                                      /* the handle is simply a stack index */
     char *fname;
     SFBANK *sf;
     sfontg *globals;
+    int ndx;
     globals = (sfontg *) (csound->QueryGlobalVariable(csound, "::sfontg"));
     if (UNLIKELY(globals==NULL)) {
       return csound->InitError(csound, Str("sfload: could not open globals\n"));
@@ -163,13 +179,16 @@ static int SfLoad_(CSOUND *csound, SFLOAD *p, int istring)
                                 0);
     }
     /*    strcpy(fname, (char*) p->fname); */
-    Gfname = fname;
-    SoundFontLoad(csound, fname);
-    *p->ihandle = (float) globals->currSFndx;
-    sf = &globals->sfArray[globals->currSFndx];
+    ndx = SoundFontLoad(csound, fname);
+    csound->Free(csound,fname);
+    if (UNLIKELY(ndx < 0))
+      return csound->InitError(csound, Str("sfload: cannot load SoundFont"));
+    *p->ihandle = (float) ndx;
+    if (ndx < globals->currSFndx)       /* already loaded */
+      return OK;
+    sf = &globals->sfArray[ndx];
     qsort(sf->preset, sf->presets_num, sizeof(presetType),
         (int (*)(const void *, const void * )) compare);
-    csound->Free(csound,fname);
     if (UNLIKELY(++globals->currSFndx>=globals->maxSFndx)) {
       globals->maxSFndx += 5;
       globals->sfArray = (SFBANK *)csound->ReAlloc(csound, globals->sfArray,
@@ -324,6 +343,8 @@ static int SfPlay_set(CSOUND *csound, SFPLAY *p)
       return csound->InitError(csound, Str("sfplay: invalid or "
                                            "out-of-range preset number"));
     }
+    if (UNLIKELY(preset_load(csound, globals, preset) != OK))
+      return NOTOK;
     layersNum = preset->layers_num;
     for (j =0; j < layersNum; j++) {
       layerType *layer = &preset->layer[j];
@@ -659,6 +680,8 @@ static int SfPlayMono_set(CSOUND *csound, SFPLAYMONO *p)
       return csound->InitError(csound, Str("sfplaym: invalid or "
                                            "out-of-range preset number"));
     }
+    if (UNLIKELY(preset_load(csound, globals, preset) != OK))
+      return NOTOK;
     layersNum= preset->layers_num;
     for (j =0; j < layersNum; j++) {
       layerType *layer = &preset->layer[j];
@@ -923,7 +946,10 @@ static int SfInstrPlay_set(CSOUND *csound, SFIPLAY *p)
       SHORT *sBase = sf->sampleData;
       int spltNum = 0, flag=(int) *p->iflag;
       int vel= (int) *p->ivel, notnum= (int) *p->inotnum;
-      int splitsNum = layer->splits_num, k;
+      int splitsNum, k;
+      if (UNLIKELY(instr_load(csound, sf, layer) != OK))
+        return NOTOK;
+      splitsNum = layer->splits_num;
       for (k = 0; k < splitsNum; k++) {
         splitType *split = &layer->split[k];
         if (notnum >= split->minNoteRange &&
@@ -1191,7 +1217,10 @@ static int SfInstrPlayMono_set(CSOUND *csound, SFIPLAYMONO *p)
       SHORT *sBase = sf->sampleData;
       int spltNum = 0, flag=(int) *p->iflag;
       int vel= (int) *p->ivel, notnum= (int) *p->inotnum;
-      int splitsNum = layer->splits_num, k;
+      int splitsNum, k;
+      if (UNLIKELY(instr_load(csound, sf, layer) != OK))
+        return NOTOK;
+      splitsNum = layer->splits_num;
       for (k = 0; k < splitsNum; k++) {
         splitType *split = &layer->split[k];
         if (notnum >= split->minNoteRange &&
@@ -1476,492 +1505,538 @@ static void ChangeByteOrder(char *fmt, char *p, int32 size)
 
 static int fill_SfStruct(CSOUND *csound)
 {
-    int j, k, i, l, m, size, iStart, iEnd, kk, ll, mStart, mEnd;
-    int pbag_num,first_pbag,layer_num;
-    int ibag_num,first_ibag,split_num;
+    int j, size;
     CHUNK *phdrChunk;
     presetType *preset;
     sfPresetHeader *phdr;
-    sfPresetBag *pbag;
-    sfGenList *pgen;
     sfInst *inst;
-    sfInstBag *ibag;
-/*  sfInstModList *imod; */
-    sfInstGenList *igen;
-    sfSample *shdr;
     SFBANK *soundFont;
     sfontg *globals;
     globals = (sfontg *) (csound->QueryGlobalVariable(csound, "::sfontg"));
     soundFont = globals->soundFont;
 
-
-/*  imod = soundFont->chunk.imod; */
-    igen = soundFont->chunk.igen;
-    shdr = soundFont->chunk.shdr;
-
     phdrChunk= soundFont->chunk.phdrChunk;
     phdr = soundFont->chunk.phdr;
-    pbag = soundFont->chunk.pbag;
-    pgen = soundFont->chunk.pgen;
     inst = soundFont->chunk.inst;
-    ibag = soundFont->chunk.ibag;
 
+    /* only the headers are read here; the layers and splits of a preset */
+    /* or instrument are filled in by preset_load() or instr_load() when  */
+    /* it is first played                                                 */
     size = phdrChunk->ckSize / sizeof(sfPresetHeader);
     soundFont->presets_num = size;
-    preset = (presetType *) csound->Malloc(csound, size * sizeof(presetType));
+    preset = (presetType *) csound->Calloc(csound, size * sizeof(presetType));
     for (j=0; j < size; j++) {
       preset[j].name = phdr[j].achPresetName;
       if (strcmp(preset[j].name,"EOP")==0) {
         soundFont->presets_num = j;
-        goto end_fill_presets;
+        break;
       }
       preset[j].num = j;
       preset[j].prog = phdr[j].wPreset;
       preset[j].bank = phdr[j].wBank;
-      first_pbag = phdr[j].wPresetBagNdx;
-      pbag_num = phdr[j+1].wPresetBagNdx - first_pbag;
-      layer_num = 0;
-      for  (k = 0 ; k < pbag_num ; k++) {
-        iStart = pbag[k+first_pbag].wGenNdx;
-        iEnd = pbag[k+first_pbag+1].wGenNdx;
-        for (i = iStart; i < iEnd; i++) {
-          if (pgen[i].sfGenOper == instrument ) {
-            layer_num++;
-          }
+      preset[j].sfndx = (int) (soundFont - globals->sfArray);
+    }
+    soundFont->preset = preset;
+/* fill layer list */
+    {
+      instrType *instru;
+      size = soundFont->chunk.instChunk->ckSize / sizeof(sfInst);
+      soundFont->instrs_num = size;
+      instru = (instrType *) csound->Calloc(csound, size * sizeof(instrType));
+      for (j=0; j < size; j++) {
+        instru[j].name = inst[j].achInstName;
+        if (strcmp(instru[j].name,"EOI")==0) {
+          soundFont->instrs_num = j;
+          break;
         }
+        instru[j].num = j;
       }
-      preset[j].layers_num = layer_num;
-      preset[j].layer =
-        (layerType *) csound->Malloc(csound, layer_num * sizeof(layerType));
-      for (k=0; k <layer_num; k++) {
-        layerDefaults(&preset[j].layer[k]);
+      soundFont->instr = instru;
+    }
+    return OK;
+}
+
+static void preset_free(CSOUND *csound, presetType *preset)
+{
+    int l;
+
+    for (l=0; l<preset->layers_num; l++)
+      csound->Free(csound, preset->layer[l].split);
+    csound->Free(csound, preset->layer);
+    preset->layer = NULL;
+    preset->layers_num = 0;
+}
+
+/* fill in the layers and splits of a preset on first use */
+
+static int preset_load(CSOUND *csound, sfontg *globals, presetType *preset)
+{
+    int k, i, l, m, iStart, iEnd, kk, ll, mStart, mEnd;
+    int pbag_num,first_pbag,layer_num;
+    int ibag_num,first_ibag,split_num;
+    sfPresetHeader *phdr;
+    sfPresetBag *pbag;
+    sfGenList *pgen;
+    sfInst *inst;
+    sfInstBag *ibag;
+    sfInstGenList *igen;
+    sfSample *shdr;
+    SFBANK *soundFont;
+
+    if (preset->loaded)
+      return OK;
+    soundFont = &globals->sfArray[preset->sfndx];
+    igen = soundFont->chunk.igen;
+    shdr = soundFont->chunk.shdr;
+    phdr = soundFont->chunk.phdr;
+    pbag = soundFont->chunk.pbag;
+    pgen = soundFont->chunk.pgen;
+    inst = soundFont->chunk.inst;
+    ibag = soundFont->chunk.ibag;
+
+    first_pbag = phdr[preset->num].wPresetBagNdx;
+    pbag_num = phdr[preset->num+1].wPresetBagNdx - first_pbag;
+    layer_num = 0;
+    for  (k = 0 ; k < pbag_num ; k++) {
+      iStart = pbag[k+first_pbag].wGenNdx;
+      iEnd = pbag[k+first_pbag+1].wGenNdx;
+      for (i = iStart; i < iEnd; i++) {
+        if (pgen[i].sfGenOper == instrument ) {
+          layer_num++;
+        }
       }
-      for  (k = 0, kk=0; k < pbag_num ; k++) {
-        iStart = pbag[k+first_pbag].wGenNdx;
-        iEnd = pbag[k+first_pbag+1].wGenNdx;
-        for (i = iStart; i < iEnd; i++) {
-          layerType *layer;
-          layer = &preset[j].layer[kk];
-          switch (pgen[i].sfGenOper) {
-          case instrument:
-            {
+    }
+    preset->layers_num = layer_num;
+    preset->layer =
+      (layerType *) csound->Calloc(csound, layer_num * sizeof(layerType));
+    for (k=0; k <layer_num; k++) {
+      layerDefaults(&preset->layer[k]);
+    }
+    for  (k = 0, kk=0; k < pbag_num ; k++) {
+      iStart = pbag[k+first_pbag].wGenNdx;
+      iEnd = pbag[k+first_pbag+1].wGenNdx;
+      for (i = iStart; i < iEnd; i++) {
+        layerType *layer;
+        layer = &preset->layer[kk];
+        switch (pgen[i].sfGenOper) {
+        case instrument:
+          {
 #define UNUSE 0x7fffffff
-              int GsampleModes=UNUSE, GcoarseTune=UNUSE, GfineTune=UNUSE;
-              int Gpan=UNUSE, GinitialAttenuation=UNUSE,GscaleTuning=UNUSE;
-              int GoverridingRootKey = UNUSE;
-
-              layer->num  = pgen[i].genAmount.wAmount;
-              layer->name = inst[layer->num].achInstName;
-              first_ibag = inst[layer->num].wInstBagNdx;
-              ibag_num = inst[layer->num +1].wInstBagNdx - first_ibag;
-              split_num = 0;
-              for (l=0; l < ibag_num; l++) {
-                mStart = ibag[l+first_ibag].wInstGenNdx;
-                mEnd = ibag[l+first_ibag+1].wInstGenNdx;
-                for (m=mStart; m < mEnd; m++) {
-                  if (igen[m].sfGenOper == sampleID) {
-                    split_num++;
-                  }
+            int GsampleModes=UNUSE, GcoarseTune=UNUSE, GfineTune=UNUSE;
+            int Gpan=UNUSE, GinitialAttenuation=UNUSE,GscaleTuning=UNUSE;
+            int GoverridingRootKey = UNUSE;
+
+            layer->num  = pgen[i].genAmount.wAmount;
+            layer->name = inst[layer->num].achInstName;
+            first_ibag = inst[layer->num].wInstBagNdx;
+            ibag_num = inst[layer->num +1].wInstBagNdx - first_ibag;
+            split_num = 0;
+            for (l=0; l < ibag_num; l++) {
+              mStart = ibag[l+first_ibag].wInstGenNdx;
+              mEnd = ibag[l+first_ibag+1].wInstGenNdx;
+              for (m=mStart; m < mEnd; m++) {
+                if (igen[m].sfGenOper == sampleID) {
+                  split_num++;
                 }
               }
-              layer->splits_num = split_num;
-              layer->split =
-                (splitType *) csound->Malloc(csound, split_num * sizeof(splitType));
-              for (l=0; l<split_num; l++) {
-                splitDefaults(&layer->split[l]);
-              }
-              for (l=0, ll=0; l < ibag_num; l++) {
-                int sglobal_zone = 1;
-                mStart = ibag[l+first_ibag].wInstGenNdx;
-                mEnd = ibag[l+first_ibag+1].wInstGenNdx;
+            }
+            layer->splits_num = split_num;
+            layer->split =
+              (splitType *) csound->Malloc(csound, split_num * sizeof(splitType));
+            for (l=0; l<split_num; l++) {
+              splitDefaults(&layer->split[l]);
+            }
+            for (l=0, ll=0; l < ibag_num; l++) {
+              int sglobal_zone = 1;
+              mStart = ibag[l+first_ibag].wInstGenNdx;
+              mEnd = ibag[l+first_ibag+1].wInstGenNdx;
 
+              for (m=mStart; m < mEnd; m++) {
+                if (igen[m].sfGenOper == sampleID) sglobal_zone=0;
+              }
+              if (sglobal_zone) {
                 for (m=mStart; m < mEnd; m++) {
-                  if (igen[m].sfGenOper == sampleID) sglobal_zone=0;
-                }
-                if (sglobal_zone) {
-                  for (m=mStart; m < mEnd; m++) {
-                    switch (igen[m].sfGenOper) {
-                    case sampleID:
-                      break;
-                    case overridingRootKey:
-                      GoverridingRootKey = igen[m].genAmount.wAmount;
-                      break;
-                    case coarseTune:
-                      GcoarseTune =  igen[m].genAmount.shAmount;
-                      break;
-                    case fineTune:
-                      GfineTune = igen[m].genAmount.shAmount;
-                      break;
-                    case scaleTuning:
-                      GscaleTuning = igen[m].genAmount.shAmount;
-                      break;
-                    case pan:
-                      Gpan = igen[m].genAmount.shAmount;
-                      break;
-                    case sampleModes:
-                      GsampleModes =  igen[m].genAmount.wAmount;
-                      break;
-                    case initialAttenuation:
-                      GinitialAttenuation = igen[m].genAmount.shAmount;
-                      break;
-                    case keyRange:
-                      break;
-                    case velRange:
-                      break;
-                    }
+                  switch (igen[m].sfGenOper) {
+                  case sampleID:
+                    break;
+                  case overridingRootKey:
+                    GoverridingRootKey = igen[m].genAmount.wAmount;
+                    break;
+                  case coarseTune:
+                    GcoarseTune =  igen[m].genAmount.shAmount;
+                    break;
+                  case fineTune:
+                    GfineTune = igen[m].genAmount.shAmount;
+                    break;
+                  case scaleTuning:
+                    GscaleTuning = igen[m].genAmount.shAmount;
+                    break;
+                  case pan:
+                    Gpan = igen[m].genAmount.shAmount;
+                    break;
+                  case sampleModes:
+                    GsampleModes =  igen[m].genAmount.wAmount;
+                    break;
+                  case initialAttenuation:
+                    GinitialAttenuation = igen[m].genAmount.shAmount;
+                    break;
+                  case keyRange:
+                    break;
+                  case velRange:
+                    break;
                   }
                 }
-                else {
-                  splitType *split;
-                  split = &layer->split[ll];
-                  split->attack = split->decay = split->sustain =
-                    split->release = FL(0.0);
-                  if (GoverridingRootKey != UNUSE)
-                    split->overridingRootKey = (BYTE) GoverridingRootKey;
-                  if (GcoarseTune != UNUSE)
-                    split->coarseTune = (BYTE) GcoarseTune;
-                  if (GfineTune != UNUSE)
-                    split->fineTune = (BYTE) GfineTune;
-                  if (GscaleTuning != UNUSE)
-                    split->scaleTuning = (BYTE) GscaleTuning;
-                  if (Gpan != UNUSE)
-                    split->pan = (BYTE) Gpan;
-                  if (GsampleModes != UNUSE)
-                    split->sampleModes = (BYTE) GsampleModes;
-                  if (GinitialAttenuation != UNUSE)
-                    split->initialAttenuation = (BYTE) GinitialAttenuation;
-
-                  for (m=mStart; m < mEnd; m++) {
-                    switch (igen[m].sfGenOper) {
-                    case sampleID:
-                      {
-                        int num = igen[m].genAmount.wAmount;
-                        split->num= num;
-                        split->sample = &shdr[num];
-                        if (UNLIKELY(split->sample->sfSampleType & 0x8000)) {
-                          csound->Free(csound, preset);
-                          csound->ErrorMsg(csound, Str("SoundFont file \"%s\" "
-                                                       "contains ROM samples !\n"
-                                                       "At present time only RAM "
-                                                       "samples are allowed "
-                                                       "by sfload.\n"
-                                                       "Session aborted !"),
-                                           Gfname);
-                            return NOTOK;
-                        }
-                        sglobal_zone = 0;
-                        ll++;
+              }
+              else {
+                splitType *split;
+                split = &layer->split[ll];
+                split->attack = split->decay = split->sustain =
+                  split->release = FL(0.0);
+                if (GoverridingRootKey != UNUSE)
+                  split->overridingRootKey = (BYTE) GoverridingRootKey;
+                if (GcoarseTune != UNUSE)
+                  split->coarseTune = (BYTE) GcoarseTune;
+                if (GfineTune != UNUSE)
+                  split->fineTune = (BYTE) GfineTune;
+                if (GscaleTuning != UNUSE)
+                  split->scaleTuning = (BYTE) GscaleTuning;
+                if (Gpan != UNUSE)
+                  split->pan = (BYTE) Gpan;
+                if (GsampleModes != UNUSE)
+                  split->sampleModes = (BYTE) GsampleModes;
+                if (GinitialAttenuation != UNUSE)
+                  split->initialAttenuation = (BYTE) GinitialAttenuation;
+
+                for (m=mStart; m < mEnd; m++) {
+                  switch (igen[m].sfGenOper) {
+                  case sampleID:
+                    {
+                      int num = igen[m].genAmount.wAmount;
+                      split->num= num;
+                      split->sample = &shdr[num];
+                      if (UNLIKELY(split->sample->sfSampleType & 0x8000)) {
+                        preset_free(csound, preset);
+                        return csound->InitError(csound,
+                                                 Str("SoundFont file \"%s\" "
+                                                     "contains ROM samples !\n"
+                                                     "At present time only RAM "
+                                                     "samples are allowed "
+                                                     "by sfload.\n"
+                                                     "Session aborted !"),
+                                                 soundFont->name);
                       }
-                      break;
-                    case overridingRootKey:
-                      split->overridingRootKey = (BYTE) igen[m].genAmount.wAmount;
-                      break;
-                    case coarseTune:
-                      split->coarseTune = (char) igen[m].genAmount.shAmount;
-                      break;
-                    case fineTune:
-                      split->fineTune = (char) igen[m].genAmount.shAmount;
-                      break;
-                    case scaleTuning:
-                      split->scaleTuning = igen[m].genAmount.shAmount;
-                      break;
-                    case pan:
-                      split->pan = igen[m].genAmount.shAmount;
-                      break;
-                    case sampleModes:
-                      split->sampleModes = (BYTE) igen[m].genAmount.wAmount;
-                      break;
-                    case initialAttenuation:
-                      split->initialAttenuation = igen[m].genAmount.shAmount;
-                      break;
-                    case keyRange:
-                      split->minNoteRange = igen[m].genAmount.ranges.byLo;
-                      split->maxNoteRange = igen[m].genAmount.ranges.byHi;
-                      break;
-                    case velRange:
-                      split->minVelRange = igen[m].genAmount.ranges.byLo;
-                      split->maxVelRange = igen[m].genAmount.ranges.byHi;
-                      break;
-                    case startAddrsOffset:
-                      split->startOffset += igen[m].genAmount.shAmount;
-                      break;
-                    case endAddrsOffset:
-                      split->endOffset += igen[m].genAmount.shAmount;
-                      break;
-                    case startloopAddrsOffset:
-                      split->startLoopOffset += igen[m].genAmount.shAmount;
-                      break;
-                    case endloopAddrsOffset:
-                      split->endLoopOffset += igen[m].genAmount.shAmount;
-                      break;
-                    case startAddrsCoarseOffset:
-                      split->startOffset += igen[m].genAmount.shAmount * 32768;
-                      break;
-                    case endAddrsCoarseOffset:
-                      split->endOffset += igen[m].genAmount.shAmount * 32768;
-                      break;
-                    case startloopAddrCoarseOffset:
-                      split->startLoopOffset += igen[m].genAmount.shAmount * 32768;
-                      break;
-                    case endloopAddrsCoarseOffset:
-                      split->endLoopOffset += igen[m].genAmount.shAmount * 32768;
-                      break;
-                    case delayVolEnv:
-                      csound->Message(csound, "del: %f\n",
-                                      (double) igen[m].genAmount.shAmount);
-                      break;
-                    case attackVolEnv:           /*attack */
-                      split->attack = POWER(FL(2.0),
-                                            igen[m].genAmount.shAmount/FL(1200.0));
-                      /* csound->Message(csound, "att: %f\n", split->attack ); */
-                      break;
-                      /* case holdVolEnv: */             /*hold   35 */
-                    case decayVolEnv:            /*decay */
-                      split->decay = POWER(FL(2.0),
+                      sglobal_zone = 0;
+                      ll++;
+                    }
+                    break;
+                  case overridingRootKey:
+                    split->overridingRootKey = (BYTE) igen[m].genAmount.wAmount;
+                    break;
+                  case coarseTune:
+                    split->coarseTune = (char) igen[m].genAmount.shAmount;
+                    break;
+                  case fineTune:
+                    split->fineTune = (char) igen[m].genAmount.shAmount;
+                    break;
+                  case scaleTuning:
+                    split->scaleTuning = igen[m].genAmount.shAmount;
+                    break;
+                  case pan:
+                    split->pan = igen[m].genAmount.shAmount;
+                    break;
+                  case sampleModes:
+                    split->sampleModes = (BYTE) igen[m].genAmount.wAmount;
+                    break;
+                  case initialAttenuation:
+                    split->initialAttenuation = igen[m].genAmount.shAmount;
+                    break;
+                  case keyRange:
+                    split->minNoteRange = igen[m].genAmount.ranges.byLo;
+                    split->maxNoteRange = igen[m].genAmount.ranges.byHi;
+                    break;
+                  case velRange:
+                    split->minVelRange = igen[m].genAmount.ranges.byLo;
+                    split->maxVelRange = igen[m].genAmount.ranges.byHi;
+                    break;
+                  case startAddrsOffset:
+                    split->startOffset += igen[m].genAmount.shAmount;
+                    break;
+                  case endAddrsOffset:
+                    split->endOffset += igen[m].genAmount.shAmount;
+                    break;
+                  case startloopAddrsOffset:
+                    split->startLoopOffset += igen[m].genAmount.shAmount;
+                    break;
+                  case endloopAddrsOffset:
+                    split->endLoopOffset += igen[m].genAmount.shAmount;
+                    break;
+                  case startAddrsCoarseOffset:
+                    split->startOffset += igen[m].genAmount.shAmount * 32768;
+                    break;
+                  case endAddrsCoarseOffset:
+                    split->endOffset += igen[m].genAmount.shAmount * 32768;
+                    break;
+                  case startloopAddrCoarseOffset:
+                    split->startLoopOffset += igen[m].genAmount.shAmount * 32768;
+                    break;
+                  case endloopAddrsCoarseOffset:
+                    split->endLoopOffset += igen[m].genAmount.shAmount * 32768;
+                    break;
+                  case delayVolEnv:
+                    csound->Message(csound, "del: %f\n",
+                                    (double) igen[m].genAmount.shAmount);
+                    break;
+                  case attackVolEnv:           /*attack */
+                    split->attack = POWER(FL(2.0),
+                                          igen[m].genAmount.shAmount/FL(1200.0));
+                    /* csound->Message(csound, "att: %f\n", split->attack ); */
+                    break;
+                    /* case holdVolEnv: */             /*hold   35 */
+                  case decayVolEnv:            /*decay */
+                    split->decay = POWER(FL(2.0),
+                                         igen[m].genAmount.shAmount/FL(1200.0));
+                    /* csound->Message(csound, "dec: %f\n", split->decay); */
+                    break;
+                  case sustainVolEnv:          /*sustain */
+                    split->sustain = POWER(FL(10.0),
+                                           -igen[m].genAmount.shAmount/FL(20.0));
+                    /* csound->Message(csound, "sus: %f\n", split->sustain); */
+                    break;
+                  case releaseVolEnv:          /*release */
+                    split->release = POWER(FL(2.0),
                                            igen[m].genAmount.shAmount/FL(1200.0));
-                      /* csound->Message(csound, "dec: %f\n", split->decay); */
-                      break;
-                    case sustainVolEnv:          /*sustain */
-                      split->sustain = POWER(FL(10.0),
-                                             -igen[m].genAmount.shAmount/FL(20.0));
-                      /* csound->Message(csound, "sus: %f\n", split->sustain); */
-                      break;
-                    case releaseVolEnv:          /*release */
-                      split->release = POWER(FL(2.0),
-                                             igen[m].genAmount.shAmount/FL(1200.0));
-                      /* csound->Message(csound, "rel: %f\n", split->release); */
-                      break;
-                    case keynum:
-                      /*csound->Message(csound, "");*/
-                      break;
-                    case velocity:
-                      /*csound->Message(csound, "");*/
-                      break;
-                    case exclusiveClass:
-                      /*csound->Message(csound, "");*/
-                      break;
+                    /* csound->Message(csound, "rel: %f\n", split->release); */
+                    break;
+                  case keynum:
+                    /*csound->Message(csound, "");*/
+                    break;
+                  case velocity:
+                    /*csound->Message(csound, "");*/
+                    break;
+                  case exclusiveClass:
+                    /*csound->Message(csound, "");*/
+                    break;
 
-                    }
                   }
                 }
               }
-              kk++;
             }
+            kk++;
+          }
+          break;
+        case coarseTune:
+          layer->coarseTune = (char) pgen[i].genAmount.shAmount;
+          break;
+        case fineTune:
+          layer->fineTune = (char) pgen[i].genAmount.shAmount;
+          break;
+        case scaleTuning:
+          layer->scaleTuning = pgen[i].genAmount.shAmount;
+          break;
+        case initialAttenuation:
+          layer->initialAttenuation = pgen[i].genAmount.shAmount;
+          break;
+        case pan:
+          layer->pan = pgen[i].genAmount.shAmount;
+          break;
+        case keyRange:
+          layer->minNoteRange = pgen[i].genAmount.ranges.byLo;
+          layer->maxNoteRange = pgen[i].genAmount.ranges.byHi;
+          break;
+        case velRange:
+          layer->minVelRange = pgen[i].genAmount.ranges.byLo;
+          layer->maxVelRange = pgen[i].genAmount.ranges.byHi;
+          break;
+        }
+      }
+    }
+    preset->loaded = 1;
+    return OK;
+}
+
+/* fill in the splits of an instrument on first use */
+
+static int instr_load(CSOUND *csound, SFBANK *soundFont, instrType *instru)
+{
+    int GsampleModes=UNUSE, GcoarseTune=UNUSE, GfineTune=UNUSE;
+    int Gpan=UNUSE, GinitialAttenuation=UNUSE,GscaleTuning=UNUSE;
+    int GoverridingRootKey = UNUSE;
+    int l, m, ll, mStart, mEnd;
+    int ibag_num,first_ibag,split_num;
+    sfInst *inst = soundFont->chunk.inst;
+    sfInstBag *ibag = soundFont->chunk.ibag;
+    sfInstGenList *igen = soundFont->chunk.igen;
+    sfSample *shdr = soundFont->chunk.shdr;
+
+    if (instru->loaded)
+      return OK;
+    first_ibag = inst[instru->num].wInstBagNdx;
+    ibag_num = inst[instru->num+1].wInstBagNdx - first_ibag;
+    split_num=0;
+    for (l=0; l < ibag_num; l++) {
+      mStart =      ibag[l+first_ibag].wInstGenNdx;
+      mEnd = ibag[l+first_ibag+1].wInstGenNdx;
+      for (m=mStart; m < mEnd; m++) {
+        if (igen[m].sfGenOper == sampleID) {
+          split_num++;
+        }
+      }
+    }
+    instru->splits_num = split_num;
+    instru->split =
+      (splitType *) csound->Malloc(csound, split_num * sizeof(splitType));
+    for (l=0; l<split_num; l++) {
+      splitDefaults(&instru->split[l]);
+    }
+    for (l=0, ll=0; l < ibag_num; l++) {
+      int sglobal_zone = 1;
+      mStart = ibag[l+first_ibag].wInstGenNdx;
+      mEnd = ibag[l+first_ibag+1].wInstGenNdx;
+
+      for (m=mStart; m < mEnd; m++) {
+        if (igen[m].sfGenOper == sampleID) sglobal_zone=0;
+      }
+      if (sglobal_zone) {
+        for (m=mStart; m < mEnd; m++) {
+          switch (igen[m].sfGenOper) {
+          case sampleID:
+            break;
+          case overridingRootKey:
+            GoverridingRootKey = igen[m].genAmount.wAmount;
             break;
           case coarseTune:
-            layer->coarseTune = (char) pgen[i].genAmount.shAmount;
+            GcoarseTune =  igen[m].genAmount.shAmount;
             break;
           case fineTune:
-            layer->fineTune = (char) pgen[i].genAmount.shAmount;
+            GfineTune = igen[m].genAmount.shAmount;
             break;
           case scaleTuning:
-            layer->scaleTuning = pgen[i].genAmount.shAmount;
-            break;
-          case initialAttenuation:
-            layer->initialAttenuation = pgen[i].genAmount.shAmount;
+            GscaleTuning = igen[m].genAmount.shAmount;
             break;
           case pan:
-            layer->pan = pgen[i].genAmount.shAmount;
+            Gpan = igen[m].genAmount.shAmount;
+            break;
+          case sampleModes:
+            GsampleModes =  igen[m].genAmount.wAmount;
+            break;
+          case initialAttenuation:
+            GinitialAttenuation = igen[m].genAmount.shAmount;
             break;
           case keyRange:
-            layer->minNoteRange = pgen[i].genAmount.ranges.byLo;
-            layer->maxNoteRange = pgen[i].genAmount.ranges.byHi;
             break;
           case velRange:
-            layer->minVelRange = pgen[i].genAmount.ranges.byLo;
-            layer->maxVelRange = pgen[i].genAmount.ranges.byHi;
             break;
           }
         }
       }
-    }
- end_fill_presets:
-    soundFont->preset = preset;
-/* fill layer list */
-    {
-      instrType *instru;
-      size = soundFont->chunk.instChunk->ckSize / sizeof(sfInst);
-      soundFont->instrs_num = size;
-      instru = (instrType *) csound->Malloc(csound, size * sizeof(layerType));
-      for (j=0; j < size; j++) {
-#define UNUSE 0x7fffffff
-        int GsampleModes=UNUSE, GcoarseTune=UNUSE, GfineTune=UNUSE;
-        int Gpan=UNUSE, GinitialAttenuation=UNUSE,GscaleTuning=UNUSE;
-        int GoverridingRootKey = UNUSE;
-
-        instru[j].name = inst[j].achInstName;
-        if (strcmp(instru[j].name,"EOI")==0) {
-          soundFont->instrs_num = j;
-          goto end_fill_layers;
-        }
-        instru[j].num = j;
-        first_ibag = inst[j].wInstBagNdx;
-        ibag_num = inst[j+1].wInstBagNdx - first_ibag;
-        split_num=0;
-        for (l=0; l < ibag_num; l++) {
-          mStart =      ibag[l+first_ibag].wInstGenNdx;
-          mEnd = ibag[l+first_ibag+1].wInstGenNdx;
-          for (m=mStart; m < mEnd; m++) {
-            if (igen[m].sfGenOper == sampleID) {
-              split_num++;
-            }
-          }
-        }
-        instru[j].splits_num = split_num;
-        instru[j].split =
-          (splitType *) csound->Malloc(csound, split_num * sizeof(splitType));
-        for (l=0; l<split_num; l++) {
-          splitDefaults(&instru[j].split[l]);
-        }
-        for (l=0, ll=0; l < ibag_num; l++) {
-          int sglobal_zone = 1;
-          mStart = ibag[l+first_ibag].wInstGenNdx;
-          mEnd = ibag[l+first_ibag+1].wInstGenNdx;
-
-          for (m=mStart; m < mEnd; m++) {
-            if (igen[m].sfGenOper == sampleID) sglobal_zone=0;
-          }
-          if (sglobal_zone) {
-            for (m=mStart; m < mEnd; m++) {
-              switch (igen[m].sfGenOper) {
-              case sampleID:
-                break;
-              case overridingRootKey:
-                GoverridingRootKey = igen[m].genAmount.wAmount;
-                break;
-              case coarseTune:
-                GcoarseTune =  igen[m].genAmount.shAmount;
-                break;
-              case fineTune:
-                GfineTune = igen[m].genAmount.shAmount;
-                break;
-              case scaleTuning:
-                GscaleTuning = igen[m].genAmount.shAmount;
-                break;
-              case pan:
-                Gpan = igen[m].genAmount.shAmount;
-                break;
-              case sampleModes:
-                GsampleModes =  igen[m].genAmount.wAmount;
-                break;
-              case initialAttenuation:
-                GinitialAttenuation = igen[m].genAmount.shAmount;
-                break;
-              case keyRange:
-                break;
-              case velRange:
-                break;
-              }
-            }
-          }
-          else {
-            splitType *split;
-            split = &instru[j].split[ll];
-            if (GoverridingRootKey != UNUSE)
-              split->overridingRootKey = (BYTE) GoverridingRootKey;
-            if (GcoarseTune != UNUSE)
-              split->coarseTune = (BYTE) GcoarseTune;
-            if (GfineTune != UNUSE)
-              split->fineTune = (BYTE) GfineTune;
-            if (GscaleTuning != UNUSE)
-              split->scaleTuning = (BYTE) GscaleTuning;
-            if (Gpan != UNUSE)
-              split->pan = (BYTE) Gpan;
-            if (GsampleModes != UNUSE)
-              split->sampleModes = (BYTE) GsampleModes;
-            if (GinitialAttenuation != UNUSE)
-              split->initialAttenuation = (BYTE) GinitialAttenuation;
-
-            for (m=mStart; m < mEnd; m++) {
-              switch (igen[m].sfGenOper) {
-              case sampleID:
-                {
-                  int num = igen[m].genAmount.wAmount;
-                  split->num= num;
-                  split->sample = &shdr[num];
-                  if (UNLIKELY(split->sample->sfSampleType & 0x8000)) {
-                    csound->Free(csound, instru);
-                    csound->ErrorMsg(csound, Str("SoundFont file \"%s\" contains "
-                                            "ROM samples !\n"
-                                            "At present time only RAM samples "
-                                            "are allowed by sfload.\n"
-                                            "Session aborted !"), Gfname);
-                    return NOTOK;
-                  }
-                  sglobal_zone = 0;
-                  ll++;
-                }
-                break;
-              case overridingRootKey:
-                split->overridingRootKey = (BYTE) igen[m].genAmount.wAmount;
-                break;
-              case coarseTune:
-                split->coarseTune = (char) igen[m].genAmount.shAmount;
-                break;
-              case fineTune:
-                split->fineTune = (char) igen[m].genAmount.shAmount;
-                break;
-              case scaleTuning:
-                split->scaleTuning = igen[m].genAmount.shAmount;
-                break;
-              case pan:
-                split->pan = igen[m].genAmount.shAmount;
-                break;
-              case sampleModes:
-                split->sampleModes = (BYTE) igen[m].genAmount.wAmount;
-                break;
-              case initialAttenuation:
-                split->initialAttenuation = igen[m].genAmount.shAmount;
-                break;
-              case keyRange:
-                split->minNoteRange = igen[m].genAmount.ranges.byLo;
-                split->maxNoteRange = igen[m].genAmount.ranges.byHi;
-                break;
-              case velRange:
-                split->minVelRange = igen[m].genAmount.ranges.byLo;
-                split->maxVelRange = igen[m].genAmount.ranges.byHi;
-                break;
-              case startAddrsOffset:
-                split->startOffset += igen[m].genAmount.shAmount;
-                break;
-              case endAddrsOffset:
-                split->endOffset += igen[m].genAmount.shAmount;
-                break;
-              case startloopAddrsOffset:
-                split->startLoopOffset += igen[m].genAmount.shAmount;
-                break;
-              case endloopAddrsOffset:
-                split->endLoopOffset += igen[m].genAmount.shAmount;
-                break;
-              case startAddrsCoarseOffset:
-                split->startOffset += igen[m].genAmount.shAmount * 32768;
-                break;
-              case endAddrsCoarseOffset:
-                split->endOffset += igen[m].genAmount.shAmount * 32768;
-                break;
-              case startloopAddrCoarseOffset:
-                split->startLoopOffset += igen[m].genAmount.shAmount * 32768;
-                break;
-              case endloopAddrsCoarseOffset:
-                split->endLoopOffset += igen[m].genAmount.shAmount * 32768;
-                break;
-              case keynum:
-                /*csound->Message(csound, "");*/
-                break;
-              case velocity:
-                /*csound->Message(csound, "");*/
-                break;
-              case exclusiveClass:
-                /*csound->Message(csound, "");*/
-                break;
+      else {
+        splitType *split;
+        split = &instru->split[ll];
+        if (GoverridingRootKey != UNUSE)
+          split->overridingRootKey = (BYTE) GoverridingRootKey;
+        if (GcoarseTune != UNUSE)
+          split->coarseTune = (BYTE) GcoarseTune;
+        if (GfineTune != UNUSE)
+          split->fineTune = (BYTE) GfineTune;
+        if (GscaleTuning != UNUSE)
+          split->scaleTuning = (BYTE) GscaleTuning;
+        if (Gpan != UNUSE)
+          split->pan = (BYTE) Gpan;
+        if (GsampleModes != UNUSE)
+          split->sampleModes = (BYTE) GsampleModes;
+        if (GinitialAttenuation != UNUSE)
+          split->initialAttenuation = (BYTE) GinitialAttenuation;
+
+        for (m=mStart; m < mEnd; m++) {
+          switch (igen[m].sfGenOper) {
+          case sampleID:
+            {
+              int num = igen[m].genAmount.wAmount;
+              split->num= num;
+              split->sample = &shdr[num];
+              if (UNLIKELY(split->sample->sfSampleType & 0x8000)) {
+                csound->Free(csound, instru->split);
+                instru->split = NULL;
+                instru->splits_num = 0;
+                return csound->InitError(csound,
+                                         Str("SoundFont file \"%s\" contains "
+                                             "ROM samples !\n"
+                                             "At present time only RAM samples "
+                                             "are allowed by sfload.\n"
+                                             "Session aborted !"),
+                                         soundFont->name);
               }
+              sglobal_zone = 0;
+              ll++;
             }
+            break;
+          case overridingRootKey:
+            split->overridingRootKey = (BYTE) igen[m].genAmount.wAmount;
+            break;
+          case coarseTune:
+            split->coarseTune = (char) igen[m].genAmount.shAmount;
+            break;
+          case fineTune:
+            split->fineTune = (char) igen[m].genAmount.shAmount;
+            break;
+          case scaleTuning:
+            split->scaleTuning = igen[m].genAmount.shAmount;
+            break;
+          case pan:
+            split->pan = igen[m].genAmount.shAmount;
+            break;
+          case sampleModes:
+            split->sampleModes = (BYTE) igen[m].genAmount.wAmount;
+            break;
+          case initialAttenuation:
+            split->initialAttenuation = igen[m].genAmount.shAmount;
+            break;
+          case keyRange:
+            split->minNoteRange = igen[m].genAmount.ranges.byLo;
+            split->maxNoteRange = igen[m].genAmount.ranges.byHi;
+            break;
+          case velRange:
+            split->minVelRange = igen[m].genAmount.ranges.byLo;
+            split->maxVelRange = igen[m].genAmount.ranges.byHi;
+            break;
+          case startAddrsOffset:
+            split->startOffset += igen[m].genAmount.shAmount;
+            break;
+          case endAddrsOffset:
+            split->endOffset += igen[m].genAmount.shAmount;
+            break;
+          case startloopAddrsOffset:
+            split->startLoopOffset += igen[m].genAmount.shAmount;
+            break;
+          case endloopAddrsOffset:
+            split->endLoopOffset += igen[m].genAmount.shAmount;
+            break;
+          case startAddrsCoarseOffset:
+            split->startOffset += igen[m].genAmount.shAmount * 32768;
+            break;
+          case endAddrsCoarseOffset:
+            split->endOffset += igen[m].genAmount.shAmount * 32768;
+            break;
+          case startloopAddrCoarseOffset:
+            split->startLoopOffset += igen[m].genAmount.shAmount * 32768;
+            break;
+          case endloopAddrsCoarseOffset:
+            split->endLoopOffset += igen[m].genAmount.shAmount * 32768;
+            break;
+          case keynum:
+            /*csound->Message(csound, "");*/
+            break;
+          case velocity:
+            /*csound->Message(csound, "");*/
+            break;
+          case exclusiveClass:
+            /*csound->Message(csound, "");*/
+            break;
           }
         }
       }
-    end_fill_layers:
-      soundFont->instr = instru;
     }
+    instru->loaded = 1;
     return OK;
 }
 
@@ -1998,6 +2073,35 @@ static void splitDefaults(splitType *split)
     split->pan                = 0;
 }
 
+/* Map the whole file instead of reading it: the sample data is then only */
+/* paged in as it is played, and the clean pages are shared with other    */
+/* instances and processes using the same SoundFont.  Big-endian builds   */
+/* byte swap everything in place, so they read the file as before.        */
+
+static int chunk_map(CSOUND *csound, FILE *fil, CHUNK *chunk)
+{
+#ifndef WORDS_BIGENDIAN
+    struct stat st;
+    BYTE *p;
+
+    if (fstat(fileno(fil), &st) != 0 || st.st_size < 12)
+      return 0;
+    p = (BYTE *) samplecache_map(csound, NULL, fileno(fil), 0,
+                                 (size_t) st.st_size, (size_t) st.st_size);
+    if (p == NULL)
+      return 0;
+    memcpy(chunk->ckID, p, 4);
+    memcpy(&chunk->ckSize, p + 4, 4);
+    if (chunk->ckSize > (DWORD) (st.st_size - 8))     /* truncated file */
+      chunk->ckSize = (DWORD) (st.st_size - 8);
+    chunk->ckDATA = p + 8;
+    return 1;
+#else
+    (void) csound; (void) fil; (void) chunk;
+    return 0;
+#endif
+}
+
 static int chunk_read(CSOUND *csound, FILE *fil, CHUNK *chunk)
 {
     if (UNLIKELY(4 != fread(chunk->ckID,1,4, fil)))
@@ -2249,6 +2353,8 @@ static int sflooper_init(CSOUND *csound, sflooper *p)
       return csound->InitError(csound, Str("sfplay: invalid or "
                                            "out-of-range preset number"));
     }
+    if (UNLIKELY(preset_load(csound, globals, preset) != OK))
+      return NOTOK;
     layersNum = preset->layers_num;
     for (j =0; j < layersNum; j++) {
       layerType *layer = &preset->layer[j];
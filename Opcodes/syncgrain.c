@@ -25,6 +25,7 @@
 #include "syncgrain.h"
 #include "soundio.h"
 #include "interlocks.h"
+#include <limits.h>
 
 /*
 #ifdef HAVE_VALUES_H
@@ -64,6 +65,12 @@ static int syncgrain_init(CSOUND *csound, syncgrain *p)
     size = (p->olaps) * sizeof(int);
     if (p->streamon.auxp == NULL || p->streamon.size < (unsigned int)size)
       csound->AuxAlloc(csound, size, &p->streamon);
+    /* room for the spans of a k-period, and their scheduling */
+    size = 2 * (p->olaps + CS_KSMPS) * sizeof(GRAINSPAN) +
+      (2 * p->olaps + (p->olaps > (int)CS_KSMPS ? p->olaps : CS_KSMPS) + 1) *
+      sizeof(int);
+    if (p->spans.auxp == NULL || p->spans.size < (unsigned int)size)
+      csound->AuxAlloc(csound, size, &p->spans);
 
     p->count = 0;                  /* sampling period counter */
 
@@ -78,9 +85,66 @@ static int syncgrain_init(CSOUND *csound, syncgrain *p)
     return OK;
 }
 
+/* sets out the span s of a grain */
+static inline void set_span(GRAINSPAN *s, int stream, int start, int end,
+                            double index, double envindex)
+{
+    s->stream = stream;
+    s->start = start;
+    s->end = end;
+    s->index = index;
+    s->envindex = envindex;
+}
+
+/* the last sample of the k-period, from sample n on, that a syncgrain
+   grain at envelope index e sounds at, or INT_MAX if it goes on: the
+   envelope index is stepped as the grain is rendered, and the grain is
+   finished once it reaches the table size */
+static int syncgrain_last(double e, MYFLT incr, int size, int n, int end)
+{
+    for ( ; n < end; n++)
+      if ((e += incr) >= size) return n;
+    return INT_MAX;
+}
+
+/* adds the grains of spans s[0..nspans) to out, one span after the
+   other, each over all of its samples, and leaves the indices of their
+   streams as at the end */
+static void syncgrain_render(MYFLT *out, const GRAINSPAN *s, int nspans,
+                             const MYFLT *datap, int datasize,
+                             const MYFLT *ftable, double *index,
+                             double *envindex, MYFLT pitch, MYFLT envincr)
+{
+    int     i, n, x0, e0;
+    double  ndx, endx;
+
+    for (i = 0; i < nspans; i++) {
+      if (s[i].start >= s[i].end) continue;
+      ndx = s[i].index;
+      endx = s[i].envindex;
+      for (n = s[i].start; n < s[i].end; n++) {
+        /* modulus */
+        while (UNLIKELY(ndx >= datasize))
+          ndx -= datasize;
+        while (UNLIKELY(ndx < 0))
+          ndx += datasize;
+        x0 = (int)ndx;
+        e0 = (int)endx;
+        /* sum all the grain streams */
+        out[n] += ((datap[x0] + (ndx - x0)*(datap[x0+1] - datap[x0])) *
+                   (ftable[e0] + (endx - e0)*(ftable[e0+1] - ftable[e0])));
+        /* increment the indexes */
+        ndx += pitch;
+        endx += envincr;
+      }
+      index[s[i].stream] = ndx;
+      envindex[s[i].stream] = endx;
+    }
+}
+
 static int syncgrain_process(CSOUND *csound, syncgrain *p)
 {
-    MYFLT   sig, pitch, amp, grsize, envincr, period, fperiod, prate;
+    MYFLT   pitch, amp, grsize, envincr, period, fperiod, prate;
     MYFLT   *output = p->output;
     MYFLT   *datap = p->sfunc->ftable;
     MYFLT   *ftable = p->efunc->ftable;
@@ -94,8 +158,15 @@ static int syncgrain_process(CSOUND *csound, syncgrain *p)
     uint32_t vecpos, vecsize=CS_KSMPS;
     int firststream = p->firststream;
     int     numstreams = p->numstreams, olaps = p->olaps;
-    int     count = p->count, j, newstream;
+    int     count = p->count, j, newstream, last, nspans = 0;
     int     datasize = p->datasize, envtablesize = p->envtablesize;
+    /* the spans as scheduled, and sorted by stream; for each stream the
+       sample its grain is finished at, and its latest span; the number
+       of grains finishing at each sample */
+    GRAINSPAN *span = (GRAINSPAN *) p->spans.auxp;
+    GRAINSPAN *sorted = span + olaps + CS_KSMPS;
+    int     *off = (int *) (sorted + olaps + CS_KSMPS);
+    int     *cur = off + olaps, *ends = cur + olaps;
 
     pitch  = *p->pitch;
     fperiod = FABS(CS_ESR/(*p->fr));
@@ -106,15 +177,31 @@ static int syncgrain_process(CSOUND *csound, syncgrain *p)
     envincr = envtablesize/grsize;
     prate = *p->prate;
 
-    if (UNLIKELY(offset)) memset(output, '\0', offset*sizeof(MYFLT));
-    if (UNLIKELY(early)) {
-      vecsize -= early;
-      memset(&output[vecsize], '\0', early*sizeof(MYFLT));
+    memset(output, '\0', CS_KSMPS*sizeof(MYFLT));
+    if (UNLIKELY(early)) vecsize -= early;
+    if (UNLIKELY(offset >= vecsize)) return OK;
+    memset(ends, 0, vecsize*sizeof(int));
+
+    /* the grains sounding on from the last k-period */
+    for (j = 0; j < olaps; j++) {
+      if (!streamon[j]) {
+        off[j] = offset;
+        continue;
+      }
+      last = syncgrain_last(envindex[j], envincr, envtablesize,
+                            offset, vecsize);
+      if (last != INT_MAX) ends[last]++;
+      off[j] = last != INT_MAX ? last + 1 : INT_MAX;
+      set_span(&span[nspans], j, offset,
+               last != INT_MAX ? last + 1 : (int)vecsize,
+               index[j], envindex[j]);
+      cur[j] = nspans++;
     }
+
+    /* schedule the grains of this k-period */
     for (vecpos = offset; vecpos < vecsize; vecpos++) {
-      sig = FL(0.0);
       /* if a grain has finished, clean up */
-      if (UNLIKELY((!streamon[firststream]) && (numstreams) )) {
+      if (UNLIKELY((off[firststream] <= (int)vecpos) && (numstreams) )) {
         //numstreams--; /* decrease the no of streams */
         firststream=(firststream+1)%olaps; /* first stream is the next */
       }
@@ -125,58 +212,48 @@ static int syncgrain_process(CSOUND *csound, syncgrain *p)
       if (count == 0 || count >= period) {
         if (count) frac = count - period; /* frac part to be accummulated */
         newstream =(firststream+numstreams)%olaps;
-        streamon[newstream] = 1; /* turn the stream on */
-        envindex[newstream] = 0.0;
+        /* a grain still sounding in the stream is cut short */
+        if (UNLIKELY(off[newstream] > (int)vecpos)) {
+          span[cur[newstream]].end = vecpos;
+          if (off[newstream] != INT_MAX) ends[off[newstream] - 1]--;
+        }
         envincrn[newstream]  = envtablesize/grsize;
-        index[newstream] = start;
+        last = syncgrain_last(0.0, envincr, envtablesize, vecpos, vecsize);
+        if (last != INT_MAX) ends[last]++;
+        off[newstream] = last != INT_MAX ? last + 1 : INT_MAX;
+        set_span(&span[nspans], newstream, vecpos,
+                 last != INT_MAX ? last + 1 : (int)vecsize, start, 0.0);
+        cur[newstream] = nspans++;
         numstreams++; /* increase the stream count */
         count = 0;
         start += prate*grsize;
         while (UNLIKELY(start >= datasize)) start-=datasize;
         while (UNLIKELY(start < 0)) start+=datasize;
       }
-
-      //for (i=numstreams,
-      //      j=firststream; i; i--, j=(j+1)%olaps) {
-      for(j=0; j < olaps; j++){
-        if(!streamon[j]) continue;
-
-        /* modulus */
-        while (UNLIKELY(index[j] >= datasize))
-          index[j] -= datasize;
-        while (UNLIKELY(index[j] < 0))
-          index[j] += datasize;
-
-       if (UNLIKELY(envindex[j] < envtablesize)){
-        /* sum all the grain streams */
-        sig += ((datap[(int)index[j]] +
-                 (index[j] - (int)index[j])*
-                 (datap[(int)index[j]+1] - datap[(int)index[j]])
-                 ) *
-                (ftable[(int)envindex[j]] +
-                 (envindex[j] - (int)envindex[j])*
-                 (ftable[(int)envindex[j]+1] - ftable[(int)envindex[j]])
-                 )
-                );
-        }
-        /* increment the indexes */
-        /* for each grain */
-        index[j] += pitch;
-        envindex[j] += envincr;
-
-        /* if the envelope is finished */
-        /* the grain is also finished */
-        if (UNLIKELY(envindex[j] >= envtablesize)) {
-          streamon[j] = 0;
-          numstreams--;
-        }
-      }
+      /* the grains whose envelopes finish here end their streams */
+      numstreams -= ends[vecpos];
 
       /* increment the period counter */
       count++;
-      /* scale the output */
-      output[vecpos] = sig*amp;
     }
+    for (j = 0; j < olaps; j++)
+      streamon[j] = off[j] == INT_MAX;
+
+    /* the streams are summed in order, so the grains are rendered
+       stream by stream */
+    memset(ends, 0, (olaps + 1)*sizeof(int));
+    for (j = 0; j < nspans; j++)
+      ends[span[j].stream + 1]++;
+    for (j = 0; j < olaps; j++)
+      ends[j + 1] += ends[j];
+    for (j = 0; j < nspans; j++)
+      sorted[ends[span[j].stream]++] = span[j];
+    syncgrain_render(output, sorted, nspans, datap, datasize, ftable,
+                     index, envindex, pitch, envincr);
+
+    /* scale the output */
+    for (vecpos = offset; vecpos < vecsize; vecpos++)
+      output[vecpos] *= amp;
 
     p->firststream = firststream;
     p->numstreams = numstreams;
@@ -224,12 +301,39 @@ static int syncgrainloop_init(CSOUND *csound, syncgrainloop *p)
     p->frac = 0.0f;
     p->firsttime = 1;
     }
+    /* room for the spans of a k-period, and their scheduling */
+    {
+      int size = (p->olaps + CS_KSMPS) * sizeof(GRAINSPAN) +
+        2 * p->olaps * sizeof(int);
+      if (p->spans.auxp == NULL || p->spans.size < (unsigned int)size)
+        csound->AuxAlloc(csound, size, &p->spans);
+    }
     return OK;
 }
 
+/* as syncgrain_last(), for syncloop, where a grain is finished once its
+   envelope index passes the table size; *off is set to the sample from
+   which it is, or INT_MAX. A grain whose index comes to the table size
+   exactly is no longer stepped or heard, but is not finished either. */
+static int syncloop_last(double e, MYFLT incr, int size, int n, int end,
+                         int *off)
+{
+    *off = INT_MAX;
+    if (!(e < size)) return n - 1;
+    for ( ; n < end; n++) {
+      e += incr;
+      if (e > size) {
+        *off = n + 1;
+        return n;
+      }
+      if (!(e < size)) return n;
+    }
+    return INT_MAX;
+}
+
 static int syncgrainloop_process(CSOUND *csound, syncgrainloop *p)
 {
-    MYFLT   sig, pitch, amp, grsize, envincr, period, fperiod, prate;
+    MYFLT   pitch, amp, grsize, envincr, period, fperiod, prate;
     MYFLT   *output = p->output;
     MYFLT   *datap = p->sfunc->ftable;
     MYFLT   *ftable = p->efunc->ftable;
@@ -242,13 +346,19 @@ static int syncgrainloop_process(CSOUND *csound, syncgrainloop *p)
     uint32_t vecpos, vecsize=CS_KSMPS;
     int      firststream = p->firststream;
     int     numstreams = p->numstreams, olaps = p->olaps;
-    int     count = p->count, i,j, newstream;
+    int     count = p->count, i,j, newstream, last, nspans = 0;
     int     datasize = p->datasize, envtablesize = p->envtablesize;
     int     loop_start;
     int     loop_end;
     int     loopsize;
     int     firsttime = p->firsttime;
     MYFLT   sr = CS_ESR;
+    /* the spans in the order the streams are summed, which is the order
+       the grains were started in; for each stream the sample its grain
+       is finished at, and its latest span */
+    GRAINSPAN *span = (GRAINSPAN *) p->spans.auxp;
+    int     *off = (int *) (span + olaps + CS_KSMPS);
+    int     *cur = off + olaps;
 
     /* loop points & checks */
     loop_start = (int) (*p->loop_start*sr);
@@ -270,15 +380,30 @@ static int syncgrainloop_process(CSOUND *csound, syncgrainloop *p)
     envincr = envtablesize/grsize;
     prate = *p->prate;
 
-    if (UNLIKELY(offset)) memset(output, '\0', offset*sizeof(MYFLT));
-    if (UNLIKELY(early)) {
-      vecsize -= early;
-      memset(&output[vecsize], '\0', early*sizeof(MYFLT));
+    memset(output, '\0', CS_KSMPS*sizeof(MYFLT));
+    if (UNLIKELY(early)) vecsize -= early;
+    if (UNLIKELY(offset >= vecsize)) return OK;
+
+    /* the grains sounding on from the last k-period */
+    for (j = 0; j < olaps; j++) {
+      off[j] = streamon[j] ? INT_MAX : (int)offset;
+      cur[j] = -1;
+    }
+    for (i = 0; i < numstreams; i++) {
+      j = (firststream + i) % olaps;
+      if (!streamon[j]) continue;
+      last = syncloop_last(envindex[j], envincr, envtablesize,
+                           offset, vecsize, &off[j]);
+      set_span(&span[nspans], j, offset,
+               last != INT_MAX ? last + 1 : (int)vecsize,
+               index[j], envindex[j]);
+      cur[j] = nspans++;
     }
+
+    /* schedule the grains of this k-period */
     for (vecpos = offset; vecpos < vecsize; vecpos++) {
-      sig = FL(0.0);
       /* if a grain has finished, clean up */
-      if (UNLIKELY((!streamon[firststream]) && (numstreams) )) {
+      if (UNLIKELY((off[firststream] <= (int)vecpos) && (numstreams) )) {
         numstreams--; /* decrease the no of streams */
         firststream=(firststream+1)%olaps; /* first stream is the next */
       }
@@ -288,10 +413,19 @@ static int syncgrainloop_process(CSOUND *csound, syncgrainloop *p)
       period = fperiod - frac;
       if (UNLIKELY(count == 0 || count >= period)) {
         if (count) frac = count - period; /* frac part to be accummulated */
+        /* with all streams taken, the oldest grain gives way */
+        if (UNLIKELY(numstreams >= olaps)) {
+          if (cur[firststream] >= 0 && span[cur[firststream]].end > (int)vecpos)
+            span[cur[firststream]].end = vecpos;
+          numstreams--;
+          firststream=(firststream+1)%olaps;
+        }
         newstream =(firststream+numstreams)%olaps;
-        streamon[newstream] = 1; /* turn the stream on */
-        envindex[newstream] = 0.0;
-        index[newstream] = start;
+        last = syncloop_last(0.0, envincr, envtablesize, vecpos, vecsize,
+                             &off[newstream]);
+        set_span(&span[nspans], newstream, vecpos,
+                 last != INT_MAX ? last + 1 : (int)vecsize, start, 0.0);
+        cur[newstream] = nspans++;
         numstreams++; /* increase the stream count */
         count = 0;
         start += prate*grsize;
@@ -306,50 +440,24 @@ static int syncgrainloop_process(CSOUND *csound, syncgrainloop *p)
         while (UNLIKELY(start < loop_start && !firsttime))
           start += loopsize;
       }
-      /* depending on pitch transpsition a
-         grain can extend beyond the loop points.
-         it will be wrapped up at the ends of the
-         table.
-       */
-      for (i=numstreams,
-             j=firststream; i; i--, j=(j+1)%olaps) {
-
-        /* modulus */
-        while (index[j] >= datasize)
-          index[j] -= datasize;
-        while(index[j] < 0)
-          index[j] += datasize;
-
-        if (UNLIKELY(envindex[j] < envtablesize)){
-
-          /* sum all the grain streams */
-          sig += ((datap[(int)index[j]] +
-                   (index[j] - (int)index[j])*
-                   (datap[(int)index[j]+1] - datap[(int)index[j]])
-                   ) *
-                  (ftable[(int)envindex[j]] +
-                   (envindex[j] - (int)envindex[j])*
-                   (ftable[(int)envindex[j]+1] - ftable[(int)envindex[j]])
-                   )
-                  );
-
-          /* increment the indexes */
-          /* for each grain */
-          index[j] += pitch;
-          envindex[j] += envincr;
-        }
-        /* if the envelope is finished */
-        /* the grain is also finished */
-
-        if (UNLIKELY(envindex[j] > envtablesize))
-          streamon[j] = 0;
-      }
 
       /* increment the period counter */
       count++;
-      /* scale the output */
-      output[vecpos] = sig*amp;
     }
+    for (j = 0; j < olaps; j++)
+      streamon[j] = off[j] == INT_MAX;
+
+    /* depending on pitch transpsition a
+       grain can extend beyond the loop points.
+       it will be wrapped up at the ends of the
+       table.
+     */
+    syncgrain_render(output, span, nspans, datap, datasize, ftable,
+                     index, envindex, pitch, envincr);
+
+    /* scale the output */
+    for (vecpos = offset; vecpos < vecsize; vecpos++)
+      output[vecpos] *= amp;
 
     p->firststream = firststream;
     p->numstreams = numstreams;
@@ -387,6 +495,7 @@ typedef struct _filegrain {
     AUXCH   streamon;
     AUXCH   index;
     AUXCH   envindex;
+    AUXCH   spans;
     float   start,frac;
     int     read1,read2;
     uint32  pos;
@@ -429,6 +538,11 @@ static int filegrain_init(CSOUND *csound, filegrain *p)
     size = (p->olaps) * sizeof(int);
     if (p->streamon.auxp == NULL || p->streamon.size < (unsigned int)size)
       csound->AuxAlloc(csound, size, &p->streamon);
+    /* room for the spans of a k-period, and their scheduling */
+    size = (p->olaps + CS_KSMPS) * sizeof(GRAINSPAN) +
+      2 * p->olaps * sizeof(int);
+    if (p->spans.auxp == NULL || p->spans.size < (unsigned int)size)
+      csound->AuxAlloc(csound, size, &p->spans);
     if (p->buffer.auxp == NULL ||
         p->buffer.size < (p->dataframes+1)*sizeof(MYFLT)*p->nChannels)
       csound->AuxAlloc(csound,
@@ -474,13 +588,80 @@ static int filegrain_init(CSOUND *csound, filegrain *p)
     return OK;
 }
 
+/* the sample from which a diskgrain grain at envelope index e, stepped
+   from sample n on, is finished, as its index passes the table size, or
+   INT_MAX if it is not in this k-period */
+static int filegrain_off(double e, MYFLT incr, int size, int n, int end)
+{
+    for ( ; n < end; n++)
+      if ((e += incr) > size) return n + 1;
+    return INT_MAX;
+}
+
+/* adds the grains of spans s[0..nspans) to the outputs as
+   syncgrain_render() does, but only up to sample until, where the file is
+   read into the buffer the grains play from. The spans going on past that
+   sample are kept, from there on, and their number returned. */
+static int filegrain_render(filegrain *p, GRAINSPAN *s, int nspans,
+                            int *cur, int until, MYFLT pitch, MYFLT envincr)
+{
+    MYFLT   *output[DGRAIN_MAXCHAN];
+    MYFLT   *datap = (MYFLT *) p->buffer.auxp;
+    MYFLT   *ftable = p->efunc->ftable;
+    double  *index = (double *) p->index.auxp;
+    double  *envindex = (double *) p->envindex.auxp;
+    int     dataframes = p->dataframes, chans = p->nChannels;
+    int     i, k, n, end, tndx, endx, kept = 0;
+    double  ndx, envndx, frac, env;
+
+    for (n=0; n < chans; n++)
+      output[n] = p->output[n];
+
+    for (i = 0; i < nspans; i++) {
+      end = s[i].end < until ? s[i].end : until;
+      if (s[i].start < end) {
+        ndx = s[i].index;
+        envndx = s[i].envindex;
+        for (k = s[i].start; k < end; k++) {
+          /* modulus */
+          if (ndx >= dataframes)
+            ndx -= dataframes;
+          if (ndx  < 0)
+            ndx += dataframes;
+
+          /* sum all the grain streams */
+          tndx = (int)ndx*chans;
+          endx = (int) envndx;
+          frac = ndx - (int)ndx;
+          env = ftable[endx] + (envndx - endx)*(ftable[endx+1] - ftable[endx]);
+          for (n=0; n < chans; n++)
+            output[n][k] += ((datap[tndx+n] +
+                              frac*(datap[tndx+n+chans] - datap[tndx+n])) *
+                             env);
+
+          /* increment the indexes */
+          /* for each grain */
+          ndx += (pitch);
+          envndx += envincr;
+        }
+        s[i].start = end;
+        s[i].index = index[s[i].stream] = ndx;
+        s[i].envindex = envindex[s[i].stream] = envndx;
+      }
+      if (s[i].end > until) {
+        s[kept] = s[i];
+        cur[s[kept].stream] = kept;
+        kept++;
+      }
+    }
+    return kept;
+}
+
 static int filegrain_process(CSOUND *csound, filegrain *p)
 {
-    MYFLT   sig[DGRAIN_MAXCHAN], pitch, amp, grsize, envincr, period,
-            fperiod, prate;
+    MYFLT   pitch, amp, grsize, envincr, period, fperiod, prate;
     MYFLT   **output = p->output;
     MYFLT   *datap = (MYFLT *) p->buffer.auxp;
-    MYFLT   *ftable = p->efunc->ftable;
     int     *streamon = (int *) p->streamon.auxp;
     float   start = p->start, frac = p->frac, jump;
     double  *index = (double *) p->index.auxp;
@@ -494,12 +675,15 @@ static int filegrain_process(CSOUND *csound, filegrain *p)
     int     datasize, hdatasize, envtablesize = p->envtablesize;
     int     dataframes = p->dataframes, hdataframes = p->dataframes/2;
     int     read1 = p->read1, read2 = p->read2;
-    int     items, chans = p->nChannels, tndx,endx,n;
+    int     items, chans = p->nChannels, n;
     uint32  pos = p->pos;
     int32   negpos, flen = p->flen;
     float   trigger = p->trigger, incr;
-
-    memset(sig, 0, DGRAIN_MAXCHAN*sizeof(MYFLT));
+    /* the spans in the order the streams are summed, as for syncloop */
+    GRAINSPAN *span = (GRAINSPAN *) p->spans.auxp;
+    int     *off = (int *) (span + olaps + CS_KSMPS);
+    int     *cur = off + olaps;
+    int     nspans = 0;
 
     datasize = dataframes*chans;
     hdatasize = hdataframes*chans;
@@ -514,15 +698,29 @@ static int filegrain_process(CSOUND *csound, filegrain *p)
     envincr = envtablesize/grsize;
     prate = *p->prate;
 
-    if (UNLIKELY(offset)) memset(output, '\0', offset*sizeof(MYFLT));
-    if (UNLIKELY(early)) {
-      vecsize -= early;
-      memset(&output[vecsize], '\0', early*sizeof(MYFLT));
+    for (n=0; n < chans; n++)
+      memset(output[n], '\0', CS_KSMPS*sizeof(MYFLT));
+    if (UNLIKELY(early)) vecsize -= early;
+    if (UNLIKELY(offset >= vecsize)) return OK;
+
+    /* the grains sounding on from the last k-period; those finished
+       play on while they wait their turn to leave */
+    for (j = 0; j < olaps; j++)
+      off[j] = streamon[j] ? INT_MAX : (int)offset;
+    for (i = 0; i < numstreams; i++) {
+      j = (firststream + i) % olaps;
+      if (streamon[j])
+        off[j] = filegrain_off(envindex[j], envincr, envtablesize,
+                               offset, vecsize);
+      set_span(&span[nspans], j, offset, vecsize, index[j], envindex[j]);
+      cur[j] = nspans++;
     }
+
+    /* schedule the grains of this k-period */
     for (vecpos = offset; vecpos < vecsize; vecpos++) {
-      /* sig = (MYFLT) 0; */
       /* if a grain has finished, clean up */
-      if (UNLIKELY((!streamon[firststream]) && (numstreams) )) {
+      if (UNLIKELY((off[firststream] <= (int)vecpos) && (numstreams) )) {
+        span[cur[firststream]].end = vecpos;
         numstreams--; /* decrease the no of streams */
         firststream=(firststream+1)%olaps; /* first stream is the next */
       }
@@ -531,10 +729,17 @@ static int filegrain_process(CSOUND *csound, filegrain *p)
       period = fperiod - frac;
       if (count ==0  || count >= period) {
         if (count) frac = count - period;
+        /* with all streams taken, the oldest grain gives way */
+        if (UNLIKELY(numstreams >= olaps)) {
+          span[cur[firststream]].end = vecpos;
+          numstreams--;
+          firststream=(firststream+1)%olaps;
+        }
         newstream =(firststream+numstreams)%olaps;
-        streamon[newstream] = 1;
-        envindex[newstream] = 0.0;
-        index[newstream] = start;
+        off[newstream] = filegrain_off(0.0, envincr, envtablesize,
+                                       vecpos, vecsize);
+        set_span(&span[nspans], newstream, vecpos, vecsize, start, 0.0);
+        cur[newstream] = nspans++;
         numstreams++;
         count = 0;
         incr = prate*grsize;
@@ -547,6 +752,10 @@ static int filegrain_process(CSOUND *csound, filegrain *p)
             trigger -= (dataframes);
 
             if (!read1) {
+              /* the grains so far are heard before the buffer changes */
+              nspans = filegrain_render(p, span, nspans, cur, vecpos,
+                                        pitch, envincr);
+
               pos += hdataframes;
               sf_seek(p->sf,pos,SEEK_SET);
 
@@ -565,6 +774,9 @@ static int filegrain_process(CSOUND *csound, filegrain *p)
           else if (trigger >= (hdataframes - jump)) {
 
             if (!read2) {
+              /* the grains so far are heard before the buffer changes */
+              nspans = filegrain_render(p, span, nspans, cur, vecpos,
+                                        pitch, envincr);
 
               pos += hdataframes;
               sf_seek(p->sf,pos,SEEK_SET);
@@ -585,6 +797,9 @@ static int filegrain_process(CSOUND *csound, filegrain *p)
           if (trigger < jump) {
             trigger += (dataframes);
             if (!read1) {
+              /* the grains so far are heard before the buffer changes */
+              nspans = filegrain_render(p, span, nspans, cur, vecpos,
+                                        pitch, envincr);
 
               /*this roundabout code is to
                 allow us to use an unsigned long
@@ -622,6 +837,9 @@ static int filegrain_process(CSOUND *csound, filegrain *p)
           }
           else if (trigger <= (hdataframes + jump)) {
             if (!read2) {
+              /* the grains so far are heard before the buffer changes */
+              nspans = filegrain_render(p, span, nspans, cur, vecpos,
+                                        pitch, envincr);
 
               negpos = pos;
               negpos -= hdataframes;
@@ -653,51 +871,18 @@ static int filegrain_process(CSOUND *csound, filegrain *p)
         if (start < 0) start += dataframes;
       }
 
-      for (i=numstreams,
-             j=firststream; i; i--, j=(j+1)%olaps) {
-
-        /* modulus */
-        if (index[j] >= dataframes)
-          index[j] -= dataframes;
-        if (index[j]  < 0)
-          index[j] += dataframes;
-
-        /* sum all the grain streams */
-        tndx = (int)index[j]*chans;
-        endx = (int) envindex[j];
-        /* sig[0] = sig[1] = sig[2] = sig[3] = 0.0; */
-        for (n=0; n < chans; n++) {
-
-          sig[n] += ((datap[tndx+n] +
-                      (index[j] - (int)index[j])*
-                      (datap[tndx+n+chans] - datap[tndx+n])
-                      ) *
-                     (ftable[endx] +
-                      (envindex[j] - endx)*
-                      (ftable[endx+1] - ftable[endx])
-                      )
-                     );
-        }
-
-        /* increment the indexes */
-        /* for each grain */
-        index[j] += (pitch);
-        envindex[j] += envincr;
-
-        /* if the envelope is finished */
-        /* the grain is also finished */
-        if (envindex[j] > envtablesize)
-          streamon[j] = 0;
-      }
-
       /* increment the period counter */
       count++;
-      /* scale the output */
-      for (n=0; n < chans; n++) {
-        output[n][vecpos] = sig[n]*amp;
-        sig[n] = 0;
-      }
     }
+    for (j = 0; j < olaps; j++)
+      streamon[j] = off[j] == INT_MAX;
+
+    (void) filegrain_render(p, span, nspans, cur, vecsize, pitch, envincr);
+
+    /* scale the output */
+    for (n=0; n < chans; n++)
+      for (vecpos = offset; vecpos < vecsize; vecpos++)
+        output[n][vecpos] *= amp;
 
     p->firststream = firststream;
     p->numstreams = numstreams;
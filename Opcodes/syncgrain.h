@@ -103,6 +103,17 @@ istart - start position (in secs), defaults to 0.
 #ifndef _SYNCGRAIN_H
 #define _SYNCGRAIN_H
 
+/* a grain as it sounds in one k-period: the stream it plays in, the
+   samples start to end (excl.) over which it is rendered, and its table
+   and envelope indices at start. The grain streams are scheduled for the
+   whole k-period first, as spans, and each span is then rendered in one
+   go, rather than all streams taking a turn at every sample. */
+typedef struct {
+    int     stream;
+    int     start, end;
+    double  index, envindex;
+} GRAINSPAN;
+
 typedef struct _syncgrain {
     OPDS h;
     MYFLT *output;
@@ -122,6 +133,7 @@ typedef struct _syncgrain {
     AUXCH index;
     AUXCH envindex;
     AUXCH envincr;
+    AUXCH spans;
     float start,frac;
 } syncgrain;
 
@@ -147,6 +159,7 @@ typedef struct _syncgrainl {
     AUXCH streamon;
     AUXCH index;
     AUXCH envindex;
+    AUXCH spans;
     float start,frac;
     int firsttime;
 } syncgrainloop;
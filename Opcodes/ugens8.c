@@ -26,7 +26,7 @@
 
 /* RWD 10:9:2000 read pvocex file format */
 #include "pvfileio.h"
-static int pvx_loadfile(CSOUND *, const char *, PVOC *);
+static int pvx_loadfile(CSOUND *, const char *, PVOC *, int);
 
 /********************************************/
 /* Originated by Dan Ellis, MIT             */
@@ -55,7 +55,10 @@ int pvset_(CSOUND *csound, PVOC *p, int stringname)
     }
     else strncpy(pvfilnam, ((STRINGDAT *)p->ifilno)->data, MAXNAME-1);
 
-    if (UNLIKELY(pvx_loadfile(csound, pvfilnam, p) != OK))
+    /* spectral extraction and gating need the whole file, else stream it */
+    if (UNLIKELY(pvx_loadfile(csound, pvfilnam, p,
+                              !(*p->imode == 1 || *p->imode == 2 ||
+                                *p->igatefun > 0)) != OK))
       return NOTOK;
 
     memsize = (int32) (PVDATASIZE + PVFFTSIZE * 3 + PVWINLEN);
@@ -125,6 +128,8 @@ int pvset_(CSOUND *csound, PVOC *p, int stringname)
     /* for (i=0; i< pvfrsiz(p); ++i) */
     /*   p->outBuf[i] = FL(0.0); */
     MakeSinc(p->pp);                    /* sinctab is same for all instances */
+    csound->RealFFT2Release(csound, p->setup);
+    p->setup = csound->RealFFT2Setup(csound, pvfrsiz(p), FFT_INV);
 
     if (p->memenv.auxp == NULL || p->memenv.size < pvdasiz(p)*sizeof(MYFLT))
         csound->AuxAlloc(csound, pvdasiz(p) * sizeof(MYFLT), &p->memenv);
@@ -174,7 +179,13 @@ int pvoc(CSOUND *csound, PVOC *p)
         csound->Warning(csound, Str("PVOC ktimpnt truncated to last frame"));
       }
     }
-    FetchIn(p->frPtr, buf, size, frIndx);
+    if (p->stream != NULL) {
+      int32 base = (int32) frIndx;
+      FetchIn(csound->PVOCEX_StreamFrame(csound, p->stream, base),
+              buf, size, frIndx - (MYFLT) base);
+    }
+    else
+      FetchIn(p->frPtr, buf, size, frIndx);
 
     if (*p->igatefun > 0)
       PvAmpGate(buf,size, p->AmpGateFunc, p->PvMaxAmp);
@@ -189,7 +200,7 @@ int pvoc(CSOUND *csound, PVOC *p)
         PreWarpSpec(buf, asize, pex, (MYFLT *)p->memenv.auxp);
      }
 
-    Polar2Real_PVOC(csound, buf, size);
+    Polar2Real_PVOC(csound, buf, size, p->setup);
 
     if (pex != FL(1.0))
       UDSample(p->pp, buf, (FL(0.5) * ((MYFLT) size - pex * (MYFLT) buf2Size)),
@@ -237,11 +248,29 @@ int pvoc(CSOUND *csound, PVOC *p)
 
   this version applies scaling to match  existing  pvanal format
  */
-static int pvx_loadfile(CSOUND *csound, const char *fname, PVOC *p)
+static int pvx_stream_deinit(CSOUND *csound, void *p_)
+{
+    PVOC  *p = (PVOC*) p_;
+
+    csound->PVOCEX_CloseStream(csound, p->stream);
+    p->stream = NULL;
+    return OK;
+}
+
+static int pvx_loadfile(CSOUND *csound, const char *fname, PVOC *p,
+                        int stream)
 {
     PVOCEX_MEMFILE  pp;
 
-    if (UNLIKELY(csound->PVOCEX_LoadFile(csound, fname, &pp) != 0)) {
+    if (p->stream != NULL)
+      pvx_stream_deinit(csound, p);
+    if (stream) {
+      if (UNLIKELY((p->stream = csound->PVOCEX_OpenStream(csound, fname,
+                                                          &pp)) == NULL))
+        return csound->InitError(csound, Str("PVOC cannot load %s"), fname);
+      csound->RegisterDeinitCallback(csound, p, pvx_stream_deinit);
+    }
+    else if (UNLIKELY(csound->PVOCEX_LoadFile(csound, fname, &pp) != 0)) {
       return csound->InitError(csound, Str("PVOC cannot load %s"), fname);
     }
     /* fft size must be <= PVFRAMSIZE (=8192) for Csound */
@@ -61,6 +61,7 @@ typedef struct {
     MYFLT   frPktim, frPrtim, scale, asr, lastPex;
     MYFLT   PvMaxAmp;
     float   *frPtr, *pvcopy;
+    void    *stream;    /* PVOC-EX stream, if not loaded whole */
     FUNC    *AmpGateFunc;
     AUXCH   auxch;
     MYFLT   *lastPhase; /* [PVDATASIZE] Keep track of cum. phase */
@@ -71,6 +72,7 @@ typedef struct {
     MYFLT   *dsputil_env;
     AUXCH   memenv;
     PVOC_GLOBALS  *pp;
+    void    *setup;     /* inverse FFT */
 } PVOC;
 
 #endif
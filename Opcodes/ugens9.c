@@ -25,6 +25,7 @@
 #include <math.h>
 #include "convolve.h"
 #include "ugens9.h"
+#include "irspec.h"
 #include "soundio.h"
 
 static int cvset_(CSOUND *csound, CONVOLVE *p, int stringname)
@@ -138,7 +139,9 @@ static int cvset_(CSOUND *csound, CONVOLVE *p, int stringname)
     p->incount = 0;
     p->obufend = p->outbuf + obufsiz - 1;
     p->outhead = p->outail = p->outbuf;
+    csound->RealFFT2Release(csound, p->fwdsetup);
     p->fwdsetup = csound->RealFFT2Setup(csound, Hlenpadded, FFT_FWD);
+    csound->RealFFT2Release(csound, p->invsetup);
     p->invsetup = csound->RealFFT2Setup(csound, Hlenpadded, FFT_INV);
     return OK;
 }
@@ -376,6 +379,17 @@ static int convolve(CSOUND *csound, CONVOLVE *p)
    allow this opcode to accept .con files.
    -ma++ april 2004 */
 
+/* the cached partition spectra are let go of at the end of the note */
+
+static int pconv_deinit(CSOUND *csound, void *pp)
+{
+    PCONVOLVE *p = (PCONVOLVE *) pp;
+
+    irspec_release(csound, p->spec);
+    p->spec = NULL;
+    return OK;
+}
+
 static int pconvset_(CSOUND *csound, PCONVOLVE *p, int stringname)
 {
     int     channel = (*(p->channel) <= 0 ? ALLCHNLS : (int) *(p->channel));
@@ -386,6 +400,7 @@ static int pconvset_(CSOUND *csound, PCONVOLVE *p, int stringname)
     MYFLT   *IRblock;
     MYFLT   ainput_dur, scaleFac;
     MYFLT   partitionSize;
+    IRSPEC  key;
 
     /* IV - 2005-04-06: fixed bug: was uninitialised */
     memset(&IRfile, 0, sizeof(SOUNDIN));
@@ -403,6 +418,43 @@ static int pconvset_(CSOUND *csound, PCONVOLVE *p, int stringname)
     if (UNLIKELY(channel < 1 || ((channel > 4) && (channel != ALLCHNLS)))) {
       return csound->InitError(csound, Str("channel request %d illegal"), channel);
     }
+
+    /* make sure the partition size is nonzero and a power of 2  */
+    if (*p->partitionSize <= 0)
+      partitionSize = csound->oparms->outbufsamps / csound->GetNchnls(csound);
+    else
+      partitionSize = *p->partitionSize;
+
+    p->Hlen = 1;
+    while (p->Hlen < partitionSize)
+      p->Hlen <<= 1;
+
+    p->Hlenpadded = 2*p->Hlen;
+
+    /* the partition spectra of a file already analysed with this
+       partition length are taken from the cache */
+    memset(&key, 0, sizeof(IRSPEC));
+    key.kind = IRSPEC_PCONVOLVE;
+    key.name = IRfile.sfname;
+    key.partSize = p->Hlen;
+    key.channel = channel;
+    irspec_release(csound, p->spec);
+    p->spec = irspec_find(csound, &key);
+    if (p->spec != NULL) {
+      p->nchanls = p->spec->nChannels;
+      p->numPartitions = p->spec->nPartitions;
+      if (UNLIKELY(p->nchanls != (int)p->OUTOCOUNT)) {
+        return csound->InitError(csound, Str("PCONVOLVE: number of output "
+                                             "channels not equal to input "
+                                             "channels"));
+      }
+      csound->RealFFT2Release(csound, p->fwdsetup);
+      p->fwdsetup = csound->RealFFT2Setup(csound,p->Hlenpadded, FFT_FWD);
+      csound->RealFFT2Release(csound, p->invsetup);
+      p->invsetup = csound->RealFFT2Setup(csound,p->Hlenpadded, FFT_INV);
+      goto bufs;
+    }
+
     IRfile.channel = channel;
     IRfile.analonly = 1;
     if (UNLIKELY((infd = csound->sndgetset(csound, &IRfile)) == NULL)) {
@@ -434,37 +486,32 @@ static int pconvset_(CSOUND *csound, PCONVOLVE *p, int stringname)
       csound->Warning(csound, Str("IR srate != orch's srate"));
     }
 
-    /* make sure the partition size is nonzero and a power of 2  */
-    if (*p->partitionSize <= 0)
-      partitionSize = csound->oparms->outbufsamps / csound->GetNchnls(csound);
-    else
-      partitionSize = *p->partitionSize;
-
-    p->Hlen = 1;
-    while (p->Hlen < partitionSize)
-      p->Hlen <<= 1;
-
-    p->Hlenpadded = 2*p->Hlen;
-
     /* determine the number of partitions */
     p->numPartitions = CEIL((MYFLT)(IRfile.getframes) / (MYFLT)p->Hlen);
 
     /* set up FFT tables */
     inbuf = (MYFLT *) csound->Malloc(csound,
                                      p->Hlen * p->nchanls * sizeof(MYFLT));
-    csound->AuxAlloc(csound, p->numPartitions * (p->Hlenpadded + 2) *
-             sizeof(MYFLT) * p->nchanls, &p->H);
-    IRblock = (MYFLT *)p->H.auxp;
+    p->spec = irspec_new(csound, &key, (size_t) p->numPartitions *
+                         (p->Hlenpadded + 2) * p->nchanls);
+    p->spec->nChannels = p->nchanls;
+    p->spec->nPartitions = p->numPartitions;
+    IRblock = p->spec->data;
+    csound->RealFFT2Release(csound, p->fwdsetup);
     p->fwdsetup = csound->RealFFT2Setup(csound,p->Hlenpadded, FFT_FWD);
+    csound->RealFFT2Release(csound, p->invsetup);
     p->invsetup = csound->RealFFT2Setup(csound,p->Hlenpadded, FFT_INV);
     /* form each partition and take its FFT */
     for (part = 0; part < p->numPartitions; part++) {
       /* get the block of input samples and normalize -- soundin code
          handles finding the right channel */
       if (UNLIKELY((read_in = csound->getsndin(csound, infd, inbuf,
-                                               p->Hlen*p->nchanls, &IRfile)) <= 0))
+                                               p->Hlen*p->nchanls, &IRfile)) <= 0)) {
+        irspec_release(csound, p->spec);
+        p->spec = NULL;
         return csound->InitError(csound,
                                  Str("PCONVOLVE: less sound than expected!"));
+      }
 
       /* take FFT of each channel */
       scaleFac = csound->dbfs_to_float
@@ -486,7 +533,9 @@ static int pconvset_(CSOUND *csound, PCONVOLVE *p, int stringname)
 
     csound->Free(csound, inbuf);
     csound->FileClose(csound, IRfile.fd);
+    irspec_insert(csound, p->spec);
 
+ bufs:
     /* allocate the buffer saving recent input samples */
     csound->AuxAlloc(csound, p->Hlen * sizeof(MYFLT), &p->savedInput);
     p->inCount = 0;
@@ -518,6 +567,7 @@ static int pconvset_(CSOUND *csound, PCONVOLVE *p, int stringname)
       p->outCount = 0;
       p->outWrite = p->outRead;
     }
+    csound->RegisterDeinitCallback(csound, p, pconv_deinit);
     return OK;
 }
 
@@ -549,7 +599,7 @@ static int pconvolve(CSOUND *csound, PCONVOLVE *p)
       if (count == p->Hlen) {
         MYFLT *dest = (MYFLT*) p->convBuf.auxp
                       + p->curPart * (p->Hlenpadded + 2) * p->nchanls;
-        MYFLT *h = (MYFLT*) p->H.auxp;
+        MYFLT *h = p->spec->data;
         MYFLT *workBuf = (MYFLT*) p->workBuf.auxp;
 
         /* FFT the input (to create X) */
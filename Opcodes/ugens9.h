@@ -48,7 +48,7 @@ typedef struct {
     int32    Hlen, Hlenpadded;
     int     nchanls;    /* number of channels we are actually processing */
 
-    AUXCH   H;                  /* array of Impulse Responses */
+    struct IRSPEC_ *spec;       /* array of Impulse Responses (cached) */
 
     AUXCH   savedInput; /* the last Hlen input samps for overlap-save method */
     int32   inCount;    /* index to write to savedInput */
@@ -162,6 +162,15 @@ int ktablexseg(CSOUND *csound, TABLESEG *p)
 #define WLN   1         /* time window is WLN*2*ksmps long */
 #define OPWLEN (2*WLN*CS_KSMPS)    /* manifest used for final time wdw */
 
+static int vpv_stream_deinit(CSOUND *csound, void *p_)
+{
+    VPVOC *p = (VPVOC*) p_;
+
+    csound->PVOCEX_CloseStream(csound, p->stream);
+    p->stream = NULL;
+    return OK;
+}
+
 int vpvset_(CSOUND *csound, VPVOC *p, int stringname)
 {
     unsigned int      i;
@@ -206,8 +215,12 @@ int vpvset_(CSOUND *csound, VPVOC *p, int stringname)
     }
     else strncpy(pvfilnam, ((STRINGDAT *)p->ifilno)->data, MAXNAME-1);
 
-    if (UNLIKELY(csound->PVOCEX_LoadFile(csound, pvfilnam, &pp) != 0))
+    if (p->stream != NULL)
+      vpv_stream_deinit(csound, p);
+    if (UNLIKELY((p->stream = csound->PVOCEX_OpenStream(csound, pvfilnam,
+                                                        &pp)) == NULL))
       return csound->InitError(csound, Str("VPVOC cannot load %s"), pvfilnam);
+    csound->RegisterDeinitCallback(csound, p, vpv_stream_deinit);
 
     p->frSiz = pp.fftsize;
     frInc    = pp.overlap;
@@ -268,6 +281,8 @@ int vpvset_(CSOUND *csound, VPVOC *p, int stringname)
     /* for (i = 0; i < pvfrsiz(p); ++i) */
     /*   p->outBuf[i] = FL(0.0); */
     MakeSinc(p->pp);                    /* sinctab is same for all instances */
+    csound->RealFFT2Release(csound, p->setup);
+    p->setup = csound->RealFFT2Setup(csound, pvfrsiz(p), FFT_INV);
     if (p->memenv.auxp == NULL || p->memenv.size < pvdasiz(p)*sizeof(MYFLT))
         csound->AuxAlloc(csound, pvdasiz(p) * sizeof(MYFLT), &p->memenv);
     return OK;
@@ -322,7 +337,11 @@ int vpvoc(CSOUND *csound, VPVOC *p)
       }
     }
 
-    FetchIn(p->frPtr, buf, size, frIndx);
+    {
+      int32 base = (int32) frIndx;
+      FetchIn(csound->PVOCEX_StreamFrame(csound, p->stream, base),
+              buf, size, frIndx - (MYFLT) base);
+    }
 
 /**** Apply "spectral envelope" to magnitudes ********/
     if (pex > FL(1.0))
@@ -347,7 +366,7 @@ int vpvoc(CSOUND *csound, VPVOC *p)
       if (specwp > 0)
         PreWarpSpec(buf, asize, pex, (MYFLT *)p->memenv.auxp);
 
-      Polar2Real_PVOC(csound, buf, size);
+      Polar2Real_PVOC(csound, buf, size, p->setup);
 
       if (pex != FL(1.0))
         UDSample(p->pp, buf,
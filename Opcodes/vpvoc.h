@@ -45,6 +45,7 @@ typedef struct {
     /* base Frame (in frameData0) and maximum frame on file, ptr to fr, size */
     MYFLT   frPktim, frPrtim, asr, scale, lastPex;
     float   *frPtr;
+    void    *stream;    /* PVOC-EX stream */
     /* asr is analysis sample rate */
     /* fft frames per k-time (equals phase change expansion factor) */
     AUXCH   auxch;          /* manage AUXDS for the following 5 buffer spaces */
@@ -56,6 +57,7 @@ typedef struct {
     TABLESEG *tableseg;
     AUXCH   auxtab;         /* For table is all else fails */
     PVOC_GLOBALS  *pp;
+    void    *setup;     /* inverse FFT */
     AUXCH memenv;
 } VPVOC;
 
@@ -277,6 +277,7 @@ static const char *longUsageList[] = {
   Str_noop("\t\t\tvelocity number to pfield N as amplitude"),
   Str_noop("--no-default-paths\tTurn off relative paths from CSD/ORC/SCO"),
   Str_noop("--sample-accurate\t\tUse sample-accurate timing of score events"),
+  Str_noop("--simd-align\t\tAlign and pad a-rate variables for vector code"),
   Str_noop("--realtime\t\trealtime priority mode"),
   Str_noop("--nchnls=N\t\t override number of audio channels"),
   Str_noop("--nchnls_i=N\t\t override number of input audio channels"),
@@ -1025,6 +1026,10 @@ static int decode_long(CSOUND *csound, char *s, int argc, char **argv)
       O->sampleAccurate = 1;
       return 1;
     }
+    else if (!(strcmp(s, "simd-align"))) {
+      O->simd_align = 1;
+      return 1;
+    }
     else if (!(strcmp(s, "realtime"))) {
       csound->Message(csound, Str("realtime mode enabled\n"));
       O->realtime = 1;
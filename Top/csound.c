@@ -479,11 +479,27 @@ static const CSOUND cenviron_ = {
     csoundRealFFT2,
     fterror,
     csoundGetA4,
+    csoundAcquireWriteCircularBuffer,
+    csoundCommitWriteCircularBuffer,
+    csoundAcquireReadCircularBuffer,
+    csoundCommitReadCircularBuffer,
+    PVOCEX_OpenStream,
+    PVOCEX_StreamFrame,
+    PVOCEX_CloseStream,
+    csoundSampleFromMYFLT,
+    csoundSampleToMYFLT,
+    csoundInterleaveFloat,
+    csoundDeinterleaveFloat,
+    csoundAddDither,
+    csoundSetDriverPaced,
+    csoundDriverPerform,
+    csoundMidiInTimestamp,
+    csoundRealFFT2Release,
+    csoundFTReAlloc,
     {
       NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
       NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-      NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-      NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+      NULL,
     },
     /* ------- private data (not to be used by hosts or externals) ------- */
     /* callback function pointers */
@@ -674,9 +690,8 @@ static const CSOUND cenviron_ = {
     NULL,           /*  FFT_table_2         */
     NULL, NULL, NULL, /* tseg, tpsave, tplim */
     (MYFLT*) NULL,  /*  gbloffbas           */
-    NULL,           /* file_io_thread    */
+    NULL,           /* file_io_service */
     0,              /* file_io_start   */
-    NULL,           /* file_io_threadlock */
     0,              /* realtime_audio_flag */
     NULL,           /* init pass thread */
     0,              /* init pass loop  */
@@ -741,6 +756,7 @@ static const CSOUND cenviron_ = {
     //NULL,           /*  musmonGlobals       */
     {
       NULL,         /*  outfile             */
+      NULL,         /*  outfd               */
       NULL,         /*  infile              */
       NULL,         /*  sfoutname;          */
       NULL,         /*  inbuf               */
@@ -754,7 +770,7 @@ static const CSOUND cenviron_ = {
       0,0,          /*  pipdevin, pipdevout */
       1U,           /*  nframes             */
       NULL, NULL,   /*  pin, pout           */
-      0,            /*dither                */
+      {0},          /*dither                */
     },
     0,              /*  warped              */
     0,              /*  sstrlen             */
@@ -776,6 +792,7 @@ static const CSOUND cenviron_ = {
     NULL,           /*  open_files          */
     NULL,           /*  searchPathCache     */
     NULL,           /*  sndmemfiles         */
+    NULL,           /*  memfile_index       */
     NULL,           /*  reset_list          */
     NULL,           /*  pvFileTable         */
     0,              /*  pvNumFiles          */
@@ -848,7 +865,8 @@ static const CSOUND cenviron_ = {
       0,            /*    no exit on compile error */
       0.4,          /*    vbr quality  */
       0,            /*    ksmps_override */
-      0             /*    fft_lib */
+      0,            /*    fft_lib */
+      0             /*    simd_align */
     },
 
     {0, 0, {0}}, /* REMOT_BUF */
@@ -1206,6 +1224,7 @@ PUBLIC CSOUND *csoundCreate(void *hostdata)
     csoundUnLock();
     csoundReset(csound);
     csound->API_lock = csoundCreateMutex(1);
+    csound->fftPlanLock = csoundCreateMutex(0);
     /* NB: as suggested by F Pinot, keep the
        address of the pointer to CSOUND inside
        the struct, so it can be cleared later */
@@ -1282,6 +1301,8 @@ PUBLIC void csoundDestroy(CSOUND *csound)
       //csoundLockMutex(csound->API_lock);
       csoundDestroyMutex(csound->API_lock);
     }
+    if (csound->fftPlanLock != NULL)
+      csoundDestroyMutex(csound->fftPlanLock);
     /* clear the pointer */
     //*(csound->self) = NULL;
     free((void*) csound);
@@ -1959,6 +1980,12 @@ PUBLIC int csoundPerformKsmps(CSOUND *csound)
                           "has not been called \n"));
       return CSOUND_ERROR;
     }
+    if (UNLIKELY(csound->driverPaced)) {
+      csound->Warning(csound,
+                      Str("csoundPerformKsmps(): the performance is run by "
+                          "the audio driver, use csoundPerform()\n"));
+      return CSOUND_ERROR;
+    }
     if (csound->jumpset == 0) {
       int returnValue;
       csound->jumpset = 1;
@@ -2019,6 +2046,12 @@ PUBLIC int csoundPerformBuffer(CSOUND *csound)
                           "has not been called \n"));
       return CSOUND_ERROR;
     }
+    if (UNLIKELY(csound->driverPaced)) {
+      csound->Warning(csound,
+                      Str("csoundPerformBuffer(): the performance is run by "
+                          "the audio driver, use csoundPerform()\n"));
+      return CSOUND_ERROR;
+    }
     /* Setup jmp for return after an exit(). */
     if (UNLIKELY((returnValue = setjmp(csound->exitjmp)))) {
 #ifndef MACOSX
@@ -2043,6 +2076,97 @@ PUBLIC int csoundPerformBuffer(CSOUND *csound)
 
 /* perform an entire score */
 
+/* Performance paced by the audio driver: a real-time audio module whose
+   callback thread should run the k-cycles itself (so that it can read and
+   write the device buffers directly, without a hand-off to the performance
+   thread) calls SetDriverPaced() when it opens the device.  csoundPerform()
+   then waits until the score ends or csoundStop() is called, while the
+   module calls DriverPerform() from its callback for every device period.
+   A module that loses its device calls SetDriverPaced(csound, 0), which
+   ends the wait with an error. */
+
+void csoundSetDriverPaced(CSOUND *csound, int on)
+{
+    csound->driverPaced = on;
+}
+
+/* Runs up to nkcycles k-cycles on behalf of a driver-paced audio module.
+   Returns 0 if they were performed, or non-zero if there is no
+   performance to run (csoundPerform() is not waiting, or the score has
+   ended); the module should then output silence. */
+
+int csoundDriverPerform(CSOUND *csound, int nkcycles)
+{
+    volatile int  locked = 0;
+    int           done = 0, returnValue;
+
+    if (UNLIKELY((returnValue = setjmp(csound->exitjmp)))) {
+      done = ((returnValue - CSOUND_EXITJMP_SUCCESS) | CSOUND_EXITJMP_SUCCESS);
+      if (!locked)
+        csoundLockMutex(csound->API_lock);
+      goto finished;
+    }
+    csoundLockMutex(csound->API_lock);
+    locked = 1;
+    if (!csound->driverWaiting || csound->driverDone ||
+        (unsigned char) csound->performState != (unsigned char) '\0') {
+      csoundUnlockMutex(csound->API_lock);
+      return 1;
+    }
+    {
+      int n;      /* counted here, so nothing live across setjmp changes */
+      for (n = nkcycles; n > 0; n--) {
+        do {
+          if ((done = sensevents(csound)))
+            goto finished;
+        } while (csound->kperf(csound));
+      }
+    }
+    csoundUnlockMutex(csound->API_lock);
+    return 0;
+ finished:
+    csound->driverDone = done;
+    csoundNotifyThreadLock(csound->driverLock);
+    csoundUnlockMutex(csound->API_lock);
+    return done;
+}
+
+static int csoundPerformDriverPaced(CSOUND *csound)
+{
+    int done;
+
+    csound->driverLock = csoundCreateThreadLock();
+    csoundWaitThreadLock(csound->driverLock, (size_t) 0);
+    csound->driverDone = 0;
+    csound->driverWaiting = 1;
+    while (!csound->driverDone && csound->driverPaced &&
+           (unsigned char) csound->performState == (unsigned char) '\0')
+      csoundWaitThreadLock(csound->driverLock, (size_t) 100);
+    /* the driver checks driverWaiting with the API lock held, so no
+       k-cycle can start after this */
+    csoundLockMutex(csound->API_lock);
+    csound->driverWaiting = 0;
+    done = csound->driverDone;
+    csoundUnlockMutex(csound->API_lock);
+    csoundDestroyThreadLock(csound->driverLock);
+    csound->driverLock = NULL;
+    if (UNLIKELY(!done && !csound->driverPaced)) {
+      csoundErrorMsg(csound, Str("csoundPerform(): the audio driver stopped\n"));
+      return CSOUND_ERROR;
+    }
+    if (done) {
+      csoundMessage(csound, Str("Score finished in csoundPerform().\n"));
+      if (csound->oparms->numThreads > 1) {
+        csound->multiThreadedComplete = 1;
+        csound->WaitBarrier(csound->barrier1);
+      }
+      return done;
+    }
+    csoundMessage(csound, Str("csoundPerform(): stopped.\n"));
+    csound->performState = 0;
+    return 0;
+}
+
 PUBLIC int csoundPerform(CSOUND *csound)
 {
     int done;
@@ -2064,6 +2188,8 @@ PUBLIC int csoundPerform(CSOUND *csound)
 #endif
       return ((returnValue - CSOUND_EXITJMP_SUCCESS) | CSOUND_EXITJMP_SUCCESS);
     }
+    if (csound->driverPaced)
+      return csoundPerformDriverPaced(csound);
     do {
            csoundLockMutex(csound->API_lock);
       do {
@@ -3028,6 +3154,7 @@ static void reset(CSOUND *csound)
     /* delete temporary files created by this Csound instance */
     remove_tmpfiles(csound);
     rlsmemfiles(csound);
+    samplecache_unmap_all(csound);      /* mapped tables and soundfonts */
 
      while (csound->filedir[n])        /* Clear source directory */
        csound->Free(csound,csound->filedir[n++]);
@@ -3058,6 +3185,7 @@ static void reset(CSOUND *csound)
     memcpy(p1, (void*) &(saved_env->first_callback_), (size_t) length);
     csound->csoundCallbacks_ = saved_env->csoundCallbacks_;
     csound->API_lock = saved_env->API_lock;
+    csound->fftPlanLock = saved_env->fftPlanLock;
 #ifdef HAVE_PTHREAD_SPIN_LOCK
     csound->memlock = saved_env->memlock;
     csound->spinlock = saved_env->spinlock;
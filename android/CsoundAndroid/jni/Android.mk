@@ -213,6 +213,7 @@ $(CSOUND_SRC_ROOT)/Opcodes/stdopcod.c \
 $(CSOUND_SRC_ROOT)/Opcodes/socksend.c \
 $(CSOUND_SRC_ROOT)/Opcodes/sockrecv.c \
 $(CSOUND_SRC_ROOT)/Opcodes/ifd.c  \
+$(CSOUND_SRC_ROOT)/Opcodes/irspec.c  \
 $(CSOUND_SRC_ROOT)/Opcodes/partials.c  \
 $(CSOUND_SRC_ROOT)/Opcodes/psynth.c  \
 $(CSOUND_SRC_ROOT)/Opcodes/pvsbasic.c \
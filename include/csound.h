@@ -1758,6 +1758,23 @@ extern "C" {
      */
     PUBLIC void csoundGetNamedGEN(CSOUND *csound, int num, char *name, int len);
 
+    /**
+     * Loads the sound file 'path' into the process-wide sample cache, so
+     * that GEN01 tables created later by any Csound instance in this
+     * process share the cached samples instead of reading the file again.
+     * 'channel' is the channel number as given to GEN01 (0 for all
+     * channels). The data is kept until csoundFlushSampleCache() is
+     * called, and may be loaded before any instance is created.
+     * Returns CSOUND_SUCCESS, or a negative error code.
+     */
+    PUBLIC int csoundPreloadSample(const char *path, int channel);
+
+    /**
+     * Releases the data loaded by csoundPreloadSample(). Samples still in
+     * use by function tables are freed when the tables are deleted.
+     */
+    PUBLIC void csoundFlushSampleCache(void);
+
     /** @}*/
     /** @defgroup TABLEDISPLAY Function table display
      *
@@ -2251,7 +2268,8 @@ extern "C" {
 
  /**
   * Create circular buffer with numelem number of elements. The element's size is set
-  * from elemsize. It should be used like:
+  * from elemsize. The buffer is a single-reader, single-writer lock-free ring;
+  * numelem is rounded up to the next power of two. It should be used like:
   *@code
   * void *rb = csoundCreateCircularBuffer(csound, 1024, sizeof(MYFLT));
   *@endcode
@@ -2300,6 +2318,46 @@ extern "C" {
    */
   PUBLIC void csoundFlushCircularBuffer(CSOUND *csound, void *p);
 
+ /**
+  * Obtain a pointer into the circular buffer where up to items elements can
+  * be written directly, without an intermediate copy. The region is
+  * contiguous, so it may be shorter than the free space when it would wrap;
+  * call again after committing to fill the remainder.
+  * @param csound This value is currently ignored.
+  * @param p pointer to an existing circular buffer
+  * @param ptr receives the start of the writable region (NULL if none)
+  * @param items maximum number of elements wanted
+  * @returns the number of elements that may be written at *ptr
+  */
+  PUBLIC int csoundAcquireWriteCircularBuffer(CSOUND *csound, void *p,
+                                              void **ptr, int items);
+
+ /**
+  * Publish items elements written into the region returned by
+  * csoundAcquireWriteCircularBuffer() to the reader.
+  */
+  PUBLIC void csoundCommitWriteCircularBuffer(CSOUND *csound, void *p,
+                                              int items);
+
+ /**
+  * Obtain a pointer to up to items contiguous readable elements, without
+  * copying them out of the circular buffer.
+  * @param csound This value is currently ignored.
+  * @param p pointer to an existing circular buffer
+  * @param ptr receives the start of the readable region (NULL if none)
+  * @param items maximum number of elements wanted
+  * @returns the number of elements that may be read at *ptr
+  */
+  PUBLIC int csoundAcquireReadCircularBuffer(CSOUND *csound, void *p,
+                                             void **ptr, int items);
+
+ /**
+  * Release items elements obtained with csoundAcquireReadCircularBuffer()
+  * back to the writer.
+  */
+  PUBLIC void csoundCommitReadCircularBuffer(CSOUND *csound, void *p,
+                                             int items);
+
  /**
   * Free circular buffer
   */
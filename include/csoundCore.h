@@ -93,6 +93,27 @@ typedef struct {
 #define CSFILE_SND_R    4
 #define CSFILE_SND_W    5
 
+/* number of words of dither generator state (see SampleFromMYFLT) */
+#define CS_DITHER_LANES 8
+
+/* Alignment of audio rate variables under the --simd-align option.
+   When csound->oparms->simd_align is set, every a-rate variable local
+   to an instrument or UDO instance starts on a CS_SIMD_ALIGN byte
+   boundary, and every a-rate buffer (local, global or array member) is
+   padded to CS_SIMD_PAD(ksmps) samples, so that opcodes may use aligned
+   vector loads and stores, and may run a vector loop over the padded
+   length; the samples past ksmps are scratch and are never read by
+   other opcodes.  Without the option only sizeof(MYFLT) alignment is
+   promised.  Global variables and array data come from the general
+   allocator and get its alignment only. */
+#define CS_SIMD_ALIGN   64
+#define CS_SIMD_ALIGN_UP(x) \
+    (((x) + (CS_SIMD_ALIGN - 1)) & ~((size_t) CS_SIMD_ALIGN - 1))
+#define CS_SIMD_PAD(n) \
+    ((int) (CS_SIMD_ALIGN_UP((size_t) (n) * sizeof(MYFLT)) / sizeof(MYFLT)))
+#define CS_IS_SIMD_ALIGNED(p) \
+    ((((uintptr_t) (p)) & ((uintptr_t) CS_SIMD_ALIGN - 1)) == 0)
+
 #define MAXINSNO  (200)
 #define PMAX      (1998)
 #define VARGMAX   (1999)
@@ -243,6 +264,7 @@ typedef struct CORFIL {
     double  quality;        /* for ogg encoding */
     int     ksmps_override;
     int     fft_lib;
+    int     simd_align;     /* align a-rate variables to CS_SIMD_ALIGN */
   } OPARMS;
 
   typedef struct arglst {
@@ -794,6 +816,9 @@ typedef struct CORFIL {
     unsigned char mbuf[MBUFSIZ];
     unsigned char *bufp, *endatp;
     int16   datreq, datcnt;
+    int64_t mtime[MBUFSIZ];     /* audio frame each byte in mbuf is due at,
+                                   or 0 if it has no timestamp            */
+    int     evtOffset;          /* sample offset of the current note event */
   } MGLOBAL;
 
   typedef struct eventnode {
@@ -1174,6 +1199,8 @@ typedef struct NAME__ {
                            const char *, int, int, int);
     unsigned int (*ReadAsync)(CSOUND *, void *, MYFLT *, int);
     unsigned int (*WriteAsync)(CSOUND *, void *, MYFLT *, int);
+    /* queues a seek, done in order after the data written before it;
+       returns pos for SEEK_SET, 0 for the other origins, -1 on error */
     int  (*FSeekAsync)(CSOUND *, void *, int, int);
     char *(*getstrformat)(int format);
     int (*sfsampsize)(int format);
@@ -1310,10 +1337,53 @@ typedef struct NAME__ {
     int  (*ftError)(const FGDATA *, const char *, ...);
     MYFLT (*GetA4)(CSOUND *csound);
        /**@}*/
+    /** @name Circular buffer zero-copy access */
+    /**@{ */
+    int (*AcquireWriteCircularBuffer)(CSOUND *, void *, void **, int);
+    void (*CommitWriteCircularBuffer)(CSOUND *, void *, int);
+    int (*AcquireReadCircularBuffer)(CSOUND *, void *, void **, int);
+    void (*CommitReadCircularBuffer)(CSOUND *, void *, int);
+    /**@}*/
+    /** @name Streaming PVOC-EX access */
+    /**@{ */
+    void *(*PVOCEX_OpenStream)(CSOUND *, const char *, PVOCEX_MEMFILE *);
+    float *(*PVOCEX_StreamFrame)(CSOUND *, void *, int32);
+    void (*PVOCEX_CloseStream)(CSOUND *, void *);
+    /**@}*/
+    /** @name Sample format conversion */
+    /**@{ */
+    void (*SampleFromMYFLT)(CSOUND *, void *out, int format,
+                            const MYFLT *in, int n, int dither, uint32_t *state);
+    void (*SampleToMYFLT)(CSOUND *, MYFLT *out, const void *in,
+                          int format, int n);
+    void (*InterleaveFloat)(CSOUND *, MYFLT *out, float *const *in,
+                            int offs, int nchnls, int nframes);
+    void (*DeinterleaveFloat)(CSOUND *, float *const *out, int offs,
+                              const MYFLT *in, int nchnls, int nframes);
+    void (*AddDither)(CSOUND *, MYFLT *buf, int n, MYFLT lsb,
+                      int dither, uint32_t *state);
+    /**@}*/
+    /** @name Performance paced by the audio driver */
+    /**@{ */
+    void (*SetDriverPaced)(CSOUND *, int on);
+    int (*DriverPerform)(CSOUND *, int nkcycles);
+    /**@}*/
+    /** @name Timestamped MIDI input */
+    /**@{ */
+    void (*MidiInTimestamp)(CSOUND *, int pos, int n, int32 age);
+    /**@}*/
+    /** @name Shared FFT setups */
+    /**@{ */
+    void (*RealFFT2Release)(CSOUND *csound, void *p);
+    /**@}*/
+    /** @name Table data */
+    /**@{ */
+    MYFLT *(*FTReAlloc)(CSOUND *, FUNC *ftp, size_t nbytes);
+    /**@}*/
     /** @name Placeholders
         To allow the API to grow while maintining backward binary compatibility. */
     /**@{ */
-    SUBR dummyfn_2[38];
+    SUBR dummyfn_2[21];
     /**@}*/
 #ifdef __BUILDING_LIBCSOUND
     /* ------- private data (not to be used by hosts or externals) ------- */
@@ -1495,9 +1565,8 @@ typedef struct NAME__ {
     void          *tseg, *tpsave, *tplim;
     /* Statics from express.c */
     MYFLT         *gbloffbas;       /* was static in oload.c */
-    void         *file_io_thread;
+    void         *file_io_service;
     int          file_io_start;
-    void         *file_io_threadlock;
     int          realtime_audio_flag;
     void         *init_pass_thread;
     int          init_pass_loop;
@@ -1578,6 +1647,8 @@ typedef struct NAME__ {
     } musmonStatics;
     struct libsndStatics__ {
       SNDFILE       *outfile;
+      void          *outfd;               /* outfile handle, if written   */
+                                          /* by the async i/o service     */
       SNDFILE       *infile;
       char          *sfoutname;           /* soundout filename            */
       MYFLT         *inbuf;
@@ -1592,7 +1663,7 @@ typedef struct NAME__ {
       int           pipdevin, pipdevout;  /* 0: file, 1: pipe, 2: rtaudio */
       uint32        nframes               /* = 1UL */;
       FILE          *pin, *pout;
-      int           dither;
+      uint32_t      dither[CS_DITHER_LANES];
     } libsndStatics;
 
     int           warped;               /* rdscor.c */
@@ -1615,6 +1686,7 @@ typedef struct NAME__ {
     void          *open_files;          /* fileopen.c */
     void          *searchPathCache;
     CS_HASH_TABLE *sndmemfiles;
+    CS_HASH_TABLE *memfile_index;       /* memfiles.c */
     void          *reset_list;
     void          *pvFileTable;         /* pvfileio.c */
     int           pvNumFiles;
@@ -1720,6 +1792,15 @@ typedef struct NAME__ {
     int           score_parser;
     CS_HASH_TABLE* symbtab;
     int           tseglen;
+    /* performance run from the audio driver's callback */
+    int           driverPaced;
+    volatile int  driverWaiting;
+    volatile int  driverDone;
+    void          *driverLock;
+    /* FFT setups shared between opcodes (fftlib.c) */
+    void          *fftPlans;
+    void          *fftPlanLock;
+    int           fftPlansReset;
     /*struct CSOUND_ **self;*/
     /**@}*/
 #endif  /* __BUILDING_LIBCSOUND */
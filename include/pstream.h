@@ -127,6 +127,7 @@ typedef struct {
         MYFLT   *wintype;
         MYFLT   *format;                /* always PVS_AMP_FREQ at present */
         MYFLT   *init;                  /* not yet implemented */
+        MYFLT   *lobin, *hibin;         /* bins analysed, sliding */
         /* internal */
         int32    buflen;
         float   fund,arate;
@@ -143,6 +144,13 @@ typedef struct {
         AUXCH           trig;
         double          *cosine, *sine;
         void    *setup;
+        /* analysis shared with an earlier pvsanal of the instrument on the
+           same input and with the same parameters */
+        void    *share;                 /* PVSANAL whose frames are copied */
+        int     followed;               /* another pvsanal copies this one */
+        uint32  runs;                   /* performances since init */
+        AUXCH   inblk;                  /* input of the last performance */
+        AUXCH   sdft;                   /* sliding: partitions of the bins */
 } PVSANAL;
 
 typedef struct {
@@ -158,6 +158,7 @@ int     pvoc_putframes(CSOUND *,
 int     pvoc_getframes(CSOUND *,
                        int ifd, float *frames, uint32 nframes);
 int     pvoc_framecount(CSOUND *, int ifd);
+const char *pvoc_datalocation(CSOUND *, int ifd, int32 *offset);
 int     pvoc_fseek(CSOUND *, int ifd, int offset);
 int     pvsys_release(CSOUND *);
 
@@ -123,34 +123,73 @@ class CsPerfThreadMsg_TogglePause : public CsoundPerformanceThreadMessage {
 };
 
 extern "C" {
+  static void recordWrite_(recordData_t *recordData, MYFLT *buf, int nframes)
+  {
+    if (recordData->scale != (MYFLT) 1.0) {
+      int len = nframes * recordData->nchnls;
+      for (int i = 0; i < len; i++)
+        buf[i] *= recordData->scale;
+    }
+#ifdef USE_DOUBLE
+    sf_writef_double((SNDFILE *) recordData->sfile, buf, nframes);
+#else
+    sf_writef_float((SNDFILE *) recordData->sfile, buf, nframes);
+#endif
+  }
+
   static uintptr_t recordThread_(void *recordData_)
   {
     recordData_t *recordData = (recordData_t *)recordData_;
+    CSOUND *csound = recordData->csound;
     int retval = 0;
-    const int bufsize = 4096;
-    MYFLT buf[bufsize];
+    int chunk = recordData->chunkframes;
+    int filled = 0, n;
+    bool running;
+    MYFLT *buf = new MYFLT[chunk * recordData->nchnls];
     _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
-    while (recordData->running) {
-        pthread_mutex_lock(&recordData->mutex);
-        pthread_cond_wait(&recordData->condvar, &recordData->mutex);
-        int sampsread;
-        do {
-            sampsread = csoundReadCircularBuffer(NULL, recordData->cbuf,
-                                                 buf, bufsize);
-#ifdef USE_DOUBLE
-            sf_write_double((SNDFILE *) recordData->sfile,
-                            buf, sampsread);
-#else
-            sf_write_float((SNDFILE *) recordData->sfile,
-                           buf, sampsread);
-#endif
-        } while(sampsread != 0);
-        pthread_mutex_unlock(&recordData->mutex);
-    }
+    do {
+      // sample the flag first, so that the final drain below sees
+      // everything the performance thread wrote before stopping
+      running = recordData->running;
+      while ((n = csoundReadCircularBuffer(NULL, recordData->cbuf,
+                                           buf + filled * recordData->nchnls,
+                                           chunk - filled)) > 0) {
+        filled += n;
+        if (filled == chunk) {
+          recordWrite_(recordData, buf, filled);
+          filled = 0;
+        }
+      }
+      if (running)
+        csoundSleep((size_t) recordData->sleepms);
+    } while (running);
+    if (filled)
+      recordWrite_(recordData, buf, filled);
+    sf_close((SNDFILE *) recordData->sfile);
+    recordData->sfile = NULL;
+    csoundDestroyCircularBuffer(csound, recordData->cbuf);
+    recordData->cbuf = NULL;
+    delete[] buf;
+    if (recordData->overruns)
+      csoundMessage(csound, "perfThread record buffer overrun: "
+                    "%ld frames dropped.\n", recordData->overruns);
     return (uintptr_t) ((unsigned int) retval);
   }
 }
 
+/**
+ * Joins a record writer thread that has already been told to stop.
+ */
+
+static void recordJoin_(recordData_t *recordData)
+{
+    if (recordData->thread) {
+      recordData->running = false;
+      csoundJoinThread(recordData->thread);
+      recordData->thread = NULL;
+    }
+}
+
 class CsPerfThreadMsg_Record: public CsoundPerformanceThreadMessage {
 public:
     CsPerfThreadMsg_Record(CsoundPerformanceThread *pt,
@@ -160,30 +199,45 @@ public:
     : CsoundPerformanceThreadMessage(pt)
     {
         this->filename = filename;
+        CSOUND * csound = pt_->GetCsound();
+        if (!csound) {
+            return;
+        }
         CsoundPerformanceThreadMessage::lockRecord();
         recordData_t *recordData = CsoundPerformanceThreadMessage::getRecordData();
         if (recordData->running) {
             CsoundPerformanceThreadMessage::unlockRecord();
             return;
         }
-        CSOUND * csound = pt_->GetCsound();
-        if (!csound) {
-            return;
-        }
-        int bufsize = csoundGetOutputBufferSize(csound)
-                * csoundGetNchnls(csound) * numbufs;
+        // a previous recording may still be flushing to disk
+        recordJoin_(recordData);
+        int nchnls = csoundGetNchnls(csound);
+        int sr = (int) csoundGetSr(csound);
+        // the ring holds whole frames, at least one second of audio, and is
+        // drained in chunks of an eighth of its size
+        int nframes = csoundGetOutputBufferSize(csound) * numbufs;
+        if (nframes < sr)
+          nframes = sr;
+        recordData->chunkframes = nframes / 8;
+        if (recordData->chunkframes < 1)
+          recordData->chunkframes = 1;
+        recordData->sleepms =
+          (int) (250.0 * recordData->chunkframes / (sr > 0 ? sr : 1));
+        if (recordData->sleepms < 1)
+          recordData->sleepms = 1;
         recordData->cbuf = csoundCreateCircularBuffer(csound,
-                                                 bufsize,
-                                                 sizeof(MYFLT));
+                                                 nframes,
+                                                 sizeof(MYFLT) * nchnls);
 
         if (!recordData->cbuf) {
-          csoundMessage(csound, "Could create recording buffer.");
+          csoundMessage(csound, "Could not create recording buffer.");
+          CsoundPerformanceThreadMessage::unlockRecord();
           return;
         }
 
         SF_INFO sf_info;
-        sf_info.samplerate = csoundGetSr(csound);
-        sf_info.channels = csoundGetNchnls(csound);
+        sf_info.samplerate = sr;
+        sf_info.channels = nchnls;
         switch (samplebits) {
         case 32:
             sf_info.format = SF_FORMAT_FLOAT;
@@ -205,14 +259,26 @@ public:
         if (!recordData->sfile) {
           csoundMessage(csound, "Could not open file for recording.");
           csoundDestroyCircularBuffer(csound, recordData->cbuf);
+          recordData->cbuf = NULL;
+          CsoundPerformanceThreadMessage::unlockRecord();
           return;
         }
         sf_command((SNDFILE *) recordData->sfile, SFC_SET_CLIPPING,
                    NULL, SF_TRUE);
 
+        recordData->csound = csound;
+        recordData->nchnls = nchnls;
+        recordData->scale = (MYFLT) 1.0 / csoundGet0dBFS(csound);
+        recordData->overruns = 0;
         recordData->running = true;
         recordData->thread = csoundCreateThread(recordThread_, (void*) recordData);
-
+        if (!recordData->thread) {
+          recordData->running = false;
+          sf_close((SNDFILE *) recordData->sfile);
+          recordData->sfile = NULL;
+          csoundDestroyCircularBuffer(csound, recordData->cbuf);
+          recordData->cbuf = NULL;
+        }
 
         CsoundPerformanceThreadMessage::unlockRecord();
     }
@@ -227,23 +293,20 @@ private:
 
 };
 
+/**
+ * Stop recording. This runs in the performance thread, so it only clears
+ * the running flag; the writer thread drains the ring, closes the file and
+ * is joined later by the next Record() or by Join().
+ */
+
 class CsPerfThreadMsg_StopRecord: public CsoundPerformanceThreadMessage {
 public:
     CsPerfThreadMsg_StopRecord(CsoundPerformanceThread *pt)
       : CsoundPerformanceThreadMessage(pt) {}
     int run()
     {
-
-      CsoundPerformanceThreadMessage::lockRecord();
       recordData_t *recordData = CsoundPerformanceThreadMessage::getRecordData();
-      if (recordData->running) {
-          recordData->running = false;
-          csoundJoinThread(recordData->thread);
-          sf_close((SNDFILE *) recordData->sfile);
-      }
-
-      CsoundPerformanceThreadMessage::unlockRecord();
-
+      recordData->running = false;
       return 0;
     }
     ~CsPerfThreadMsg_StopRecord(){}
@@ -431,24 +494,15 @@ int CsoundPerformanceThread::Perform()
            processcallback(cdata);
       retval = csoundPerformKsmps(csound);
       if (recordData.running) {
-          MYFLT *spout = csoundGetSpout(csound);
-          int len = csoundGetKsmps(csound) * csoundGetNchnls(csound);
-          if (csoundGet0dBFS(csound) != 1.0) {
-              MYFLT zdbfs = csoundGet0dBFS(csound);
-              MYFLT *modspout = spout;
-              for (int i = 0; i < len; i++) {
-                  *modspout /= zdbfs;
-                  modspout++;
-              }
-          }
+          // copy whole frames only; 0dBFS scaling and disk access are
+          // left to the writer thread
+          int nframes = csoundGetKsmps(csound);
           int written = csoundWriteCircularBuffer(NULL, recordData.cbuf,
-                                                  spout, len);
-          if (written != len) {
-              csoundMessage(csound, "perfThread record buffer overrun.\n");
-          }
+                                                  csoundGetSpout(csound),
+                                                  nframes);
+          if (written != nframes)
+            recordData.overruns += nframes - written;
       }
-      pthread_cond_signal(&recordData.condvar); // Needs to be outside the if
-                              // for the case where stop record was requested
     } while (!retval);
  endOfPerf:
     status = retval;
@@ -538,10 +592,9 @@ void CsoundPerformanceThread::csPerfThread_constructor(CSOUND *csound_)
     recordData.cbuf = NULL;
     recordData.sfile = NULL;
     recordData.thread = NULL;
+    recordData.csound = csound;
     recordData.running = false;
-
-    pthread_mutex_init(&recordData.mutex, NULL);
-    pthread_cond_init(&recordData.condvar, NULL);
+    recordData.overruns = 0;
 
     perfThread = csoundCreateThread(csoundPerformanceThread_, (void*) this);
     if (perfThread) {
@@ -677,11 +730,7 @@ int CsoundPerformanceThread::Join()
       retval = csoundJoinThread(perfThread);
       perfThread = (void*) 0;
     }
-    if (recordData.running) {
-        recordData.running = false;
-        pthread_cond_signal(&recordData.condvar);
-        csoundJoinThread(recordData.thread);
-    }
+    recordJoin_(&recordData);
 
     // delete any pending messages
     {
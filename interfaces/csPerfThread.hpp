@@ -108,13 +108,25 @@ struct PUBLIC pycallbackdata {
 };
 #endif
 
+/**
+ * State shared between the performance thread and the record writer.
+ * The performance thread only ever copies whole frames into the
+ * lock-free ring 'cbuf'; the writer thread polls the ring and hands it
+ * to libsndfile in chunks of 'chunkframes' frames, so disk latency never
+ * reaches the audio thread. Frames that do not fit are dropped and
+ * counted in 'overruns'.
+ */
 typedef struct {
     void *cbuf;
     void *sfile;
     void *thread;
-    bool running;
-    pthread_cond_t condvar;
-    pthread_mutex_t mutex;
+    CSOUND *csound;
+    volatile bool running;
+    int nchnls;
+    int chunkframes;
+    int sleepms;
+    MYFLT scale;
+    volatile long overruns;
 } recordData_t;
 
 class PUBLIC CsoundPerformanceThread {
@@ -200,6 +212,14 @@ class PUBLIC CsoundPerformanceThread {
      * Stops recording and closes audio file.
      */
     void StopRecord();
+    /**
+     * Returns the number of sample frames dropped by the current or
+     * last recording because the writer thread fell behind.
+     */
+    long GetRecordOverruns()
+    {
+      return recordData.overruns;
+    }
     /**
      * Sends a score event of type 'opcod' (e.g. 'i' for a note event), with
      * 'pcnt' p-fields in array 'p' (p[0] is p1). If absp2mode is non-zero,
@@ -0,0 +1,255 @@
+/*
+ * File:   aops_bench.c
+ *
+ * Throughput of the a-rate arithmetic kernels of OOps/aops.c, for each
+ * instruction set aops.c dispatches to, against the scalar loops they
+ * replaced, with a check that every variant gives the scalar results.
+ *
+ *   aopsBench [ksmps [seconds-per-kernel]]
+ *
+ * (see kernel_bench.h)
+ */
+
+#define __BUILDING_LIBCSOUND
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "csoundCore.h"
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic ignored "-Wunused-function"  /* not every kernel */
+#endif
+
+#define KERNEL      static
+#define KNAME(x)    aops_##x##_generic
+#include "../../OOps/aops_kernels.h"
+#undef KNAME
+#undef KERNEL
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#define HAVE_AVX2_KERNELS 1
+#define KERNEL      static __attribute__ ((target ("avx2")))
+#define KNAME(x)    aops_##x##_avx2
+#define AOPS_VECTOR_EXP 1
+#include "../../OOps/aops_kernels.h"
+#undef KNAME
+#undef AOPS_VECTOR_EXP
+#undef KERNEL
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    !defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 8
+#define HAVE_AVX512_KERNELS 1
+#define KERNEL      static \
+                    __attribute__ ((target ("avx512f,prefer-vector-width=512")))
+#define KNAME(x)    aops_##x##_avx512
+#define AOPS_VECTOR_EXP 1
+#include "../../OOps/aops_kernels.h"
+#undef KNAME
+#undef AOPS_VECTOR_EXP
+#undef KERNEL
+#endif
+
+#include "kernel_bench.h"
+
+#ifdef USE_DOUBLE
+#define TOLERANCE   1.0e-12
+#else
+#define TOLERANCE   1.0e-5
+#endif
+
+static int     ksmps = 64;
+static MYFLT  *in_a, *in_b, *out, *ref, *cpsocfrc;
+
+/* the loops of the opcodes before they called the kernels */
+
+static MYFLT MOD(MYFLT a, MYFLT bb)
+{
+    if (UNLIKELY(bb==FL(0.0))) return FL(0.0);
+    else {
+      MYFLT b = (bb<0 ? -bb : bb);
+      MYFLT d = FMOD(a, b);
+      while (d>b) d -= b;
+      while (-d>b) d += b;
+      return d;
+  }
+}
+
+#define MYFLOOR(x) ((int32)((double)(x) >= 0.0 ? (x) : (x) - 0.99999999))
+
+static void scalar(int op, MYFLT *r)
+{
+    MYFLT    intpart, *a = in_a, *b = in_b;
+    uint32_t n, nsmps = ksmps;
+    switch (op) {
+    case 0:
+      for (n = 0; n < nsmps; n++) r[n] = a[n] + b[n];
+      break;
+    case 1:
+      for (n = 0; n < nsmps; n++) r[n] = a[n] * b[n];
+      break;
+    case 2:
+      for (n = 0; n < nsmps; n++) r[n] = a[n] / b[n];
+      break;
+    case 3:
+      for (n = 0; n < nsmps; n++) r[n] = a[n] * b[0];
+      break;
+    case 4:
+      for (n = 0; n < nsmps; n++) r[n] = a[0] - b[n];
+      break;
+    case 5:
+      for (n = 0; n < nsmps; n++) r[n] = MOD(a[n], b[n]);
+      break;
+    case 6:
+      for (n = 0; n < nsmps; n++)
+        r[n] = (b[n]==FL(0.0) ? FL(0.0) : a[n] / b[n]);
+      break;
+    case 7:
+      for (n = 0; n < nsmps; n++) r[n] = EXP(a[n] * LOG10D20);
+      break;
+    case 8:
+      for (n = 0; n < nsmps; n++) {
+        int loct = (int)(b[n] * OCTRES);
+        r[n] = (MYFLT) (1 << (loct >> 13)) * cpsocfrc[loct & 8191];
+      }
+      break;
+    case 9:
+      for (n = 0; n < nsmps; n++) {
+        MODF(a[n], &intpart);
+        r[n] = intpart;
+      }
+      break;
+    case 10:
+      for (n = 0; n < nsmps; n++) r[n] = MODF(a[n], &intpart);
+      break;
+    case 11:
+      for (n = 0; n < nsmps; n++) r[n] = (MYFLT) MYFLT2LRND(a[n]);
+      break;
+    case 12:
+      for (n = 0; n < nsmps; n++) r[n] = (MYFLT) (MYFLOOR(a[n]));
+      break;
+    }
+}
+
+/* one call of kernel 'op' of variant 'v' over the input blocks; the
+   k-rate operands are taken from the first input sample */
+
+#define CALL(v, S)                                                      \
+  case v:                                                               \
+    switch (op) {                                                       \
+    case 0:  aops_add_aa_##S(r, in_a, in_b, ksmps); break;              \
+    case 1:  aops_mul_aa_##S(r, in_a, in_b, ksmps); break;              \
+    case 2:  aops_div_aa_##S(r, in_a, in_b, ksmps); break;              \
+    case 3:  aops_mul_ak_##S(r, in_a, in_b[0], ksmps); break;           \
+    case 4:  aops_sub_ka_##S(r, in_a[0], in_b, ksmps); break;           \
+    case 5:  aops_mod_aa_##S(r, in_a, in_b, ksmps); break;              \
+    case 6:  aops_divz_aa_##S(r, in_a, in_b, FL(0.0), ksmps); break;    \
+    case 7:  aops_ampdb_##S(r, in_a, FL(1.0), ksmps); break;            \
+    case 8:  aops_cpsoct_##S(r, in_b, cpsocfrc, ksmps); break;          \
+    case 9:  aops_int_trunc_##S(r, in_a, ksmps); break;                 \
+    case 10: aops_frac_##S(r, in_a, ksmps); break;                      \
+    case 11: aops_int_round_##S(r, in_a, ksmps); break;                 \
+    case 12: aops_int_floor_##S(r, in_a, ksmps); break;                 \
+    }                                                                   \
+    break;
+
+static const char *op_name[] = {
+    "add aa", "mul aa", "div aa", "mul ak", "sub ka", "mod aa", "divz aa",
+    "ampdb", "cpsoct", "int", "frac", "round", "floor"
+};
+
+#define NOPS ((int) (sizeof(op_name) / sizeof(op_name[0])))
+
+static void run(int v, int op, MYFLT *r)
+{
+    switch (v) {
+    case VAR_SCALAR:
+      scalar(op, r);
+      break;
+    CALL(VAR_GENERIC, generic)
+#ifdef HAVE_AVX2_KERNELS
+    CALL(VAR_AVX2, avx2)
+#endif
+#ifdef HAVE_AVX512_KERNELS
+    CALL(VAR_AVX512, avx512)
+#endif
+    }
+}
+
+static void call(int v, int op)
+{
+    run(v, op, out);
+}
+
+/* samples per second of variant 'v' of kernel 'op' */
+
+static double measure(int v, int op, double seconds)
+{
+    return bench_rate(call, v, op, 1024, seconds) * (double) ksmps;
+}
+
+/* largest difference from the scalar results, relative where they are
+   larger than one */
+
+static double difference(int v, int op)
+{
+    double err = 0.0;
+    int    i;
+    run(VAR_SCALAR, op, ref);
+    run(v, op, out);
+    for (i = 0; i < ksmps; i++) {
+      double d = fabs((double) out[i] - (double) ref[i]);
+      double m = fabs((double) ref[i]);
+      if (isnan((double) out[i]) != isnan((double) ref[i]))
+        return HUGE_VAL;
+      if (isnan((double) ref[i]))
+        continue;
+      if (m > 1.0)
+        d /= m;
+      if (d > err)
+        err = d;
+    }
+    return err;
+}
+
+static int compare(int v, int op)
+{
+    double err = difference(v, op);
+    if (err <= TOLERANCE)
+      return 0;
+    fprintf(stderr, "%s %s: differs from scalar by %g\n",
+            op_name[op], variant_name[v], err);
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    static const KERNEL_BENCH b = { NOPS, op_name, measure, compare };
+    char   title[32];
+    double seconds = 0.2;
+    int    i, failed;
+
+    if (bench_args(argc, argv, &ksmps, &seconds))
+      return 1;
+    in_a = (MYFLT *) malloc(sizeof(MYFLT) * ksmps);
+    in_b = (MYFLT *) malloc(sizeof(MYFLT) * ksmps);
+    out = (MYFLT *) malloc(sizeof(MYFLT) * ksmps);
+    ref = (MYFLT *) malloc(sizeof(MYFLT) * ksmps);
+    cpsocfrc = (MYFLT *) malloc(sizeof(MYFLT) * OCTRES);
+    for (i = 0; i < OCTRES; i++)
+      cpsocfrc[i] = (MYFLT) (pow(2.0, (double) i / OCTRES) * 1.02197486);
+    srand(1);
+    for (i = 0; i < ksmps; i++) {
+      in_a[i] = (MYFLT) ((rand() / (double) RAND_MAX - 0.5) * 200.0);
+      in_b[i] = (MYFLT) (rand() / (double) RAND_MAX * 12.0 + 0.01);
+    }
+    if (ksmps > 1)
+      in_b[ksmps - 1] = FL(0.0);    /* exercise the divz default */
+
+    snprintf(title, sizeof(title), "ksmps %d", ksmps);
+    failed = bench_table(&b, title, "samples", seconds);
+    free(in_a); free(in_b); free(out); free(ref); free(cpsocfrc);
+    return failed;
+}
@@ -132,6 +132,36 @@ void test_wrap(void) {
     csoundDestroy(csound);
 }
 
+void test_acquire_commit(void) {
+    int i, j;
+    CSOUND* csound = csoundCreate(NULL);
+    void *rb = csoundCreateCircularBuffer(csound, 32, sizeof(float));
+    CU_ASSERT_PTR_NOT_NULL(rb);
+    int writeindex = 0;
+    int readindex = 0;
+    for (i = 0 ; i < 40; i++) {
+        void *ptr;
+        int n = csoundAcquireWriteCircularBuffer(csound, rb, &ptr, 7);
+        CU_ASSERT(n > 0 && n <= 7);
+        for (j = 0; j < n; j++) {
+            ((float *) ptr)[j] = writeindex++;
+        }
+        csoundCommitWriteCircularBuffer(csound, rb, n);
+        n = csoundAcquireReadCircularBuffer(csound, rb, &ptr, 7);
+        CU_ASSERT(n > 0 && n <= 7);
+        for (j = 0; j < n; j++) {
+            CU_ASSERT_EQUAL(((float *) ptr)[j], readindex++);
+        }
+        csoundCommitReadCircularBuffer(csound, rb, n);
+    }
+    float val;
+    while (csoundReadCircularBuffer(csound, rb, &val, 1) == 1) {
+        CU_ASSERT_EQUAL(val, readindex++);
+    }
+    CU_ASSERT_EQUAL(readindex, writeindex);
+    csoundDestroyCircularBuffer(csound, rb);
+    csoundDestroy(csound);
+}
 
 int main()
 {
@@ -152,6 +182,7 @@ int main()
             || (NULL == CU_add_test(pSuite, "Test read and write diff sizes", test_read_write_diff_size))
             || (NULL == CU_add_test(pSuite, "Test peek", test_peek))
             || (NULL == CU_add_test(pSuite, "Test wrap", test_wrap))
+            || (NULL == CU_add_test(pSuite, "Test acquire and commit", test_acquire_commit))
         )
     {
         CU_cleanup_registry();
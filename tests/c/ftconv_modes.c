@@ -0,0 +1,194 @@
+/*
+ * File:   ftconv_modes.c
+ *
+ * ftconv with a maximum partition length (non-uniform partitions, the
+ * longer ones computed by the engine's worker thread where they span two
+ * or more control periods) gives the output of the uniform mode, to
+ * within rounding, for ksmps that divide the partition length and ksmps
+ * that do not, with two non-uniform instances sharing the worker.  The
+ * worker adds the blocks of its levels as they are done, so the order of
+ * the sums, and with it the rounding, depends on the timing.  Built like
+ * the regression tests (see
+ * opcode_regression.h), with the FFT, the IR cache and the threads of the
+ * library, as the same comparison through the API needs the orchestra
+ * compiler.
+ *
+ *   ftconvModes
+ */
+
+#include <math.h>
+#include "opcode_regression.h"
+#include "../../Opcodes/ftconv.c"
+
+#define PARTLEN     64
+#define MAXPARTLEN  2048
+#define IRLEN       10000           /* frames, of two channels */
+#define NSAMPLES    44100           /* a second, over four times the IR */
+#define MAXKSMPS    1000
+
+#ifdef USE_DOUBLE
+#define TOLERANCE   1.0e-9
+#else
+#define TOLERANCE   1.0e-4
+#endif
+
+/* defined in OOps/fftlib.c and Top/threads.c, built into the test */
+
+extern void *csoundRealFFT2Setup(CSOUND *, int, int);
+extern void csoundRealFFT2(CSOUND *, void *, MYFLT *);
+extern void csoundRealFFT2Release(CSOUND *, void *);
+extern MYFLT csoundGetInverseRealFFTScale(CSOUND *, int);
+
+/* the callbacks, run as at the end of a note and on reset */
+
+#define MAXCALLBACKS    16
+
+typedef struct {
+    void    *p;
+    int     (*func)(CSOUND *, void *);
+} CALLBACK;
+
+static CALLBACK deinits[MAXCALLBACKS], resets[MAXCALLBACKS];
+static int      ndeinits = 0, nresets = 0;
+
+static int add_deinit(CSOUND *csound, void *p, int (*func)(CSOUND *, void *))
+{
+    (void) csound;
+    if (ndeinits >= MAXCALLBACKS)
+      return CSOUND_MEMORY;
+    deinits[ndeinits].p = p;
+    deinits[ndeinits++].func = func;
+    return OK;
+}
+
+static int add_reset(CSOUND *csound, void *p, int (*func)(CSOUND *, void *))
+{
+    (void) csound;
+    if (nresets >= MAXCALLBACKS)
+      return CSOUND_MEMORY;
+    resets[nresets].p = p;
+    resets[nresets++].func = func;
+    return OK;
+}
+
+static void run_callbacks(CSOUND *csound, CALLBACK *c, int *n)
+{
+    int     i;
+
+    for (i = 0; i < *n; i++)
+      c[i].func(csound, c[i].p);
+    *n = 0;
+}
+
+static void sleep_ms(size_t ms)
+{
+    csoundSleep(ms);
+}
+
+static MYFLT    aIn[MAXKSMPS], aOut[3][2][MAXKSMPS];
+static MYFLT    ift = FL(1.0), ipartlen = (MYFLT) PARTLEN, izero = FL(0.0);
+static MYFLT    imaxlen = (MYFLT) MAXPARTLEN;
+static OPTXT    optext;                 /* for OUTOCOUNT */
+
+/* the instances are kept from case to case, so that each is initialised
+   again as in a note that reuses an instrument instance */
+
+static int ftconv_start(CSOUND *csound, FTCONV *p, MYFLT (*out)[MAXKSMPS],
+                        MYFLT *imax)
+{
+    p->h.insdshead = &reg_ip;
+    p->h.optext = &optext;
+    p->aOut[0] = out[0];
+    p->aOut[1] = out[1];
+    p->aIn = aIn;
+    p->iFTNum = &ift;
+    p->iPartLen = &ipartlen;
+    p->iSkipSamples = &izero;
+    p->iTotLen = &izero;
+    p->iSkipInit = &izero;
+    p->iMaxPartLen = imax;
+    return ftconv_init(csound, p);
+}
+
+/* the largest difference between the uniform output and those of the
+   non-uniform instances, relative to the peak of the uniform one */
+
+static double compare_modes(CSOUND *csound, int ksmps)
+{
+    static FTCONV u, n1, n2;
+    double  err = 0.0, peak = 0.0, d;
+    int     i, c, j, k;
+
+    csound->ksmps = ksmps;
+    reg_ip.ksmps = ksmps;
+    reg_ip.ekr = (MYFLT) REG_SR / ksmps;
+    reg_rand_state = 1;
+    if (ftconv_start(csound, &u, aOut[0], &izero) != OK ||
+        ftconv_start(csound, &n1, aOut[1], &imaxlen) != OK ||
+        ftconv_start(csound, &n2, aOut[2], &imaxlen) != OK)
+      return HUGE_VAL;
+    for (k = 0; k < NSAMPLES; k += ksmps) {
+      for (i = 0; i < ksmps; i++)
+        aIn[i] = reg_rand();
+      if (ftconv_perf(csound, &u) != OK || ftconv_perf(csound, &n1) != OK ||
+          ftconv_perf(csound, &n2) != OK)
+        return HUGE_VAL;
+      for (c = 0; c < 2; c++) {
+        for (i = 0; i < ksmps; i++) {
+          for (j = 1; j <= 2; j++) {
+            d = fabs((double) aOut[0][c][i] - (double) aOut[j][c][i]);
+            if (d > err)
+              err = d;
+          }
+          if (fabs((double) aOut[0][c][i]) > peak)
+            peak = fabs((double) aOut[0][c][i]);
+        }
+      }
+    }
+    run_callbacks(csound, deinits, &ndeinits);
+    return (peak > 0.0 ? err / peak : HUGE_VAL);
+}
+
+int main(int argc, char **argv)
+{
+    static const int ksmps[] = { PARTLEN, 4 * PARTLEN, 16, 100, MAXKSMPS };
+    static OPARMS oparms;
+    CSOUND  *csound = reg_init(argc, argv);
+    FUNC    *ftp;
+    char    name[64];
+    double  err;
+    int32   i;
+
+    csound->oparms = &oparms;
+    csound->RegisterDeinitCallback = add_deinit;
+    csound->RegisterResetCallback = add_reset;
+    csound->RealFFT2Setup = csoundRealFFT2Setup;
+    csound->RealFFT2 = csoundRealFFT2;
+    csound->RealFFT2Release = csoundRealFFT2Release;
+    csound->GetInverseRealFFTScale = csoundGetInverseRealFFTScale;
+    csound->CreateThread = csoundCreateThread;
+    csound->JoinThread = csoundJoinThread;
+    csound->CreateThreadLock = csoundCreateThreadLock;
+    csound->WaitThreadLock = csoundWaitThreadLock;
+    csound->NotifyThreadLock = csoundNotifyThreadLock;
+    csound->DestroyThreadLock = csoundDestroyThreadLock;
+    csound->Create_Mutex = csoundCreateMutex;
+    csound->LockMutex = csoundLockMutex;
+    csound->UnlockMutex = csoundUnlockMutex;
+    csound->DestroyMutex = csoundDestroyMutex;
+    csound->Sleep = sleep_ms;
+    optext.t.outArgCount = 2;
+    /* a decaying noise, interleaved */
+    ftp = reg_table(1, 2 * IRLEN);
+    for (i = 0; i < 2 * IRLEN; i++)
+      ftp->ftable[i] = reg_rand() * (MYFLT) exp(-3.0 * i / (2.0 * IRLEN));
+    for (i = 0; i < (int32) (sizeof(ksmps) / sizeof(ksmps[0])); i++) {
+      err = compare_modes(csound, ksmps[i]);
+      snprintf(name, sizeof(name), "ksmps %d, difference %.1e", ksmps[i], err);
+      printf("%-40s %s\n", name, err < TOLERANCE ? "ok" : "DIFFERS");
+      if (!(err < TOLERANCE))
+        reg_failed = 1;
+    }
+    run_callbacks(csound, resets, &nresets);
+    return reg_failed;
+}
@@ -0,0 +1,121 @@
+/*
+ * File:   ftconv_test.c
+ *
+ * ftconv with a maximum partition length (non-uniform partitions, the
+ * longer ones on a worker thread where they span two or more control
+ * periods) gives the output of the uniform mode, to within rounding,
+ * for ksmps that are multiples of the partition length and ksmps that
+ * are not.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "csound.h"
+#include "CUnit/Basic.h"
+
+#define PARTLEN     64
+#define MAXPARTLEN  2048
+#define NSAMPLES    44100           /* a second, over twice the IR */
+
+#ifdef USE_DOUBLE
+#define TOLERANCE   1.0e-9
+#else
+#define TOLERANCE   1.0e-4
+#endif
+
+int init_suite1(void)
+{
+    return 0;
+}
+
+int clean_suite1(void)
+{
+    return 0;
+}
+
+/* the largest difference between the uniform (left) and non-uniform
+   (right) outputs, relative to the peak of the uniform one */
+
+static double compare_modes(int ksmps)
+{
+    char    orc[512];
+    CSOUND  *csound = csoundCreate(NULL);
+    MYFLT   *spout;
+    double  err = 0.0, peak = 0.0;
+    int     i, n = 0;
+
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "-d");
+    csoundSetOption(csound, "-m0");
+    snprintf(orc, 512,
+             "sr = 44100\nksmps = %d\nnchnls = 2\n0dbfs = 1\n"
+             "gir ftgen 1, 0, -20000, -10, 1, 0.5, 0.3, 0.2, 0.1\n"
+             "instr 1\n"
+             "asig rand 0.5, 0.1234\n"
+             "au ftconv asig, 1, %d\n"
+             "an ftconv asig, 1, %d, 0, 0, 0, %d\n"
+             "outs au, an\n"
+             "endin\n", ksmps, PARTLEN, PARTLEN, MAXPARTLEN);
+    CU_ASSERT_EQUAL(csoundCompileOrc(csound, orc), 0);
+    CU_ASSERT_EQUAL(csoundReadScore(csound, "i 1 0 2\n"), 0);
+    CU_ASSERT_EQUAL(csoundStart(csound), 0);
+    spout = csoundGetSpout(csound);
+    while (n < NSAMPLES && csoundPerformKsmps(csound) == 0) {
+      for (i = 0; i < ksmps; i++) {
+        double d = fabs((double) spout[2 * i] - (double) spout[2 * i + 1]);
+        if (d > err)
+          err = d;
+        if (fabs((double) spout[2 * i]) > peak)
+          peak = fabs((double) spout[2 * i]);
+      }
+      n += ksmps;
+    }
+    csoundDestroy(csound);
+    CU_ASSERT(n >= NSAMPLES);
+    CU_ASSERT(peak > 0.0);
+    return (peak > 0.0 ? err / peak : HUGE_VAL);
+}
+
+void test_ksmps_multiple(void)
+{
+    CU_ASSERT(compare_modes(PARTLEN) < TOLERANCE);
+    CU_ASSERT(compare_modes(4 * PARTLEN) < TOLERANCE);
+}
+
+void test_ksmps_not_multiple(void)
+{
+    CU_ASSERT(compare_modes(16) < TOLERANCE);
+    CU_ASSERT(compare_modes(100) < TOLERANCE);
+    CU_ASSERT(compare_modes(1000) < TOLERANCE);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+      return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("ftconv tests", init_suite1, clean_suite1);
+    if (NULL == pSuite) {
+      CU_cleanup_registry();
+      return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if ((NULL == CU_add_test(pSuite, "Test ksmps a multiple of iPartLen",
+                             test_ksmps_multiple)) ||
+        (NULL == CU_add_test(pSuite, "Test ksmps not a multiple of iPartLen",
+                             test_ksmps_not_multiple))) {
+      CU_cleanup_registry();
+      return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -0,0 +1,134 @@
+/*
+ * File:   kernel_bench.h
+ *
+ * The parts the kernel benchmarks of this directory share: the variants
+ * (the old scalar loops, and the kernels for each instruction set the
+ * bench has defined HAVE_AVX2_KERNELS or HAVE_AVX512_KERNELS for), the
+ * command line, the timing and the table of results.  A bench includes
+ * it after its kernels and fills in a KERNEL_BENCH.
+ *
+ *   xxxBench [ksmps [seconds-per-kernel]]
+ *
+ * returns non-zero if a kernel does not give the results of the scalar
+ * loops; with a short time per kernel (0.01 s) it is run as a test.
+ */
+
+#ifndef KERNEL_BENCH_H
+#define KERNEL_BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+enum { VAR_SCALAR, VAR_GENERIC, VAR_AVX2, VAR_AVX512, NVARIANTS };
+
+static const char *variant_name[NVARIANTS] = {
+    "scalar", "generic", "avx2", "avx512"
+};
+
+typedef struct {
+    int         nops;
+    const char  **op_name;
+    /* units (samples, bins) per second of variant v of kernel op */
+    double      (*measure)(int v, int op, double seconds);
+    /* non-zero, after saying how on stderr, if variant v of kernel op
+       differs from the scalar loop */
+    int         (*compare)(int v, int op);
+} KERNEL_BENCH;
+
+static int have_variant(int v)
+{
+    switch (v) {
+    case VAR_SCALAR:
+    case VAR_GENERIC:
+      return 1;
+#ifdef HAVE_AVX2_KERNELS
+    case VAR_AVX2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2");
+#endif
+#ifdef HAVE_AVX512_KERNELS
+    case VAR_AVX512:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx512f");
+#endif
+    }
+    return 0;
+}
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + 1.0e-9 * (double) ts.tv_nsec;
+}
+
+/* calls per second of call(v, op), made iters at a time until at least
+   'seconds' have gone */
+
+static double bench_rate(void (*call)(int v, int op), int v, int op,
+                         long iters, double seconds)
+{
+    long   i, total = 0;
+    double t0 = bench_now(), t;
+    do {
+      for (i = 0; i < iters; i++)
+        call(v, op);
+      total += iters;
+      t = bench_now() - t0;
+    } while (t < seconds);
+    return (double) total / t;
+}
+
+/* ksmps and the seconds per kernel from the command line; non-zero if
+   they make no sense */
+
+static int bench_args(int argc, char **argv, int *ksmps, double *seconds)
+{
+    if (argc > 1)
+      *ksmps = atoi(argv[1]);
+    if (argc > 2)
+      *seconds = atof(argv[2]);
+    if (*ksmps < 1 || *seconds < 0.0) {
+      fprintf(stderr, "usage: %s [ksmps [seconds-per-kernel]]\n", argv[0]);
+      return 1;
+    }
+    return 0;
+}
+
+/* one table of rates in 'units' per second, a row per kernel and a
+   column per variant the CPU has, with the speedups over the scalar
+   loops and a mark where a variant failed the comparison; non-zero if
+   one did */
+
+static int bench_table(const KERNEL_BENCH *b, const char *title,
+                       const char *units, double seconds)
+{
+    double base, rate;
+    int    op, v, bad, failed = 0;
+
+    printf("%s, M%s/s (speedup over scalar)\n", title, units);
+    printf("%-10s", "");
+    for (v = 0; v < NVARIANTS; v++)
+      if (have_variant(v))
+        printf(" %18s", variant_name[v]);
+    printf("\n");
+    for (op = 0; op < b->nops; op++) {
+      printf("%-10s", b->op_name[op]);
+      base = b->measure(VAR_SCALAR, op, seconds);
+      for (v = 0; v < NVARIANTS; v++) {
+        if (!have_variant(v))
+          continue;
+        rate = (v == VAR_SCALAR ? base : b->measure(v, op, seconds));
+        bad = (v == VAR_SCALAR ? 0 : b->compare(v, op));
+        printf(" %10.1f (%4.2fx)%s", rate * 1.0e-6, rate / base,
+               bad ? "!" : " ");
+        failed |= bad;
+      }
+      printf("\n");
+    }
+    printf("\n");
+    return failed;
+}
+
+#endif  /* KERNEL_BENCH_H */
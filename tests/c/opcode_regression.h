@@ -0,0 +1,259 @@
+/*
+ * File:   opcode_regression.h
+ *
+ * The parts the opcode regression tests of this directory share.  A
+ * test includes the source of the opcodes it covers, runs them on a
+ * CSOUND that has only what they call filled in, and compares a hash of
+ * every bit of their output with the one recorded from the code before
+ * a change that was meant to leave the output as it was.
+ *
+ *   xxxRegression [-p]
+ *
+ * returns non-zero if an output differs; with -p it prints the hashes
+ * instead, to record new references after an intended change.
+ *
+ * The tables are made without the maths library, but some opcodes call
+ * it (pow(), cos()), so the references hold for the x86-64 glibc they
+ * were recorded with, with the definitions of the build (the phases of
+ * B64BIT, the rounding of USE_LRINT).
+ */
+
+#ifndef OPCODE_REGRESSION_H
+#define OPCODE_REGRESSION_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include "csoundCore.h"
+#include "csound_standard_types.h"
+
+#define REG_SR      44100
+#define REG_KSMPS   64
+#define REG_NTABS   40
+
+static CSOUND   reg_csound;
+static INSDS    reg_ip;
+static FUNC     *reg_tabs[REG_NTABS];
+static int      reg_print = 0, reg_failed = 0;
+
+/* the type of the arguments of IS_ASIG_ARG(): a-rate if registered */
+
+const CS_TYPE   CS_VAR_TYPE_A;
+static MYFLT    *reg_asig = NULL;
+
+CS_TYPE *csoundGetTypeForArg(void *argPtr)
+{
+    return (argPtr != NULL && argPtr == (void*) reg_asig ?
+            (CS_TYPE*) &CS_VAR_TYPE_A : NULL);
+}
+
+/* tables, with the guard point and the fields the opcodes use */
+
+static uint32_t reg_rand_state = 1;
+
+static inline MYFLT reg_rand(void)          /* [-0.5, 0.5) */
+{
+    reg_rand_state = reg_rand_state * 1664525U + 1013904223U;
+    return (MYFLT) (reg_rand_state >> 8) / FL(16777216.0) - FL(0.5);
+}
+
+static FUNC *reg_table(int fno, int32 flen)
+{
+    FUNC    *ftp = (FUNC*) calloc(1, sizeof(FUNC));
+
+    ftp->ftable = (MYFLT*) calloc(flen + 8, sizeof(MYFLT));
+    ftp->flen = flen;
+    ftp->fno = fno;
+    ftp->lenmask = flen - 1;
+    ftp->lobits = 0;
+    while (((int64_t) flen << ftp->lobits) < MAXLEN)
+      ftp->lobits++;
+    ftp->lomask = (1L << ftp->lobits) - 1;
+    ftp->lodiv = FL(1.0) / (MYFLT) (1L << ftp->lobits);
+    reg_tabs[fno] = ftp;
+    return ftp;
+}
+
+/* a parabolic approximation of a sine over one period of the table */
+
+static MYFLT reg_sine(int32 i, int32 flen)
+{
+    MYFLT   x = (MYFLT) (i % flen) / (MYFLT) flen * FL(2.0) - FL(1.0);
+    return FL(4.0) * x * (FL(1.0) - (x < FL(0.0) ? -x : x));
+}
+
+static FUNC *reg_ftfind(CSOUND *csound, MYFLT *argp)
+{
+    int     n = (int) *argp;
+    (void) csound;
+    return (n > 0 && n < REG_NTABS ? reg_tabs[n] : NULL);
+}
+
+static void reg_auxalloc(CSOUND *csound, size_t nbytes, AUXCH *auxchp)
+{
+    (void) csound;
+    free(auxchp->auxp);
+    auxchp->auxp = calloc(1, nbytes);
+    auxchp->size = nbytes;
+    auxchp->endp = (char*) auxchp->auxp + nbytes;
+}
+
+static void *reg_malloc(CSOUND *csound, size_t nbytes)
+{
+    (void) csound;
+    return malloc(nbytes);
+}
+
+static void *reg_calloc(CSOUND *csound, size_t nbytes)
+{
+    (void) csound;
+    return calloc(1, nbytes);
+}
+
+static void reg_free(CSOUND *csound, void *p)
+{
+    (void) csound;
+    free(p);
+}
+
+static int reg_initerror(CSOUND *csound, const char *msg, ...)
+{
+    (void) csound;
+    fprintf(stderr, "init error: %s\n", msg);
+    return NOTOK;
+}
+
+static int reg_perferror(CSOUND *csound, INSDS *ip, const char *msg, ...)
+{
+    (void) csound; (void) ip;
+    fprintf(stderr, "perf error: %s\n", msg);
+    return NOTOK;
+}
+
+static void reg_warning(CSOUND *csound, const char *msg, ...)
+{
+    (void) csound; (void) msg;
+}
+
+static void reg_message(CSOUND *csound, const char *msg, ...)
+{
+    (void) csound; (void) msg;
+}
+
+static char *reg_localize(const char *s)
+{
+    return (char*) s;
+}
+
+/* a few global variables are enough for the opcodes tested */
+
+#define REG_NGLOBALS    4
+
+static char     reg_gname[REG_NGLOBALS][64];
+static void     *reg_gvar[REG_NGLOBALS];
+
+static void *reg_queryglobal(CSOUND *csound, const char *name)
+{
+    int     i;
+    (void) csound;
+    for (i = 0; i < REG_NGLOBALS; i++)
+      if (reg_gvar[i] != NULL && strcmp(name, reg_gname[i]) == 0)
+        return reg_gvar[i];
+    return NULL;
+}
+
+static int reg_createglobal(CSOUND *csound, const char *name, size_t nbytes)
+{
+    int     i;
+    if (reg_queryglobal(csound, name) != NULL)
+      return CSOUND_ERROR;
+    for (i = 0; i < REG_NGLOBALS && reg_gvar[i] != NULL; i++)
+      ;
+    if (i >= REG_NGLOBALS)
+      return CSOUND_MEMORY;
+    strncpy(reg_gname[i], name, sizeof(reg_gname[i]) - 1);
+    reg_gvar[i] = calloc(1, nbytes);
+    return CSOUND_SUCCESS;
+}
+
+static int      reg_noutputs = 1;
+
+static int reg_outargcnt(void *p)
+{
+    (void) p;
+    return reg_noutputs;
+}
+
+static uint32_t reg_seed(void)
+{
+    return 12345;
+}
+
+/* defined in OOps/random.c, built into the test */
+
+extern uint32_t csoundRandMT(CsoundRandMTState *p);
+extern void csoundSeedRandMT(CsoundRandMTState *p,
+                             const uint32_t *initKey, uint32_t keyLength);
+
+static CSOUND *reg_init(int argc, char **argv)
+{
+    CSOUND  *csound = &reg_csound;
+
+    reg_print = (argc > 1 && strcmp(argv[1], "-p") == 0);
+    csound->esr = REG_SR;
+    csound->onedsr = FL(1.0) / REG_SR;
+    csound->sicvt = FMAXLEN / REG_SR;
+    csound->e0dbfs = FL(1.0);
+    csound->ksmps = REG_KSMPS;
+    csound->FTFind = reg_ftfind;
+    csound->FTFindP = reg_ftfind;
+    csound->FTnp2Find = reg_ftfind;
+    csound->AuxAlloc = reg_auxalloc;
+    csound->Malloc = reg_malloc;
+    csound->Calloc = reg_calloc;
+    csound->Free = reg_free;
+    csound->InitError = reg_initerror;
+    csound->PerfError = reg_perferror;
+    csound->Warning = reg_warning;
+    csound->Message = reg_message;
+    csound->LocalizeString = reg_localize;
+    csound->CreateGlobalVariable = reg_createglobal;
+    csound->QueryGlobalVariable = reg_queryglobal;
+    csound->GetOutputArgCnt = reg_outargcnt;
+    csound->GetRandomSeedFromTime = reg_seed;
+    csound->RandMT = csoundRandMT;
+    csound->SeedRandMT = csoundSeedRandMT;
+    reg_ip.ksmps = REG_KSMPS;
+    reg_ip.ekr = (MYFLT) REG_SR / REG_KSMPS;
+    return csound;
+}
+
+/* FNV-1a over the bits of the samples */
+
+static void reg_hash(uint64_t *h, const MYFLT *x, int n)
+{
+    const unsigned char *b = (const unsigned char*) x;
+    size_t  i;
+
+    for (i = 0; i < (size_t) n * sizeof(MYFLT); i++)
+      *h = (*h ^ b[i]) * 0x100000001b3ULL;
+}
+
+#define REG_HASH0   0xcbf29ce484222325ULL
+
+/* compares the hash of one case with its reference, or prints it */
+
+static void reg_check(const char *name, uint64_t h, uint64_t ref)
+{
+    if (reg_print) {
+      printf("    0x%016llxULL,   /* %s */\n", (unsigned long long) h, name);
+      return;
+    }
+    printf("%-40s %s\n", name, h == ref ? "ok" : "DIFFERS");
+    if (h != ref)
+      reg_failed = 1;
+}
+
+#endif  /* OPCODE_REGRESSION_H */
@@ -0,0 +1,150 @@
+/*
+ * File:   oscbnk_regression.c
+ *
+ * The output of grain2 and grain3, in their window and grain
+ * interpolation and frequency locking modes, at steady and modulated
+ * grain durations, frequencies and densities, and with sample accurate
+ * starts and ends.  The references are of the code before grain2 ran one
+ * oscillator after another and grain3 counted the samples of its loops,
+ * which was meant to leave the output as it was, bit for bit.
+ *
+ *   oscbnkRegression [-p]
+ *
+ * (see opcode_regression.h)
+ */
+
+#include "opcode_regression.h"
+#include "../../Opcodes/oscbnk.c"
+
+/* the bits of a case, over those of imode */
+
+#define M_MOD       0x100   /* modulated duration, frequency and density */
+#define M_OFFSET    0x200   /* sample accurate starts and ends */
+
+typedef struct {
+    int     grain3, mode;
+    MYFLT   gdur, overlap, fmd;
+} CASE;
+
+static const CASE cases[] = {
+    { 0, 0, 0.05, 20.0, 100.0 },
+    { 0, 2 | 8, 0.02, 50.0, 300.0 },
+    { 0, 4 | M_MOD, 0.1, 10.0, 50.0 },
+    { 0, 8 | M_OFFSET, 0.03, 30.0, 0.0 },
+    { 1, 0, 0.05, 200.0, 100.0 },
+    { 1, 2 | 8 | 0x40, 0.02, 500.0, 300.0 },
+    { 1, 4 | 0x20 | M_MOD, 0.1, 100.0, 50.0 },
+    { 1, 8 | 0x10 | M_OFFSET, 0.03, 300.0, 0.0 }
+};
+
+#define NCASES ((int) (sizeof(cases) / sizeof(cases[0])))
+
+/* recorded with the code of before the change, in double and in float
+   builds */
+
+static const uint64_t refs[NCASES] = {
+#ifdef USE_DOUBLE
+    0xaf7102c350085926ULL,   /* grain2, case 0 */
+    0x915d539019cde9f5ULL,   /* grain2, case 1 */
+    0xe694495a8c727295ULL,   /* grain2, case 2 */
+    0xa277541ed0005c4cULL,   /* grain2, case 3 */
+    0x319a287ab975dca6ULL,   /* grain3, case 4 */
+    0x6a17a8cec047f462ULL,   /* grain3, case 5 */
+    0x6a658cdb1a8d2406ULL,   /* grain3, case 6 */
+    0xa590817f493f08dbULL,   /* grain3, case 7 */
+#else
+    0x38aa30ca16c6e2e4ULL,   /* grain2, case 0 */
+    0xd56e89f87d217bd4ULL,   /* grain2, case 1 */
+    0x2b143e161df3f14bULL,   /* grain2, case 2 */
+    0x127e4fc7fcb7264dULL,   /* grain2, case 3 */
+    0x4997f9eebdd5790bULL,   /* grain3, case 4 */
+    0xfd53d118b1c1d5f6ULL,   /* grain3, case 5 */
+    0xd16c01410909ba6eULL,   /* grain3, case 6 */
+    0xfc8d1ced56d116ecULL,   /* grain3, case 7 */
+#endif
+};
+
+/* only for the table opcodes */
+
+PUBLIC int csoundGetTable(CSOUND *csound, MYFLT **tablePtr, int tableNum)
+{
+    (void) csound; (void) tableNum;
+    *tablePtr = NULL;
+    return -1;
+}
+
+static uint64_t run_case(CSOUND *csound, const CASE *t, int cycles)
+{
+    static MYFLT out[REG_KSMPS];
+    MYFLT   cps = FL(220.0), fmd = t->fmd, gdur = t->gdur;
+    MYFLT   overlap = t->overlap, fn = FL(1.0), wfn = FL(2.0);
+    MYFLT   rpow = FL(0.5), seed = FL(1234.0), mode = (MYFLT) (t->mode & 0xFF);
+    MYFLT   phs = FL(0.1), pmd = FL(0.3), maxovr = FL(2000.0);
+    MYFLT   frpow = FL(0.7), prpow = -FL(2.0);
+    GRAIN2  g2;
+    GRAIN3  g3;
+    uint64_t h = REG_HASH0;
+    int     c, ok;
+
+    memset(&g2, 0, sizeof(g2));
+    memset(&g3, 0, sizeof(g3));
+    reg_ip.ksmps_offset = reg_ip.ksmps_no_end = 0;
+    if (!t->grain3) {
+      g2.h.insdshead = &reg_ip;
+      g2.ar = out; g2.kcps = &cps; g2.kfmd = &fmd; g2.kgdur = &gdur;
+      g2.iovrlp = &overlap; g2.kfn = &fn; g2.iwfn = &wfn; g2.irpow = &rpow;
+      g2.iseed = &seed; g2.imode = &mode;
+      ok = grain2set(csound, &g2);
+    }
+    else {
+      g3.h.insdshead = &reg_ip;
+      g3.ar = out; g3.kcps = &cps; g3.kphs = &phs; g3.kfmd = &fmd;
+      g3.kpmd = &pmd; g3.kgdur = &gdur; g3.kdens = &overlap;
+      g3.imaxovr = &maxovr; g3.kfn = &fn; g3.iwfn = &wfn;
+      g3.kfrpow = &frpow; g3.kprpow = &prpow; g3.iseed = &seed;
+      g3.imode = &mode;
+      ok = grain3set(csound, &g3);
+    }
+    if (ok != OK)
+      return 0;
+    for (c = 0; c < cycles; c++) {
+      if (t->mode & M_MOD) {
+        gdur = t->gdur * (FL(1.0) + FL(0.5) * reg_sine(c, 628));
+        cps = FL(220.0) * (FL(1.0) + FL(0.3) * reg_sine(c, 483));
+        phs = FL(0.1) + FL(0.05) * c;
+        overlap = t->overlap * (FL(1.0) + FL(0.4) * reg_sine(c, 897));
+      }
+      if (t->mode & M_OFFSET) {
+        reg_ip.ksmps_offset = c % 5 == 1 ? c % 17 : 0;
+        reg_ip.ksmps_no_end = c % 7 == 3 ? c % 13 : 0;
+      }
+      ok = (t->grain3 ? grain3(csound, &g3) : grain2(csound, &g2));
+      if (ok != OK)
+        return 0;
+      reg_hash(&h, out, REG_KSMPS);
+    }
+    return h;
+}
+
+int main(int argc, char **argv)
+{
+    CSOUND  *csound = reg_init(argc, argv);
+    FUNC    *ftp;
+    char    name[64];
+    int32   i;
+
+    ftp = reg_table(1, 4096);
+    for (i = 0; i <= ftp->flen; i++)
+      ftp->ftable[i] = reg_sine(i, 4096) + FL(0.3) * reg_sine(3 * i, 4096);
+    ftp = reg_table(2, 16384);
+    for (i = 0; i <= ftp->flen; i++) {
+      MYFLT x = (MYFLT) i / (MYFLT) ftp->flen;
+      ftp->ftable[i] = FL(4.0) * x * (FL(1.0) - x);
+    }
+    for (i = 0; i < NCASES; i++) {
+      snprintf(name, sizeof(name), "%s, case %d",
+               cases[i].grain3 ? "grain3" : "grain2", i);
+      reg_check(name, run_case(csound, &cases[i], 600), refs[i]);
+    }
+    return reg_failed;
+}
@@ -0,0 +1,210 @@
+/*
+ * File:   partikkel_regression.c
+ *
+ * The output of partikkel, in both channels, for a set of cases that
+ * between them go through each path of the grain scheduler and renderer:
+ * the distributions, envelopes and sweeps, the grain limit, the
+ * channel masks, a-rate grain rate, external sync, and sample accurate
+ * starts and ends.  The references are of the code before the grains
+ * were kept in dense arrays, which was meant to leave the output as it
+ * was, bit for bit.
+ *
+ *   partikkelRegression [-p]
+ *
+ * (see opcode_regression.h)
+ */
+
+#include "opcode_regression.h"
+#include "../../Opcodes/partikkel.c"
+
+/* the bits of a case */
+
+#define M_DIST      3       /* 0 periodic, 1 and 2 +-0.5 of the rest */
+#define M_ADR       4       /* long attack and decay */
+#define M_LONG      8       /* grains longer than their period */
+#define M_SWEEP     16      /* sweep shape */
+#define M_RANDMASK  32      /* random masking */
+#define M_MAXGR     64      /* at most 7 grains */
+#define M_PAN       128     /* a pan table */
+#define M_NOFMENV   256     /* no FM envelope table */
+#define M_ARATE     512     /* a-rate grain rate */
+#define M_SYNC      1024    /* external sync */
+#define M_OFFSET    2048    /* sample accurate starts and ends */
+
+static const int cases[] = {
+    0, 1, 2, M_ADR | M_LONG, M_SWEEP | M_RANDMASK, M_MAXGR | M_LONG,
+    M_PAN, M_NOFMENV, M_ARATE, M_SYNC, M_OFFSET, 4095
+};
+
+#define NCASES ((int) (sizeof(cases) / sizeof(cases[0])))
+
+/* recorded with the code of before the change, in double and in float
+   builds */
+
+static const uint64_t refs[NCASES] = {
+#ifdef USE_DOUBLE
+    0xcb48eaaab5e75f7dULL,   /* partikkel, case 0 */
+    0xcf44cc85f222a9f7ULL,   /* partikkel, case 1 */
+    0x21511a6a59f550f4ULL,   /* partikkel, case 2 */
+    0x6fab73cd13a29dfaULL,   /* partikkel, case 12 */
+    0x35bc477adebc277dULL,   /* partikkel, case 48 */
+    0x252af95bbff729b6ULL,   /* partikkel, case 72 */
+    0x0b5f538207dd1b53ULL,   /* partikkel, case 128 */
+    0x7cfce8f1c2c71148ULL,   /* partikkel, case 256 */
+    0x29e8f13c8e8b8073ULL,   /* partikkel, case 512 */
+    0xc9ae7473efbcbf2aULL,   /* partikkel, case 1024 */
+    0xf07633a08ab5f426ULL,   /* partikkel, case 2048 */
+    0x50af015d46ba2c53ULL,   /* partikkel, case 4095 */
+#else
+    0xb11f6d83e44dae98ULL,   /* partikkel, case 0 */
+    0x80f1d473b1338f7eULL,   /* partikkel, case 1 */
+    0x98b5dc1def53a617ULL,   /* partikkel, case 2 */
+    0x715c10037a6554dfULL,   /* partikkel, case 12 */
+    0x85bd961876fc5e2eULL,   /* partikkel, case 48 */
+    0x2d54401bebf3f335ULL,   /* partikkel, case 72 */
+    0x0a8bfd6248c3333eULL,   /* partikkel, case 128 */
+    0x7ff7c42a100bf449ULL,   /* partikkel, case 256 */
+    0xaed136dd79ab121cULL,   /* partikkel, case 512 */
+    0x1227e68c4adb42d7ULL,   /* partikkel, case 1024 */
+    0x6fde0f03fb688962ULL,   /* partikkel, case 2048 */
+    0x01409a0a7041bf96ULL,   /* partikkel, case 4095 */
+#endif
+};
+
+static void table(int fno, int32 flen, int kind)
+{
+    FUNC    *ftp = reg_table(fno, flen);
+    int32   i;
+
+    for (i = 0; i <= flen; i++) {
+      MYFLT x = (MYFLT) i / (MYFLT) flen;
+      switch (kind) {
+      case 0: ftp->ftable[i] = reg_sine(i, flen) +
+                FL(0.3) * reg_sine(3 * i, flen); break;
+      case 1: ftp->ftable[i] = reg_sine(i + flen / 4, flen); break;
+      case 2: ftp->ftable[i] = x; break;
+      case 3: ftp->ftable[i] = FL(1.0) - x; break;
+      case 4: ftp->ftable[i] = FL(4.0) * x * (FL(1.0) - x); break;
+      case 5: ftp->ftable[i] = reg_rand(); break;
+      default: ftp->ftable[i] = FL(0.5) + FL(0.5) * x; break;
+      }
+    }
+}
+
+/* a mask table: the loop start and end, in entries of 'size' values,
+   then the values */
+
+static void mask(int fno, int n, int size, const MYFLT *v)
+{
+    FUNC    *ftp = reg_table(fno, n + 2);
+    int     i;
+
+    ftp->ftable[0] = FL(0.0);
+    ftp->ftable[1] = (MYFLT) (n / size - 1);
+    for (i = 0; i < n; i++)
+      ftp->ftable[i + 2] = v[i];
+}
+
+static uint64_t run_case(CSOUND *csound, int mode, MYFLT rate, int cycles)
+{
+    static MYFLT out1[REG_KSMPS], out2[REG_KSMPS], unused[6][REG_KSMPS];
+    static MYFLT gf[REG_KSMPS], sync[REG_KSMPS], fm[REG_KSMPS];
+    static MYFLT sp[4][REG_KSMPS], sc[60];
+    MYFLT   v_dist, v_env2amt = FL(0.5), v_sus = FL(0.3), v_adr, v_dur;
+    MYFLT   v_amp = FL(0.8), v_wf = FL(440.0), v_sweep, v_tfreq = FL(150.0);
+    MYFLT   v_harm = FL(12.0), v_fall = FL(0.7), v_rmask, v_maxg;
+    MYFLT   v_id = FL(0.0), v_pan, v_keys[4], m1 = -FL(1.0);
+    MYFLT   *args[50];
+    PARTIKKEL *p = (PARTIKKEL*) calloc(1, sizeof(PARTIKKEL));
+    uint64_t h = REG_HASH0;
+    int     c, k, i;
+
+    for (k = 0; k < 60; k++)
+      sc[k] = (MYFLT) k;
+    v_dist = ((mode & M_DIST) == 0 ? FL(0.0) :
+              (mode & M_DIST) == 1 ? FL(0.5) : -FL(0.5));
+    v_adr = (mode & M_ADR ? FL(2.5) : FL(0.5));
+    v_dur = (mode & M_LONG ? FL(120.0) : FL(25.0));
+    v_sweep = (mode & M_SWEEP ? FL(0.3) : FL(0.5));
+    v_rmask = (mode & M_RANDMASK ? FL(0.3) : FL(0.0));
+    v_maxg = (mode & M_MAXGR ? FL(7.0) : FL(1000.0));
+    v_pan = (mode & M_PAN ? FL(7.0) : -FL(1.0));
+    v_keys[0] = FL(1.0); v_keys[1] = FL(1.5);
+    v_keys[2] = FL(2.0); v_keys[3] = FL(0.5);
+    {
+      MYFLT *a[50] = {
+        out1, out2, unused[0], unused[1], unused[2], unused[3],
+        unused[4], unused[5],
+        gf, &v_dist, &sc[6], sync, &v_env2amt, &sc[5], &sc[3], &sc[4],
+        &v_sus, &v_adr, &v_dur, &v_amp, &sc[10], &v_wf, &v_sweep,
+        &sc[12], &sc[13], fm, &sc[14], &sc[5], &sc[2], &v_tfreq, &v_harm,
+        &v_fall, &sc[11], &v_rmask, &sc[1], &sc[8],
+        (mode & M_NOFMENV ? &m1 : &sc[2]), &sc[1], &sc[15],
+        sp[0], sp[1], sp[2], sp[3],
+        &v_keys[0], &v_keys[1], &v_keys[2], &v_keys[3],
+        &v_maxg, &v_id, &v_pan
+      };
+      memcpy(args, a, sizeof(args));
+    }
+    reg_asig = (mode & M_ARATE ? gf : NULL);
+    reg_noutputs = 2;
+    for (k = 0; k < REG_KSMPS; k++)
+      gf[k] = rate;
+    p->h.insdshead = &reg_ip;
+    memcpy(&p->output1, args, sizeof(args));
+    reg_ip.ksmps_offset = reg_ip.ksmps_no_end = 0;
+    if (partikkel_init(csound, p) != OK)
+      return 0;
+    for (c = 0; c < cycles; c++) {
+      int32 n = c * REG_KSMPS;
+      for (k = 0; k < REG_KSMPS; k++) {
+        fm[k] = FL(0.3) * reg_sine(n + k, 2000);
+        sync[k] = FL(0.0);
+        for (i = 0; i < 4; i++)
+          sp[i][k] = FL(0.1) * i + FL(0.001) * k;
+        if (mode & M_ARATE)
+          gf[k] = rate * (FL(1.0) + FL(0.5) * reg_sine(n + k, 6000));
+      }
+      if ((mode & M_SYNC) && c % 5 == 2) {
+        sync[10] = FL(1.0); sync[11] = FL(1.0); sync[40] = FL(0.3);
+      }
+      if (!(mode & M_ARATE))
+        gf[0] = rate * (FL(1.0) + FL(0.2) * reg_sine(c, 60));
+      reg_ip.ksmps_offset = (mode & M_OFFSET) && c % 7 == 3 ? 5 : 0;
+      reg_ip.ksmps_no_end = (mode & M_OFFSET) && c % 11 == 4 ? 9 : 0;
+      if (partikkel(csound, p) != OK)
+        return 0;
+      reg_hash(&h, out1, REG_KSMPS);
+      reg_hash(&h, out2, REG_KSMPS);
+    }
+    free(p);
+    return h;
+}
+
+int main(int argc, char **argv)
+{
+    CSOUND  *csound = reg_init(argc, argv);
+    char    name[64];
+    int     i;
+
+    table(1, 4096, 0); table(2, 4096, 1); table(3, 1024, 2);
+    table(4, 1024, 3); table(5, 2048, 4); table(6, 256, 5);
+    table(7, 512, 6); table(8, 4097, 0);
+    {
+      static const MYFLT gains[] = { 1.0, 0.5, 0.8 };
+      static const MYFLT chans[] = { 0.0, 0.5, 1.0, 1.7, 0.3 };
+      static const MYFLT fstart[] = { 1.0, 1.5, 0.7 };
+      static const MYFLT fend[] = { 1.0, 0.5, 2.0, 1.0 };
+      static const MYFLT fmidx[] = { 0.5, 1.0, 0.0 };
+      static const MYFLT wgains[] = { 0.5, 0.3, 0.2, 0.4, 0.25,
+                                      0.1, 0.6, 0.0, 0.2, 0.5 };
+      mask(10, 3, 1, gains); mask(11, 5, 1, chans);
+      mask(12, 3, 1, fstart); mask(13, 4, 1, fend);
+      mask(14, 3, 1, fmidx); mask(15, 10, 5, wgains);
+    }
+    for (i = 0; i < NCASES; i++) {
+      snprintf(name, sizeof(name), "partikkel, case %d", cases[i]);
+      reg_check(name, run_case(csound, cases[i], FL(200.0), 300), refs[i]);
+    }
+    return reg_failed;
+}
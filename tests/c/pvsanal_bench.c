@@ -0,0 +1,282 @@
+/*
+ * File:   pvsanal_bench.c
+ *
+ * Throughput of the sliding DFT kernels of OOps/pvsanal.c (pvsanal with
+ * an overlap below ksmps, and pvsynth of its frames), for each
+ * instruction set pvsanal.c dispatches to and for a few sizes of
+ * transform, against the scalar loops they replaced, with a check that
+ * every variant gives the scalar results to within rounding.  The
+ * polynomial atan2() may put a phase difference of PI on the other side
+ * of the wrap than atan2() of the C library did; those frequencies, a
+ * sample rate apart, are counted as the same.
+ *
+ *   pvsanalBench [ksmps [seconds-per-kernel]]
+ *
+ * (see kernel_bench.h)
+ */
+
+#define __BUILDING_LIBCSOUND
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "csoundCore.h"
+#include "pstream.h"
+
+#define KERNEL      static
+#define KNAME(x)    x##_generic
+#include "../../OOps/pvsanal_kernels.h"
+#undef KNAME
+#undef KERNEL
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#define HAVE_AVX2_KERNELS 1
+#define KERNEL      static __attribute__ ((target ("avx2")))
+#define KNAME(x)    x##_avx2
+#include "../../OOps/pvsanal_kernels.h"
+#undef KNAME
+#undef KERNEL
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    !defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 8
+#define HAVE_AVX512_KERNELS 1
+#define KERNEL      static \
+                    __attribute__ ((target ("avx512f,prefer-vector-width=512")))
+#define KNAME(x)    x##_avx512
+#include "../../OOps/pvsanal_kernels.h"
+#undef KNAME
+#undef KERNEL
+#endif
+
+#include "kernel_bench.h"
+
+enum { OP_ANAL, OP_SYNTH, NOPS };
+
+static const char *op_name[NOPS] = { "pvsanal", "pvsynth" };
+
+#define ESR         44100.0
+#define TOLERANCE   1.0e-9
+
+static int     ksmps = 64, N, NB;
+static MYFLT  *in_dx, *fwre, *fwim, *outfrm, *reffrm, *frm;
+static double *cosine, *sine, *h, *output;
+static SDFT    sd;
+
+/* the loops of pvssanal() (with a Hann window) and of pvssynth() before
+   they called the kernels */
+
+static void scalar_anal(CMPLX *frame)
+{
+    int     i, j;
+    CMPLX   *fw = (CMPLX *) fwre;
+
+    for (i = 0; i < ksmps; i++) {
+      MYFLT re, im, dx = in_dx[i];
+      CMPLX *ff = frame + i * NB;
+      for (j = 0; j < NB; j++) {
+        double ci = cosine[j], si = sine[j];
+        re = fw[j].re + dx;
+        im = fw[j].im;
+        fw[j].re = ci*re - si*im;
+        fw[j].im = ci*im + si*re;
+      }
+      for (j = 0; j < NB; j++) {
+        ff[j].re = FL(0.5)*fw[j].re;
+        ff[j].im = FL(0.5)*fw[j].im;
+      }
+      for (j = 1; j < NB-1; j++) {
+        ff[j].re -= FL(0.25)*(fw[j+1].re + fw[j-1].re);
+        ff[j].im -= FL(0.25)*(fw[j+1].im + fw[j-1].im);
+      }
+      ff[0].re -= FL(0.5)*fw[1].re;
+      ff[NB-1].re -= FL(0.5)*fw[NB-2].re;
+      for (j = 0; j < NB; j++) {
+        double ph = atan2(ff[j].im, ff[j].re);
+        double angleDif = ph - h[j];
+        ff[j].re = hypot(ff[j].re, ff[j].im);
+        h[j] = ph;
+        angleDif -= (double)j * TWOPI/N;
+        angleDif = mod2Pi(angleDif);
+        angleDif = angleDif * N / TWOPI;
+        ff[j].im = ESR * (j + angleDif)/N;
+      }
+    }
+}
+
+static void scalar_synth(const CMPLX *frame)
+{
+    int     i, k;
+
+    for (i = 0; i < ksmps; i++) {
+      const CMPLX *ff = frame + i * NB;
+      for (k = 0; k < NB; k++) {
+        double tmp, phase;
+        tmp = ff[k].im;
+        tmp -= (double)k * ESR/N;
+        tmp *= TWOPI / ESR;
+        tmp += (double)k*TWOPI/N;
+        h[k] = phase = mod2Pi(h[k] + tmp);
+        output[k] = ff[k].re*cos(phase);
+      }
+    }
+}
+
+static void run(int v, int op, MYFLT *r)
+{
+    void (*anal)(SDFT *, SDFT_PART *) = sdft_anal_generic;
+    void (*synth)(const CMPLX *, double *, double *, int32, int32, double) =
+      sdft_synth_generic;
+    int i;
+
+    switch (v) {
+#ifdef HAVE_AVX2_KERNELS
+    case VAR_AVX2:
+      anal = sdft_anal_avx2; synth = sdft_synth_avx2;
+      break;
+#endif
+#ifdef HAVE_AVX512_KERNELS
+    case VAR_AVX512:
+      anal = sdft_anal_avx512; synth = sdft_synth_avx512;
+      break;
+#endif
+    }
+    if (op == OP_ANAL) {
+      if (v == VAR_SCALAR)
+        scalar_anal((CMPLX *) r);
+      else {
+        sd.frame = (CMPLX *) r;
+        anal(&sd, &sd.part[0]);
+      }
+    }
+    else {
+      if (v == VAR_SCALAR)
+        scalar_synth((const CMPLX *) frm);
+      else
+        for (i = 0; i < ksmps; i++)
+          synth((const CMPLX *) frm + i * NB, h, output, NB, N, ESR);
+      for (i = 0; i < NB; i++)
+        r[i] = (MYFLT) output[i];
+    }
+}
+
+/* from the start: no input so far */
+
+static void reset(void)
+{
+    memset(fwre, 0, sizeof(MYFLT) * 2 * (NB + 4));
+    memset(h, 0, sizeof(double) * NB);
+}
+
+static void call(int v, int op)
+{
+    run(v, op, outfrm);
+}
+
+/* bins per second of variant 'v' of kernel 'op' */
+
+static double measure(int v, int op, double seconds)
+{
+    reset();
+    return bench_rate(call, v, op, 16, seconds) * (double) ksmps * (double) NB;
+}
+
+/* the number of values that differ from the scalar results by more than
+   rounding, on the first cycle from the start for a few blocks of input */
+
+static int compare(int v, int op)
+{
+    int c, i, n, bad = 0;
+    n = (op == OP_ANAL ? ksmps * (N + 2) : NB);
+    for (c = 0; c < 16; c++) {
+      reset();
+      run(VAR_SCALAR, op, reffrm);
+      reset();
+      run(v, op, outfrm);
+      for (i = 0; i < n; i++) {
+        double d = fabs(outfrm[i] - reffrm[i]);
+        if (op == OP_ANAL && (i & 1) && fabs(d - ESR) < 1.0e-6 * ESR)
+          continue;                     /* the other side of the wrap */
+        if (d > TOLERANCE * (fabs(reffrm[i]) > 1.0 ? fabs(reffrm[i]) : 1.0))
+          bad++;
+      }
+      for (i = 0; i < ksmps; i++)
+        in_dx[i] = (MYFLT) (rand() / (double) RAND_MAX - 0.5);
+    }
+    if (bad)
+      fprintf(stderr, "%s %s, N %d: %d values differ from scalar\n",
+              op_name[op], variant_name[v], N, bad);
+    return bad;
+}
+
+int main(int argc, char **argv)
+{
+    static const int sizes[] = { 64, 512, 4096 };
+    static const KERNEL_BENCH b = { NOPS, op_name, measure, compare };
+    char   title[48];
+    double seconds = 0.1;
+    int    i, s, failed = 0;
+
+    if (bench_args(argc, argv, &ksmps, &seconds))
+      return 1;
+    in_dx = (MYFLT *) malloc(sizeof(MYFLT) * ksmps);
+    srand(1);
+    for (i = 0; i < ksmps; i++)
+      in_dx[i] = (MYFLT) (rand() / (double) RAND_MAX - 0.5);
+
+    for (s = 0; s < (int) (sizeof(sizes) / sizeof(sizes[0])); s++) {
+      SDFT_PART *q = &sd.part[0];
+      N = sizes[s];
+      NB = N / 2 + 1;
+      /* the scalar loops keep the transform as CMPLX, the kernels as
+         one partition of all the bins, from 2 below the first */
+      fwre = (MYFLT *) calloc(2 * (NB + 4), sizeof(MYFLT));
+      fwim = fwre + NB + 4;
+      cosine = (double *) calloc(2 * (NB + 4), sizeof(double));
+      sine = cosine + NB + 4;
+      h = (double *) calloc(2 * NB, sizeof(double));
+      output = h + NB;
+      frm = (MYFLT *) calloc(ksmps * (N + 2), sizeof(MYFLT));
+      outfrm = (MYFLT *) calloc(ksmps * (N + 2), sizeof(MYFLT));
+      reffrm = (MYFLT *) calloc(ksmps * (N + 2), sizeof(MYFLT));
+      for (i = 0; i < NB; i++) {
+        cosine[i] = cos(TWOPI * i / N);
+        sine[i] = sin(TWOPI * i / N);
+      }
+      memset(&sd, 0, sizeof(SDFT));
+      sd.N = N; sd.NB = NB;
+      sd.nterms = 3;
+      sd.a0 = FL(0.5); sd.a1 = FL(0.25);
+      sd.e1 = FL(0.5);
+      sd.esr = ESR;
+      sd.h = h;
+      sd.dx = in_dx;
+      sd.i0 = 0; sd.i1 = ksmps;
+      sd.nparts = 1;
+      q->sd = &sd;
+      q->base = -2;
+      q->len = NB + 4;
+      q->o0 = 2; q->o1 = NB + 2;
+      q->re = fwre; q->im = fwim;
+      q->yr = (MYFLT *) calloc(2 * (NB + 4), sizeof(MYFLT));
+      q->yi = q->yr + NB + 4;
+      q->c = (double *) calloc(2 * (NB + 4), sizeof(double));
+      q->s = q->c + NB + 4;
+      for (i = 0; i < NB; i++) {
+        q->c[i + 2] = cosine[i];
+        q->s[i + 2] = sine[i];
+      }
+      /* frames for the synthesis */
+      reset();
+      scalar_anal((CMPLX *) frm);
+
+      snprintf(title, sizeof(title), "N %d, ksmps %d", N, ksmps);
+      failed |= bench_table(&b, title, "bins", seconds);
+      free(fwre); free(cosine); free(h); free(frm); free(outfrm);
+      free(reffrm); free(q->yr); free(q->c);
+    }
+    free(in_dx);
+    return failed;
+}
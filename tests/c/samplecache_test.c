@@ -0,0 +1,241 @@
+/*
+ * File:   samplecache_test.c
+ *
+ * Two instances loading the same sound file or memfile share one entry
+ * of the process-wide sample cache, and the entry goes away with them.
+ */
+
+#define __BUILDING_LIBCSOUND
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "csoundCore.h"
+#include "soundio.h"
+#include "prototyp.h"
+#include "CUnit/Basic.h"
+
+#define TEST_FILE   "samplecache_test.wav"
+#define TEST_LEN    5000
+#define TEST_MEMFILE "samplecache_test.dat"
+#define MEMFILE_LEN 4096
+
+static short test_sample(int i)
+{
+    return (short) ((i * 37) % 2001 - 1000);
+}
+
+static void put32(FILE *f, unsigned int x)
+{
+    fputc(x & 0xFF, f); fputc((x >> 8) & 0xFF, f);
+    fputc((x >> 16) & 0xFF, f); fputc((x >> 24) & 0xFF, f);
+}
+
+static void put16(FILE *f, unsigned int x)
+{
+    fputc(x & 0xFF, f); fputc((x >> 8) & 0xFF, f);
+}
+
+/* 16 bit mono WAV: converted by GEN01, so it goes through the cache */
+
+int init_suite1(void)
+{
+    FILE    *f = fopen(TEST_FILE, "wb");
+    int     i;
+
+    if (f == NULL)
+      return -1;
+    fwrite("RIFF", 1, 4, f); put32(f, 36 + 2 * TEST_LEN);
+    fwrite("WAVEfmt ", 1, 8, f); put32(f, 16);
+    put16(f, 1); put16(f, 1); put32(f, 44100); put32(f, 88200);
+    put16(f, 2); put16(f, 16);
+    fwrite("data", 1, 4, f); put32(f, 2 * TEST_LEN);
+    for (i = 0; i < TEST_LEN; i++)
+      put16(f, (unsigned short) test_sample(i));
+    fclose(f);
+    if ((f = fopen(TEST_MEMFILE, "wb")) == NULL)
+      return -1;
+    for (i = 0; i < MEMFILE_LEN; i++)
+      fputc(i & 0xFF, f);
+    fclose(f);
+    return 0;
+}
+
+int clean_suite1(void)
+{
+    remove(TEST_FILE);
+    remove(TEST_MEMFILE);
+    return 0;
+}
+
+static CSOUND *load_table(const char *dbfs)
+{
+    char    orc[256];
+    CSOUND  *csound = csoundCreate(NULL);
+
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "-d");
+    csoundSetOption(csound, "-m0");
+    snprintf(orc, 256, "sr = 44100\nksmps = 32\nnchnls = 1\n0dbfs = %s\n"
+             "gi1 ftgen 1, 0, 8192, -1, \"%s\", 0, 0, 0\n", dbfs, TEST_FILE);
+    CU_ASSERT_EQUAL(csoundCompileOrc(csound, orc), 0);
+    CU_ASSERT_EQUAL(csoundStart(csound), 0);
+    return csound;
+}
+
+static int in_cache(void)
+{
+    size_t  nbytes;
+    void    *entry = samplecache_find(TEST_FILE, SAMPLECACHE_GEN01, AE_SHORT,
+                                      ALLCHNLS, NULL, &nbytes);
+    if (entry == NULL)
+      return 0;
+    samplecache_release(entry);
+    return 1;
+}
+
+static int check_table(CSOUND *csound, MYFLT scale)
+{
+    MYFLT   *tab;
+    int     i, bad = 0;
+
+    if (csoundGetTable(csound, &tab, 1) != 8192)
+      return -1;
+    for (i = 0; i < TEST_LEN; i++)
+      if (tab[i] != (MYFLT) test_sample(i) * scale / FL(32768.0))
+        bad++;
+    for ( ; i < 8192; i++)
+      if (tab[i] != FL(0.0))
+        bad++;
+    return bad;
+}
+
+void test_shared_gen01(void)
+{
+    CSOUND  *a, *b, *c;
+
+    CU_ASSERT_FALSE(in_cache());
+    a = load_table("1");
+    CU_ASSERT_TRUE(in_cache());
+    b = load_table("1");
+    c = load_table("32768");            /* copies from the entry */
+    CU_ASSERT_EQUAL(check_table(a, FL(1.0)), 0);
+    CU_ASSERT_EQUAL(check_table(b, FL(1.0)), 0);
+    CU_ASSERT_EQUAL(check_table(c, FL(32768.0)), 0);
+    csoundDestroy(a);
+    CU_ASSERT_TRUE(in_cache());
+    CU_ASSERT_EQUAL(check_table(b, FL(1.0)), 0);
+    csoundDestroy(b);
+    csoundDestroy(c);
+    CU_ASSERT_FALSE(in_cache());
+}
+
+void test_scaled_gen01(void)
+{
+    CSOUND  *c;
+
+    /* a scaled table does not create an entry it could not map */
+    c = load_table("32768");
+    CU_ASSERT_EQUAL(check_table(c, FL(32768.0)), 0);
+    CU_ASSERT_FALSE(in_cache());
+    csoundDestroy(c);
+}
+
+static int ncallbacks = 0;
+
+static int invert_memfile(CSOUND *csound, MEMFIL *mfp)
+{
+    char    *p;
+
+    (void) csound;
+    for (p = mfp->beginp; p < mfp->endp; p++)
+      *p = ~(*p);
+    ncallbacks++;
+    return OK;
+}
+
+static int memfile_cached(int (*callback)(CSOUND*, MEMFIL*))
+{
+    size_t  nbytes;
+    void    *entry = samplecache_find(TEST_MEMFILE, SAMPLECACHE_MEMFILE,
+                                      CSFTYPE_UNKNOWN, 0,
+                                      (const void*) callback, &nbytes);
+    if (entry == NULL)
+      return 0;
+    samplecache_release(entry);
+    return 1;
+}
+
+static int check_memfile(MEMFIL *mfp, int inverted)
+{
+    int     i, bad = 0;
+
+    if (mfp == NULL || mfp->length != MEMFILE_LEN)
+      return -1;
+    for (i = 0; i < MEMFILE_LEN; i++)
+      if ((unsigned char) mfp->beginp[i] !=
+          (unsigned char) (inverted ? ~i : i))
+        bad++;
+    return bad;
+}
+
+void test_shared_memfile(void)
+{
+    CSOUND  *a = csoundCreate(NULL), *b = csoundCreate(NULL);
+    MEMFIL  *ma, *mb, *pa, *pb;
+
+    /* processed data is loaded and processed once, and then shared */
+    ncallbacks = 0;
+    ma = a->ldmemfile2withCB(a, TEST_MEMFILE, CSFTYPE_UNKNOWN,
+                             invert_memfile);
+    CU_ASSERT_TRUE(memfile_cached(invert_memfile));
+    mb = b->ldmemfile2withCB(b, TEST_MEMFILE, CSFTYPE_UNKNOWN,
+                             invert_memfile);
+    CU_ASSERT_EQUAL(ncallbacks, 1);
+    CU_ASSERT_EQUAL(check_memfile(ma, 1), 0);
+    CU_ASSERT_EQUAL(check_memfile(mb, 1), 0);
+    /* plain files are mapped as they are, without a cache entry */
+    pa = a->ldmemfile2withCB(a, "./" TEST_MEMFILE, CSFTYPE_UNKNOWN, NULL);
+    pb = b->ldmemfile2withCB(b, "./" TEST_MEMFILE, CSFTYPE_UNKNOWN, NULL);
+    CU_ASSERT_EQUAL(check_memfile(pa, 0), 0);
+    CU_ASSERT_EQUAL(check_memfile(pb, 0), 0);
+    CU_ASSERT_FALSE(memfile_cached(NULL));
+    csoundDestroy(a);
+    CU_ASSERT_TRUE(memfile_cached(invert_memfile));
+    CU_ASSERT_EQUAL(check_memfile(mb, 1), 0);
+    csoundDestroy(b);
+    CU_ASSERT_FALSE(memfile_cached(invert_memfile));
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+      return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("sample cache tests", init_suite1, clean_suite1);
+    if (NULL == pSuite) {
+      CU_cleanup_registry();
+      return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if ((NULL == CU_add_test(pSuite, "Test shared GEN01 tables",
+                             test_shared_gen01)) ||
+        (NULL == CU_add_test(pSuite, "Test scaled GEN01 tables",
+                             test_scaled_gen01)) ||
+        (NULL == CU_add_test(pSuite, "Test shared memfiles",
+                             test_shared_memfile))) {
+      CU_cleanup_registry();
+      return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -0,0 +1,246 @@
+/*
+ * File:   syncgrain_regression.c
+ *
+ * The output of syncgrain, syncloop and diskgrain, at steady and
+ * modulated densities, sizes, pitches and pointer rates, forwards and
+ * backwards, with sample accurate starts and ends, and for diskgrain
+ * over buffer reloads of one, two and four channel files.  The
+ * references are of the code before the grains were rendered a span at
+ * a time, which was meant to leave the output as it was, bit for bit,
+ * where no grain stream has to be let go.
+ *
+ *   syncgrainRegression [-p]
+ *
+ * (see opcode_regression.h)
+ */
+
+#include "opcode_regression.h"
+#include "../../Opcodes/syncgrain.c"
+
+/* the opcodes */
+
+enum { OP_SYNCGRAIN, OP_SYNCLOOP, OP_DISKGRAIN };
+
+static const char *op_name[] = { "syncgrain", "syncloop", "diskgrain" };
+
+/* the bits of a case */
+
+#define M_MOD       1       /* modulated density, size and pitch */
+#define M_OFFSET    2       /* sample accurate starts and ends */
+#define M_PRATE     4       /* pointer rate swept forwards and back */
+#define M_SHORTENV  8       /* an envelope of 1000 points */
+
+typedef struct {
+    int     op, mode, nchnls;
+    MYFLT   dens, dur, olaps, pitch, prate;
+} CASE;
+
+static const CASE cases[] = {
+    { OP_SYNCGRAIN, 0, 1, 100.0, 0.05, 20.0, 1.0, 1.0 },
+    { OP_SYNCGRAIN, M_MOD | M_SHORTENV, 1, 30.0, 0.3, 40.0, 1.5, 0.5 },
+    { OP_SYNCGRAIN, M_OFFSET, 1, 200.0, 0.02, 10.0, 0.7, -1.0 },
+    { OP_SYNCGRAIN, M_PRATE | M_MOD, 1, 60.0, 0.1, 30.0, -0.8, 1.0 },
+    { OP_SYNCLOOP, 0, 1, 100.0, 0.05, 20.0, 1.0, 1.0 },
+    { OP_SYNCLOOP, M_MOD | M_SHORTENV, 1, 30.0, 0.3, 40.0, 1.5, 0.5 },
+    { OP_SYNCLOOP, M_OFFSET, 1, 200.0, 0.02, 10.0, 0.7, -1.0 },
+    { OP_SYNCLOOP, M_PRATE | M_MOD, 1, 60.0, 0.1, 30.0, -0.8, 1.0 },
+    { OP_DISKGRAIN, 0, 1, 50.0, 0.1, 20.0, 1.0, 2.0 },
+    { OP_DISKGRAIN, M_MOD, 2, 40.0, 0.15, 30.0, 1.5, 3.0 },
+    { OP_DISKGRAIN, M_PRATE | M_SHORTENV, 2, 80.0, 0.05, 20.0, 0.9, 2.0 },
+    { OP_DISKGRAIN, M_MOD, 4, 30.0, 0.2, 30.0, -1.2, 2.5 }
+};
+
+#define NCASES ((int) (sizeof(cases) / sizeof(cases[0])))
+
+/* recorded with the code of before the change, in double and in float
+   builds */
+
+static const uint64_t refs[NCASES] = {
+#ifdef USE_DOUBLE
+    0x6887e35629558d4bULL,   /* syncgrain, case 0 */
+    0x1e70e0cf4992499cULL,   /* syncgrain, case 1 */
+    0xe4b15ff355945481ULL,   /* syncgrain, case 2 */
+    0xda8c73c508ff6e85ULL,   /* syncgrain, case 3 */
+    0x45a1422e62f66497ULL,   /* syncloop, case 4 */
+    0xcf2dde58dc39db4dULL,   /* syncloop, case 5 */
+    0xa673b7e4032d61c2ULL,   /* syncloop, case 6 */
+    0xd2e6c3d0f7737acaULL,   /* syncloop, case 7 */
+    0xc8a5635fe08bb971ULL,   /* diskgrain, case 8 */
+    0x1fbae197522eaa70ULL,   /* diskgrain, case 9 */
+    0x847d4524862c7076ULL,   /* diskgrain, case 10 */
+    0xc0b69a1722b4aeceULL,   /* diskgrain, case 11 */
+#else
+    0xd3c001c6f62ec9ceULL,   /* syncgrain, case 0 */
+    0x98ab053018ca114fULL,   /* syncgrain, case 1 */
+    0x5cb2fbe4975ce4c4ULL,   /* syncgrain, case 2 */
+    0x06d824439def5d11ULL,   /* syncgrain, case 3 */
+    0x9e76d3339279cfb5ULL,   /* syncloop, case 4 */
+    0x816088b4cde1c074ULL,   /* syncloop, case 5 */
+    0x138f574d3e86dc40ULL,   /* syncloop, case 6 */
+    0x21e1016fdde81ac0ULL,   /* syncloop, case 7 */
+    0x51c302f22874cdbdULL,   /* diskgrain, case 8 */
+    0xc207ce16f18f8b58ULL,   /* diskgrain, case 9 */
+    0x41cd34de1ae72620ULL,   /* diskgrain, case 10 */
+    0x8c37d25a66b23d30ULL,   /* diskgrain, case 11 */
+#endif
+};
+
+/* an in-memory sound file for diskgrain */
+
+#define FILE_FRAMES 300000
+
+static int      file_chans;
+static MYFLT    *file_data;
+
+struct SNDFILE_tag {
+    sf_count_t  pos;
+};
+
+sf_count_t sf_seek(SNDFILE *sf, sf_count_t frames, int whence)
+{
+    sf->pos = (whence == SEEK_SET ? frames :
+               whence == SEEK_END ? FILE_FRAMES + frames : sf->pos + frames);
+    if (sf->pos < 0)
+      sf->pos = 0;
+    if (sf->pos > FILE_FRAMES)
+      sf->pos = FILE_FRAMES;
+    return sf->pos;
+}
+
+sf_count_t sf_read_MYFLT(SNDFILE *sf, MYFLT *ptr, sf_count_t items)
+{
+    sf_count_t frames = items / file_chans;
+
+    if (frames > FILE_FRAMES - sf->pos)
+      frames = FILE_FRAMES - sf->pos;
+    memcpy(ptr, &file_data[sf->pos * file_chans],
+           (size_t) (frames * file_chans) * sizeof(MYFLT));
+    sf->pos += frames;
+    return frames * file_chans;
+}
+
+static SNDFILE  file_sf;
+
+static void *file_open(CSOUND *csound, void *fd, int type, const char *name,
+                       void *param, const char *env, int csFileType,
+                       int isTemporary)
+{
+    SF_INFO *info = (SF_INFO*) param;
+
+    (void) csound; (void) type; (void) name; (void) env;
+    (void) csFileType; (void) isTemporary;
+    file_sf.pos = 0;
+    *(SNDFILE**) fd = &file_sf;
+    memset(info, 0, sizeof(SF_INFO));
+    info->frames = FILE_FRAMES;
+    info->channels = file_chans;
+    info->samplerate = REG_SR;
+    return (void*) &file_sf;
+}
+
+static void window(int fno, int32 flen)
+{
+    FUNC    *ftp = reg_table(fno, flen);
+    int32   i;
+
+    for (i = 0; i <= flen; i++) {
+      MYFLT x = (MYFLT) i / (MYFLT) flen;
+      ftp->ftable[i] = FL(4.0) * x * (FL(1.0) - x);
+    }
+}
+
+static uint64_t run_case(CSOUND *csound, const CASE *t, int cycles)
+{
+    static MYFLT out[DGRAIN_MAXCHAN][REG_KSMPS];
+    static STRINGDAT fname = { "regression.wav", 15 };
+    static OPTXT optext;
+    MYFLT   amp = FL(0.7), fr, pitch, gs, prate, fn1 = FL(1.0);
+    MYFLT   fn2 = (t->mode & M_SHORTENV ? FL(3.0) : FL(2.0));
+    MYFLT   olaps = t->olaps, loop_start = FL(0.5), loop_end = FL(1.2);
+    MYFLT   start = FL(0.1), skip = FL(0.0), maxsize = FL(1.0);
+    MYFLT   ioff = FL(0.3);
+    syncgrain       sg;
+    syncgrainloop   sl;
+    filegrain       fg;
+    uint64_t h = REG_HASH0;
+    int     c, i, ok = OK;
+
+    fr = t->dens; gs = t->dur; pitch = t->pitch; prate = t->prate;
+    memset(&sg, 0, sizeof(sg));
+    memset(&sl, 0, sizeof(sl));
+    memset(&fg, 0, sizeof(fg));
+    reg_ip.ksmps_offset = reg_ip.ksmps_no_end = 0;
+    switch (t->op) {
+    case OP_SYNCGRAIN:
+      sg.h.insdshead = &reg_ip;
+      sg.output = out[0]; sg.amp = &amp; sg.fr = &fr; sg.pitch = &pitch;
+      sg.grsize = &gs; sg.prate = &prate; sg.ifn1 = &fn1; sg.ifn2 = &fn2;
+      sg.ols = &olaps;
+      ok = syncgrain_init(csound, &sg);
+      break;
+    case OP_SYNCLOOP:
+      sl.h.insdshead = &reg_ip;
+      sl.output = out[0]; sl.amp = &amp; sl.fr = &fr; sl.pitch = &pitch;
+      sl.grsize = &gs; sl.prate = &prate; sl.loop_start = &loop_start;
+      sl.loop_end = &loop_end; sl.ifn1 = &fn1; sl.ifn2 = &fn2;
+      sl.ols = &olaps; sl.startpos = &start; sl.iskip = &skip;
+      ok = syncgrainloop_init(csound, &sl);
+      break;
+    default:
+      file_chans = t->nchnls;
+      for (i = 0; i < FILE_FRAMES * file_chans; i++)
+        file_data[i] = reg_sine(i, 2094) + FL(0.1) * reg_rand();
+      optext.t.outArgCount = t->nchnls;
+      fg.h.insdshead = &reg_ip;
+      fg.h.optext = &optext;
+      for (i = 0; i < DGRAIN_MAXCHAN; i++)
+        fg.output[i] = out[i];
+      fg.fname = &fname; fg.amp = &amp; fg.fr = &fr; fg.pitch = &pitch;
+      fg.grsize = &gs; fg.prate = &prate; fg.ifn2 = &fn2; fg.ols = &olaps;
+      fg.max = &maxsize; fg.ioff = &ioff;
+      ok = filegrain_init(csound, &fg);
+      break;
+    }
+    if (ok != OK)
+      return 0;
+    for (c = 0; c < cycles; c++) {
+      if (t->mode & M_MOD) {
+        fr = t->dens * (FL(1.0) + FL(0.3) * reg_sine(c, 126));
+        gs = t->dur * (FL(1.0) + FL(0.4) * reg_sine(c, 203));
+        pitch = t->pitch * (FL(1.0) + FL(0.2) * reg_sine(c, 314));
+      }
+      if (t->mode & M_PRATE)
+        prate = t->prate * FL(2.0) * reg_sine(c, 628);
+      reg_ip.ksmps_offset = (t->mode & M_OFFSET) && c % 7 == 3 ? 5 : 0;
+      reg_ip.ksmps_no_end = (t->mode & M_OFFSET) && c % 11 == 4 ? 9 : 0;
+      ok = (t->op == OP_SYNCGRAIN ? syncgrain_process(csound, &sg) :
+            t->op == OP_SYNCLOOP ? syncgrainloop_process(csound, &sl) :
+            filegrain_process(csound, &fg));
+      if (ok != OK)
+        return 0;
+      for (i = 0; i < t->nchnls; i++)
+        reg_hash(&h, out[i], REG_KSMPS);
+    }
+    return h;
+}
+
+int main(int argc, char **argv)
+{
+    CSOUND  *csound = reg_init(argc, argv);
+    FUNC    *ftp;
+    char    name[64];
+    int32   i;
+
+    csound->FileOpen2 = file_open;
+    ftp = reg_table(1, 100000);
+    for (i = 0; i <= ftp->flen; i++)
+      ftp->ftable[i] = reg_sine(i, 628) + FL(0.2) * reg_rand();
+    window(2, 8192);
+    window(3, 1000);
+    file_data = (MYFLT*) malloc(FILE_FRAMES * DGRAIN_MAXCHAN * sizeof(MYFLT));
+    for (i = 0; i < NCASES; i++) {
+      snprintf(name, sizeof(name), "%s, case %d", op_name[cases[i].op], i);
+      reg_check(name, run_case(csound, &cases[i], 600), refs[i]);
+    }
+    return reg_failed;
+}
@@ -0,0 +1,314 @@
+/*
+ * File:   ugens2_bench.c
+ *
+ * Throughput of the table reading and oscillator kernels of
+ * OOps/ugens2.c, for each instruction set ugens2.c dispatches to and
+ * for table sizes from those that fit in the first level cache to those
+ * that do not fit in any, against the scalar loops they replaced, with a
+ * check that every variant gives the scalar results exactly.
+ *
+ *   ugens2Bench [ksmps [seconds-per-kernel]]
+ *
+ * (see kernel_bench.h)
+ */
+
+#define __BUILDING_LIBCSOUND
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "csoundCore.h"
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic ignored "-Wunused-function"  /* not every kernel */
+#endif
+
+#define KERNEL      static
+#define KNAME(x)    ug2_##x##_generic
+#include "../../OOps/ugens2_kernels.h"
+#undef KNAME
+#undef KERNEL
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#define HAVE_AVX2_KERNELS 1
+#define KERNEL      static __attribute__ ((target ("avx2")))
+#define KNAME(x)    ug2_##x##_avx2
+#define UG2_GATHER  2
+#include "../../OOps/ugens2_kernels.h"
+#undef KNAME
+#undef UG2_GATHER
+#undef KERNEL
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    !defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 8
+#define HAVE_AVX512_KERNELS 1
+#define KERNEL      static \
+                    __attribute__ ((target ("avx512f,prefer-vector-width=512")))
+#define KNAME(x)    ug2_##x##_avx512
+#define UG2_GATHER  3
+#include "../../OOps/ugens2_kernels.h"
+#undef KNAME
+#undef UG2_GATHER
+#undef KERNEL
+#endif
+
+#include "kernel_bench.h"
+
+static int     ksmps = 64;
+static MYFLT  *in_x, *in_cps, *in_amp, *out, *ref, *ftbl;
+static int32   flen, lobits, lomask, phs0;
+static MYFLT   lodiv, sicvt;
+
+/* the loops of the opcodes before they called the kernels */
+
+#define MYFLOOR(x) (x >= FL(0.0) ? (int32)x : (int32)((double)x - 0.99999999))
+
+static void scalar(int op, MYFLT *r)
+{
+    MYFLT   *x = in_x, *tab = ftbl, xbmul = (MYFLT) flen, fract, v1, v2, ndx;
+    int32    n, nsmps = ksmps, indx, phs = phs0, length = flen;
+    int32    mask = flen - 1;
+    int32    inc = MYFLT2LONG(in_cps[0] * sicvt);
+    switch (op) {
+    case 0:                                     /* oscil, k-rate cps */
+      for (n = 0; n < nsmps; n++) {
+        r[n] = tab[phs >> lobits] * in_amp[0];
+        phs = (phs + inc) & PHMASK;
+      }
+      break;
+    case 1:                                     /* oscil, a-rate cps */
+      for (n = 0; n < nsmps; n++) {
+        int32 inc = MYFLT2LONG(in_cps[n] * sicvt);
+        r[n] = tab[phs >> lobits] * in_amp[0];
+        phs += inc;
+        phs &= PHMASK;
+      }
+      break;
+    case 2:                                     /* oscili, k-rate cps */
+    case 3:                                     /* oscili, a-rate both */
+      for (n = 0; n < nsmps; n++) {
+        MYFLT *ftab;
+        fract = (MYFLT) (phs & lomask) * lodiv;
+        ftab = tab + (phs >> lobits);
+        v1 = ftab[0];
+        r[n] = (v1 + (ftab[1] - v1) * fract) * in_amp[op == 2 ? 0 : n];
+        if (op == 3) inc = MYFLT2LONG(in_cps[n] * sicvt);
+        phs = (phs + inc) & PHMASK;
+      }
+      break;
+    case 4:                                     /* table, limited */
+      for (n = 0; n < nsmps; n++) {
+        ndx = (x[n] * xbmul);
+        indx = (int32) MYFLOOR((double)ndx);
+        if (UNLIKELY(indx > length - 1))
+          indx = length - 1;
+        else if (UNLIKELY(indx < (int32)0))
+          indx = 0L;
+        r[n] = tab[indx];
+      }
+      break;
+    case 5:                                     /* tablei, limited */
+      for (n = 0; n < nsmps; n++) {
+        ndx = (x[n] * xbmul);
+        indx = (int32) ndx;
+        if (UNLIKELY(indx <= 0L)) {
+          r[n] = tab[0];
+          continue;
+        }
+        if (UNLIKELY(indx >= length)) {
+          r[n] = tab[length];
+          continue;
+        }
+        fract = ndx - indx;
+        v1 = tab[indx];
+        v2 = tab[indx + 1];
+        r[n] = v1 + (v2 - v1)*fract;
+      }
+      break;
+    case 6:                                     /* tablei, wrapped */
+      for (n = 0; n < nsmps; n++) {
+        ndx = (x[n] * xbmul);
+        indx = (int32) MYFLOOR(ndx);
+        fract = ndx - indx;
+        indx &= mask;
+        v1 = tab[indx];
+        v2 = tab[indx + 1];
+        r[n] = v1 + (v2 - v1)*fract;
+      }
+      break;
+    case 7:                                     /* table3, limited */
+    case 8:                                     /* table3, wrapped */
+      for (n = 0; n < nsmps; n++) {
+        ndx = (x[n] * xbmul);
+        indx = (int32) MYFLOOR((double)ndx);
+        fract = ndx - indx;
+        if (op == 7) {
+          if (UNLIKELY(ndx > length)) {
+            indx  = length - 1;
+            fract = FL(1.0);
+          }
+          else if (UNLIKELY(indx < 0L)) {
+            indx  = 0L;
+            fract = FL(0.0);
+          }
+        }
+        else
+          indx &= mask;
+        if (UNLIKELY(indx <1 || indx == length-1 || length<4)) {
+          v1 = tab[indx];
+          v2 = tab[indx + 1];
+          r[n] = v1 + (v2 - v1)*fract;
+        }
+        else {
+          MYFLT ym1 = tab[indx-1], y0 = tab[indx];
+          MYFLT y1 = tab[indx+1], y2 = tab[indx+2];
+          MYFLT frsq = fract*fract;
+          MYFLT frcu = frsq*ym1;
+          MYFLT t1 = y2 + y0+y0+y0;
+          r[n] = y0 + FL(0.5)*frcu +
+            fract*(y1 - frcu/FL(6.0) - t1/FL(6.0) - ym1/FL(3.0)) +
+            frsq*fract*(t1/FL(6.0) - FL(0.5)*y1) + frsq*(FL(0.5)* y1 - y0);
+        }
+      }
+      break;
+    }
+}
+
+/* one call of kernel 'op' of variant 'v' over the input blocks, as the
+   opcodes call them; k-rate arguments are taken from the first sample */
+
+#define CALL(v, S)                                                      \
+  case v:                                                               \
+    switch (op) {                                                       \
+    case 0:                                                             \
+      ug2_osc_##S(r, ftbl, phs0, MYFLT2LONG(in_cps[0] * sicvt), NULL,   \
+                  sicvt, lobits, in_amp[0], NULL, ksmps);               \
+      break;                                                            \
+    case 1:                                                             \
+      ug2_osc_##S(r, ftbl, phs0, 0, in_cps, sicvt, lobits,              \
+                  in_amp[0], NULL, ksmps);                              \
+      break;                                                            \
+    case 2:                                                             \
+      ug2_osci_##S(r, ftbl, phs0, MYFLT2LONG(in_cps[0] * sicvt), NULL,  \
+                   sicvt, lobits, lomask, lodiv, in_amp[0], NULL, ksmps); \
+      break;                                                            \
+    case 3:                                                             \
+      ug2_osci_##S(r, ftbl, phs0, 0, in_cps, sicvt, lobits, lomask,     \
+                   lodiv, FL(1.0), in_amp, ksmps);                      \
+      break;                                                            \
+    case 4:                                                             \
+      ug2_tab_##S(r, ftbl, in_x, (MYFLT) flen, FL(0.0), flen, flen - 1, \
+                  0, ksmps);                                            \
+      break;                                                            \
+    case 5:                                                             \
+    case 6:                                                             \
+      ug2_tabi_##S(r, ftbl, in_x, (MYFLT) flen, FL(0.0), flen, flen - 1, \
+                   op == 6, ksmps);                                     \
+      break;                                                            \
+    case 7:                                                             \
+    case 8:                                                             \
+      ug2_tab3_##S(r, ftbl, in_x, (MYFLT) flen, FL(0.0), flen, flen - 1, \
+                   op == 8, ksmps);                                     \
+      break;                                                            \
+    }                                                                   \
+    break;
+
+static const char *op_name[] = {
+    "oscil kk", "oscil ka", "oscili kk", "oscili aa",
+    "table", "tablei", "tablei w", "table3", "table3 w"
+};
+
+#define NOPS ((int) (sizeof(op_name) / sizeof(op_name[0])))
+
+static void run(int v, int op, MYFLT *r)
+{
+    switch (v) {
+    case VAR_SCALAR:
+      scalar(op, r);
+      break;
+    CALL(VAR_GENERIC, generic)
+#ifdef HAVE_AVX2_KERNELS
+    CALL(VAR_AVX2, avx2)
+#endif
+#ifdef HAVE_AVX512_KERNELS
+    CALL(VAR_AVX512, avx512)
+#endif
+    }
+}
+
+/* the oscillators start from a new phase on every call, so that the
+   reads cover the whole table */
+
+static void call(int v, int op)
+{
+    phs0 = (phs0 + 0x2468ACE) & PHMASK;
+    run(v, op, out);
+}
+
+/* samples per second of variant 'v' of kernel 'op' */
+
+static double measure(int v, int op, double seconds)
+{
+    return bench_rate(call, v, op, 256, seconds) * (double) ksmps;
+}
+
+/* the number of samples that differ from the scalar results */
+
+static int compare(int v, int op)
+{
+    int i, bad = 0;
+    run(VAR_SCALAR, op, ref);
+    run(v, op, out);
+    for (i = 0; i < ksmps; i++)
+      if (memcmp(&out[i], &ref[i], sizeof(MYFLT)) != 0)
+        bad++;
+    if (bad)
+      fprintf(stderr, "%s %s, table %d: %d samples differ from scalar\n",
+              op_name[op], variant_name[v], (int) flen, bad);
+    return bad;
+}
+
+int main(int argc, char **argv)
+{
+    static const int32 sizes[] = { 1024, 16384, 262144, 4194304 };
+    static const KERNEL_BENCH b = { NOPS, op_name, measure, compare };
+    char   title[48];
+    double seconds = 0.1;
+    int    i, s, failed = 0;
+
+    if (bench_args(argc, argv, &ksmps, &seconds))
+      return 1;
+    in_x = (MYFLT *) malloc(sizeof(MYFLT) * ksmps);
+    in_cps = (MYFLT *) malloc(sizeof(MYFLT) * ksmps);
+    in_amp = (MYFLT *) malloc(sizeof(MYFLT) * ksmps);
+    out = (MYFLT *) malloc(sizeof(MYFLT) * ksmps);
+    ref = (MYFLT *) malloc(sizeof(MYFLT) * ksmps);
+    sicvt = FMAXLEN / FL(44100.0);
+    srand(1);
+    for (i = 0; i < ksmps; i++) {
+      /* indices a little outside the table, to exercise the limits */
+      in_x[i] = (MYFLT) (rand() / (double) RAND_MAX * 1.2 - 0.1);
+      in_cps[i] = (MYFLT) (rand() / (double) RAND_MAX * 4000.0 - 500.0);
+      in_amp[i] = (MYFLT) (rand() / (double) RAND_MAX);
+    }
+
+    for (s = 0; s < (int) (sizeof(sizes) / sizeof(sizes[0])); s++) {
+      flen = sizes[s];
+      for (lobits = 0; (flen << lobits) < MAXLEN; lobits++)
+        ;
+      lomask = (1 << lobits) - 1;
+      lodiv = FL(1.0) / (MYFLT) (1 << lobits);
+      ftbl = (MYFLT *) malloc(sizeof(MYFLT) * (flen + 3));
+      for (i = 0; i < flen + 3; i++)
+        ftbl[i] = (MYFLT) sin(2.0 * PI * i / flen);
+
+      snprintf(title, sizeof(title), "table %d, ksmps %d", (int) flen, ksmps);
+      failed |= bench_table(&b, title, "samples", seconds);
+      free(ftbl);
+    }
+    free(in_x); free(in_cps); free(in_amp); free(out); free(ref);
+    return failed;
+}